@@ -0,0 +1,75 @@
+#ifndef INCL_SIM_BATCH_HPP
+#define INCL_SIM_BATCH_HPP
+
+#include <string>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/elf_load.hpp>
+#include <sim/simulator.hpp>
+
+namespace sim::batch {
+
+// Single ELF simulation result
+struct JobResult final {
+    std::string elf_path{};
+    SimStatus status = SimStatus::OK;
+    size_t icount = 0;
+    // Host wall time in seconds
+    double wall_time = 0;
+};
+
+// Batch simulation result
+struct BatchResult final {
+    std::vector<JobResult> jobs{};
+    size_t icount = 0;
+    // Host wall time in seconds
+    double wall_time = 0;
+
+    NODISCARD double mips() const noexcept {
+        static constexpr double MEGA = 1e6;
+        return wall_time == 0 ? 0 : icount / wall_time / MEGA;
+    }
+};
+
+// ELF loading result
+struct LoadElfResult final {
+    SimStatus status = SimStatus::OK;
+    VirtAddr start_pc = 0;
+    elf::SymbolIndex symbols{};
+};
+
+// Map stack, load ELF to given simulator and enable translation.
+// Simulator must be reset. With host_funcs, guest libc functions found in
+// ELF symbol table are simulated with host routines
+NODISCARD LoadElfResult loadElf(Simulator &sim, const std::string &elf_path,
+                                bool host_funcs = false);
+
+// Load ELF to given simulator and simulate it. Simulator must be reset
+JobResult runElf(Simulator &sim, const std::string &elf_path,
+                 bool host_funcs = false);
+
+// Read batch manifest: one ELF path per line.
+// Empty lines and lines starting with '#' are skipped
+NODISCARD bool readManifest(const std::string &manifest_path,
+                            std::vector<std::string> &elf_paths);
+
+// Runs ELF images on a work-stealing pool of simulators.
+// Simulator instances are reused across jobs. With code sharing enabled,
+// simulators take decoded bbs from shared store of the run
+class BatchRunner final {
+    size_t m_worker_number = 1;
+    bool m_share_code = false;
+
+  public:
+    explicit BatchRunner(size_t worker_number, bool share_code = false)
+        : m_worker_number(worker_number), m_share_code(share_code) {
+        SIM_ASSERT(worker_number != 0);
+    }
+
+    BatchResult run(const std::vector<std::string> &elf_paths);
+};
+
+} // namespace sim::batch
+
+#endif // INCL_SIM_BATCH_HPP
@@ -0,0 +1,141 @@
+#include <chrono>
+#include <fstream>
+#include <memory>
+
+#include <sim/batch.hpp>
+#include <sim/elf_load.hpp>
+#include <sim/pool.hpp>
+
+namespace sim::batch {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+NODISCARD double secondsSince(Clock::time_point start) noexcept {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct HostFuncName final {
+    const char *name = nullptr;
+    Simulator::HostFunc func{};
+};
+
+constexpr HostFuncName HOST_FUNC_NAMES[] = {
+    {"memcpy", Simulator::HostFunc::MEMCPY},
+    {"memset", Simulator::HostFunc::MEMSET},
+    {"strlen", Simulator::HostFunc::STRLEN},
+    {"strcmp", Simulator::HostFunc::STRCMP},
+};
+
+} // namespace
+
+NODISCARD LoadElfResult loadElf(Simulator &sim, const std::string &elf_path,
+                                bool host_funcs) {
+    elf::ElfLoader loader{sim.getPhysMemory()};
+
+    auto [stack_map_status, start_sp] = loader.mapStack();
+    if (stack_map_status != SimStatus::OK) {
+        return {stack_map_status, 0, {}};
+    }
+    sim.getHart().gprFile().write(gpr::GPR_IDX::SP, start_sp);
+
+    auto [load_elf_status, start_pc] = loader.loadElf(elf_path.c_str());
+    if (load_elf_status != SimStatus::OK) {
+        return {load_elf_status, 0, {}};
+    }
+
+    // Heap pages are mapped by copy of loader mapper, so checkpoints of
+    // syscalls state keep their own page allocation
+    sim.syscalls().setMemory(loader.brkStart(), loader.lazyMapper());
+
+    if (host_funcs) {
+        for (auto &&[name, func] : HOST_FUNC_NAMES) {
+            if (auto entry = loader.findFunc(name); entry != 0) {
+                sim.setHostFunc(entry, func);
+            }
+        }
+    }
+
+    csr::SATP64 satp64{};
+    satp64.setMODE(csr::SATP64::MODEValue::SV39);
+    sim.getHart().csrFile().set(satp64);
+
+    return {SimStatus::OK, start_pc,
+            elf::SymbolIndex{loader.funcSymbols()}};
+}
+
+JobResult runElf(Simulator &sim, const std::string &elf_path,
+                 bool host_funcs) {
+    auto start = Clock::now();
+    JobResult res{elf_path};
+
+    auto load_res = loadElf(sim, elf_path, host_funcs);
+    if (load_res.status != SimStatus::OK) {
+        res.status = load_res.status;
+        return res;
+    }
+
+    res.status = sim.simulate(load_res.start_pc);
+    res.icount = sim.icount();
+    res.wall_time = secondsSince(start);
+
+    return res;
+}
+
+NODISCARD bool readManifest(const std::string &manifest_path,
+                            std::vector<std::string> &elf_paths) {
+    std::ifstream manifest{manifest_path};
+    if (!manifest) {
+        return false;
+    }
+
+    for (std::string line{}; std::getline(manifest, line);) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        elf_paths.push_back(line);
+    }
+
+    return true;
+}
+
+BatchResult BatchRunner::run(const std::vector<std::string> &elf_paths) {
+    auto start = Clock::now();
+
+    BatchResult res{};
+    res.jobs.resize(elf_paths.size());
+
+    // Shared bbs are released with the batch
+    cache::SharedBbStore shared_bb_store{};
+
+    // Simulators are created lazily by their workers
+    std::vector<std::unique_ptr<Simulator>> sims(m_worker_number);
+
+    pool::WorkStealingPool pool{m_worker_number};
+    pool.run(elf_paths.size(), [&](size_t worker_idx, size_t job_idx) {
+        auto &sim = sims[worker_idx];
+
+        if (sim == nullptr) {
+            sim = std::make_unique<Simulator>();
+
+            if (m_share_code) {
+                sim->setSharedBbStore(&shared_bb_store);
+            }
+        } else {
+            sim->reset();
+        }
+
+        res.jobs[job_idx] = runElf(*sim, elf_paths[job_idx]);
+    });
+
+    for (auto &&job : res.jobs) {
+        res.icount += job.icount;
+    }
+    res.wall_time = secondsSince(start);
+
+    return res;
+}
+
+} // namespace sim::batch
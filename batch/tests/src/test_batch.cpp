@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sim/batch.hpp>
+
+namespace sim::batch {
+
+namespace {
+
+const std::string QUEENS_PATH = SIM_TESTS_DIR "/queens/8-queens";
+const std::string MISSING_PATH = SIM_TESTS_DIR "/queens/missing";
+
+} // namespace
+
+TEST(BatchTest, readManifest) {
+    const std::string PATH = "test_batch_manifest.txt";
+
+    {
+        std::ofstream manifest{PATH};
+        manifest << "# comment\n"
+                 << "a.elf\n"
+                 << "\n"
+                 << "dir/b.elf\n"
+                 << "# c.elf\n"
+                 << "missing.elf";
+    }
+
+    // Paths are appended. ELF files are not checked
+    std::vector<std::string> elf_paths{"first.elf"};
+    ASSERT_TRUE(readManifest(PATH, elf_paths));
+    std::remove(PATH.c_str());
+
+    ASSERT_EQ(elf_paths, (std::vector<std::string>{"first.elf", "a.elf",
+                                                   "dir/b.elf",
+                                                   "missing.elf"}));
+
+    ASSERT_FALSE(readManifest(PATH, elf_paths));
+    ASSERT_EQ(elf_paths.size(), 4);
+}
+
+TEST(BatchTest, runElf) {
+    Simulator sim{};
+
+    auto res = runElf(sim, QUEENS_PATH);
+    ASSERT_EQ(res.status, SimStatus::OK);
+    ASSERT_EQ(res.elf_path, QUEENS_PATH);
+    ASSERT_NE(res.icount, 0);
+    ASSERT_EQ(res.icount, sim.icount());
+
+    sim.reset();
+    auto missing_res = runElf(sim, MISSING_PATH);
+    ASSERT_NE(missing_res.status, SimStatus::OK);
+    ASSERT_EQ(missing_res.icount, 0);
+}
+
+class BatchRunnerTest : public ::testing::TestWithParam<bool> {};
+
+// Simulators are reused across jobs, so every job of same ELF gives same
+// icount. Failed jobs do not stop batch
+TEST_P(BatchRunnerTest, run) {
+    Simulator ref_sim{};
+    auto ref = runElf(ref_sim, QUEENS_PATH);
+    ASSERT_EQ(ref.status, SimStatus::OK);
+
+    const std::vector<std::string> ELF_PATHS = {
+        QUEENS_PATH, QUEENS_PATH, MISSING_PATH, QUEENS_PATH, QUEENS_PATH};
+
+    BatchRunner runner{2, GetParam()};
+    auto res = runner.run(ELF_PATHS);
+
+    ASSERT_EQ(res.jobs.size(), ELF_PATHS.size());
+    for (size_t i = 0; i != ELF_PATHS.size(); ++i) {
+        const auto &job = res.jobs[i];
+        ASSERT_EQ(job.elf_path, ELF_PATHS[i]);
+
+        if (ELF_PATHS[i] == MISSING_PATH) {
+            ASSERT_NE(job.status, SimStatus::OK);
+            ASSERT_EQ(job.icount, 0);
+        } else {
+            ASSERT_EQ(job.status, SimStatus::OK);
+            ASSERT_EQ(job.icount, ref.icount);
+        }
+    }
+
+    ASSERT_EQ(res.icount, 4 * ref.icount);
+    ASSERT_GT(res.wall_time, 0);
+    ASSERT_DOUBLE_EQ(res.mips(), res.icount / res.wall_time / 1e6);
+}
+
+INSTANTIATE_TEST_SUITE_P(BatchTest, BatchRunnerTest, ::testing::Bool());
+
+TEST(BatchTest, emptyBatch) {
+    BatchRunner runner{3};
+    auto res = runner.run({});
+
+    ASSERT_TRUE(res.jobs.empty());
+    ASSERT_EQ(res.icount, 0);
+}
+
+} // namespace sim::batch
@@ -16,6 +16,7 @@ struct Bb final {
 
     std::array<instr::Instr, MAX_SIZE> m_instrs{};
 
+  public:
     NODISCARD static constexpr bool isBranch(instr::InstrId id) noexcept {
         switch (id) {
         case instr::InstrId::JAL:
@@ -26,6 +27,8 @@ struct Bb final {
         case instr::InstrId::BLTU:
         case instr::InstrId::BGE:
         case instr::InstrId::BGEU:
+        // Invalidates bb cache
+        case instr::InstrId::FENCE_I:
             return true;
         default:
             return false;
@@ -34,7 +37,6 @@ struct Bb final {
         SIM_UNREACHABLE();
     }
 
-  public:
     NODISCARD constexpr auto getVirtAddr() const noexcept {
         return m_virt_addr;
     }
@@ -46,32 +48,53 @@ struct Bb final {
         InstrCode instr_code = 0;
     };
 
+    // Decode at most MAX_SIZE - 1 instrs starting from bb_virt_addr.
+    // Instrs not fitting into max_code_size bytes are left for next bb
     template <class Fetch>
-    void update(VirtAddr bb_virt_addr, Fetch &fetch) noexcept {
-        // Decode instrs starting from bb_virt_addr
+    void update(VirtAddr bb_virt_addr, Fetch &fetch,
+                size_t max_code_size = ~size_t{0}) noexcept {
         m_virt_addr = bb_virt_addr;
 
+        size_t code_size = 0;
         for (size_t i = 0; i < MAX_SIZE - 1; ++i) {
+            auto code_size_left = max_code_size - code_size;
+            if (code_size_left < COMPRESSED_INSTR_CODE_SIZE) {
+                m_instrs[i] = instr::Instr::statusInstr(SimStatus::OK);
+                return;
+            }
+
             // Fetch next instr
             FetchResult fetch_res = fetch();
 
             // Fetch failure ends bb
             if (fetch_res.status != SimStatus::OK) {
-                m_instrs[i] = instr::Instr::statusInstr(fetch_res.status);
+                m_instrs[i] = instr::Instr::statusInstr(
+                    code_size_left < INSTR_CODE_SIZE ? SimStatus::OK
+                                                     : fetch_res.status);
                 return;
             }
 
             // Decode next instr
             auto &instr = m_instrs[i] = instr::Instr(fetch_res.instr_code);
 
+            if (instr.size() > code_size_left) {
+                instr = instr::Instr::statusInstr(SimStatus::OK);
+                return;
+            }
+            code_size += instr.size();
+
             // Status instr indicates illegal instr
             // Illegal instr ends bb
             if (instr.id() == instr::InstrId::SIM_STATUS_INSTR) {
                 return;
             }
 
-            // Branch instr ends bb
+            // Branch instr ends bb. JAL simulation continues with next instr,
+            // so it is followed by terminator
             if (isBranch(instr.id())) {
+                if (instr.id() == instr::InstrId::JAL) {
+                    m_instrs[i + 1] = instr::Instr::statusInstr(SimStatus::OK);
+                }
                 return;
             }
         }
@@ -80,6 +103,15 @@ struct Bb final {
         m_instrs[MAX_SIZE - 1] = instr::Instr::statusInstr(SimStatus::OK);
     }
 
+    // Replace bb with single host call instr
+    void updateHostCall(VirtAddr bb_virt_addr, instr::Instr instr) noexcept {
+        m_virt_addr = bb_virt_addr;
+        m_instrs[0] = instr;
+    }
+
+    // Replace entry instr, e.g. with jump to instrumented copy of bb
+    void redirect(instr::Instr entry) noexcept { m_instrs[0] = entry; }
+
     void invalidate() noexcept {
         m_virt_addr = INVALID_VA;
         m_instrs[0] =
@@ -87,6 +119,96 @@ struct Bb final {
     }
 };
 
+// Hot code trace. Unlike bb, superblock continues through direct jumps
+struct Superblock final {
+    static constexpr size_t MAX_SIZE = 64;
+
+  private:
+    VirtAddr m_virt_addr = Bb::INVALID_VA;
+
+    std::array<instr::Instr, MAX_SIZE> m_instrs{};
+
+  public:
+    NODISCARD constexpr auto getVirtAddr() const noexcept {
+        return m_virt_addr;
+    }
+
+    NODISCARD const auto *instrs() const noexcept { return m_instrs.data(); }
+
+    // Decode instrs starting from sb_virt_addr. Fetch must provide
+    // jump(VirtAddr) method to continue fetching from JAL target.
+    // Fetch failure ends superblock without error: simulation goes on with
+    // regular bbs. JAL to va for which is_host_func(va) is true ends
+    // superblock, so host function is called by dispatcher
+    template <class Fetch, class IsHostFunc>
+    void update(VirtAddr sb_virt_addr, Fetch &fetch,
+                IsHostFunc is_host_func) noexcept {
+        m_virt_addr = sb_virt_addr;
+
+        VirtAddr pc = sb_virt_addr;
+        for (size_t i = 0; i < MAX_SIZE - 1; ++i) {
+            Bb::FetchResult fetch_res = fetch();
+
+            if (fetch_res.status != SimStatus::OK) {
+                m_instrs[i] = instr::Instr::statusInstr(SimStatus::OK);
+                return;
+            }
+
+            auto &instr = m_instrs[i] = instr::Instr(fetch_res.instr_code);
+
+            if (instr.id() == instr::InstrId::SIM_STATUS_INSTR) {
+                return;
+            }
+
+            // Follow direct jump
+            if (instr.id() == instr::InstrId::JAL) {
+                pc += static_cast<int32_t>(instr.imm());
+
+                if (is_host_func(pc)) {
+                    m_instrs[i + 1] = instr::Instr::statusInstr(SimStatus::OK);
+                    return;
+                }
+
+                fetch.jump(pc);
+                continue;
+            }
+
+            if (Bb::isBranch(instr.id())) {
+                return;
+            }
+
+            pc += instr.size();
+        }
+
+        // Reached max size
+        m_instrs[MAX_SIZE - 1] = instr::Instr::statusInstr(SimStatus::OK);
+    }
+
+    // Replace entry instr, e.g. with jump to instrumented copy of superblock
+    void redirect(instr::Instr entry) noexcept { m_instrs[0] = entry; }
+};
+
+// Call func for each instr executed from bb or superblock entry unless
+// execution stops early. Instrs after branch or host call are left from
+// previously decoded bbs and are skipped. Plugin hook calls are skipped too
+template <class Func>
+void forEachInstr(const instr::Instr *instrs, Func func) {
+    for (const auto *instr = instrs;
+         instr->id() != instr::InstrId::SIM_STATUS_INSTR; ++instr) {
+        auto id = instr->id();
+        if (id == instr::InstrId::SIM_PLUGIN_CALL) {
+            continue;
+        }
+
+        func(*instr);
+
+        if (id == instr::InstrId::SIM_HOST_CALL ||
+            (id != instr::InstrId::JAL && Bb::isBranch(id))) {
+            return;
+        }
+    }
+}
+
 } // namespace sim::bb
 
 #endif // INCL_SIM_BB_HPP
@@ -0,0 +1,159 @@
+#ifndef INCL_SIM_BPRED_HPP
+#define INCL_SIM_BPRED_HPP
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sim/bpred/predictors.hpp>
+#include <sim/common.hpp>
+#include <sim/stats.hpp>
+
+namespace sim::elf {
+class SymbolIndex;
+} // namespace sim::elf
+
+namespace sim::bpred {
+
+enum class JumpKind : uint8_t { DIRECT, CALL, INDIRECT_CALL, RETURN, INDIRECT };
+inline constexpr size_t JUMP_KIND_NUMBER = 5;
+
+// Classify jump by link registers usage as in RISC-V calling convention
+NODISCARD JumpKind classifyJump(bool is_indirect, size_t rd,
+                                size_t rs1) noexcept;
+
+// Executions and mispredictions of one branch
+struct BranchCounters final {
+    VirtAddr pc = 0;
+    uint64_t executions = 0;
+    uint64_t mispredicts = 0;
+};
+
+// Branch outcomes consumer. Simulator reports every conditional branch
+// and jump with their actual outcome
+class Model {
+    // Direct-mapped last target table for indirect jumps
+    static constexpr bit::BitSize BTB_SIZE_LOG_2 = 10;
+    static constexpr size_t BTB_SIZE = size_t{1} << BTB_SIZE_LOG_2;
+
+    struct BtbEntry final {
+        VirtAddr pc = 0;
+        VirtAddr target = 0;
+    };
+
+    std::unique_ptr<BtbEntry[]> m_btb{new BtbEntry[BTB_SIZE]};
+
+    // Per branch counters are kept in direct-mapped table like in bb
+    // profiler. Counters of conflicting branches are moved to a map
+    static constexpr bit::BitSize BRANCHES_SIZE_LOG_2 = 12;
+    static constexpr size_t BRANCHES_SIZE = size_t{1} << BRANCHES_SIZE_LOG_2;
+    static constexpr bit::BitSize PC_ALIGN_BITS = 1;
+
+    std::unique_ptr<BranchCounters[]> m_branches{
+        new BranchCounters[BRANCHES_SIZE]};
+    std::unordered_map<VirtAddr, BranchCounters> m_evicted{};
+
+    BranchCounters m_cond{};
+    std::array<BranchCounters, JUMP_KIND_NUMBER> m_jumps{};
+
+    NODISCARD bool predictIndirect(VirtAddr pc, VirtAddr target) noexcept;
+
+    virtual bool predictCondBranch(VirtAddr pc, bool taken) noexcept = 0;
+    virtual void pushReturn(VirtAddr return_addr) noexcept = 0;
+    virtual VirtAddr popReturn() noexcept = 0;
+
+    void evict(const BranchCounters &branch);
+
+    void count(BranchCounters &counters, VirtAddr pc, bool correct) {
+        auto &branch = m_branches[bit::getBitField(
+            PC_ALIGN_BITS + BRANCHES_SIZE_LOG_2 - 1, PC_ALIGN_BITS, pc)];
+
+        if (branch.pc != pc) {
+            evict(branch);
+            branch = {pc};
+        }
+
+        ++counters.executions;
+        ++branch.executions;
+
+        if (!correct) {
+            ++counters.mispredicts;
+            ++branch.mispredicts;
+        }
+    }
+
+  protected:
+    Model() = default;
+
+  public:
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
+
+    virtual ~Model() = default;
+
+    void condBranch(VirtAddr pc, bool taken) {
+        count(m_cond, pc, predictCondBranch(pc, taken));
+    }
+
+    void jump(JumpKind kind, VirtAddr pc, VirtAddr target,
+              VirtAddr return_addr);
+
+    NODISCARD const auto &condBranches() const noexcept { return m_cond; }
+    NODISCARD const auto &jumps(JumpKind kind) const noexcept {
+        return m_jumps[to_underlying(kind)];
+    }
+
+    NODISCARD uint64_t mispredicts() const noexcept;
+
+    // Add counters of other model, e.g. of other sampled interval.
+    // Predictor state is not merged
+    void merge(const Model &other);
+
+    // Counters of all executed branches in no particular order
+    NODISCARD std::vector<BranchCounters> branches() const;
+
+    // Add branch and mispredict counters to registry
+    void collectStats(stats::Registry &registry, uint64_t icount) const;
+};
+
+// Model with direction predictor of given type and return address stack
+template <class Predictor, size_t RAS_SIZE = 16>
+class PredictorModel final : public Model {
+    Predictor m_predictor{};
+    ReturnStack<RAS_SIZE> m_ras{};
+
+    bool predictCondBranch(VirtAddr pc, bool taken) noexcept override {
+        bool correct = m_predictor.predict(pc) == taken;
+        m_predictor.update(pc, taken);
+
+        return correct;
+    }
+
+    void pushReturn(VirtAddr return_addr) noexcept override {
+        m_ras.push(return_addr);
+    }
+
+    VirtAddr popReturn() noexcept override { return m_ras.pop(); }
+};
+
+using BimodalModel = PredictorModel<Bimodal<12>>;
+using GshareModel = PredictorModel<Gshare<14, 14>>;
+using TageLiteModel = PredictorModel<TageLite<10, 12>>;
+
+// Make model by predictor name: bimodal, gshare or tage-lite. Returns
+// nullptr for unknown name
+NODISCARD std::unique_ptr<Model> makeModel(std::string_view name);
+
+// Mispredicts per kilo instrs
+NODISCARD double mpki(uint64_t mispredicts, uint64_t icount) noexcept;
+
+// Write MPKI by branch kind and worst predicted branches
+void writeReport(std::ostream &out, const Model &model, uint64_t icount,
+                 const elf::SymbolIndex &symbols, size_t top_number);
+
+} // namespace sim::bpred
+
+#endif // INCL_SIM_BPRED_HPP
@@ -0,0 +1,252 @@
+#ifndef INCL_SIM_BPRED_PREDICTORS_HPP
+#define INCL_SIM_BPRED_PREDICTORS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include <sim/common.hpp>
+
+// Direction predictors. Each provides
+//   bool predict(VirtAddr pc)
+//   void update(VirtAddr pc, bool taken)
+// update is called for every conditional branch right after predict
+namespace sim::bpred {
+
+namespace detail {
+
+inline constexpr bit::BitSize PC_ALIGN_BITS = 1;
+
+// Saturating counter update
+template <int MIN, int MAX> constexpr int8_t saturate(int value) noexcept {
+    return static_cast<int8_t>(value < MIN ? MIN : value > MAX ? MAX : value);
+}
+
+// Xor-fold low length bits of history to bits wide value
+constexpr uint64_t fold(uint64_t history, bit::BitSize length,
+                        bit::BitSize bits) noexcept {
+    if (length < 64) {
+        history &= (uint64_t{1} << length) - 1;
+    }
+
+    uint64_t folded = 0;
+    for (; history != 0; history >>= bits) {
+        folded ^= history;
+    }
+
+    return folded & ((uint64_t{1} << bits) - 1);
+}
+
+} // namespace detail
+
+// Table of 2-bit counters indexed by pc
+template <bit::BitSize TABLE_SIZE_LOG_2> class Bimodal final {
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_SIZE_LOG_2;
+
+    // Weakly taken
+    std::array<int8_t, TABLE_SIZE> m_counters{};
+
+    NODISCARD static size_t index(VirtAddr pc) noexcept {
+        return (pc >> detail::PC_ALIGN_BITS) & (TABLE_SIZE - 1);
+    }
+
+  public:
+    NODISCARD bool predict(VirtAddr pc) const noexcept {
+        return m_counters[index(pc)] >= 0;
+    }
+
+    void update(VirtAddr pc, bool taken) noexcept {
+        auto &counter = m_counters[index(pc)];
+        counter = detail::saturate<-2, 1>(counter + (taken ? 1 : -1));
+    }
+};
+
+// 2-bit counters indexed by pc xor global history
+template <bit::BitSize TABLE_SIZE_LOG_2, bit::BitSize HISTORY_LENGTH>
+class Gshare final {
+    static_assert(HISTORY_LENGTH <= 64);
+
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_SIZE_LOG_2;
+
+    std::array<int8_t, TABLE_SIZE> m_counters{};
+    uint64_t m_history = 0;
+
+    NODISCARD size_t index(VirtAddr pc) const noexcept {
+        return ((pc >> detail::PC_ALIGN_BITS) ^
+                detail::fold(m_history, HISTORY_LENGTH, TABLE_SIZE_LOG_2)) &
+               (TABLE_SIZE - 1);
+    }
+
+  public:
+    NODISCARD bool predict(VirtAddr pc) const noexcept {
+        return m_counters[index(pc)] >= 0;
+    }
+
+    void update(VirtAddr pc, bool taken) noexcept {
+        auto &counter = m_counters[index(pc)];
+        counter = detail::saturate<-2, 1>(counter + (taken ? 1 : -1));
+
+        m_history = m_history << 1 | taken;
+    }
+};
+
+// Reduced TAGE: bimodal base and tagged tables with geometric history
+// lengths. Longest matching table provides prediction, new entries are
+// allocated in one longer table on misprediction
+template <bit::BitSize TABLE_SIZE_LOG_2, bit::BitSize BASE_SIZE_LOG_2>
+class TageLite final {
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_SIZE_LOG_2;
+    static constexpr size_t TABLE_NUMBER = 4;
+    static constexpr std::array<bit::BitSize, TABLE_NUMBER> HISTORY_LENGTHS =
+        {5, 11, 22, 44};
+
+    static constexpr bit::BitSize TAG_BITS = 9;
+    static constexpr uint64_t TAG_MASK = (uint64_t{1} << TAG_BITS) - 1;
+
+    // Useful bits are reset once per period
+    static constexpr uint64_t USEFUL_RESET_PERIOD = uint64_t{1} << 18;
+
+    struct Entry final {
+        uint16_t tag = 0;
+        // 3-bit counter, taken when non-negative
+        int8_t counter = 0;
+        uint8_t useful = 0;
+    };
+
+    Bimodal<BASE_SIZE_LOG_2> m_base{};
+
+    using Table = std::array<Entry, TABLE_SIZE>;
+    std::unique_ptr<Table[]> m_tables{new Table[TABLE_NUMBER]};
+
+    uint64_t m_history = 0;
+    uint64_t m_update_number = 0;
+
+    // Lookup state of last predict
+    std::array<size_t, TABLE_NUMBER> m_indices{};
+    std::array<uint16_t, TABLE_NUMBER> m_tags{};
+    int m_provider = -1;
+    int m_alt_provider = -1;
+
+    NODISCARD bool entryPrediction(int table) const noexcept {
+        return m_tables[table][m_indices[table]].counter >= 0;
+    }
+
+    void lookup(VirtAddr pc) noexcept {
+        auto pc_bits = pc >> detail::PC_ALIGN_BITS;
+
+        m_provider = m_alt_provider = -1;
+        for (size_t i = 0; i != TABLE_NUMBER; ++i) {
+            auto length = HISTORY_LENGTHS[i];
+
+            m_indices[i] =
+                (pc_bits ^ (pc_bits >> TABLE_SIZE_LOG_2) ^
+                 detail::fold(m_history, length, TABLE_SIZE_LOG_2)) &
+                (TABLE_SIZE - 1);
+            m_tags[i] = static_cast<uint16_t>(
+                (pc_bits ^ detail::fold(m_history, length, TAG_BITS) ^
+                 (detail::fold(m_history, length, TAG_BITS - 1) << 1)) &
+                TAG_MASK);
+
+            if (m_tables[i][m_indices[i]].tag == m_tags[i]) {
+                m_alt_provider = m_provider;
+                m_provider = static_cast<int>(i);
+            }
+        }
+    }
+
+    NODISCARD bool altPrediction(VirtAddr pc) const noexcept {
+        return m_alt_provider < 0 ? m_base.predict(pc)
+                                  : entryPrediction(m_alt_provider);
+    }
+
+    void allocate(bool taken) noexcept {
+        for (size_t i = m_provider + 1; i != TABLE_NUMBER; ++i) {
+            auto &entry = m_tables[i][m_indices[i]];
+            if (entry.useful == 0) {
+                entry = {m_tags[i], static_cast<int8_t>(taken ? 0 : -1), 0};
+                return;
+            }
+        }
+
+        // No free entry: age candidates
+        for (size_t i = m_provider + 1; i != TABLE_NUMBER; ++i) {
+            --m_tables[i][m_indices[i]].useful;
+        }
+    }
+
+  public:
+    NODISCARD bool predict(VirtAddr pc) noexcept {
+        lookup(pc);
+
+        return m_provider < 0 ? m_base.predict(pc)
+                              : entryPrediction(m_provider);
+    }
+
+    void update(VirtAddr pc, bool taken) noexcept {
+        bool prediction = m_provider < 0 ? m_base.predict(pc)
+                                         : entryPrediction(m_provider);
+
+        if (m_provider < 0) {
+            m_base.update(pc, taken);
+        } else {
+            auto &entry = m_tables[m_provider][m_indices[m_provider]];
+
+            bool alt_prediction = altPrediction(pc);
+            if (prediction != alt_prediction) {
+                entry.useful = static_cast<uint8_t>(
+                    prediction == taken ? std::min(entry.useful + 1, 3)
+                                        : std::max(entry.useful - 1, 0));
+            }
+
+            entry.counter =
+                detail::saturate<-4, 3>(entry.counter + (taken ? 1 : -1));
+        }
+
+        if (prediction != taken &&
+            m_provider + 1 != static_cast<int>(TABLE_NUMBER)) {
+            allocate(taken);
+        }
+
+        if (++m_update_number % USEFUL_RESET_PERIOD == 0) {
+            for (size_t i = 0; i != TABLE_NUMBER; ++i) {
+                for (auto &&entry : m_tables[i]) {
+                    entry.useful >>= 1;
+                }
+            }
+        }
+
+        m_history = m_history << 1 | taken;
+    }
+};
+
+// Return address stack. Overflow drops the oldest entry
+template <size_t SIZE> class ReturnStack final {
+    std::array<VirtAddr, SIZE> m_entries{};
+    size_t m_top = 0;
+    size_t m_depth = 0;
+
+  public:
+    void push(VirtAddr return_addr) noexcept {
+        m_top = (m_top + 1) % SIZE;
+        m_entries[m_top] = return_addr;
+        m_depth = std::min(m_depth + 1, SIZE);
+    }
+
+    // Predicted return address. Returns 0 if stack is empty
+    NODISCARD VirtAddr pop() noexcept {
+        if (m_depth == 0) {
+            return 0;
+        }
+
+        auto addr = m_entries[m_top];
+        m_top = (m_top + SIZE - 1) % SIZE;
+        --m_depth;
+
+        return addr;
+    }
+};
+
+} // namespace sim::bpred
+
+#endif // INCL_SIM_BPRED_PREDICTORS_HPP
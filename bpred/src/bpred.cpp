@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <string>
+
+#include <sim/bpred.hpp>
+#include <sim/elf_load.hpp>
+#include <sim/gpr.hpp>
+
+namespace sim::bpred {
+
+namespace {
+
+constexpr const char *UNKNOWN_SYMBOL = "??";
+constexpr std::array<const char *, JUMP_KIND_NUMBER> JUMP_KIND_NAMES = {
+    "direct", "call", "indirect_call", "return", "indirect"};
+
+constexpr int NAME_WIDTH = 14;
+constexpr int COUNT_WIDTH = 14;
+constexpr int SHARE_WIDTH = 8;
+constexpr int ADDR_WIDTH = 12;
+
+NODISCARD bool isLink(size_t idx) noexcept {
+    return idx == gpr::GPR_IDX::RA || idx == gpr::GPR_IDX::T0;
+}
+
+// Percent of total
+double share(uint64_t value, uint64_t total) noexcept {
+    constexpr double PERCENT = 100;
+    return total == 0 ? 0 : PERCENT * value / total;
+}
+
+void writeCounters(std::ostream &out, const char *name,
+                   const BranchCounters &counters, uint64_t icount) {
+    out << std::setw(NAME_WIDTH) << name << std::setw(COUNT_WIDTH)
+        << counters.executions << std::setw(COUNT_WIDTH)
+        << counters.mispredicts << std::setw(SHARE_WIDTH)
+        << share(counters.mispredicts, counters.executions)
+        << std::setw(SHARE_WIDTH) << mpki(counters.mispredicts, icount)
+        << std::endl;
+}
+
+} // namespace
+
+JumpKind classifyJump(bool is_indirect, size_t rd, size_t rs1) noexcept {
+    if (!is_indirect) {
+        return isLink(rd) ? JumpKind::CALL : JumpKind::DIRECT;
+    }
+
+    if (isLink(rd)) {
+        return JumpKind::INDIRECT_CALL;
+    }
+
+    return isLink(rs1) ? JumpKind::RETURN : JumpKind::INDIRECT;
+}
+
+bool Model::predictIndirect(VirtAddr pc, VirtAddr target) noexcept {
+    auto &entry = m_btb[(pc >> detail::PC_ALIGN_BITS) & (BTB_SIZE - 1)];
+
+    bool correct = entry.pc == pc && entry.target == target;
+    entry = {pc, target};
+
+    return correct;
+}
+
+void Model::evict(const BranchCounters &branch) {
+    if (branch.executions == 0) {
+        return;
+    }
+
+    auto &evicted = m_evicted[branch.pc];
+    evicted.pc = branch.pc;
+    evicted.executions += branch.executions;
+    evicted.mispredicts += branch.mispredicts;
+}
+
+void Model::jump(JumpKind kind, VirtAddr pc, VirtAddr target,
+                 VirtAddr return_addr) {
+    bool correct = true;
+
+    switch (kind) {
+    case JumpKind::DIRECT:
+        break;
+    case JumpKind::CALL:
+        pushReturn(return_addr);
+        break;
+    case JumpKind::INDIRECT_CALL:
+        correct = predictIndirect(pc, target);
+        pushReturn(return_addr);
+        break;
+    case JumpKind::RETURN:
+        correct = popReturn() == target;
+        break;
+    case JumpKind::INDIRECT:
+        correct = predictIndirect(pc, target);
+        break;
+    default:
+        SIM_UNREACHABLE();
+    }
+
+    count(m_jumps[to_underlying(kind)], pc, correct);
+}
+
+void Model::merge(const Model &other) {
+    auto add = [](BranchCounters &dst, const BranchCounters &src) {
+        dst.executions += src.executions;
+        dst.mispredicts += src.mispredicts;
+    };
+
+    add(m_cond, other.m_cond);
+    for (size_t i = 0; i != JUMP_KIND_NUMBER; ++i) {
+        add(m_jumps[i], other.m_jumps[i]);
+    }
+
+    // Branches of other model are accumulated with evicted ones
+    for (auto &&branch : other.branches()) {
+        evict(branch);
+    }
+}
+
+uint64_t Model::mispredicts() const noexcept {
+    auto total = m_cond.mispredicts;
+    for (auto &&jumps : m_jumps) {
+        total += jumps.mispredicts;
+    }
+
+    return total;
+}
+
+std::vector<BranchCounters> Model::branches() const {
+    auto all = m_evicted;
+
+    for (size_t i = 0; i != BRANCHES_SIZE; ++i) {
+        const auto &branch = m_branches[i];
+        if (branch.executions == 0) {
+            continue;
+        }
+
+        auto &merged = all[branch.pc];
+        merged.pc = branch.pc;
+        merged.executions += branch.executions;
+        merged.mispredicts += branch.mispredicts;
+    }
+
+    std::vector<BranchCounters> out{};
+    out.reserve(all.size());
+    for (auto &&[pc, counters] : all) {
+        out.push_back(counters);
+    }
+
+    return out;
+}
+
+void Model::collectStats(stats::Registry &registry, uint64_t icount) const {
+    auto add = [&registry](const std::string &name,
+                           const BranchCounters &counters) {
+        registry.add("bpred." + name + ".executions", counters.executions);
+        registry.add("bpred." + name + ".mispredicts", counters.mispredicts);
+    };
+
+    add("cond", m_cond);
+    for (size_t i = 0; i != JUMP_KIND_NUMBER; ++i) {
+        add(JUMP_KIND_NAMES[i], m_jumps[i]);
+    }
+
+    registry.add("bpred.mpki", mpki(mispredicts(), icount));
+}
+
+std::unique_ptr<Model> makeModel(std::string_view name) {
+    if (name == "bimodal") {
+        return std::make_unique<BimodalModel>();
+    }
+    if (name == "gshare") {
+        return std::make_unique<GshareModel>();
+    }
+    if (name == "tage-lite") {
+        return std::make_unique<TageLiteModel>();
+    }
+
+    return nullptr;
+}
+
+double mpki(uint64_t mispredicts, uint64_t icount) noexcept {
+    constexpr double KILO = 1000;
+    return icount == 0 ? 0 : KILO * mispredicts / icount;
+}
+
+void writeReport(std::ostream &out, const Model &model, uint64_t icount,
+                 const elf::SymbolIndex &symbols, size_t top_number) {
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+
+    out << "icount = " << icount
+        << ", mispredicts = " << model.mispredicts()
+        << ", MPKI = " << mpki(model.mispredicts(), icount) << std::endl
+        << std::endl;
+
+    // Branch kinds
+    out << std::setw(NAME_WIDTH) << "kind" << std::setw(COUNT_WIDTH)
+        << "executions" << std::setw(COUNT_WIDTH) << "mispredicts"
+        << std::setw(SHARE_WIDTH) << "%" << std::setw(SHARE_WIDTH) << "MPKI"
+        << std::endl;
+
+    writeCounters(out, "cond", model.condBranches(), icount);
+    for (size_t i = 0; i != JUMP_KIND_NUMBER; ++i) {
+        writeCounters(out, JUMP_KIND_NAMES[i], model.jumps(JumpKind(i)),
+                      icount);
+    }
+
+    // Worst predicted branches
+    auto branches = model.branches();
+    auto middle = branches.begin() + std::min(top_number, branches.size());
+    std::partial_sort(branches.begin(), middle, branches.end(),
+                      [](const BranchCounters &lhs, const BranchCounters &rhs) {
+                          return lhs.mispredicts > rhs.mispredicts;
+                      });
+    branches.erase(middle, branches.end());
+
+    out << std::endl
+        << std::setw(ADDR_WIDTH) << "pc" << std::setw(COUNT_WIDTH)
+        << "executions" << std::setw(COUNT_WIDTH) << "mispredicts"
+        << std::setw(SHARE_WIDTH) << "%" << "  symbol" << std::endl;
+
+    for (auto &&branch : branches) {
+        out << std::hex << std::setw(ADDR_WIDTH) << branch.pc << std::dec
+            << std::setw(COUNT_WIDTH) << branch.executions
+            << std::setw(COUNT_WIDTH) << branch.mispredicts
+            << std::setw(SHARE_WIDTH)
+            << share(branch.mispredicts, branch.executions) << "  ";
+
+        if (const auto *symbol = symbols.find(branch.pc)) {
+            out << symbol->name << "+0x" << std::hex
+                << branch.pc - symbol->addr << std::dec;
+        } else {
+            out << UNKNOWN_SYMBOL;
+        }
+        out << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace sim::bpred
@@ -0,0 +1,149 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <sim/bpred.hpp>
+#include <sim/elf_load.hpp>
+#include <sim/gpr.hpp>
+
+namespace sim::bpred {
+
+namespace {
+
+// Mispredicts of predictor on branch at pc repeating pattern
+template <class Predictor>
+size_t countMispredicts(Predictor &predictor, VirtAddr pc,
+                        const std::vector<bool> &pattern, size_t repeats) {
+    size_t mispredicts = 0;
+
+    for (size_t i = 0; i != repeats; ++i) {
+        for (bool taken : pattern) {
+            mispredicts += predictor.predict(pc) != taken;
+            predictor.update(pc, taken);
+        }
+    }
+
+    return mispredicts;
+}
+
+} // namespace
+
+TEST(BpredTest, predictors) {
+    constexpr VirtAddr PC = 0x10010;
+    const std::vector<bool> ALTERNATING = {true, false};
+    const std::vector<bool> LOOP = {true, true, true, true, true, true, false};
+
+    Bimodal<10> bimodal{};
+    ASSERT_LE(countMispredicts(bimodal, PC, {true}, 100), 2);
+    // Bimodal can not learn alternation
+    ASSERT_GE(countMispredicts(bimodal, PC, ALTERNATING, 100), 100);
+
+    Gshare<12, 12> gshare{};
+    countMispredicts(gshare, PC, ALTERNATING, 100);
+    ASSERT_EQ(countMispredicts(gshare, PC, ALTERNATING, 100), 0);
+
+    TageLite<10, 10> tage{};
+    countMispredicts(tage, PC, LOOP, 1000);
+    ASSERT_EQ(countMispredicts(tage, PC, LOOP, 100), 0);
+}
+
+TEST(BpredTest, returnStack) {
+    ReturnStack<2> ras{};
+    ASSERT_EQ(ras.pop(), 0);
+
+    ras.push(0x100);
+    ras.push(0x200);
+    ras.push(0x300);
+
+    // Oldest entry is dropped on overflow
+    ASSERT_EQ(ras.pop(), 0x300);
+    ASSERT_EQ(ras.pop(), 0x200);
+    ASSERT_EQ(ras.pop(), 0);
+}
+
+TEST(BpredTest, model) {
+    using namespace gpr::GPR_IDX;
+
+    ASSERT_EQ(classifyJump(false, ZERO, ZERO), JumpKind::DIRECT);
+    ASSERT_EQ(classifyJump(false, RA, ZERO), JumpKind::CALL);
+    ASSERT_EQ(classifyJump(true, RA, A0), JumpKind::INDIRECT_CALL);
+    ASSERT_EQ(classifyJump(true, ZERO, RA), JumpKind::RETURN);
+    ASSERT_EQ(classifyJump(true, ZERO, A0), JumpKind::INDIRECT);
+
+    auto model = makeModel("gshare");
+    ASSERT_NE(model, nullptr);
+    ASSERT_EQ(makeModel("perceptron"), nullptr);
+
+    // Calls from two sites return correctly
+    for (VirtAddr site : {0x1000, 0x2000}) {
+        model->jump(JumpKind::CALL, site, 0x8000, site + 4);
+        model->condBranch(0x8004, true);
+        model->jump(JumpKind::RETURN, 0x8008, site + 4, 0x800c);
+    }
+
+    // Indirect jump target changes once
+    for (VirtAddr target : {0x3000, 0x3000, 0x4000, 0x4000}) {
+        model->jump(JumpKind::INDIRECT, 0x5000, target, 0x5004);
+    }
+
+    ASSERT_EQ(model->jumps(JumpKind::CALL).executions, 2);
+    ASSERT_EQ(model->jumps(JumpKind::RETURN).mispredicts, 0);
+    ASSERT_EQ(model->jumps(JumpKind::INDIRECT).executions, 4);
+    ASSERT_EQ(model->jumps(JumpKind::INDIRECT).mispredicts, 2);
+    ASSERT_EQ(model->condBranches().executions, 2);
+    ASSERT_EQ(model->mispredicts(), 2);
+    ASSERT_DOUBLE_EQ(mpki(model->mispredicts(), 1000), 2);
+
+    elf::SymbolIndex symbols{{{"dispatch", 0x4ff0, 0x20}}};
+    std::ostringstream out{};
+    writeReport(out, *model, 1000, symbols, 1);
+    ASSERT_NE(out.str().find("MPKI = 2.00"), std::string::npos);
+    ASSERT_NE(out.str().find("dispatch+0x10"), std::string::npos);
+}
+
+TEST(BpredTest, merge) {
+    auto total = makeModel("bimodal");
+
+    for (size_t i = 0; i != 2; ++i) {
+        auto interval = makeModel("bimodal");
+        interval->condBranch(0x1000, true);
+        interval->condBranch(0x1000, true);
+        interval->jump(JumpKind::RETURN, 0x2000, 0x3000, 0x2004);
+
+        total->merge(*interval);
+    }
+
+    ASSERT_EQ(total->condBranches().executions, 4);
+    ASSERT_EQ(total->jumps(JumpKind::RETURN).executions, 2);
+    ASSERT_EQ(total->jumps(JumpKind::RETURN).mispredicts, 2);
+    // Weakly taken counters predict taken branches, RAS is empty
+    ASSERT_EQ(total->mispredicts(), 2);
+
+    auto branches = total->branches();
+    ASSERT_EQ(branches.size(), 2);
+    for (auto &&branch : branches) {
+        ASSERT_EQ(branch.executions, branch.pc == 0x1000 ? 4 : 2);
+    }
+}
+
+TEST(BpredTest, branchConflicts) {
+    auto model = makeModel("bimodal");
+
+    // Branches conflict in direct-mapped counters table
+    constexpr VirtAddr PC = 0x10010;
+    constexpr VirtAddr CONFLICT_PC = PC + 0x100000;
+
+    for (size_t i = 0; i != 3; ++i) {
+        model->condBranch(PC, true);
+        model->condBranch(CONFLICT_PC, false);
+    }
+    model->condBranch(PC, true);
+
+    auto branches = model->branches();
+    ASSERT_EQ(branches.size(), 2);
+    for (auto &&branch : branches) {
+        ASSERT_EQ(branch.executions, branch.pc == PC ? 4 : 3);
+    }
+}
+
+} // namespace sim::bpred
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <type_traits>
 
 #include <sim/bb.hpp>
@@ -13,9 +14,19 @@
 
 namespace sim::cache {
 
+// Index of bb in direct-mapped table of 2^N_LOG_2 entries. Pc bits above
+// index are folded in, so 4-byte aligned code uses odd entries too
+template <bit::BitSize N_LOG_2>
+NODISCARD constexpr size_t getBbIdx(VirtAddr virt_addr) noexcept {
+    constexpr bit::BitSize PC_ALIGN_BITS = 1;
+
+    return bit::getBitField(N_LOG_2 - 1, 0,
+                            (virt_addr >> PC_ALIGN_BITS) ^
+                                (virt_addr >> (PC_ALIGN_BITS + N_LOG_2)));
+}
+
 template <bit::BitSize N_LOG_2> class BbCache final {
     static constexpr size_t N = 1ULL << N_LOG_2;
-    static constexpr bit::BitSize PC_ALIGN_BITS = 2;
 
     std::array<bb::Bb, N> m_entries{};
 
@@ -27,8 +38,58 @@ template <bit::BitSize N_LOG_2> class BbCache final {
     }
 
     bb::Bb &find(VirtAddr virt_addr) {
-        return m_entries[bit::getBitField(PC_ALIGN_BITS + N_LOG_2 - 1,
-                                          PC_ALIGN_BITS, virt_addr)];
+        return m_entries[getBbIdx<N_LOG_2>(virt_addr)];
+    }
+};
+
+// Bb cache holding pointers to bbs owned elsewhere
+template <bit::BitSize N_LOG_2> class BbPtrCache final {
+    static constexpr size_t N = 1ULL << N_LOG_2;
+
+  public:
+    struct Entry final {
+        VirtAddr virt_addr = bb::Bb::INVALID_VA;
+        const bb::Bb *bb = nullptr;
+    };
+
+  private:
+    std::array<Entry, N> m_entries{};
+
+  public:
+    void invalidate() noexcept {
+        for (auto &&entry : m_entries) {
+            entry = {};
+        }
+    }
+
+    Entry &find(VirtAddr virt_addr) {
+        return m_entries[getBbIdx<N_LOG_2>(virt_addr)];
+    }
+};
+
+// Hot bbs table. Counts bb executions and holds superblocks built for hot bbs
+template <bit::BitSize N_LOG_2> class HotBbCache final {
+    static constexpr size_t N = 1ULL << N_LOG_2;
+
+  public:
+    struct Entry final {
+        VirtAddr virt_addr = bb::Bb::INVALID_VA;
+        uint32_t exec_count = 0;
+        std::unique_ptr<const bb::Superblock> superblock = nullptr;
+    };
+
+  private:
+    std::array<Entry, N> m_entries{};
+
+  public:
+    void invalidate() noexcept {
+        for (auto &&entry : m_entries) {
+            entry = {};
+        }
+    }
+
+    Entry &find(VirtAddr virt_addr) {
+        return m_entries[getBbIdx<N_LOG_2>(virt_addr)];
     }
 };
 
@@ -0,0 +1,138 @@
+#ifndef INCL_SIM_SHARED_BB_STORE_HPP
+#define INCL_SIM_SHARED_BB_STORE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include <sim/bb.hpp>
+#include <sim/common.hpp>
+#include <sim/memory.hpp>
+
+namespace sim::cache {
+
+// Decoded bbs shared by harts and simulator instances.
+// Bbs are keyed by (bb physical address, page content hash, bb code bytes)
+// and are never changed after publication. Lookups are lock-free. Published
+// bbs are released only on store destruction, so readers need no
+// reclamation protocol and store should be scoped to a run. Bbs must not
+// cross page boundaries
+class SharedBbStore final {
+    static constexpr bit::BitSize BUCKETS_NUMBER_LOG_2 = 16;
+    static constexpr size_t BUCKETS_NUMBER = size_t{1} << BUCKETS_NUMBER_LOG_2;
+    static constexpr bit::BitSize PC_ALIGN_BITS = 1;
+
+  public:
+    // Max code bytes bb is decoded from
+    static constexpr size_t MAX_CODE_SIZE =
+        (bb::Bb::MAX_SIZE - 1) * INSTR_CODE_SIZE;
+
+    // Bb lookup key. Page hash may collide, so code bytes bb could be
+    // decoded from are compared too
+    struct Key final {
+        PhysAddr phys_addr = 0;
+        uint64_t page_hash = 0;
+        memory::ConstHostPtr code = nullptr;
+        // Not greater than MAX_CODE_SIZE
+        size_t code_size = 0;
+    };
+
+  private:
+    struct Node final {
+        PhysAddr phys_addr = 0;
+        uint64_t page_hash = 0;
+        std::array<uint8_t, MAX_CODE_SIZE> code{};
+        size_t code_size = 0;
+        bb::Bb bb{};
+        Node *next = nullptr;
+    };
+
+    std::unique_ptr<std::atomic<Node *>[]> m_buckets{
+        new std::atomic<Node *>[BUCKETS_NUMBER] {}
+    };
+
+    std::atomic<size_t> m_size = 0;
+
+    NODISCARD static size_t getBucketIdx(PhysAddr phys_addr,
+                                         uint64_t page_hash) noexcept {
+        return bit::getBitField(PC_ALIGN_BITS + BUCKETS_NUMBER_LOG_2 - 1,
+                                PC_ALIGN_BITS, phys_addr ^ page_hash);
+    }
+
+    NODISCARD static const bb::Bb *findInList(const Node *node,
+                                              const Key &key) noexcept {
+        for (; node != nullptr; node = node->next) {
+            if (node->phys_addr == key.phys_addr &&
+                node->page_hash == key.page_hash &&
+                node->code_size == key.code_size &&
+                std::memcmp(node->code.data(), key.code, key.code_size) == 0) {
+                return &node->bb;
+            }
+        }
+
+        return nullptr;
+    }
+
+  public:
+    SharedBbStore() = default;
+    SharedBbStore(const SharedBbStore &) = delete;
+    SharedBbStore &operator=(const SharedBbStore &) = delete;
+
+    ~SharedBbStore() {
+        for (size_t i = 0; i != BUCKETS_NUMBER; ++i) {
+            for (auto *node = m_buckets[i].load(); node != nullptr;) {
+                delete std::exchange(node, node->next);
+            }
+        }
+    }
+
+    // Number of published bbs
+    NODISCARD auto size() const noexcept {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    // Find published bb. Thread-safe
+    NODISCARD const bb::Bb *find(const Key &key) const noexcept {
+        const auto &bucket =
+            m_buckets[getBucketIdx(key.phys_addr, key.page_hash)];
+        return findInList(bucket.load(std::memory_order_acquire), key);
+    }
+
+    // Publish bb. If other thread published bb with the same key first, its
+    // bb is returned instead. Thread-safe
+    const bb::Bb *publish(const Key &key, const bb::Bb &bb) {
+        SIM_ASSERT(key.code_size <= MAX_CODE_SIZE);
+
+        auto &bucket = m_buckets[getBucketIdx(key.phys_addr, key.page_hash)];
+        auto node = std::make_unique<Node>();
+        node->phys_addr = key.phys_addr;
+        node->page_hash = key.page_hash;
+        std::memcpy(node->code.data(), key.code, key.code_size);
+        node->code_size = key.code_size;
+        node->bb = bb;
+
+        auto *head = bucket.load(std::memory_order_acquire);
+        while (true) {
+            // Lost race with other publisher
+            if (auto *found = findInList(head, key)) {
+                return found;
+            }
+
+            node->next = head;
+            if (bucket.compare_exchange_weak(head, node.get(),
+                                             std::memory_order_release,
+                                             std::memory_order_acquire)) {
+                m_size.fetch_add(1, std::memory_order_relaxed);
+                return &node.release()->bb;
+            }
+        }
+    }
+};
+
+} // namespace sim::cache
+
+#endif // INCL_SIM_SHARED_BB_STORE_HPP
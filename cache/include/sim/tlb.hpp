@@ -9,6 +9,7 @@
 
 #include <sim/common.hpp>
 #include <sim/memory.hpp>
+#include <sim/stats.hpp>
 
 namespace sim::cache {
 
@@ -23,6 +24,9 @@ template <class HostPtr, bit::BitSize N_LOG_2> class TLB final {
 
     std::array<Entry, N> m_entries{};
 
+    stats::Counter m_hits{};
+    stats::Counter m_misses{};
+
     auto &getEntry(VirtAddr virt_addr) noexcept {
         return m_entries[bit::getBitField(memory::PAGE_BIT_SIZE + N_LOG_2 - 1,
                                           memory::PAGE_BIT_SIZE, virt_addr)];
@@ -39,7 +43,10 @@ template <class HostPtr, bit::BitSize N_LOG_2> class TLB final {
         Entry &e = getEntry(virt_addr);
 
         host = e.host + (virt_addr & memory::PAGE_OFFSET_MASK);
-        return (virt_addr & ~memory::PAGE_OFFSET_MASK) == e.virt_addr;
+        bool hit = (virt_addr & ~memory::PAGE_OFFSET_MASK) == e.virt_addr;
+
+        (hit ? m_hits : m_misses).inc();
+        return hit;
     }
 
     void update(VirtAddr virt_addr, HostPtr host_page_ptr) noexcept {
@@ -49,6 +56,9 @@ template <class HostPtr, bit::BitSize N_LOG_2> class TLB final {
         e.virt_addr = virt_addr - offset;
         e.host = host_page_ptr;
     }
+
+    NODISCARD uint64_t hits() const noexcept { return m_hits.value(); }
+    NODISCARD uint64_t misses() const noexcept { return m_misses.value(); }
 };
 
 } // namespace sim::cache
@@ -0,0 +1,177 @@
+#ifndef INCL_SIM_CACHE_MODEL_HPP
+#define INCL_SIM_CACHE_MODEL_HPP
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/stats.hpp>
+
+namespace sim::elf {
+class SymbolIndex;
+} // namespace sim::elf
+
+namespace sim::cache_model {
+
+enum class Replacement : uint8_t { LRU, FIFO, RANDOM };
+
+// Cache level geometry. Size, associativity and line size are powers of 2
+struct CacheConfig final {
+    size_t size = 0;
+    size_t assoc = 0;
+    size_t line_size = 0;
+    Replacement replacement = Replacement::LRU;
+
+    NODISCARD bool isValid() const noexcept;
+};
+
+// Parse "<size>:<assoc>:<line size>:<lru | fifo | random>" spec
+NODISCARD bool parseCacheConfig(std::string_view spec, CacheConfig &config);
+
+// Set-associative cache level. Only tags are modelled
+class Cache final {
+    struct Way final {
+        uint64_t tag = 0;
+        // Last use for LRU, fill time for FIFO. Zero for invalid way
+        uint64_t stamp = 0;
+    };
+
+    CacheConfig m_config{};
+    bit::BitSize m_line_bits = 0;
+    uint64_t m_set_mask = 0;
+
+    std::vector<Way> m_ways{};
+    uint64_t m_time = 0;
+    uint64_t m_random_state = 0x2545f4914f6cdd1d;
+
+    uint64_t m_accesses = 0;
+    uint64_t m_misses = 0;
+
+    size_t victim(Way *set) noexcept;
+
+  public:
+    explicit Cache(const CacheConfig &config);
+
+    // Access line containing addr. Returns true on hit
+    bool access(VirtAddr addr) noexcept;
+
+    NODISCARD const auto &config() const noexcept { return m_config; }
+    NODISCARD auto lineBits() const noexcept { return m_line_bits; }
+    NODISCARD auto setNumber() const noexcept { return m_set_mask + 1; }
+
+    NODISCARD auto accesses() const noexcept { return m_accesses; }
+    NODISCARD auto misses() const noexcept { return m_misses; }
+
+    // Add counters of other cache. Tags are not merged
+    void merge(const Cache &other) noexcept {
+        m_accesses += other.m_accesses;
+        m_misses += other.m_misses;
+    }
+};
+
+enum class Level : uint8_t { L1I, L1D, L2 };
+inline constexpr size_t LEVEL_NUMBER = 3;
+
+// Accesses and misses of code region by level
+struct RegionCounters final {
+    VirtAddr virt_addr = 0;
+    std::array<uint64_t, LEVEL_NUMBER> accesses{};
+    std::array<uint64_t, LEVEL_NUMBER> misses{};
+};
+
+// L1I, L1D and shared L2 model fed with guest fetches and data accesses.
+// Caches are indexed by virtual addrs. Accesses are attributed to code
+// regions of L1I line size by pc of accessing instr.
+// With set sampling, only addrs mapped to every sampling-th set of each
+// level are modelled, so miss rates are estimated from a subset of sets
+class Hierarchy final {
+  public:
+    struct Config final {
+        CacheConfig l1i{32 * 1024, 8, 64, Replacement::LRU};
+        CacheConfig l1d{32 * 1024, 8, 64, Replacement::LRU};
+        CacheConfig l2{1024 * 1024, 16, 64, Replacement::LRU};
+        // Power of 2 not greater than sets number of any level
+        size_t set_sampling = 1;
+
+        NODISCARD bool isValid() const noexcept;
+    };
+
+  private:
+    std::array<Cache, LEVEL_NUMBER> m_levels;
+
+    bit::BitSize m_region_bits = 0;
+    bit::BitSize m_sample_shift = 0;
+    uint64_t m_sample_mask = 0;
+
+    // Last fetched line. Fetches within one line access L1I once
+    VirtAddr m_fetch_line = ~VirtAddr{0};
+
+    std::unordered_map<VirtAddr, RegionCounters> m_regions{};
+    VirtAddr m_curr_region_idx = ~VirtAddr{0};
+    RegionCounters *m_curr_region = nullptr;
+
+    NODISCARD bool isSampled(VirtAddr addr) const noexcept {
+        return ((addr >> m_sample_shift) & m_sample_mask) == 0;
+    }
+
+    RegionCounters &region(VirtAddr pc) {
+        auto idx = pc >> m_region_bits;
+        if (idx != m_curr_region_idx) {
+            m_curr_region_idx = idx;
+            m_curr_region = &m_regions[idx];
+            m_curr_region->virt_addr = idx << m_region_bits;
+        }
+
+        return *m_curr_region;
+    }
+
+    // Access L1 level, then L2 on miss
+    void access(Level l1, VirtAddr pc, VirtAddr addr);
+
+  public:
+    // Config must be valid
+    explicit Hierarchy(const Config &config);
+
+    Hierarchy(const Hierarchy &) = delete;
+    Hierarchy &operator=(const Hierarchy &) = delete;
+
+    // Instr fetch at pc
+    void fetch(VirtAddr pc) {
+        auto line = pc >> m_region_bits;
+        if (line != m_fetch_line) {
+            m_fetch_line = line;
+            access(Level::L1I, pc, pc);
+        }
+    }
+
+    // Data access to addr by instr at pc
+    void dataAccess(VirtAddr pc, VirtAddr addr) {
+        access(Level::L1D, pc, addr);
+    }
+
+    NODISCARD const Cache &level(Level level) const noexcept {
+        return m_levels[to_underlying(level)];
+    }
+
+    // Add counters of other hierarchy with same L1I line size, e.g. of
+    // other sampled interval. Caches content is not merged
+    void merge(const Hierarchy &other);
+
+    // Counters of all accessing code regions in no particular order
+    NODISCARD std::vector<RegionCounters> regions() const;
+
+    // Add per-level accesses and misses to registry
+    void collectStats(stats::Registry &registry) const;
+};
+
+// Write miss rates by level and top code regions and functions by misses
+void writeReport(std::ostream &out, const Hierarchy &hierarchy,
+                 const elf::SymbolIndex &symbols, size_t top_number);
+
+} // namespace sim::cache_model
+
+#endif // INCL_SIM_CACHE_MODEL_HPP
@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <iomanip>
+#include <map>
+#include <string>
+
+#include <sim/cache_model.hpp>
+#include <sim/elf_load.hpp>
+
+namespace sim::cache_model {
+
+namespace {
+
+constexpr const char *UNKNOWN_SYMBOL = "??";
+constexpr std::array<const char *, LEVEL_NUMBER> LEVEL_NAMES = {"l1i", "l1d",
+                                                                "l2"};
+
+constexpr int LEVEL_WIDTH = 4;
+constexpr int COUNT_WIDTH = 14;
+constexpr int SHARE_WIDTH = 8;
+constexpr int ADDR_WIDTH = 12;
+
+NODISCARD bool isPow2(size_t value) noexcept {
+    return std::has_single_bit(value);
+}
+
+NODISCARD bit::BitSize log2(size_t value) noexcept {
+    return std::countr_zero(value);
+}
+
+// Percent of total
+double share(uint64_t value, uint64_t total) noexcept {
+    constexpr double PERCENT = 100;
+    return total == 0 ? 0 : PERCENT * value / total;
+}
+
+NODISCARD uint64_t totalMisses(const RegionCounters &counters) noexcept {
+    uint64_t total = 0;
+    for (auto misses : counters.misses) {
+        total += misses;
+    }
+
+    return total;
+}
+
+void addCounters(RegionCounters &to, const RegionCounters &from) noexcept {
+    for (size_t i = 0; i != LEVEL_NUMBER; ++i) {
+        to.accesses[i] += from.accesses[i];
+        to.misses[i] += from.misses[i];
+    }
+}
+
+template <class Item, class Key>
+void sortTop(std::vector<Item> &items, size_t top_number, Key key) {
+    auto middle = items.begin() + std::min(top_number, items.size());
+    std::partial_sort(
+        items.begin(), middle, items.end(),
+        [&](const Item &lhs, const Item &rhs) { return key(lhs) > key(rhs); });
+    items.erase(middle, items.end());
+}
+
+void writeCountersHeader(std::ostream &out) {
+    out << std::setw(COUNT_WIDTH) << "l1i misses" << std::setw(COUNT_WIDTH)
+        << "l1d misses" << std::setw(SHARE_WIDTH) << "l1d %"
+        << std::setw(COUNT_WIDTH) << "l2 misses" << std::setw(SHARE_WIDTH)
+        << "l2 %";
+}
+
+void writeCounters(std::ostream &out, const RegionCounters &counters) {
+    constexpr auto L1I = to_underlying(Level::L1I);
+    constexpr auto L1D = to_underlying(Level::L1D);
+    constexpr auto L2 = to_underlying(Level::L2);
+
+    out << std::setw(COUNT_WIDTH) << counters.misses[L1I]
+        << std::setw(COUNT_WIDTH) << counters.misses[L1D]
+        << std::setw(SHARE_WIDTH)
+        << share(counters.misses[L1D], counters.accesses[L1D])
+        << std::setw(COUNT_WIDTH) << counters.misses[L2]
+        << std::setw(SHARE_WIDTH)
+        << share(counters.misses[L2], counters.accesses[L2]);
+}
+
+} // namespace
+
+bool CacheConfig::isValid() const noexcept {
+    return isPow2(size) && isPow2(assoc) && isPow2(line_size) &&
+           size >= assoc * line_size;
+}
+
+bool parseCacheConfig(std::string_view spec, CacheConfig &config) {
+    CacheConfig parsed{};
+
+    for (auto *field : {&parsed.size, &parsed.assoc, &parsed.line_size}) {
+        auto [end, ec] =
+            std::from_chars(spec.data(), spec.data() + spec.size(), *field);
+        if (ec != std::errc{} || end == spec.data() + spec.size() ||
+            *end != ':') {
+            return false;
+        }
+
+        spec.remove_prefix(end - spec.data() + 1);
+    }
+
+    if (spec == "lru") {
+        parsed.replacement = Replacement::LRU;
+    } else if (spec == "fifo") {
+        parsed.replacement = Replacement::FIFO;
+    } else if (spec == "random") {
+        parsed.replacement = Replacement::RANDOM;
+    } else {
+        return false;
+    }
+
+    if (!parsed.isValid()) {
+        return false;
+    }
+
+    config = parsed;
+    return true;
+}
+
+Cache::Cache(const CacheConfig &config)
+    : m_config(config), m_line_bits(log2(config.line_size)),
+      m_set_mask(config.size / config.line_size / config.assoc - 1),
+      m_ways(config.size / config.line_size) {
+    SIM_ASSERT(config.isValid());
+}
+
+size_t Cache::victim(Way *set) noexcept {
+    auto assoc = m_config.assoc;
+
+    // Invalid way has the least stamp
+    if (m_config.replacement != Replacement::RANDOM) {
+        size_t victim = 0;
+        for (size_t i = 1; i != assoc; ++i) {
+            if (set[i].stamp < set[victim].stamp) {
+                victim = i;
+            }
+        }
+
+        return victim;
+    }
+
+    for (size_t i = 0; i != assoc; ++i) {
+        if (set[i].stamp == 0) {
+            return i;
+        }
+    }
+
+    // xorshift64
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 7;
+    m_random_state ^= m_random_state << 17;
+
+    return m_random_state & (assoc - 1);
+}
+
+bool Cache::access(VirtAddr addr) noexcept {
+    auto tag = addr >> m_line_bits;
+    auto *set = m_ways.data() + (tag & m_set_mask) * m_config.assoc;
+
+    ++m_accesses;
+    ++m_time;
+
+    for (size_t i = 0, assoc = m_config.assoc; i != assoc; ++i) {
+        if (set[i].stamp != 0 && set[i].tag == tag) {
+            if (m_config.replacement == Replacement::LRU) {
+                set[i].stamp = m_time;
+            }
+            return true;
+        }
+    }
+
+    ++m_misses;
+    set[victim(set)] = {tag, m_time};
+
+    return false;
+}
+
+bool Hierarchy::Config::isValid() const noexcept {
+    if (!l1i.isValid() || !l1d.isValid() || !l2.isValid() ||
+        !isPow2(set_sampling)) {
+        return false;
+    }
+
+    for (const auto *config : {&l1i, &l1d, &l2}) {
+        if (set_sampling > config->size / config->line_size / config->assoc) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Hierarchy::Hierarchy(const Config &config)
+    : m_levels{Cache{config.l1i}, Cache{config.l1d}, Cache{config.l2}},
+      m_region_bits(log2(config.l1i.line_size)),
+      m_sample_shift(log2(std::max(
+          {config.l1i.line_size, config.l1d.line_size, config.l2.line_size}))),
+      m_sample_mask(config.set_sampling - 1) {
+    SIM_ASSERT(config.isValid());
+}
+
+void Hierarchy::access(Level l1, VirtAddr pc, VirtAddr addr) {
+    constexpr auto L2 = to_underlying(Level::L2);
+
+    if (!isSampled(addr)) {
+        return;
+    }
+
+    auto &counters = region(pc);
+    auto l1_idx = to_underlying(l1);
+
+    ++counters.accesses[l1_idx];
+    if (m_levels[l1_idx].access(addr)) {
+        return;
+    }
+    ++counters.misses[l1_idx];
+
+    ++counters.accesses[L2];
+    if (!m_levels[L2].access(addr)) {
+        ++counters.misses[L2];
+    }
+}
+
+void Hierarchy::merge(const Hierarchy &other) {
+    SIM_ASSERT(m_region_bits == other.m_region_bits);
+
+    for (size_t i = 0; i != LEVEL_NUMBER; ++i) {
+        m_levels[i].merge(other.m_levels[i]);
+    }
+
+    for (auto &&[idx, counters] : other.m_regions) {
+        auto &region = m_regions[idx];
+        region.virt_addr = counters.virt_addr;
+
+        for (size_t i = 0; i != LEVEL_NUMBER; ++i) {
+            region.accesses[i] += counters.accesses[i];
+            region.misses[i] += counters.misses[i];
+        }
+    }
+}
+
+std::vector<RegionCounters> Hierarchy::regions() const {
+    std::vector<RegionCounters> out{};
+    out.reserve(m_regions.size());
+
+    for (auto &&[idx, counters] : m_regions) {
+        out.push_back(counters);
+    }
+
+    return out;
+}
+
+void Hierarchy::collectStats(stats::Registry &registry) const {
+    for (size_t i = 0; i != LEVEL_NUMBER; ++i) {
+        std::string prefix = std::string{"cache_model."} + LEVEL_NAMES[i];
+
+        registry.add(prefix + ".accesses", m_levels[i].accesses());
+        registry.add(prefix + ".misses", m_levels[i].misses());
+    }
+}
+
+void writeReport(std::ostream &out, const Hierarchy &hierarchy,
+                 const elf::SymbolIndex &symbols, size_t top_number) {
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+
+    // Levels
+    out << std::setw(LEVEL_WIDTH) << "" << std::setw(COUNT_WIDTH)
+        << "accesses" << std::setw(COUNT_WIDTH) << "misses"
+        << std::setw(SHARE_WIDTH) << "miss %" << "  config" << std::endl;
+
+    for (size_t i = 0; i != LEVEL_NUMBER; ++i) {
+        const auto &cache = hierarchy.level(Level(i));
+        const auto &config = cache.config();
+
+        out << std::setw(LEVEL_WIDTH) << LEVEL_NAMES[i]
+            << std::setw(COUNT_WIDTH) << cache.accesses()
+            << std::setw(COUNT_WIDTH) << cache.misses()
+            << std::setw(SHARE_WIDTH)
+            << share(cache.misses(), cache.accesses()) << "  " << config.size
+            << " B, " << config.assoc << "-way, " << config.line_size
+            << " B lines" << std::endl;
+    }
+
+    // Top regions
+    auto regions = hierarchy.regions();
+
+    std::map<std::string, RegionCounters> funcs{};
+    for (auto &&region : regions) {
+        const auto *symbol = symbols.find(region.virt_addr);
+        addCounters(funcs[symbol ? symbol->name : UNKNOWN_SYMBOL], region);
+    }
+
+    sortTop(regions, top_number, totalMisses);
+
+    out << std::endl << std::setw(ADDR_WIDTH) << "region";
+    writeCountersHeader(out);
+    out << "  symbol" << std::endl;
+
+    for (auto &&region : regions) {
+        out << std::hex << std::setw(ADDR_WIDTH) << region.virt_addr
+            << std::dec;
+        writeCounters(out, region);
+        out << "  ";
+
+        if (const auto *symbol = symbols.find(region.virt_addr)) {
+            out << symbol->name << "+0x" << std::hex
+                << region.virt_addr - symbol->addr << std::dec;
+        } else {
+            out << UNKNOWN_SYMBOL;
+        }
+        out << std::endl;
+    }
+
+    // Top functions
+    std::vector<std::pair<std::string, RegionCounters>> top_funcs(
+        funcs.begin(), funcs.end());
+    sortTop(top_funcs, top_number,
+            [](const auto &func) { return totalMisses(func.second); });
+
+    out << std::endl << std::setw(ADDR_WIDTH) << "";
+    writeCountersHeader(out);
+    out << "  function" << std::endl;
+
+    for (auto &&[name, counters] : top_funcs) {
+        out << std::setw(ADDR_WIDTH) << "";
+        writeCounters(out, counters);
+        out << "  " << name << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace sim::cache_model
@@ -0,0 +1,147 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <sim/cache_model.hpp>
+#include <sim/elf_load.hpp>
+
+namespace sim::cache_model {
+
+TEST(CacheModelTest, parseConfig) {
+    CacheConfig config{};
+
+    ASSERT_TRUE(parseCacheConfig("32768:8:64:fifo", config));
+    ASSERT_EQ(config.size, 32768);
+    ASSERT_EQ(config.assoc, 8);
+    ASSERT_EQ(config.line_size, 64);
+    ASSERT_EQ(config.replacement, Replacement::FIFO);
+
+    ASSERT_FALSE(parseCacheConfig("32768:8:64", config));
+    ASSERT_FALSE(parseCacheConfig("32768:8:64:plru", config));
+    ASSERT_FALSE(parseCacheConfig("32768:3:64:lru", config));
+    // Less than one line per way
+    ASSERT_FALSE(parseCacheConfig("64:2:64:lru", config));
+    ASSERT_EQ(config.size, 32768);
+}
+
+TEST(CacheModelTest, replacement) {
+    // Single set of two ways
+    constexpr VirtAddr A = 0x1000;
+    constexpr VirtAddr B = 0x2000;
+    constexpr VirtAddr C = 0x3000;
+
+    Cache lru{{128, 2, 64, Replacement::LRU}};
+    ASSERT_FALSE(lru.access(A));
+    ASSERT_FALSE(lru.access(B));
+    ASSERT_TRUE(lru.access(A + 8));
+    ASSERT_FALSE(lru.access(C));
+    ASSERT_TRUE(lru.access(A));
+    ASSERT_FALSE(lru.access(B));
+    ASSERT_EQ(lru.accesses(), 6);
+    ASSERT_EQ(lru.misses(), 4);
+
+    Cache fifo{{128, 2, 64, Replacement::FIFO}};
+    ASSERT_FALSE(fifo.access(A));
+    ASSERT_FALSE(fifo.access(B));
+    ASSERT_TRUE(fifo.access(A));
+    ASSERT_FALSE(fifo.access(C));
+    ASSERT_FALSE(fifo.access(A));
+
+    Cache random{{128, 2, 64, Replacement::RANDOM}};
+    ASSERT_FALSE(random.access(A));
+    ASSERT_FALSE(random.access(B));
+    ASSERT_TRUE(random.access(A));
+    ASSERT_TRUE(random.access(B));
+}
+
+TEST(CacheModelTest, hierarchy) {
+    constexpr VirtAddr PC = 0x10000;
+    constexpr VirtAddr DATA = 0x80000;
+
+    Hierarchy::Config config{};
+    ASSERT_TRUE(config.isValid());
+
+    Hierarchy hierarchy{config};
+
+    // Fetches within one line access L1I once
+    for (VirtAddr pc = PC; pc != PC + 64; pc += 4) {
+        hierarchy.fetch(pc);
+    }
+    hierarchy.fetch(PC + 64);
+
+    // Lines are reused on second pass
+    for (size_t pass = 0; pass != 2; ++pass) {
+        for (VirtAddr addr = DATA; addr != DATA + 1024; addr += 8) {
+            hierarchy.dataAccess(PC, addr);
+        }
+    }
+
+    const auto &l1i = hierarchy.level(Level::L1I);
+    ASSERT_EQ(l1i.accesses(), 2);
+    ASSERT_EQ(l1i.misses(), 2);
+
+    const auto &l1d = hierarchy.level(Level::L1D);
+    ASSERT_EQ(l1d.accesses(), 256);
+    ASSERT_EQ(l1d.misses(), 16);
+
+    const auto &l2 = hierarchy.level(Level::L2);
+    ASSERT_EQ(l2.accesses(), 18);
+    ASSERT_EQ(l2.misses(), 18);
+
+    auto regions = hierarchy.regions();
+    ASSERT_EQ(regions.size(), 2);
+
+    elf::SymbolIndex symbols{{{"main", PC, 0x100}}};
+    std::ostringstream out{};
+    writeReport(out, hierarchy, symbols, 10);
+    ASSERT_NE(out.str().find("main+0x40"), std::string::npos);
+}
+
+TEST(CacheModelTest, merge) {
+    constexpr VirtAddr PC = 0x10000;
+
+    Hierarchy::Config config{};
+    Hierarchy total{config};
+
+    for (size_t i = 0; i != 2; ++i) {
+        Hierarchy interval{config};
+        interval.fetch(PC);
+        interval.dataAccess(PC, 0x80000);
+        interval.dataAccess(PC + 64, 0x80000);
+
+        total.merge(interval);
+    }
+
+    // Each interval starts cold
+    ASSERT_EQ(total.level(Level::L1I).misses(), 2);
+    ASSERT_EQ(total.level(Level::L1D).accesses(), 4);
+    ASSERT_EQ(total.level(Level::L1D).misses(), 2);
+    ASSERT_EQ(total.level(Level::L2).accesses(), 4);
+
+    auto regions = total.regions();
+    ASSERT_EQ(regions.size(), 2);
+    for (auto &&region : regions) {
+        auto l1d = to_underlying(Level::L1D);
+        ASSERT_EQ(region.accesses[l1d], 2);
+        ASSERT_EQ(region.misses[l1d], region.virt_addr == PC ? 2 : 0);
+    }
+}
+
+TEST(CacheModelTest, setSampling) {
+    Hierarchy::Config config{};
+    config.set_sampling = 4;
+    ASSERT_TRUE(config.isValid());
+
+    Hierarchy hierarchy{config};
+    for (VirtAddr addr = 0; addr != 64 * 1024; addr += 64) {
+        hierarchy.dataAccess(0, addr);
+    }
+
+    // Quarter of lines is modelled
+    ASSERT_EQ(hierarchy.level(Level::L1D).accesses(), 256);
+
+    config.set_sampling = 128;
+    ASSERT_FALSE(config.isValid());
+}
+
+} // namespace sim::cache_model
@@ -63,12 +63,22 @@ enum class SimStatus {
     MAPPER__TABLE_REGION_END,
     MAPPER__TABLE_REGION_PAGE_MAPPED,
 
+    // *** elf::ElfLoader codes ***
+    ELF__OPEN_ERROR,
+    ELF__FORMAT_ERROR,
+
+    // *** plugin::Manager codes ***
+    PLUGIN__LOAD_ERROR,
+    PLUGIN__VERSION_MISMATCH,
+
     // Simulator codes
     SIM__EXIT,
     SIM__NOT_IMPLEMENTED_INSTR,
     SIM__PC_ALIGN_ERROR,
     SIM__UNALIGNED_LOAD,
     SIM__UNALIGNED_STORE,
+    SIM__STOP_REQUEST,
+    SIM__ICOUNT_LIMIT,
 };
 
 enum class XLen { XLEN_32 = 32, XLEN_64 = 64 };
@@ -79,6 +89,10 @@ using VirtAddr = RegValue;
 
 using InstrCode = uint32_t;
 static constexpr size_t INSTR_CODE_SIZE = sizeof(InstrCode);
+static constexpr size_t COMPRESSED_INSTR_CODE_SIZE = sizeof(uint16_t);
+
+// Instrs are 2 bytes aligned with C extension
+static constexpr VirtAddr PC_ALIGN_MASK = COMPRESSED_INSTR_CODE_SIZE - 1;
 
 enum class PrivLevel { USER = 0b00, SUPERVISOR = 0b01, MACHINE = 0b11 };
 
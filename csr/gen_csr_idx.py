@@ -43,6 +43,14 @@ def main():
     for csr_name, csr_descr in csrs.items():
         csr_idx = csr_descr["idx"]
 
+        # Numbered CSRs are described with one entry
+        if "number" in csr_descr:
+            first = csr_descr["first"]
+
+            for i in range(csr_descr["number"]):
+                out_str += gen_enum_value(csr_name + str(first + i), csr_idx + i)
+            continue
+
         out_str += gen_enum_value(csr_name, csr_idx)
 
     out_str += gen_file_close()
@@ -18,6 +18,29 @@
 
 namespace sim::elf {
 
+// ELF function symbol
+struct FuncSymbol final {
+    std::string name{};
+    VirtAddr addr = 0;
+    size_t size = 0;
+};
+
+// Address to function symbol index
+class SymbolIndex final {
+    // Sorted by addr, one symbol per addr
+    std::vector<FuncSymbol> m_symbols{};
+
+  public:
+    SymbolIndex() = default;
+    explicit SymbolIndex(std::vector<FuncSymbol> symbols);
+
+    // Function containing addr. Sizeless symbols span up to the next one.
+    // Returns nullptr if there is none
+    NODISCARD const FuncSymbol *find(VirtAddr addr) const noexcept;
+
+    NODISCARD bool empty() const noexcept { return m_symbols.empty(); }
+};
+
 class ElfLoader final {
     using PPN = memory::PPN;
     using VPN = memory::VPN;
@@ -27,7 +50,8 @@ class ElfLoader final {
     static constexpr VPN DEFAULT_STACK_BASE = 0x10000000;
     static constexpr VPN DEFAULT_STACK_SIZE = 0x1000;
 
-    static constexpr PPN DEFAULT_TABLE_REGION_SIZE = 0x10;
+    // Enough tables to map heap and mmap regions lazily
+    static constexpr PPN DEFAULT_TABLE_REGION_SIZE = 0x100;
 
     memory::PhysMemory &m_pm;
 
@@ -48,31 +72,76 @@ class ElfLoader final {
 
     std::unordered_map<VPN, PPN> m_mapping{};
 
-    NODISCARD auto mapPage(VPN page_vpn) {
-        if (m_mmu_mode == MMUMode::BARE) {
+    // End of loaded segments
+    VirtAddr m_brk_start = 0;
+
+    std::vector<FuncSymbol> m_func_symbols{};
+
+    // Collect function symbols from symbol tables
+    void readFuncSymbols(Elf *elf);
+
+    // Map fresh RAM page at given virtual page of given memory
+    NODISCARD static SimStatus
+    mapFreshPage(memory::PhysMemory &pm, memory::SimpleMemoryMapper &mapper,
+                 MMUMode mmu_mode, PPN &next_map_ppn, VPN page_vpn) {
+        if (mmu_mode == MMUMode::BARE) {
             // Map RAM page with same addr
-            SIM_ASSERT(m_pm.addRAMPage(page_vpn * memory::PAGE_SIZE));
+            SIM_ASSERT(pm.addRAMPage(page_vpn * memory::PAGE_SIZE));
             return SimStatus::OK;
         }
 
         // Allocate new RAM page
-        PPN page_ppn = m_next_map_ppn++;
-        SIM_ASSERT(m_pm.addRAMPage(page_ppn * memory::PAGE_SIZE));
-
-        // Update mapping info
-        m_mapping.insert({page_vpn, page_ppn});
+        PPN page_ppn = next_map_ppn++;
+        SIM_ASSERT(pm.addRAMPage(page_ppn * memory::PAGE_SIZE));
 
         // Add arch mapping
         using Flags = memory::PTEFlags;
         Flags flags{Flags::U_MASK | Flags::R_MASK | Flags::W_MASK |
                     Flags::X_MASK};
 
-        return m_mapper.map({flags, page_vpn, page_ppn});
+        return mapper.map(pm, {flags, page_vpn, page_ppn});
     }
 
   public:
+    // Maps fresh RAM pages of loaded program. Mapper owns its allocation
+    // state, so its copy maps the same pages in copy of program memory
+    class LazyMapper final {
+        memory::SimpleMemoryMapper m_mapper;
+        MMUMode m_mmu_mode = MMUMode::SV39;
+        PPN m_next_map_ppn = 0;
+
+      public:
+        LazyMapper(const memory::SimpleMemoryMapper &mapper, MMUMode mmu_mode,
+                   PPN next_map_ppn)
+            : m_mapper(mapper), m_mmu_mode(mmu_mode),
+              m_next_map_ppn(next_map_ppn) {}
+
+        NODISCARD SimStatus operator()(memory::PhysMemory &pm,
+                                       VPN page_vpn) {
+            return mapFreshPage(pm, m_mapper, m_mmu_mode, m_next_map_ppn,
+                                page_vpn);
+        }
+    };
+
     ElfLoader(memory::PhysMemory &pm) : m_pm(pm) {}
 
+    // Map fresh RAM page at given virtual page
+    NODISCARD SimStatus mapPage(VPN page_vpn) {
+        // Update mapping info
+        if (m_mmu_mode != MMUMode::BARE) {
+            m_mapping.insert({page_vpn, m_next_map_ppn});
+        }
+
+        return mapFreshPage(m_pm, m_mapper, m_mmu_mode, m_next_map_ppn,
+                            page_vpn);
+    }
+
+    // Mapper continuing page allocation of this loader. Loader must not map
+    // pages after that
+    NODISCARD LazyMapper lazyMapper() const {
+        return {m_mapper, m_mmu_mode, m_next_map_ppn};
+    }
+
     struct MapStackRes final {
         SimStatus status = SimStatus::OK;
         RegValue start_sp = 0;
@@ -97,6 +166,25 @@ class ElfLoader final {
     };
 
     LoadElfRes loadElf(const char *elf_name);
+
+    // Initial program break. Page aligned end of loaded segments
+    NODISCARD auto brkStart() const noexcept { return m_brk_start; }
+
+    // Function symbols of loaded ELF. Empty for stripped ELFs
+    NODISCARD const auto &funcSymbols() const noexcept {
+        return m_func_symbols;
+    }
+
+    // Address of function with given name. Returns 0 if there is none
+    NODISCARD VirtAddr findFunc(const std::string &name) const noexcept {
+        for (auto &&symbol : m_func_symbols) {
+            if (symbol.name == name) {
+                return symbol.addr;
+            }
+        }
+
+        return 0;
+    }
 };
 
 } // namespace sim::elf
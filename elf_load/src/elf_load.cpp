@@ -1,14 +1,85 @@
+#include <algorithm>
+
 #include <sim/elf_load.hpp>
 
 namespace sim::elf {
 
+SymbolIndex::SymbolIndex(std::vector<FuncSymbol> symbols)
+    : m_symbols(std::move(symbols)) {
+    // Sized symbols win over aliases at the same addr
+    std::stable_sort(m_symbols.begin(), m_symbols.end(),
+                     [](const FuncSymbol &lhs, const FuncSymbol &rhs) {
+                         return lhs.addr != rhs.addr ? lhs.addr < rhs.addr
+                                                     : lhs.size > rhs.size;
+                     });
+
+    auto end = std::unique(m_symbols.begin(), m_symbols.end(),
+                           [](const FuncSymbol &lhs, const FuncSymbol &rhs) {
+                               return lhs.addr == rhs.addr;
+                           });
+    m_symbols.erase(end, m_symbols.end());
+}
+
+const FuncSymbol *SymbolIndex::find(VirtAddr addr) const noexcept {
+    auto it = std::upper_bound(
+        m_symbols.begin(), m_symbols.end(), addr,
+        [](VirtAddr addr, const FuncSymbol &symbol) {
+            return addr < symbol.addr;
+        });
+
+    if (it == m_symbols.begin()) {
+        return nullptr;
+    }
+
+    const auto &symbol = *--it;
+    if (symbol.size != 0 && addr - symbol.addr >= symbol.size) {
+        return nullptr;
+    }
+
+    return &symbol;
+}
+
+void ElfLoader::readFuncSymbols(Elf *elf) {
+    m_func_symbols.clear();
+
+    for (Elf_Scn *scn = elf_nextscn(elf, nullptr); scn != nullptr;
+         scn = elf_nextscn(elf, scn)) {
+        GElf_Shdr sec_header{};
+        if (gelf_getshdr(scn, &sec_header) == nullptr ||
+            sec_header.sh_type != SHT_SYMTAB || sec_header.sh_entsize == 0) {
+            continue;
+        }
+
+        Elf_Data *data = elf_getdata(scn, nullptr);
+        if (data == nullptr) {
+            continue;
+        }
+
+        for (size_t i = 0, end = sec_header.sh_size / sec_header.sh_entsize;
+             i != end; ++i) {
+            GElf_Sym sym{};
+            if (gelf_getsym(data, i, &sym) == nullptr ||
+                ELF64_ST_TYPE(sym.st_info) != STT_FUNC || sym.st_value == 0) {
+                continue;
+            }
+
+            const char *name = elf_strptr(elf, sec_header.sh_link, sym.st_name);
+            if (name != nullptr) {
+                m_func_symbols.push_back({name, sym.st_value, sym.st_size});
+            }
+        }
+    }
+}
+
 ElfLoader::LoadElfRes ElfLoader::loadElf(const char *elf_name) {
     // Check LibElf version
     SIM_ASSERT(elf_version(EV_CURRENT) != EV_NONE);
 
     // Open elf file
     int elf_file = open(elf_name, O_RDONLY);
-    SIM_ASSERT(elf_file != -1);
+    if (elf_file == -1) {
+        return {SimStatus::ELF__OPEN_ERROR, 0};
+    }
 
     // Get elf file size
     auto elf_size = lseek(elf_file, 0, SEEK_END);
@@ -20,12 +91,14 @@ ElfLoader::LoadElfRes ElfLoader::loadElf(const char *elf_name) {
     SIM_ASSERT(read_num != -1);
 
     Elf *elf = elf_begin(elf_file, ELF_C_READ, nullptr);
-    SIM_ASSERT(elf != nullptr);
-    SIM_ASSERT(gelf_getclass(elf) != ELFCLASSNONE);
-    SIM_ASSERT(gelf_getclass(elf) != ELFCLASS32);
-
     GElf_Ehdr elf_header{};
-    SIM_ASSERT(gelf_getehdr(elf, &elf_header) != nullptr);
+
+    if (elf == nullptr || gelf_getclass(elf) != ELFCLASS64 ||
+        gelf_getehdr(elf, &elf_header) == nullptr) {
+        elf_end(elf);
+        close(elf_file);
+        return {SimStatus::ELF__FORMAT_ERROR, 0};
+    }
 
     for (size_t i = 0; i < elf_header.e_phnum; ++i) {
         GElf_Phdr seg_header{};
@@ -38,11 +111,16 @@ ElfLoader::LoadElfRes ElfLoader::loadElf(const char *elf_name) {
             // Map pages
             VirtAddr seg_base = seg_vaddr & ~memory::PAGE_OFFSET_MASK;
             VirtAddr seg_end = seg_vaddr + seg_header.p_memsz;
+            m_brk_start = std::max(m_brk_start,
+                                   (seg_end + memory::PAGE_OFFSET_MASK) &
+                                       ~memory::PAGE_OFFSET_MASK);
             for (auto curr_page_va = seg_base; curr_page_va < seg_end;
                  curr_page_va += memory::PAGE_SIZE) {
 
                 auto status = mapPage(curr_page_va / memory::PAGE_SIZE);
                 if (status != SimStatus::OK) {
+                    elf_end(elf);
+                    close(elf_file);
                     return {status, 0};
                 }
             }
@@ -71,6 +149,8 @@ ElfLoader::LoadElfRes ElfLoader::loadElf(const char *elf_name) {
         }
     }
 
+    readFuncSymbols(elf);
+
     elf_end(elf);
     close(elf_file);
 
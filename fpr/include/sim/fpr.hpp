@@ -0,0 +1,125 @@
+#ifndef INCL_FPR_HPP
+#define INCL_FPR_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#include <sim/common.hpp>
+
+namespace sim {
+namespace fpr {
+
+static constexpr size_t FPR_NUMBER = 32;
+
+// Instr rm field and frm values
+enum class RoundingMode : uint8_t {
+    RNE = 0b000,
+    RTZ = 0b001,
+    RDN = 0b010,
+    RUP = 0b011,
+    RMM = 0b100,
+    // Use frm. Valid in instrs only
+    DYN = 0b111
+};
+
+// Accrued exception flags
+namespace FFLAGS {
+enum FFLAGS : uint8_t {
+    NX = 1 << 0,
+    UF = 1 << 1,
+    OF = 1 << 2,
+    DZ = 1 << 3,
+    NV = 1 << 4,
+
+    ALL = NX | UF | OF | DZ | NV
+};
+} // namespace FFLAGS
+
+static constexpr uint32_t CANONICAL_NAN_S = 0x7fc00000;
+static constexpr uint64_t CANONICAL_NAN_D = 0x7ff8000000000000;
+
+// Upper bits of NaN-boxed single precision value
+static constexpr uint64_t NAN_BOX = 0xffffffff00000000;
+
+template <class Float> NODISCARD Float canonicalNaN() noexcept {
+    if constexpr (std::is_same_v<Float, float>) {
+        return std::bit_cast<float>(CANONICAL_NAN_S);
+    } else {
+        return std::bit_cast<double>(CANONICAL_NAN_D);
+    }
+}
+
+// FP registers are 64 bits wide. Single precision values are NaN-boxed
+class FPRFile final {
+    std::array<uint64_t, FPR_NUMBER> m_fpr{};
+
+    uint8_t m_frm = 0;
+    uint8_t m_fflags = 0;
+
+  public:
+    NODISCARD uint64_t readBits(size_t idx) const noexcept {
+        SIM_ASSERT(idx < FPR_NUMBER);
+
+        return m_fpr[idx];
+    }
+
+    void writeBits(size_t idx, uint64_t bits) noexcept {
+        SIM_ASSERT(idx < FPR_NUMBER);
+
+        m_fpr[idx] = bits;
+    }
+
+    // Improperly NaN-boxed single precision value is read as canonical NaN
+    template <class Float> NODISCARD Float read(size_t idx) const noexcept {
+        static_assert(std::is_same_v<Float, float> ||
+                      std::is_same_v<Float, double>);
+
+        auto bits = readBits(idx);
+
+        if constexpr (std::is_same_v<Float, float>) {
+            if ((bits & NAN_BOX) != NAN_BOX) {
+                return canonicalNaN<float>();
+            }
+            return std::bit_cast<float>(static_cast<uint32_t>(bits));
+        } else {
+            return std::bit_cast<double>(bits);
+        }
+    }
+
+    template <class Float> void write(size_t idx, Float value) noexcept {
+        static_assert(std::is_same_v<Float, float> ||
+                      std::is_same_v<Float, double>);
+
+        if constexpr (std::is_same_v<Float, float>) {
+            writeBits(idx, NAN_BOX | std::bit_cast<uint32_t>(value));
+        } else {
+            writeBits(idx, std::bit_cast<uint64_t>(value));
+        }
+    }
+
+    NODISCARD auto frm() const noexcept { return m_frm; }
+    void setFrm(uint8_t frm) noexcept { m_frm = frm & 0x7; }
+
+    NODISCARD auto fflags() const noexcept { return m_fflags; }
+    void setFflags(uint8_t fflags) noexcept { m_fflags = fflags & FFLAGS::ALL; }
+    void accrueFflags(uint8_t fflags) noexcept {
+        m_fflags |= fflags & FFLAGS::ALL;
+    }
+
+    // fcsr is frm and fflags combined
+    NODISCARD RegValue fcsr() const noexcept {
+        return RegValue{m_frm} << 5 | m_fflags;
+    }
+
+    void setFcsr(RegValue fcsr) noexcept {
+        setFflags(static_cast<uint8_t>(fcsr));
+        setFrm(static_cast<uint8_t>(fcsr >> 5));
+    }
+};
+
+} // namespace fpr
+} // namespace sim
+
+#endif // INCL_FPR_HPP
@@ -0,0 +1,58 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include <sim/common.hpp>
+#include <sim/fpr.hpp>
+
+namespace sim {
+namespace fpr {
+
+class FPRTest : public ::testing::Test {
+  protected:
+    static constexpr uint64_t MT_SEED = 1003;
+    std::mt19937_64 mt{MT_SEED};
+
+    FPRFile fpr_file{};
+};
+
+TEST_F(FPRTest, readWrite) {
+    for (size_t i = 0; i != FPR_NUMBER; ++i) {
+        fpr_file.writeBits(i, mt());
+    }
+
+    std::mt19937_64 mt{MT_SEED};
+    for (size_t i = 0; i != FPR_NUMBER; ++i) {
+        auto value = mt();
+
+        ASSERT_EQ(fpr_file.readBits(i), value);
+        ASSERT_EQ(std::bit_cast<uint64_t>(fpr_file.read<double>(i)), value);
+    }
+}
+
+TEST_F(FPRTest, nanBoxing) {
+    fpr_file.write(1, 1.5f);
+    ASSERT_EQ(fpr_file.readBits(1), NAN_BOX | std::bit_cast<uint32_t>(1.5f));
+    ASSERT_EQ(fpr_file.read<float>(1), 1.5f);
+
+    // Double is not a valid NaN-boxed single
+    fpr_file.write(2, 1.5);
+    ASSERT_EQ(std::bit_cast<uint32_t>(fpr_file.read<float>(2)),
+              CANONICAL_NAN_S);
+}
+
+TEST_F(FPRTest, fcsr) {
+    fpr_file.setFcsr(0xff);
+    ASSERT_EQ(fpr_file.frm(), 0b111);
+    ASSERT_EQ(fpr_file.fflags(), FFLAGS::ALL);
+    ASSERT_EQ(fpr_file.fcsr(), 0xff);
+
+    fpr_file.setFflags(0);
+    fpr_file.accrueFflags(FFLAGS::NX);
+    fpr_file.accrueFflags(FFLAGS::DZ);
+    ASSERT_EQ(fpr_file.fflags(), FFLAGS::NX | FFLAGS::DZ);
+    ASSERT_EQ(fpr_file.fcsr(), 0b11101001);
+}
+
+} // namespace fpr
+} // namespace sim
@@ -5,15 +5,21 @@
 
 #include <sim/common.hpp>
 #include <sim/csr.hpp>
+#include <sim/fpr.hpp>
 #include <sim/gpr.hpp>
 #include <sim/memory.hpp>
+#include <sim/vr.hpp>
 
 namespace sim {
 namespace hart {
 
 class Hart final {
+    size_t m_hart_id = 0;
+
     VirtAddr m_pc = 0;
     gpr::GPRFile m_gpr_file{};
+    fpr::FPRFile m_fpr_file{};
+    vr::VRFile m_vr_file{};
     csr::CSRFile m_csr_file{};
 
     memory::PhysMemory &m_phys_memory;
@@ -22,7 +28,19 @@ class Hart final {
                           m_csr_file.get<XLen::XLEN_64, csr::CSRIdx::SATP>()};
 
   public:
-    Hart(memory::PhysMemory &phys_memory) : m_phys_memory(phys_memory) {}
+    Hart(memory::PhysMemory &phys_memory, size_t hart_id = 0)
+        : m_hart_id(hart_id), m_phys_memory(phys_memory) {}
+
+    NODISCARD auto hartId() const noexcept { return m_hart_id; }
+
+    // Reset architectural state
+    void reset() noexcept {
+        m_pc = 0;
+        m_gpr_file = {};
+        m_fpr_file = {};
+        m_vr_file = {};
+        m_csr_file = {};
+    }
 
     NODISCARD auto pc() const noexcept { return m_pc; }
     NODISCARD auto &pc() noexcept { return m_pc; }
@@ -30,6 +48,12 @@ class Hart final {
     NODISCARD const auto &gprFile() const noexcept { return m_gpr_file; }
     NODISCARD auto &gprFile() noexcept { return m_gpr_file; }
 
+    NODISCARD const auto &fprFile() const noexcept { return m_fpr_file; }
+    NODISCARD auto &fprFile() noexcept { return m_fpr_file; }
+
+    NODISCARD const auto &vrFile() const noexcept { return m_vr_file; }
+    NODISCARD auto &vrFile() noexcept { return m_vr_file; }
+
     NODISCARD const auto &csrFile() const noexcept { return m_csr_file; }
     NODISCARD auto &csrFile() noexcept { return m_csr_file; }
 
@@ -2,9 +2,12 @@ import yaml
 import subprocess
 import sys
 
-KNOWN_REGS = ["rd", "rs1", "rs2", "rm"]
-KNOWN_IMMS = [ "imm12", "imm20", "jimm20", "storeimm", "bimm", "shamt", "shamtw"]
-IMMS_NO_EXTEND = ["shamt", "shamtw"]
+KNOWN_REGS = ["rd", "rs1", "rs2", "rs3", "rm", "vm"]
+KNOWN_IMMS = [ "imm12", "imm20", "jimm20", "storeimm", "bimm", "shamt", "shamtw",
+               "simm5", "zimm10", "zimm11"]
+IMMS_NO_EXTEND = ["shamt", "shamtw", "zimm10", "zimm11"]
+# Vector operands and vsetivli AVL are stored in scalar operand fields
+FIELD_ALIASES = {"vd": "rd", "vs3": "rd", "vs1": "rs1", "vs2": "rs2", "zimm5": "rs1"}
 
 def GenerateGetBinValue(bit_section: dict) -> str:
     write_buffer = ""
@@ -25,8 +28,8 @@ def GenerateFieldAssigning(inst: dict, field_dict: dict) -> str:
     extend_from = 0
 
     for field in inst.get("fields"):
-        if field in KNOWN_REGS:
-            write_buffer += f"m_{field} = static_cast<uint8_t>("
+        if field in KNOWN_REGS or field in FIELD_ALIASES:
+            write_buffer += f"m_{FIELD_ALIASES.get(field, field)} = static_cast<uint8_t>("
             write_buffer += GenerateGetBinValue(field_dict.get(field).get('location').get('bits')[0])
             write_buffer += ");\n"
         elif field in KNOWN_IMMS:
@@ -96,7 +99,7 @@ def main():
         "namespace sim {" "\n"                      +\
         "namespace instr {" "\n"                    +\
         "\n"                                        +\
-        "Instr::Instr(InstrCode instr_code) {" "\n"
+        "void Instr::decode(InstrCode instr_code) {" "\n"
 
     write_buffer += GenerateDecoderTree(yaml_dump)
 
@@ -3,6 +3,44 @@ import subprocess
 import sys
 
 
+# Instr classes by major opcode in bits [6:2]
+OPCODE_CLASSES = {
+    0: "LOAD",
+    1: "LOAD_FP",
+    3: "MISC_MEM",
+    4: "OP_IMM",
+    5: "AUIPC",
+    6: "OP_IMM_32",
+    8: "STORE",
+    9: "STORE_FP",
+    11: "AMO",
+    12: "OP",
+    13: "LUI",
+    14: "OP_32",
+    16: "MADD",
+    17: "MSUB",
+    18: "NMSUB",
+    19: "NMADD",
+    20: "OP_FP",
+    21: "OP_V",
+    24: "BRANCH",
+    25: "JALR",
+    27: "JAL",
+    28: "SYSTEM",
+}
+
+# Class of simulator pseudo instrs
+SIM_CLASS = "SIM"
+
+
+def get_opcode(inst):
+    for bits in inst.get("fixedbits"):
+        if bits.get("msb") == 6 and bits.get("lsb") == 2:
+            return bits.get("value")
+
+    raise ValueError(f"No major opcode for {inst.get('mnemonic')}")
+
+
 def main():
     if len(sys.argv) < 2:
         print("No risc-v.yaml file provided")
@@ -13,20 +51,79 @@ def main():
 
     write_buffer = "#ifndef INCL_TYPE_GEN_HPP" "\n" +\
                    "#define INCL_TYPE_GEN_HPP" "\n\n" +\
+                   "#include <cstddef>" "\n" +\
                    "#include <cstdint>" "\n\n" +\
                    "namespace sim {" "\n" +\
                    "namespace instr {" "\n\n" +\
-                   "enum class InstrId : uint8_t {" "\n"
+                   "enum class InstrId : uint16_t {" "\n"
 
-    write_buffer += "SIM_STATUS_INSTR,\n"
+    inst_names = ["SIM_STATUS_INSTR"]
+    inst_classes = [SIM_CLASS]
     for inst in yaml_dump.get("instructions"):
         inst_name = inst.get("mnemonic").upper()
         if "." in inst_name:
             inst_name = inst_name.replace(".", "_", 2)
 
+        inst_names.append(inst_name)
+        inst_classes.append(OPCODE_CLASSES[get_opcode(inst)])
+
+    # Pseudo instr for host-simulated guest functions. Never decoded
+    inst_names.append("SIM_HOST_CALL")
+    inst_classes.append(SIM_CLASS)
+
+    # Pseudo instrs of plugin instrumentation. Never decoded
+    inst_names.append("SIM_PLUGIN_CALL")
+    inst_classes.append(SIM_CLASS)
+    inst_names.append("SIM_PLUGIN_BLOCK")
+    inst_classes.append(SIM_CLASS)
+
+    # Classes of present instrs in opcode order
+    class_names = [name for name in OPCODE_CLASSES.values()
+                   if name in inst_classes] + [SIM_CLASS]
+
+    for inst_name in inst_names:
         write_buffer += f"{inst_name},\n"
+    write_buffer += "};\n\n"
+
+    write_buffer += "inline constexpr size_t INSTR_ID_NUMBER = " +\
+                    f"{len(inst_names)};\n\n"
 
+    write_buffer += "// InstrId name\n" +\
+                    "constexpr const char *instrName(InstrId id) noexcept {\n" +\
+                    "constexpr const char *NAMES[] = {\n"
+    for inst_name in inst_names:
+        write_buffer += f"\"{inst_name}\",\n"
+    write_buffer += "};\n\n" +\
+                    "return NAMES[static_cast<uint16_t>(id)];\n" +\
+                    "}\n\n"
+
+    write_buffer += "// Instr classes by major opcode\n" +\
+                    "enum class InstrClass : uint8_t {\n"
+    for class_name in class_names:
+        write_buffer += f"{class_name},\n"
     write_buffer += "};\n\n"
+
+    write_buffer += "inline constexpr size_t INSTR_CLASS_NUMBER = " +\
+                    f"{len(class_names)};\n\n"
+
+    write_buffer += "// InstrClass name\n" +\
+                    "constexpr const char *instrClassName(InstrClass cls) " +\
+                    "noexcept {\n" +\
+                    "constexpr const char *NAMES[] = {\n"
+    for class_name in class_names:
+        write_buffer += f"\"{class_name.lower()}\",\n"
+    write_buffer += "};\n\n" +\
+                    "return NAMES[static_cast<uint8_t>(cls)];\n" +\
+                    "}\n\n"
+
+    write_buffer += "// InstrId class\n" +\
+                    "constexpr InstrClass instrClass(InstrId id) noexcept {\n" +\
+                    "constexpr InstrClass CLASSES[] = {\n"
+    for inst_class in inst_classes:
+        write_buffer += f"InstrClass::{inst_class},\n"
+    write_buffer += "};\n\n" +\
+                    "return CLASSES[static_cast<uint16_t>(id)];\n" +\
+                    "}\n\n"
     write_buffer += "} // namespace instr" "\n"
     write_buffer += "} // namespace sim" "\n\n"
 
@@ -11,31 +11,56 @@
 namespace sim {
 namespace instr {
 
+// Compressed instr codes have low bits != 0b11
+NODISCARD constexpr bool isCompressed(InstrCode instr_code) noexcept {
+    return (instr_code & 0x3) != 0x3;
+}
+
+NODISCARD constexpr size_t codeSize(InstrCode instr_code) noexcept {
+    return isCompressed(instr_code) ? COMPRESSED_INSTR_CODE_SIZE
+                                    : INSTR_CODE_SIZE;
+}
+
+// Expand compressed instr code to equivalent 32-bit instr code.
+// Returns 0 for illegal and reserved codes
+NODISCARD InstrCode expandCompressed(uint16_t instr_code) noexcept;
+
 class Instr final {
     InstrId m_id = InstrId::SIM_STATUS_INSTR;
     uint8_t m_rd = 0;
     uint8_t m_rs1 = 0;
     uint8_t m_rs2 = 0;
+    uint8_t m_rs3 = 0;
     uint32_t m_imm = to_underlying(SimStatus::SIM__NOT_IMPLEMENTED_INSTR);
     uint8_t m_rm = 0;
+    uint8_t m_vm = 0;
+    uint8_t m_size = INSTR_CODE_SIZE;
 
     // Status is stored in imm for status instructions
     static_assert(sizeof(SimStatus) <= sizeof(m_imm));
 
+    // Decode 32-bit instr code. Body is generated with YAML description
+    void decode(InstrCode instr_code);
+
   public:
     NODISCARD auto id() const noexcept { return m_id; }
     NODISCARD auto rd() const noexcept { return m_rd; }
     NODISCARD auto rs1() const noexcept { return m_rs1; }
     NODISCARD auto rs2() const noexcept { return m_rs2; }
+    NODISCARD auto rs3() const noexcept { return m_rs3; }
     NODISCARD auto imm() const noexcept { return m_imm; }
     NODISCARD auto rm() const noexcept { return m_rm; }
+    // Vector mask bit. Set for unmasked vector instrs
+    NODISCARD bool vm() const noexcept { return m_vm; }
+    // Instr code size in bytes
+    NODISCARD auto size() const noexcept { return m_size; }
 
     Instr() = default;
     Instr(const Instr &) = default;
     Instr &operator=(const Instr &) = default;
 
-    // Decode given InstrCode and construct Instr object
-    // Body is generated with YAML description
+    // Decode given InstrCode and construct Instr object.
+    // Compressed instrs are expanded to their 32-bit equivalents
     explicit Instr(InstrCode instr_code);
 
     NODISCARD static Instr statusInstr(SimStatus status) noexcept {
@@ -44,6 +69,32 @@ class Instr final {
         return out;
     }
 
+    // Pseudo instr calling host function with given index
+    NODISCARD static Instr hostCallInstr(uint32_t func_idx) noexcept {
+        Instr out{};
+        out.m_id = InstrId::SIM_HOST_CALL;
+        out.m_imm = func_idx;
+        return out;
+    }
+
+    // Pseudo instr calling plugin hook with given index
+    NODISCARD static Instr pluginCallInstr(uint32_t hook_idx) noexcept {
+        Instr out{};
+        out.m_id = InstrId::SIM_PLUGIN_CALL;
+        out.m_imm = hook_idx;
+        return out;
+    }
+
+    // Pseudo instr jumping to instrumented block with given index
+    NODISCARD static Instr pluginBlockInstr(uint32_t block_idx) noexcept {
+        Instr out{};
+        out.m_id = InstrId::SIM_PLUGIN_BLOCK;
+        out.m_imm = block_idx;
+        return out;
+    }
+
+    NODISCARD bool operator==(const Instr &) const noexcept = default;
+
     NODISCARD SimStatus status() const noexcept {
         SIM_ASSERT(m_id == InstrId::SIM_STATUS_INSTR);
         return static_cast<SimStatus>(m_imm);
@@ -0,0 +1,301 @@
+#include <array>
+
+#include <sim/instr.hpp>
+
+namespace sim::instr {
+
+namespace {
+
+// 32-bit major opcodes used by compressed instrs expansion
+enum Opcode : InstrCode {
+    LOAD = 0x03,
+    LOAD_FP = 0x07,
+    OP_IMM = 0x13,
+    OP_IMM_32 = 0x1b,
+    STORE = 0x23,
+    STORE_FP = 0x27,
+    OP = 0x33,
+    LUI = 0x37,
+    OP_32 = 0x3b,
+    BRANCH = 0x63,
+    JALR = 0x67,
+    JAL = 0x6f
+};
+
+constexpr InstrCode EBREAK_CODE = 0x00100073;
+
+constexpr uint8_t SP = 2;
+constexpr uint8_t RA = 1;
+
+// Get instr code bits [hi:lo] placed at position to
+constexpr InstrCode bits(InstrCode code, bit::BitIdx hi, bit::BitIdx lo,
+                         bit::BitIdx to) noexcept {
+    return bit::getBitField(hi, lo, code) << to;
+}
+
+// Registers x8-x15 encoded in 3 bits
+constexpr uint8_t cReg(InstrCode code, bit::BitIdx lo) noexcept {
+    return static_cast<uint8_t>(bits(code, lo + 2, lo, 0) + 8);
+}
+
+constexpr uint8_t cRd(InstrCode code) noexcept {
+    return static_cast<uint8_t>(bits(code, 11, 7, 0));
+}
+
+constexpr uint8_t cRs2(InstrCode code) noexcept {
+    return static_cast<uint8_t>(bits(code, 6, 2, 0));
+}
+
+// Sign extended 6-bit immediate of CI format
+constexpr InstrCode ciImm(InstrCode code) noexcept {
+    return bit::signExtend(5, bits(code, 12, 12, 5) | bits(code, 6, 2, 0));
+}
+
+// Offsets of word and double word accesses in CL and CS formats
+constexpr InstrCode clwImm(InstrCode code) noexcept {
+    return bits(code, 12, 10, 3) | bits(code, 6, 6, 2) | bits(code, 5, 5, 6);
+}
+
+constexpr InstrCode cldImm(InstrCode code) noexcept {
+    return bits(code, 12, 10, 3) | bits(code, 6, 5, 6);
+}
+
+// Stack pointer relative double word offsets
+constexpr InstrCode ldspImm(InstrCode code) noexcept {
+    return bits(code, 12, 12, 5) | bits(code, 6, 5, 3) | bits(code, 4, 2, 6);
+}
+
+constexpr InstrCode sdspImm(InstrCode code) noexcept {
+    return bits(code, 12, 10, 3) | bits(code, 9, 7, 6);
+}
+
+constexpr InstrCode cbImm(InstrCode code) noexcept {
+    return bit::signExtend(8, bits(code, 12, 12, 8) | bits(code, 11, 10, 3) |
+                                  bits(code, 6, 5, 6) | bits(code, 4, 3, 1) |
+                                  bits(code, 2, 2, 5));
+}
+
+constexpr InstrCode encodeR(InstrCode opcode, InstrCode funct3,
+                            InstrCode funct7, uint8_t rd, uint8_t rs1,
+                            uint8_t rs2) noexcept {
+    return funct7 << 25 | InstrCode{rs2} << 20 | InstrCode{rs1} << 15 |
+           funct3 << 12 | InstrCode{rd} << 7 | opcode;
+}
+
+constexpr InstrCode encodeI(InstrCode opcode, InstrCode funct3, uint8_t rd,
+                            uint8_t rs1, InstrCode imm) noexcept {
+    return (imm & 0xfff) << 20 | InstrCode{rs1} << 15 | funct3 << 12 |
+           InstrCode{rd} << 7 | opcode;
+}
+
+constexpr InstrCode encodeS(InstrCode opcode, InstrCode funct3, uint8_t rs1,
+                            uint8_t rs2, InstrCode imm) noexcept {
+    return bits(imm, 11, 5, 25) | InstrCode{rs2} << 20 |
+           InstrCode{rs1} << 15 | funct3 << 12 | bits(imm, 4, 0, 7) | opcode;
+}
+
+constexpr InstrCode encodeB(InstrCode funct3, uint8_t rs1, uint8_t rs2,
+                            InstrCode imm) noexcept {
+    return bits(imm, 12, 12, 31) | bits(imm, 10, 5, 25) |
+           InstrCode{rs2} << 20 | InstrCode{rs1} << 15 | funct3 << 12 |
+           bits(imm, 4, 1, 8) | bits(imm, 11, 11, 7) | BRANCH;
+}
+
+constexpr InstrCode encodeJ(uint8_t rd, InstrCode imm) noexcept {
+    return bits(imm, 20, 20, 31) | bits(imm, 10, 1, 21) |
+           bits(imm, 11, 11, 20) | bits(imm, 19, 12, 12) | InstrCode{rd} << 7 |
+           JAL;
+}
+
+InstrCode expandQuadrant0(InstrCode code) noexcept {
+    auto rd = cReg(code, 2);
+    auto rs1 = cReg(code, 7);
+
+    switch (bits(code, 15, 13, 0)) {
+    case 0: { // C.ADDI4SPN
+        auto imm = bits(code, 12, 11, 4) | bits(code, 10, 7, 6) |
+                   bits(code, 6, 6, 2) | bits(code, 5, 5, 3);
+        return imm == 0 ? 0 : encodeI(OP_IMM, 0, rd, SP, imm);
+    }
+    case 1: // C.FLD
+        return encodeI(LOAD_FP, 3, rd, rs1, cldImm(code));
+    case 2: // C.LW
+        return encodeI(LOAD, 2, rd, rs1, clwImm(code));
+    case 3: // C.LD
+        return encodeI(LOAD, 3, rd, rs1, cldImm(code));
+    case 5: // C.FSD
+        return encodeS(STORE_FP, 3, rs1, rd, cldImm(code));
+    case 6: // C.SW
+        return encodeS(STORE, 2, rs1, rd, clwImm(code));
+    case 7: // C.SD
+        return encodeS(STORE, 3, rs1, rd, cldImm(code));
+    default:
+        return 0;
+    }
+}
+
+InstrCode expandArith(InstrCode code) noexcept {
+    auto rd = cReg(code, 7);
+    auto rs2 = cReg(code, 2);
+    auto shamt = bits(code, 12, 12, 5) | bits(code, 6, 2, 0);
+
+    switch (bits(code, 11, 10, 0)) {
+    case 0: // C.SRLI
+        return encodeI(OP_IMM, 5, rd, rd, shamt);
+    case 1: // C.SRAI
+        return encodeI(OP_IMM, 5, rd, rd, shamt | 0x400);
+    case 2: // C.ANDI
+        return encodeI(OP_IMM, 7, rd, rd, ciImm(code));
+    default:
+        break;
+    }
+
+    // C.SUB, C.XOR, C.OR, C.AND
+    if (bits(code, 12, 12, 0) == 0) {
+        constexpr InstrCode FUNCT3[] = {0, 4, 6, 7};
+        auto op = bits(code, 6, 5, 0);
+        return encodeR(OP, FUNCT3[op], op == 0 ? 0x20 : 0, rd, rd, rs2);
+    }
+
+    switch (bits(code, 6, 5, 0)) {
+    case 0: // C.SUBW
+        return encodeR(OP_32, 0, 0x20, rd, rd, rs2);
+    case 1: // C.ADDW
+        return encodeR(OP_32, 0, 0, rd, rd, rs2);
+    default:
+        return 0;
+    }
+}
+
+InstrCode expandQuadrant1(InstrCode code) noexcept {
+    auto rd = cRd(code);
+    auto rs1 = cReg(code, 7);
+
+    switch (bits(code, 15, 13, 0)) {
+    case 0: // C.ADDI
+        return encodeI(OP_IMM, 0, rd, rd, ciImm(code));
+    case 1: // C.ADDIW
+        return rd == 0 ? 0 : encodeI(OP_IMM_32, 0, rd, rd, ciImm(code));
+    case 2: // C.LI
+        return encodeI(OP_IMM, 0, rd, 0, ciImm(code));
+    case 3: {
+        if (rd == SP) { // C.ADDI16SP
+            auto imm = bit::signExtend(
+                9, bits(code, 12, 12, 9) | bits(code, 6, 6, 4) |
+                       bits(code, 5, 5, 6) | bits(code, 4, 3, 7) |
+                       bits(code, 2, 2, 5));
+            return imm == 0 ? 0 : encodeI(OP_IMM, 0, SP, SP, imm);
+        }
+
+        // C.LUI
+        auto imm = ciImm(code);
+        return imm == 0 ? 0 : (imm & 0xfffff) << 12 | InstrCode{rd} << 7 | LUI;
+    }
+    case 4:
+        return expandArith(code);
+    case 5: { // C.J
+        auto imm = bit::signExtend(
+            11, bits(code, 12, 12, 11) | bits(code, 11, 11, 4) |
+                    bits(code, 10, 9, 8) | bits(code, 8, 8, 10) |
+                    bits(code, 7, 7, 6) | bits(code, 6, 6, 7) |
+                    bits(code, 5, 3, 1) | bits(code, 2, 2, 5));
+        return encodeJ(0, imm);
+    }
+    case 6: // C.BEQZ
+        return encodeB(0, rs1, 0, cbImm(code));
+    case 7: // C.BNEZ
+        return encodeB(1, rs1, 0, cbImm(code));
+    default:
+        return 0;
+    }
+}
+
+InstrCode expandQuadrant2(InstrCode code) noexcept {
+    auto rd = cRd(code);
+    auto rs2 = cRs2(code);
+
+    switch (bits(code, 15, 13, 0)) {
+    case 0: // C.SLLI
+        return encodeI(OP_IMM, 1, rd, rd,
+                       bits(code, 12, 12, 5) | bits(code, 6, 2, 0));
+    case 1: // C.FLDSP
+        return encodeI(LOAD_FP, 3, rd, SP, ldspImm(code));
+    case 2: { // C.LWSP
+        auto imm =
+            bits(code, 12, 12, 5) | bits(code, 6, 4, 2) | bits(code, 3, 2, 6);
+        return rd == 0 ? 0 : encodeI(LOAD, 2, rd, SP, imm);
+    }
+    case 3: // C.LDSP
+        return rd == 0 ? 0 : encodeI(LOAD, 3, rd, SP, ldspImm(code));
+    case 4:
+        if (bits(code, 12, 12, 0) == 0) {
+            if (rs2 == 0) { // C.JR
+                return rd == 0 ? 0 : encodeI(JALR, 0, 0, rd, 0);
+            }
+            // C.MV
+            return encodeR(OP, 0, 0, rd, 0, rs2);
+        }
+
+        if (rs2 == 0) { // C.EBREAK, C.JALR
+            return rd == 0 ? EBREAK_CODE : encodeI(JALR, 0, RA, rd, 0);
+        }
+        // C.ADD
+        return encodeR(OP, 0, 0, rd, rd, rs2);
+    case 5: // C.FSDSP
+        return encodeS(STORE_FP, 3, SP, rs2, sdspImm(code));
+    case 6: // C.SWSP
+        return encodeS(STORE, 2, SP, rs2,
+                       bits(code, 12, 9, 2) | bits(code, 8, 7, 6));
+    case 7: // C.SDSP
+        return encodeS(STORE, 3, SP, rs2, sdspImm(code));
+    default:
+        return 0;
+    }
+}
+
+// Expanded codes of all 16-bit parcels
+const std::array<InstrCode, 1 << 16> &expansionTable() noexcept {
+    static const auto table = [] {
+        std::array<InstrCode, 1 << 16> out{};
+        for (size_t code = 0; code != out.size(); ++code) {
+            out[code] = expandCompressed(static_cast<uint16_t>(code));
+        }
+        return out;
+    }();
+
+    return table;
+}
+
+} // namespace
+
+InstrCode expandCompressed(uint16_t instr_code) noexcept {
+    InstrCode code = instr_code;
+
+    switch (code & 0x3) {
+    case 0:
+        return expandQuadrant0(code);
+    case 1:
+        return expandQuadrant1(code);
+    case 2:
+        return expandQuadrant2(code);
+    default:
+        return 0;
+    }
+}
+
+Instr::Instr(InstrCode instr_code) {
+    if (!isCompressed(instr_code)) {
+        decode(instr_code);
+        return;
+    }
+
+    auto expanded = expansionTable()[instr_code & 0xffff];
+    if (expanded == 0) {
+        return;
+    }
+
+    decode(expanded);
+    m_size = COMPRESSED_INSTR_CODE_SIZE;
+}
+
+} // namespace sim::instr
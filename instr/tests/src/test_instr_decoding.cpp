@@ -1,4 +1,5 @@
 #include <tuple>
+#include <utility>
 
 #include <gtest/gtest.h>
 
@@ -68,6 +69,158 @@ TEST(Instr, sraiw) {
     ASSERT_EQ(test.imm(), 30);
 }
 
+TEST(Instr, compressed) {
+    // Compressed instr and its 32-bit equivalent
+    const std::pair<InstrCode, InstrCode> CODES[] = {
+        {0x0800, 0x01010413}, // c.addi4spn s0, sp, 16
+        {0x41c8, 0x0045a503}, // c.lw a0, 4(a1)
+        {0xe49c, 0x00f4b423}, // c.sd a5, 8(s1)
+        {0x1575, 0xffd50513}, // c.addi a0, -3
+        {0x7585, 0xfffe15b7}, // c.lui a1, 0xfffe1
+        {0x7139, 0xfc010113}, // c.addi16sp sp, -64
+        {0x9405, 0x42145413}, // c.srai s0, 33
+        {0x8d0d, 0x40b50533}, // c.sub a0, a1
+        {0x9f3d, 0x00f7073b}, // c.addw a4, a5
+        {0xbfed, 0xffbff06f}, // c.j -6
+        {0xe509, 0x00051563}, // c.bnez a0, 10
+        {0x12fe, 0x03f29293}, // c.slli t0, 63
+        {0x60e2, 0x01813083}, // c.ldsp ra, 24(sp)
+        {0xec06, 0x00113c23}, // c.sdsp ra, 24(sp)
+        {0x851a, 0x00600533}, // c.mv a0, t1
+        {0x9282, 0x000280e7}, // c.jalr t0
+        {0x8082, 0x00008067}, // c.jr ra
+    };
+
+    for (auto [compressed_code, code] : CODES) {
+        Instr compressed = Instr(compressed_code);
+        Instr expected = Instr(code);
+
+        ASSERT_EQ(compressed.id(), expected.id());
+        ASSERT_EQ(compressed.rd(), expected.rd());
+        ASSERT_EQ(compressed.rs1(), expected.rs1());
+        ASSERT_EQ(compressed.rs2(), expected.rs2());
+        ASSERT_EQ(compressed.imm(), expected.imm());
+
+        ASSERT_EQ(compressed.size(), COMPRESSED_INSTR_CODE_SIZE);
+        ASSERT_EQ(expected.size(), INSTR_CODE_SIZE);
+    }
+}
+
+TEST(Instr, compressedReserved) {
+    // c.addi16sp with zero immediate
+    Instr test = Instr(static_cast<InstrCode>(0x6101));
+    ASSERT_EQ(test.id(), InstrId::SIM_STATUS_INSTR);
+    ASSERT_EQ(test.status(), SimStatus::SIM__NOT_IMPLEMENTED_INSTR);
+}
+
+TEST(Instr, bitManip) {
+    const std::pair<InstrCode, InstrId> CODES[] = {
+        {0x08c5853b, InstrId::ADD_UW}, // add.uw a0, a1, a2
+        {0x20c5a533, InstrId::SH1ADD}, // sh1add a0, a1, a2
+        {0x20c5c533, InstrId::SH2ADD}, // sh2add a0, a1, a2
+        {0x20c5e533, InstrId::SH3ADD}, // sh3add a0, a1, a2
+        {0x20c5a53b, InstrId::SH1ADD_UW}, // sh1add.uw a0, a1, a2
+        {0x20c5c53b, InstrId::SH2ADD_UW}, // sh2add.uw a0, a1, a2
+        {0x20c5e53b, InstrId::SH3ADD_UW}, // sh3add.uw a0, a1, a2
+        {0x0a85951b, InstrId::SLLI_UW}, // slli.uw a0, a1, 40
+        {0x40c5f533, InstrId::ANDN}, // andn a0, a1, a2
+        {0x40c5e533, InstrId::ORN}, // orn a0, a1, a2
+        {0x40c5c533, InstrId::XNOR}, // xnor a0, a1, a2
+        {0x60059513, InstrId::CLZ}, // clz a0, a1
+        {0x6005951b, InstrId::CLZW}, // clzw a0, a1
+        {0x60159513, InstrId::CTZ}, // ctz a0, a1
+        {0x6015951b, InstrId::CTZW}, // ctzw a0, a1
+        {0x60259513, InstrId::CPOP}, // cpop a0, a1
+        {0x6025951b, InstrId::CPOPW}, // cpopw a0, a1
+        {0x0ac5e533, InstrId::MAX}, // max a0, a1, a2
+        {0x0ac5f533, InstrId::MAXU}, // maxu a0, a1, a2
+        {0x0ac5c533, InstrId::MIN}, // min a0, a1, a2
+        {0x0ac5d533, InstrId::MINU}, // minu a0, a1, a2
+        {0x60459513, InstrId::SEXT_B}, // sext.b a0, a1
+        {0x60559513, InstrId::SEXT_H}, // sext.h a0, a1
+        {0x0805c53b, InstrId::ZEXT_H}, // zext.h a0, a1
+        {0x60c59533, InstrId::ROL}, // rol a0, a1, a2
+        {0x60c5953b, InstrId::ROLW}, // rolw a0, a1, a2
+        {0x60c5d533, InstrId::ROR}, // ror a0, a1, a2
+        {0x6285d513, InstrId::RORI}, // rori a0, a1, 40
+        {0x6145d51b, InstrId::RORIW}, // roriw a0, a1, 20
+        {0x60c5d53b, InstrId::RORW}, // rorw a0, a1, a2
+        {0x2875d513, InstrId::ORC_B}, // orc.b a0, a1
+        {0x6b85d513, InstrId::REV8}, // rev8 a0, a1
+        {0x48c59533, InstrId::BCLR}, // bclr a0, a1, a2
+        {0x4a859513, InstrId::BCLRI}, // bclri a0, a1, 40
+        {0x48c5d533, InstrId::BEXT}, // bext a0, a1, a2
+        {0x4a85d513, InstrId::BEXTI}, // bexti a0, a1, 40
+        {0x68c59533, InstrId::BINV}, // binv a0, a1, a2
+        {0x6a859513, InstrId::BINVI}, // binvi a0, a1, 40
+        {0x28c59533, InstrId::BSET}, // bset a0, a1, a2
+        {0x2a859513, InstrId::BSETI}, // bseti a0, a1, 40
+    };
+
+    for (auto [code, id] : CODES) {
+        Instr test = Instr(code);
+        ASSERT_EQ(test.id(), id);
+        ASSERT_EQ(test.rd(), 10);
+        ASSERT_EQ(test.rs1(), 11);
+    }
+
+    ASSERT_EQ(Instr(0x0a85951b).imm(), 40); // slli.uw a0, a1, 40
+    ASSERT_EQ(Instr(0x6145d51b).imm(), 20); // roriw a0, a1, 20
+    ASSERT_EQ(Instr(0x6a859513).imm(), 40); // binvi a0, a1, 40
+    ASSERT_EQ(Instr(0x0ac5e533).rs2(), 12); // max a0, a1, a2
+}
+
+TEST(Instr, vector) {
+    const std::pair<InstrCode, InstrId> CODES[] = {
+        {0x0205e207, InstrId::VLE32_V}, // vle32.v v4, (a1)
+        {0x0ac5f207, InstrId::VLSE64_V}, // vlse64.v v4, (a1), a2
+        {0x0005d227, InstrId::VSE16_V}, // vse16.v v4, (a1), v0.t
+        {0x02860257, InstrId::VADD_VV}, // vadd.vv v4, v8, v12
+        {0x028eb257, InstrId::VADD_VI}, // vadd.vi v4, v8, -3
+        {0x968fb257, InstrId::VSLL_VI}, // vsll.vi v4, v8, 31
+        {0x6a85c257, InstrId::VMSLTU_VX}, // vmsltu.vx v4, v8, a1
+        {0x5c82b257, InstrId::VMERGE_VIM}, // vmerge.vim v4, v8, 5, v0
+        {0x5e05c257, InstrId::VMV_V_X}, // vmv.v.x v4, a1
+        {0x02862257, InstrId::VREDSUM_VS}, // vredsum.vs v4, v8, v12
+        {0x66862257, InstrId::VMAND_MM}, // vmand.mm v4, v8, v12
+        {0x9485e257, InstrId::VMUL_VX}, // vmul.vx v4, v8, a1, v0.t
+    };
+
+    for (auto [code, id] : CODES) {
+        Instr test = Instr(code);
+        ASSERT_EQ(test.id(), id);
+        ASSERT_EQ(test.rd(), 4);
+    }
+
+    Instr vsetvli = Instr(0x0d15f557); // vsetvli a0, a1, e32, m2, ta, ma
+    ASSERT_EQ(vsetvli.id(), InstrId::VSETVLI);
+    ASSERT_EQ(vsetvli.rs1(), 11);
+    ASSERT_EQ(vsetvli.imm(), 0xd1);
+
+    Instr vsetivli = Instr(0xc008f557); // vsetivli a0, 17, e8, m1, tu, mu
+    ASSERT_EQ(vsetivli.id(), InstrId::VSETIVLI);
+    ASSERT_EQ(vsetivli.rs1(), 17);
+    ASSERT_EQ(vsetivli.imm(), 0);
+
+    ASSERT_EQ(Instr(0x02860257).rs1(), 12); // vadd.vv v4, v8, v12
+    ASSERT_EQ(Instr(0x02860257).rs2(), 8);
+    ASSERT_EQ(Instr(0x028eb257).imm(), -3); // vadd.vi v4, v8, -3
+    ASSERT_TRUE(Instr(0x02860257).vm());
+    ASSERT_FALSE(Instr(0x9485e257).vm()); // vmul.vx v4, v8, a1, v0.t
+
+    ASSERT_EQ(Instr(0x42802557).id(), InstrId::VMV_X_S); // vmv.x.s a0, v8
+    ASSERT_EQ(Instr(0x42882557).id(), InstrId::VCPOP_M); // vcpop.m a0, v8
+}
+
+TEST(Instr, classes) {
+    ASSERT_EQ(instrClass(InstrId::ADDI), InstrClass::OP_IMM);
+    ASSERT_EQ(instrClass(InstrId::LD), InstrClass::LOAD);
+    ASSERT_EQ(instrClass(InstrId::BEQ), InstrClass::BRANCH);
+    ASSERT_EQ(instrClass(InstrId::VADD_VV), InstrClass::OP_V);
+    ASSERT_EQ(instrClass(InstrId::SIM_HOST_CALL), InstrClass::SIM);
+    ASSERT_STREQ(instrClassName(InstrClass::OP_IMM_32), "op_imm_32");
+}
+
 TEST(Instr, garbage) {
     // Decoder must not crash on any input
     for (uint64_t code = 0, last = std::numeric_limits<InstrCode>::max();
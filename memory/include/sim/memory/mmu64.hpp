@@ -1,11 +1,14 @@
 #ifndef INCL_MEMORY_MMU64_HPP
 #define INCL_MEMORY_MMU64_HPP
 
+#include <array>
+
 #include <sim/csr/idx.gen.hpp>
 #include <sim/csr/value.gen.hpp>
 
 #include <sim/memory/phys_memory.hpp>
 #include <sim/memory/pte.hpp>
+#include <sim/stats.hpp>
 
 namespace sim::memory {
 
@@ -19,11 +22,20 @@ struct MMU64 final {
         PhysAddr phys_addr = 0;
     };
 
+    // Page table levels in SV57 mode
+    static constexpr size_t MAX_WALK_DEPTH = 5;
+
   private:
     PhysMemory &m_phys_memory;
     const csr::MSTATUS64 &m_mstatus64;
     const csr::SATP64 &m_satp64;
 
+    // Translations by number of PTEs read
+    std::array<stats::Counter, MAX_WALK_DEPTH + 1> m_walks{};
+
+    NODISCARD Result walk(PrivLevel priv_level, AccessType access_type,
+                          VirtAddr va, size_t &depth) noexcept;
+
   public:
     MMU64(PhysMemory &phys_memory, const csr::MSTATUS64 &mstatus64,
           const csr::SATP64 &satp64)
@@ -32,7 +44,27 @@ struct MMU64 final {
 
     // Translate VirtAddr -> PhysAddr in 64-bit mode
     NODISCARD Result translate(PrivLevel priv_level, AccessType access_type,
-                               VirtAddr va) noexcept;
+                               VirtAddr va) noexcept {
+        size_t depth = 0;
+        auto res = walk(priv_level, access_type, va, depth);
+
+        m_walks[depth].inc();
+        return res;
+    }
+
+    // Translate without counting walk, e.g. for tracing of already done
+    // access
+    NODISCARD Result query(PrivLevel priv_level, AccessType access_type,
+                           VirtAddr va) noexcept {
+        size_t depth = 0;
+        return walk(priv_level, access_type, va, depth);
+    }
+
+    // Translations with given page table walk depth. Bare mode translations
+    // have zero depth
+    NODISCARD uint64_t walks(size_t depth) const noexcept {
+        return m_walks[depth].value();
+    }
 };
 
 } // namespace sim::memory
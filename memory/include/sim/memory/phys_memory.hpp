@@ -1,6 +1,9 @@
 #ifndef INCL_MEMORY_PHYS_MEMORY_HPP
 #define INCL_MEMORY_PHYS_MEMORY_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -61,8 +64,14 @@ class MMap final {
 // Host pages allocator
 class PageAllocator final {
     std::vector<MMap> m_mmaps{};
+    size_t m_curr_mmap = 0;
     PPN m_curr_ppn = 0;
 
+    // Pages allocated since last reset
+    size_t m_alloc_number = 0;
+    // Pages that were handed out before last reset
+    size_t m_used_number = 0;
+
   public:
     PageAllocator(PPN ppn) {
         SIM_ASSERT(ppn != 0);
@@ -72,15 +81,30 @@ class PageAllocator final {
     uint8_t *allocPage() {
         static constexpr size_t ALLOC_FACTOR = 2;
 
-        PPN end_ppn = m_mmaps.back().ppn();
-
-        if (m_curr_ppn == end_ppn) {
-            PPN new_ppn = end_ppn * ALLOC_FACTOR;
-            m_mmaps.emplace_back(MMap{new_ppn});
+        if (m_curr_ppn == m_mmaps[m_curr_mmap].ppn()) {
+            if (++m_curr_mmap == m_mmaps.size()) {
+                PPN new_ppn = m_mmaps.back().ppn() * ALLOC_FACTOR;
+                m_mmaps.emplace_back(MMap{new_ppn});
+            }
             m_curr_ppn = 0;
         }
 
-        return m_mmaps.back().ptr() + m_curr_ppn++ * PAGE_SIZE;
+        auto *page = m_mmaps[m_curr_mmap].ptr() + m_curr_ppn++ * PAGE_SIZE;
+
+        // Reused page holds data from previous allocation
+        if (m_alloc_number++ < m_used_number) {
+            std::memset(page, 0, PAGE_SIZE);
+        }
+
+        return page;
+    }
+
+    // Release all pages. Host memory is kept for next allocations
+    void reset() noexcept {
+        m_used_number = std::max(m_used_number, m_alloc_number);
+        m_alloc_number = 0;
+        m_curr_mmap = 0;
+        m_curr_ppn = 0;
     }
 };
 
@@ -88,16 +112,55 @@ class PageAllocator final {
 class RAM final {
     static constexpr PPN PPN_16MB = PPN{1} << 12;
 
+    struct Page final {
+        HostPtr host_ptr = nullptr;
+        // Page was modified since last dirty pages collection
+        bool dirty = false;
+        // Content hash of page used for code. 0 if not computed yet
+        std::atomic<uint64_t> code_hash = 0;
+    };
+
+    NODISCARD static uint64_t hashPage(ConstHostPtr host_page_ptr) noexcept {
+        static constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325;
+        static constexpr uint64_t FNV_PRIME = 0x100000001b3;
+
+        uint64_t hash = FNV_OFFSET;
+        for (size_t offset = 0; offset != PAGE_SIZE; offset += sizeof(hash)) {
+            uint64_t word = 0;
+            std::memcpy(&word, host_page_ptr + offset, sizeof(word));
+            hash = (hash ^ word) * FNV_PRIME;
+        }
+
+        // 0 is reserved for unknown hash
+        return hash == 0 ? 1 : hash;
+    }
+
     PageAllocator m_page_allocator{PPN_16MB};
-    std::unordered_map<PhysAddr, HostPtr> m_mapping{};
+    std::unordered_map<PhysAddr, Page> m_mapping{};
+
+    // Dirty pages tracking. Not thread-safe, so disabled by default
+    bool m_dirty_tracking = false;
+    std::vector<PhysAddr> m_dirty_pages{};
+
+    void markDirty(PhysAddr page_pa, Page &page) {
+        if (m_dirty_tracking && !page.dirty) {
+            page.dirty = true;
+            m_dirty_pages.push_back(page_pa);
+        }
+    }
 
   public:
     // Add RAM page to mapping
     NODISCARD bool addPage(PhysAddr page_pa) {
         SIM_ASSERT(!(page_pa & PAGE_OFFSET_MASK));
 
-        return m_mapping.try_emplace(page_pa, m_page_allocator.allocPage())
-            .second;
+        auto [it, inserted] =
+            m_mapping.try_emplace(page_pa, m_page_allocator.allocPage());
+        if (inserted) {
+            markDirty(page_pa, it->second);
+        }
+
+        return inserted;
     }
 
     // Get address of host page, mapped with given RAM page
@@ -110,11 +173,12 @@ class RAM final {
             return nullptr;
         }
 
-        return it->second;
+        return it->second.host_ptr;
     }
 
-    // Get address of host page, mapped with given RAM page
-    NODISCARD HostPtr getHostPagePtr(PhysAddr page_pa) noexcept {
+    // Get address of host page, mapped with given RAM page.
+    // Page is considered dirty after this call
+    NODISCARD HostPtr getHostPagePtr(PhysAddr page_pa) {
         SIM_ASSERT(!(page_pa & PAGE_OFFSET_MASK));
 
         auto it = m_mapping.find(page_pa);
@@ -122,7 +186,64 @@ class RAM final {
             return nullptr;
         }
 
-        return it->second;
+        markDirty(page_pa, it->second);
+        it->second.code_hash.store(0, std::memory_order_relaxed);
+
+        return it->second.host_ptr;
+    }
+
+    // Get page content hash. Hash is computed on first request and kept
+    // until page is written through PhysMemory or code hashes are
+    // invalidated. Returns 0 for unmapped page
+    NODISCARD uint64_t getCodePageHash(PhysAddr page_pa) {
+        SIM_ASSERT(!(page_pa & PAGE_OFFSET_MASK));
+
+        auto it = m_mapping.find(page_pa);
+        if (it == m_mapping.end()) {
+            return 0;
+        }
+
+        auto &page = it->second;
+        auto hash = page.code_hash.load(std::memory_order_relaxed);
+        if (hash == 0) {
+            hash = hashPage(page.host_ptr);
+            page.code_hash.store(hash, std::memory_order_relaxed);
+        }
+
+        return hash;
+    }
+
+    // Drop all computed page hashes
+    void invalidateCodeHashes() noexcept {
+        for (auto &&[page_pa, page] : m_mapping) {
+            page.code_hash.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void setDirtyTracking(bool enable) { m_dirty_tracking = enable; }
+
+    // Move dirty pages list to dst and clear dirty flags
+    void takeDirtyPages(std::vector<PhysAddr> &dst) {
+        for (auto page_pa : m_dirty_pages) {
+            m_mapping[page_pa].dirty = false;
+        }
+
+        dst.swap(m_dirty_pages);
+        m_dirty_pages.clear();
+    }
+
+    // Call func(page_pa, const_host_page_ptr) for each RAM page
+    template <class Func> void forEachPage(Func func) const {
+        for (auto &&[page_pa, page] : m_mapping) {
+            func(page_pa, ConstHostPtr{page.host_ptr});
+        }
+    }
+
+    // Remove all RAM pages
+    void reset() noexcept {
+        m_mapping.clear();
+        m_dirty_pages.clear();
+        m_page_allocator.reset();
     }
 };
 
@@ -139,6 +260,46 @@ class PhysMemory final {
         return m_ram.addPage(page_pa);
     }
 
+    // Remove all memory pages. Allocated host memory is reused
+    void reset() noexcept { m_ram.reset(); }
+
+    // Get address of host page, mapped with given page. Returns nullptr for
+    // unmapped page
+    NODISCARD HostPtr getHostPagePtr(PhysAddr page_pa) {
+        return m_ram.getHostPagePtr(page_pa);
+    }
+
+    // Get address of host page, mapped with given page. Returns nullptr for
+    // unmapped page
+    NODISCARD ConstHostPtr getConstHostPagePtr(PhysAddr page_pa) const {
+        return m_ram.getConstHostPagePtr(page_pa);
+    }
+
+    // Track pages modified through PhysMemory or through host pointers it
+    // forwarded. Host pointers forwarded before tracking start are not
+    // tracked. Single-threaded use only
+    void setDirtyTracking(bool enable) { m_ram.setDirtyTracking(enable); }
+
+    // Get pages dirtied since previous call
+    void takeDirtyPages(std::vector<PhysAddr> &dst) {
+        m_ram.takeDirtyPages(dst);
+    }
+
+    // Call func(page_pa, const_host_page_ptr) for each memory page
+    template <class Func> void forEachPage(Func func) const {
+        m_ram.forEachPage(func);
+    }
+
+    // Get page content hash for decoded code sharing. Writes through host
+    // pointers forwarded earlier are seen only after invalidateCodeHashes.
+    // Returns 0 for unmapped page
+    NODISCARD uint64_t getCodePageHash(PhysAddr page_pa) {
+        return m_ram.getCodePageHash(page_pa);
+    }
+
+    // Drop computed page hashes. Called on instruction fetch fences
+    void invalidateCodeHashes() noexcept { m_ram.invalidateCodeHashes(); }
+
     // Physical memory read access result
     struct ReadResult final {
         SimStatus status = SimStatus::PHYS_MEM__ACCESS_FAULT;
@@ -61,7 +61,14 @@ struct SimpleMemoryMapper final {
     }
 
     // Add PTEs for given mapping
-    NODISCARD SimStatus map(MemoryMapping mapping) noexcept;
+    NODISCARD SimStatus map(MemoryMapping mapping) noexcept {
+        return map(m_phys_memory, mapping);
+    }
+
+    // Add PTEs for given mapping to tables in other memory. Memory must hold
+    // copy of this mapper tables
+    NODISCARD SimStatus map(PhysMemory &phys_memory,
+                            MemoryMapping mapping) noexcept;
 };
 
 } // namespace sim::memory
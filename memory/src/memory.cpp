@@ -91,9 +91,9 @@ NODISCARD PhysAddr calcPhysAddr(PTE pte, VirtAddr va, size_t i) noexcept {
 
 } // namespace
 
-NODISCARD MMU64::Result MMU64::translate(PrivLevel priv_level,
-                                         AccessType access_type,
-                                         VirtAddr va) noexcept {
+NODISCARD MMU64::Result MMU64::walk(PrivLevel priv_level,
+                                    AccessType access_type, VirtAddr va,
+                                    size_t &depth) noexcept {
     static constexpr MMU64::Result PAGE_FAULT_RES = {
         SimStatus::MMU64__PAGE_FAULT, 0};
 
@@ -113,6 +113,7 @@ NODISCARD MMU64::Result MMU64::translate(PrivLevel priv_level,
         // Read next PTE
         PhysAddr pte_pa = table_ppn * PAGE_SIZE + getVPN(va, i) * sizeof(PTE);
 
+        ++depth;
         if (auto s = m_phys_memory.read(pte_pa, pte).status;
             s != SimStatus::OK) {
             return {s, 0};
@@ -162,7 +163,8 @@ NODISCARD MMU64::Result MMU64::translate(PrivLevel priv_level,
     return {SimStatus::OK, calcPhysAddr(pte, va, i)};
 }
 
-NODISCARD SimStatus SimpleMemoryMapper::map(MemoryMapping mapping) noexcept {
+NODISCARD SimStatus SimpleMemoryMapper::map(PhysMemory &phys_memory,
+                                            MemoryMapping mapping) noexcept {
     // Mappings for table region pages are forbidden
     if (mapping.ppn() >= m_table_region_begin &&
         mapping.ppn() < m_table_region_end) {
@@ -179,7 +181,7 @@ NODISCARD SimStatus SimpleMemoryMapper::map(MemoryMapping mapping) noexcept {
         PhysAddr pte_pa = table_ppn * PAGE_SIZE + getVPN(va, i) * sizeof(PTE);
 
         PTE pte = 0;
-        if (auto s = m_phys_memory.read(pte_pa, pte).status;
+        if (auto s = phys_memory.read(pte_pa, pte).status;
             s != SimStatus::OK) {
             return s;
         }
@@ -200,7 +202,7 @@ NODISCARD SimStatus SimpleMemoryMapper::map(MemoryMapping mapping) noexcept {
             }
 
             // Write PTE
-            if (auto s = m_phys_memory.write(pte_pa, pte).status;
+            if (auto s = phys_memory.write(pte_pa, pte).status;
                 s != SimStatus::OK) {
                 return s;
             }
@@ -196,4 +196,63 @@ TEST_F(PhysMemoryTest, hostPtrCoherency) {
     }
 }
 
+// Test that reset removes mappings and reused pages are zeroed
+TEST_F(PhysMemoryTest, reset) {
+    PhysAddr pa = RAM_BASE_PA + PAGE_SIZE;
+
+    uint64_t value = mt();
+    ASSERT_EQ(pm.write(pa, value).status, SimStatus::OK);
+
+    pm.reset();
+
+    uint64_t dst = 0;
+    ASSERT_EQ(pm.read(pa, dst).status, SimStatus::PHYS_MEM__ACCESS_FAULT);
+
+    // Map all pages again. Old data must not leak through reused host pages
+    for (PhysAddr page_pa = RAM_BASE_PA, end = RAM_BASE_PA + RAM_SIZE_16MB;
+         page_pa != end; page_pa += PAGE_SIZE) {
+        ASSERT_TRUE(pm.addRAMPage(page_pa));
+
+        ASSERT_EQ(pm.read(page_pa + PAGE_SIZE - sizeof(dst), dst).status,
+                  SimStatus::OK);
+        ASSERT_EQ(dst, 0);
+    }
+
+    ASSERT_EQ(pm.read(pa, dst).status, SimStatus::OK);
+    ASSERT_EQ(dst, 0);
+}
+
+// Test that pages written through PhysMemory and forwarded host pointers are
+// reported dirty once
+TEST_F(PhysMemoryTest, dirtyTracking) {
+    PhysAddr pa = RAM_BASE_PA + PAGE_SIZE;
+    std::vector<PhysAddr> dirty_pages{};
+
+    // Tracking is disabled by default
+    ASSERT_EQ(pm.write(pa, uint8_t{1}).status, SimStatus::OK);
+    pm.takeDirtyPages(dirty_pages);
+    ASSERT_TRUE(dirty_pages.empty());
+
+    pm.setDirtyTracking(true);
+
+    ASSERT_EQ(pm.write(pa, uint8_t{1}).status, SimStatus::OK);
+    ASSERT_EQ(pm.write(pa + 1, uint8_t{2}).status, SimStatus::OK);
+    ASSERT_NE(pm.getHostPagePtr(RAM_BASE_PA), nullptr);
+
+    uint8_t byte = 0;
+    ASSERT_EQ(pm.read(RAM_BASE_PA + 2 * PAGE_SIZE, byte).status, SimStatus::OK);
+
+    pm.takeDirtyPages(dirty_pages);
+    std::sort(dirty_pages.begin(), dirty_pages.end());
+    ASSERT_EQ(dirty_pages, (std::vector<PhysAddr>{RAM_BASE_PA, pa}));
+
+    // Dirty flags are cleared by collection
+    pm.takeDirtyPages(dirty_pages);
+    ASSERT_TRUE(dirty_pages.empty());
+
+    ASSERT_EQ(pm.write(pa, uint8_t{1}).status, SimStatus::OK);
+    pm.takeDirtyPages(dirty_pages);
+    ASSERT_EQ(dirty_pages, std::vector<PhysAddr>{pa});
+}
+
 } // namespace sim::memory
@@ -0,0 +1,69 @@
+#include <deque>
+#include <iostream>
+#include <string_view>
+
+#include <sim/plugin.hpp>
+
+namespace {
+
+// Count executed instrs per block entry. With "mem" arg loads and stores
+// are counted too. Instrs of block are counted on its entry, so instrs
+// after the last executed one are counted if simulation stops in the middle
+// of block
+class InsnCount final : public sim::plugin::Plugin {
+    struct Block final {
+        InsnCount *plugin = nullptr;
+        uint64_t instr_number = 0;
+    };
+
+    // Blocks are passed to callbacks by address
+    std::deque<Block> m_blocks{};
+
+    bool m_count_mem = false;
+
+    uint64_t m_instrs = 0;
+    uint64_t m_loads = 0;
+    uint64_t m_stores = 0;
+
+    static void onBlockExec(const sim::hart::Hart &, void *data) {
+        auto *block = static_cast<Block *>(data);
+        block->plugin->m_instrs += block->instr_number;
+    }
+
+    static void onMemAccess(const sim::hart::Hart &,
+                            const sim::plugin::MemAccess &access, void *data) {
+        auto *plugin = static_cast<InsnCount *>(data);
+        ++(access.is_store ? plugin->m_stores : plugin->m_loads);
+    }
+
+  public:
+    explicit InsnCount(const char *args)
+        : m_count_mem(std::string_view{args} == "mem") {}
+
+    void onBlockTranslate(sim::plugin::BlockBuilder &block) override {
+        auto &counted = m_blocks.emplace_back(this, block.instrNumber());
+        block.onExec(onBlockExec, &counted);
+
+        if (!m_count_mem) {
+            return;
+        }
+
+        for (size_t i = 0; i != block.instrNumber(); ++i) {
+            block.onMemAccess(i, onMemAccess, this);
+        }
+    }
+
+    void onExit(const sim::hart::Hart &, uint64_t icount) override {
+        std::cout << "insn_count: instrs = " << m_instrs
+                  << ", icount = " << icount;
+        if (m_count_mem) {
+            std::cout << ", loads = " << m_loads
+                      << ", stores = " << m_stores;
+        }
+        std::cout << std::endl;
+    }
+};
+
+} // namespace
+
+SIM_PLUGIN(InsnCount)
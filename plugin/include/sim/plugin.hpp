@@ -0,0 +1,96 @@
+#ifndef INCL_SIM_PLUGIN_HPP
+#define INCL_SIM_PLUGIN_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sim/common.hpp>
+#include <sim/hart.hpp>
+#include <sim/instr.hpp>
+
+namespace sim::plugin {
+
+// Plugin API version. Shared objects built for other version are rejected
+inline constexpr uint32_t API_VERSION = 1;
+
+// Execution callback. Called before instrs of block or single instr
+using ExecCallback = void (*)(const hart::Hart &hart, void *data);
+
+// Scalar memory access of instr
+struct MemAccess final {
+    VirtAddr va = 0;
+    // Access size in bytes
+    uint8_t size = 0;
+    bool is_store = false;
+};
+
+// Memory access callback. Called before the access, so accesses which fault
+// are reported too
+using MemCallback = void (*)(const hart::Hart &hart, const MemAccess &access,
+                             void *data);
+
+// Block being translated. Hooks registered with builder are injected into
+// this block only. Block instrs are the instrs executed from block entry
+// when execution does not stop early
+class BlockBuilder {
+  protected:
+    ~BlockBuilder() = default;
+
+  public:
+    NODISCARD virtual VirtAddr virtAddr() const noexcept = 0;
+
+    NODISCARD virtual size_t instrNumber() const noexcept = 0;
+    NODISCARD virtual const instr::Instr &instr(size_t idx) const noexcept = 0;
+    NODISCARD virtual VirtAddr instrVirtAddr(size_t idx) const noexcept = 0;
+
+    // Call callback on each block entry
+    virtual void onExec(ExecCallback callback, void *data) = 0;
+
+    // Call callback before instr with given index
+    virtual void onInstrExec(size_t idx, ExecCallback callback,
+                             void *data) = 0;
+
+    // Call callback before memory access of instr with given index. Returns
+    // false for instrs without scalar memory access
+    virtual bool onMemAccess(size_t idx, MemCallback callback, void *data) = 0;
+};
+
+// Instrumentation plugin
+class Plugin {
+  public:
+    Plugin() = default;
+
+    Plugin(const Plugin &) = delete;
+    Plugin &operator=(const Plugin &) = delete;
+
+    virtual ~Plugin() = default;
+
+    // Inspect translated block and register its hooks
+    virtual void onBlockTranslate([[maybe_unused]] BlockBuilder &block) {}
+
+    // Simulation finished with given icount
+    virtual void onExit([[maybe_unused]] const hart::Hart &hart,
+                        [[maybe_unused]] uint64_t icount) {}
+};
+
+// Entry points of plugin shared object
+inline constexpr const char *API_VERSION_SYMBOL = "sim_plugin_api_version";
+inline constexpr const char *CREATE_SYMBOL = "sim_plugin_create";
+
+using ApiVersionFunc = uint32_t (*)();
+using CreateFunc = Plugin *(*)(const char *args);
+
+} // namespace sim::plugin
+
+// Define entry points of plugin shared object. Plugin is constructed from
+// args string given after plugin path
+#define SIM_PLUGIN(PLUGIN_CLASS)                                               \
+    extern "C" uint32_t sim_plugin_api_version() {                             \
+        return sim::plugin::API_VERSION;                                       \
+    }                                                                          \
+                                                                               \
+    extern "C" sim::plugin::Plugin *sim_plugin_create(const char *args) {      \
+        return new PLUGIN_CLASS{args};                                         \
+    }
+
+#endif // INCL_SIM_PLUGIN_HPP
@@ -0,0 +1,107 @@
+#ifndef INCL_SIM_PLUGIN_MANAGER_HPP
+#define INCL_SIM_PLUGIN_MANAGER_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/hart.hpp>
+#include <sim/instr.hpp>
+#include <sim/plugin.hpp>
+
+namespace sim::plugin {
+
+// Loaded plugins and blocks instrumented by them. Instrumented block is a
+// copy of decoded instrs interleaved with hook call pseudo instrs. Entry of
+// decoded block is replaced with jump to the copy, so blocks without hooks
+// are executed as is. One manager serves one simulator
+class Manager final {
+    struct Hook final {
+        ExecCallback exec = nullptr;
+        MemCallback mem = nullptr;
+        void *data = nullptr;
+
+        // Memory access of mem hook. va is base register value plus offset
+        MemAccess access{};
+        uint8_t base_reg = 0;
+        int32_t offset = 0;
+    };
+
+    struct Block final {
+        VirtAddr virt_addr = 0;
+        // Decoded instrs up to terminator
+        std::vector<instr::Instr> source{};
+        // Instrumented copy. Empty if block has no hooks
+        std::vector<instr::Instr> instrs{};
+    };
+
+    class Builder;
+
+    std::vector<void *> m_handles{};
+    std::vector<std::unique_ptr<Plugin>> m_plugins{};
+    std::string m_load_error{};
+
+    std::vector<Hook> m_hooks{};
+
+    // Blocks are translated once. Decoded instrs at the same va differ for
+    // bb and superblock, so blocks are found by va and source instrs
+    std::vector<Block> m_blocks{};
+    std::unordered_multimap<VirtAddr, uint32_t> m_block_idxs{};
+
+    uint32_t translate(VirtAddr virt_addr,
+                       std::vector<instr::Instr> &&source);
+
+  public:
+    Manager() = default;
+
+    Manager(const Manager &) = delete;
+    Manager &operator=(const Manager &) = delete;
+
+    ~Manager();
+
+    // Load plugin shared object and create plugin with given args
+    SimStatus load(const std::string &path, const std::string &args);
+
+    // Reason of the last load failure
+    NODISCARD const auto &loadError() const noexcept { return m_load_error; }
+
+    // Add plugin. Blocks translated before are not instrumented by it
+    void add(std::unique_ptr<Plugin> plugin);
+
+    NODISCARD bool empty() const noexcept { return m_plugins.empty(); }
+
+    // Instrument decoded instrs of block starting at virt_addr. Returns
+    // entry instr jumping to instrumented copy if block has hooks
+    NODISCARD std::optional<instr::Instr>
+    instrument(VirtAddr virt_addr, const instr::Instr *instrs);
+
+    // Instrumented copy of block with given index
+    NODISCARD const instr::Instr *blockInstrs(uint32_t idx) const noexcept {
+        return m_blocks[idx].instrs.data();
+    }
+
+    // Call hook with given index
+    void call(uint32_t idx, const hart::Hart &hart) const {
+        const auto &hook = m_hooks[idx];
+
+        if (hook.exec != nullptr) {
+            hook.exec(hart, hook.data);
+            return;
+        }
+
+        auto access = hook.access;
+        access.va =
+            hart.gprFile().read<VirtAddr>(hook.base_reg) + hook.offset;
+        hook.mem(hart, access, hook.data);
+    }
+
+    // Notify plugins of simulation end
+    void exit(const hart::Hart &hart, uint64_t icount);
+};
+
+} // namespace sim::plugin
+
+#endif // INCL_SIM_PLUGIN_MANAGER_HPP
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <string_view>
+
+#include <dlfcn.h>
+
+#include <sim/bb.hpp>
+#include <sim/plugin/manager.hpp>
+
+namespace sim::plugin {
+
+namespace {
+
+// Scalar memory access of instr. Returns false for other instrs
+bool memAccessOf(instr::InstrId id, MemAccess &access, bool &has_offset) {
+    using instr::InstrId;
+
+    has_offset = true;
+
+    switch (id) {
+    case InstrId::LB:
+    case InstrId::LBU:
+        access = {0, 1, false};
+        return true;
+    case InstrId::LH:
+    case InstrId::LHU:
+        access = {0, 2, false};
+        return true;
+    case InstrId::LW:
+    case InstrId::LWU:
+    case InstrId::FLW:
+        access = {0, 4, false};
+        return true;
+    case InstrId::LD:
+    case InstrId::FLD:
+        access = {0, 8, false};
+        return true;
+    case InstrId::SB:
+        access = {0, 1, true};
+        return true;
+    case InstrId::SH:
+        access = {0, 2, true};
+        return true;
+    case InstrId::SW:
+    case InstrId::FSW:
+        access = {0, 4, true};
+        return true;
+    case InstrId::SD:
+    case InstrId::FSD:
+        access = {0, 8, true};
+        return true;
+    default:
+        break;
+    }
+
+    // Atomics address memory with rs1 only
+    has_offset = false;
+
+    switch (id) {
+    case InstrId::LR_W:
+        access = {0, 4, false};
+        return true;
+    case InstrId::LR_D:
+        access = {0, 8, false};
+        return true;
+    default:
+        break;
+    }
+
+    if (instr::instrClass(id) != instr::InstrClass::AMO) {
+        return false;
+    }
+
+    auto name = std::string_view{instr::instrName(id)};
+    access = {0, static_cast<uint8_t>(name.ends_with("_D") ? 8 : 4), true};
+    return true;
+}
+
+} // namespace
+
+class Manager::Builder final : public BlockBuilder {
+    Manager &m_manager;
+    VirtAddr m_virt_addr = 0;
+
+    const std::vector<instr::Instr> &m_instrs;
+    std::vector<VirtAddr> m_instr_vas{};
+
+    // Hook indices by instr index. Block hooks go before instr hooks
+    std::vector<uint32_t> m_entry_hooks{};
+    std::vector<std::vector<uint32_t>> m_instr_hooks{};
+
+    uint32_t addHook(const Hook &hook) {
+        m_manager.m_hooks.push_back(hook);
+        return static_cast<uint32_t>(m_manager.m_hooks.size() - 1);
+    }
+
+  public:
+    Builder(Manager &manager, VirtAddr virt_addr,
+            const std::vector<instr::Instr> &instrs)
+        : m_manager(manager), m_virt_addr(virt_addr), m_instrs(instrs),
+          m_instr_hooks(instrs.size()) {
+        // Superblocks continue through JAL to its target
+        auto pc = virt_addr;
+        for (const auto &instr : instrs) {
+            m_instr_vas.push_back(pc);
+            pc += instr.id() == instr::InstrId::JAL
+                      ? static_cast<int32_t>(instr.imm())
+                      : instr.size();
+        }
+    }
+
+    VirtAddr virtAddr() const noexcept override { return m_virt_addr; }
+
+    size_t instrNumber() const noexcept override { return m_instrs.size(); }
+
+    const instr::Instr &instr(size_t idx) const noexcept override {
+        return m_instrs[idx];
+    }
+
+    VirtAddr instrVirtAddr(size_t idx) const noexcept override {
+        return m_instr_vas[idx];
+    }
+
+    void onExec(ExecCallback callback, void *data) override {
+        m_entry_hooks.push_back(addHook({callback, nullptr, data}));
+    }
+
+    void onInstrExec(size_t idx, ExecCallback callback, void *data) override {
+        SIM_ASSERT(idx < m_instrs.size());
+        m_instr_hooks[idx].push_back(addHook({callback, nullptr, data}));
+    }
+
+    bool onMemAccess(size_t idx, MemCallback callback, void *data) override {
+        SIM_ASSERT(idx < m_instrs.size());
+        const auto &instr = m_instrs[idx];
+
+        Hook hook{nullptr, callback, data};
+        bool has_offset = false;
+        if (!memAccessOf(instr.id(), hook.access, has_offset)) {
+            return false;
+        }
+
+        hook.base_reg = instr.rs1();
+        hook.offset = has_offset ? static_cast<int32_t>(instr.imm()) : 0;
+
+        m_instr_hooks[idx].push_back(addHook(hook));
+        return true;
+    }
+
+    NODISCARD bool hasHooks() const noexcept {
+        if (!m_entry_hooks.empty()) {
+            return true;
+        }
+
+        for (const auto &hooks : m_instr_hooks) {
+            if (!hooks.empty()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Interleave source instrs with hook calls
+    NODISCARD std::vector<instr::Instr>
+    build(const std::vector<instr::Instr> &source) const {
+        std::vector<instr::Instr> out{};
+
+        for (auto hook_idx : m_entry_hooks) {
+            out.push_back(instr::Instr::pluginCallInstr(hook_idx));
+        }
+
+        for (size_t i = 0; i != m_instrs.size(); ++i) {
+            for (auto hook_idx : m_instr_hooks[i]) {
+                out.push_back(instr::Instr::pluginCallInstr(hook_idx));
+            }
+            out.push_back(m_instrs[i]);
+        }
+
+        out.push_back(source.back());
+        return out;
+    }
+};
+
+Manager::~Manager() {
+    // Plugin code is unloaded after plugins are destroyed
+    m_plugins.clear();
+
+    for (auto *handle : m_handles) {
+        dlclose(handle);
+    }
+}
+
+SimStatus Manager::load(const std::string &path, const std::string &args) {
+    auto *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        m_load_error = dlerror();
+        return SimStatus::PLUGIN__LOAD_ERROR;
+    }
+
+    auto api_version = reinterpret_cast<ApiVersionFunc>(
+        dlsym(handle, API_VERSION_SYMBOL));
+    auto create =
+        reinterpret_cast<CreateFunc>(dlsym(handle, CREATE_SYMBOL));
+
+    if (api_version == nullptr || create == nullptr) {
+        m_load_error = "no plugin entry points";
+        dlclose(handle);
+        return SimStatus::PLUGIN__LOAD_ERROR;
+    }
+
+    if (api_version() != API_VERSION) {
+        m_load_error = "plugin API version mismatch";
+        dlclose(handle);
+        return SimStatus::PLUGIN__VERSION_MISMATCH;
+    }
+
+    m_handles.push_back(handle);
+
+    auto *plugin = create(args.c_str());
+    if (plugin == nullptr) {
+        m_load_error = "plugin is not created";
+        return SimStatus::PLUGIN__LOAD_ERROR;
+    }
+
+    add(std::unique_ptr<Plugin>{plugin});
+    return SimStatus::OK;
+}
+
+void Manager::add(std::unique_ptr<Plugin> plugin) {
+    m_plugins.push_back(std::move(plugin));
+}
+
+std::optional<instr::Instr> Manager::instrument(VirtAddr virt_addr,
+                                                const instr::Instr *instrs) {
+    // Instrs after branch or host call are left from previously decoded
+    // bbs and are replaced with terminator
+    std::vector<instr::Instr> source{};
+    bb::forEachInstr(instrs, [&source](const instr::Instr &instr) {
+        source.push_back(instr);
+    });
+
+    const auto *end = instrs + source.size();
+    source.push_back(end->id() == instr::InstrId::SIM_STATUS_INSTR
+                         ? *end
+                         : instr::Instr::statusInstr(SimStatus::OK));
+
+    // Empty blocks and host calls run no guest instrs
+    if (source.size() == 1 ||
+        source.front().id() == instr::InstrId::SIM_HOST_CALL) {
+        return std::nullopt;
+    }
+
+    uint32_t block_idx = 0;
+    auto [begin, range_end] = m_block_idxs.equal_range(virt_addr);
+    auto found = std::find_if(begin, range_end, [&](const auto &entry) {
+        return m_blocks[entry.second].source == source;
+    });
+
+    if (found != range_end) {
+        block_idx = found->second;
+    } else {
+        block_idx = translate(virt_addr, std::move(source));
+    }
+
+    if (m_blocks[block_idx].instrs.empty()) {
+        return std::nullopt;
+    }
+
+    return instr::Instr::pluginBlockInstr(block_idx);
+}
+
+uint32_t Manager::translate(VirtAddr virt_addr,
+                            std::vector<instr::Instr> &&source) {
+    Block block{virt_addr, std::move(source)};
+
+    // Builder sees block instrs without terminator
+    std::vector<instr::Instr> instrs{block.source.begin(),
+                                     block.source.end() - 1};
+    Builder builder{*this, virt_addr, instrs};
+
+    for (auto &plugin : m_plugins) {
+        plugin->onBlockTranslate(builder);
+    }
+
+    if (builder.hasHooks()) {
+        block.instrs = builder.build(block.source);
+    }
+
+    auto block_idx = static_cast<uint32_t>(m_blocks.size());
+    m_blocks.push_back(std::move(block));
+    m_block_idxs.emplace(virt_addr, block_idx);
+
+    return block_idx;
+}
+
+void Manager::exit(const hart::Hart &hart, uint64_t icount) {
+    for (auto &plugin : m_plugins) {
+        plugin->onExit(hart, icount);
+    }
+}
+
+} // namespace sim::plugin
@@ -0,0 +1,115 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sim/plugin/manager.hpp>
+
+namespace sim::plugin {
+
+namespace {
+
+// Hook exec of the first instr and memory accesses of all instrs
+class TestPlugin final : public Plugin {
+  public:
+    std::vector<VirtAddr> translated{};
+
+    void onBlockTranslate(BlockBuilder &block) override {
+        translated.push_back(block.virtAddr());
+
+        block.onInstrExec(0, [](const hart::Hart &, void *) {}, nullptr);
+        for (size_t i = 0; i != block.instrNumber(); ++i) {
+            block.onMemAccess(
+                i, [](const hart::Hart &, const MemAccess &, void *) {},
+                nullptr);
+        }
+    }
+};
+
+std::vector<instr::Instr> decode(const std::vector<InstrCode> &code) {
+    std::vector<instr::Instr> instrs{};
+    for (auto instr_code : code) {
+        instrs.emplace_back(instr_code);
+    }
+    instrs.push_back(instr::Instr::statusInstr(SimStatus::OK));
+
+    return instrs;
+}
+
+} // namespace
+
+TEST(PluginTest, noPlugins) {
+    const auto INSTRS = decode({
+        0x00a0059b, // addiw a1,x0,10
+        0x0140051b, // addiw a0,x0,20
+    });
+
+    Manager manager{};
+    ASSERT_FALSE(manager.instrument(0x1000, INSTRS.data()).has_value());
+}
+
+TEST(PluginTest, instrument) {
+    const auto INSTRS = decode({
+        0x00a0059b, // addiw a1,x0,10
+        0xffd5b603, // ld a2,-3(a1)
+        0x00a5b2a3, // sd a0,5(a1)
+        0x00c58463, // beq a1,a2,8
+        // Left from previous bb
+        0x0140051b, // addiw a0,x0,20
+    });
+
+    Manager manager{};
+    auto plugin = std::make_unique<TestPlugin>();
+    auto &translated = plugin->translated;
+    manager.add(std::move(plugin));
+
+    auto entry = manager.instrument(0x1000, INSTRS.data());
+    ASSERT_TRUE(entry.has_value());
+    ASSERT_EQ(entry->id(), instr::InstrId::SIM_PLUGIN_BLOCK);
+
+    // Hook calls go before hooked instrs. Instrs after branch are dropped
+    using instr::InstrId;
+    const std::vector<InstrId> EXPECTED = {
+        InstrId::SIM_PLUGIN_CALL, InstrId::ADDIW, InstrId::SIM_PLUGIN_CALL,
+        InstrId::LD,              InstrId::SIM_PLUGIN_CALL,
+        InstrId::SD,              InstrId::BEQ,
+        InstrId::SIM_STATUS_INSTR};
+
+    const auto *block = manager.blockInstrs(entry->imm());
+    for (size_t i = 0; i != EXPECTED.size(); ++i) {
+        ASSERT_EQ(block[i].id(), EXPECTED[i]);
+    }
+    ASSERT_EQ(block[EXPECTED.size() - 1].status(), SimStatus::OK);
+
+    // Block is translated once
+    auto again = manager.instrument(0x1000, INSTRS.data());
+    ASSERT_TRUE(again.has_value());
+    ASSERT_EQ(again->imm(), entry->imm());
+    ASSERT_EQ(translated.size(), 1);
+
+    // Other instrs at the same va are other block
+    auto other = decode({0x00a0059b});
+    auto other_entry = manager.instrument(0x1000, other.data());
+    ASSERT_TRUE(other_entry.has_value());
+    ASSERT_NE(other_entry->imm(), entry->imm());
+    ASSERT_EQ(translated.size(), 2);
+}
+
+TEST(PluginTest, load) {
+    Manager manager{};
+
+    ASSERT_EQ(manager.load("no_such_plugin.so", ""),
+              SimStatus::PLUGIN__LOAD_ERROR);
+    ASSERT_FALSE(manager.loadError().empty());
+    ASSERT_TRUE(manager.empty());
+
+    ASSERT_EQ(manager.load(INSN_COUNT_PLUGIN_PATH, "mem"), SimStatus::OK);
+    ASSERT_FALSE(manager.empty());
+
+    const auto INSTRS = decode({
+        0x00a0059b, // addiw a1,x0,10
+        0xffd5b603, // ld a2,-3(a1)
+    });
+    ASSERT_TRUE(manager.instrument(0x1000, INSTRS.data()).has_value());
+}
+
+} // namespace sim::plugin
@@ -0,0 +1,125 @@
+#ifndef INCL_SIM_POOL_HPP
+#define INCL_SIM_POOL_HPP
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <sim/common.hpp>
+
+namespace sim::pool {
+
+// Work-stealing pool of worker threads.
+// Jobs are spread over per-worker deques. Worker takes jobs from the front of
+// its own deque and steals from the back of other deques when it runs out
+class WorkStealingPool final {
+    struct JobDeque final {
+        std::mutex mutex{};
+        std::deque<size_t> jobs{};
+    };
+
+    size_t m_worker_number = 0;
+
+    // Take job from own deque
+    static std::optional<size_t> pop(JobDeque &deque) {
+        std::lock_guard lock{deque.mutex};
+
+        if (deque.jobs.empty()) {
+            return std::nullopt;
+        }
+
+        auto job_idx = deque.jobs.front();
+        deque.jobs.pop_front();
+        return job_idx;
+    }
+
+    // Take job from other worker deque
+    static std::optional<size_t> steal(JobDeque &deque) {
+        std::lock_guard lock{deque.mutex};
+
+        if (deque.jobs.empty()) {
+            return std::nullopt;
+        }
+
+        auto job_idx = deque.jobs.back();
+        deque.jobs.pop_back();
+        return job_idx;
+    }
+
+  public:
+    explicit WorkStealingPool(size_t worker_number)
+        : m_worker_number(worker_number) {
+        SIM_ASSERT(worker_number != 0);
+    }
+
+    NODISCARD auto workerNumber() const noexcept { return m_worker_number; }
+
+    // Call job(worker_idx, job_idx) for each job_idx in [0, job_number).
+    // Jobs of one worker are executed sequentially, so worker_idx can be used
+    // to select per-worker state. Blocks until all jobs are done. If job
+    // throws, jobs not yet started are skipped and first exception is
+    // rethrown
+    template <class Job> void run(size_t job_number, Job &&job) {
+        std::vector<JobDeque> deques(m_worker_number);
+
+        for (size_t job_idx = 0; job_idx != job_number; ++job_idx) {
+            deques[job_idx % m_worker_number].jobs.push_back(job_idx);
+        }
+
+        std::atomic<bool> failed = false;
+        std::exception_ptr error = nullptr;
+        std::mutex error_mutex{};
+
+        auto work = [&](size_t worker_idx) {
+            while (!failed.load(std::memory_order_relaxed)) {
+                auto job_idx = pop(deques[worker_idx]);
+
+                for (size_t i = 1; !job_idx && i != m_worker_number; ++i) {
+                    job_idx = steal(deques[(worker_idx + i) % m_worker_number]);
+                }
+
+                // No jobs left
+                if (!job_idx) {
+                    return;
+                }
+
+                try {
+                    job(worker_idx, *job_idx);
+                } catch (...) {
+                    std::lock_guard lock{error_mutex};
+                    if (error == nullptr) {
+                        error = std::current_exception();
+                    }
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads{};
+        threads.reserve(m_worker_number - 1);
+
+        for (size_t worker_idx = 1; worker_idx != m_worker_number;
+             ++worker_idx) {
+            threads.emplace_back(work, worker_idx);
+        }
+
+        // Calling thread is worker 0
+        work(0);
+
+        for (auto &&thread : threads) {
+            thread.join();
+        }
+
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace sim::pool
+
+#endif // INCL_SIM_POOL_HPP
@@ -0,0 +1,103 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sim/pool.hpp>
+
+namespace sim::pool {
+
+TEST(PoolTest, allJobsOnce) {
+    static constexpr size_t JOB_NUMBER = 1000;
+
+    WorkStealingPool pool{4};
+    ASSERT_EQ(pool.workerNumber(), 4);
+
+    std::vector<std::atomic<size_t>> runs(JOB_NUMBER);
+    pool.run(JOB_NUMBER, [&](size_t worker_idx, size_t job_idx) {
+        ASSERT_LT(worker_idx, 4);
+        runs[job_idx].fetch_add(1, std::memory_order_relaxed);
+    });
+
+    for (auto &&run : runs) {
+        ASSERT_EQ(run.load(), 1);
+    }
+}
+
+TEST(PoolTest, zeroJobs) {
+    WorkStealingPool pool{3};
+
+    size_t calls = 0;
+    pool.run(0, [&](size_t, size_t) { ++calls; });
+    ASSERT_EQ(calls, 0);
+}
+
+TEST(PoolTest, singleWorker) {
+    WorkStealingPool pool{1};
+
+    // Jobs of single worker run in order on calling thread
+    std::vector<size_t> order{};
+    auto caller = std::this_thread::get_id();
+    pool.run(5, [&](size_t worker_idx, size_t job_idx) {
+        ASSERT_EQ(worker_idx, 0);
+        ASSERT_EQ(std::this_thread::get_id(), caller);
+        order.push_back(job_idx);
+    });
+
+    ASSERT_EQ(order, (std::vector<size_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(PoolTest, stealing) {
+    // Jobs 0, 2 are given to worker 0, jobs 1, 3 to worker 1. Job 1 waits
+    // for job 3, so job 3 can only be done by worker 0 stealing it
+    std::atomic<bool> job_3_done = false;
+    std::atomic<size_t> job_3_worker = ~size_t{0};
+
+    WorkStealingPool pool{2};
+    pool.run(4, [&](size_t worker_idx, size_t job_idx) {
+        if (job_idx == 3) {
+            job_3_worker = worker_idx;
+            job_3_done = true;
+        }
+
+        if (job_idx != 1) {
+            return;
+        }
+
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds{10};
+        while (!job_3_done && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    });
+
+    ASSERT_TRUE(job_3_done);
+    ASSERT_EQ(job_3_worker, 0);
+}
+
+TEST(PoolTest, exception) {
+    static constexpr size_t JOB_NUMBER = 100;
+
+    WorkStealingPool pool{4};
+
+    std::atomic<size_t> runs = 0;
+    auto job = [&](size_t, size_t job_idx) {
+        ++runs;
+        if (job_idx == 10) {
+            throw std::runtime_error{"job failed"};
+        }
+    };
+
+    ASSERT_THROW(pool.run(JOB_NUMBER, job), std::runtime_error);
+    ASSERT_LE(runs, JOB_NUMBER);
+
+    // Pool is reusable after failure
+    runs = 0;
+    pool.run(JOB_NUMBER, [&](size_t, size_t) { ++runs; });
+    ASSERT_EQ(runs, JOB_NUMBER);
+}
+
+} // namespace sim::pool
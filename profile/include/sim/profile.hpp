@@ -0,0 +1,347 @@
+#ifndef INCL_SIM_PROFILE_HPP
+#define INCL_SIM_PROFILE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include <sim/bb.hpp>
+#include <sim/common.hpp>
+#include <sim/instr.hpp>
+
+namespace sim::elf {
+class SymbolIndex;
+} // namespace sim::elf
+
+namespace sim::stats {
+class Registry;
+} // namespace sim::stats
+
+namespace sim::profile {
+
+// Bb execution counters
+struct BbCounters final {
+    VirtAddr virt_addr = bb::Bb::INVALID_VA;
+    // Bb entries number
+    uint64_t entries = 0;
+    // Instrs executed from bb entry to next bb entry
+    uint64_t icount = 0;
+};
+
+// Hot bbs profiler. Counters are kept in direct-mapped table indexed like
+// bb cache. Counters of conflicting bbs are moved to a map, so only
+// conflicts leave the fast path
+class BbProfiler final {
+    static constexpr bit::BitSize TABLE_SIZE_LOG_2 = 12;
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_SIZE_LOG_2;
+    static constexpr bit::BitSize PC_ALIGN_BITS = 1;
+
+    std::unique_ptr<BbCounters[]> m_table{new BbCounters[TABLE_SIZE]};
+    std::unordered_map<VirtAddr, BbCounters> m_evicted{};
+
+    // Counters of currently executed bb
+    BbCounters m_idle{};
+    BbCounters *m_curr = &m_idle;
+    uint64_t m_curr_start_icount = 0;
+
+    void evict(BbCounters &counters);
+
+  public:
+    BbProfiler() = default;
+
+    BbProfiler(const BbProfiler &) = delete;
+    BbProfiler &operator=(const BbProfiler &) = delete;
+
+    // Count bb entry. icount is simulator icount at bb entry
+    void enter(VirtAddr virt_addr, uint64_t icount) {
+        m_curr->icount += icount - m_curr_start_icount;
+        m_curr_start_icount = icount;
+
+        auto &counters = m_table[bit::getBitField(
+            PC_ALIGN_BITS + TABLE_SIZE_LOG_2 - 1, PC_ALIGN_BITS, virt_addr)];
+
+        if (counters.virt_addr != virt_addr) {
+            evict(counters);
+            counters = {virt_addr};
+        }
+
+        ++counters.entries;
+        m_curr = &counters;
+    }
+
+    // Stop counting current bb. icount is simulator icount at exit
+    void exit(uint64_t icount) noexcept {
+        m_curr->icount += icount - m_curr_start_icount;
+        m_curr_start_icount = icount;
+        m_curr = &m_idle;
+    }
+
+    // Counters of all executed bbs in no particular order
+    NODISCARD std::vector<BbCounters> counters() const;
+};
+
+// SimPoint basic block vectors recorder. Instrs executed in each bb are
+// accumulated per interval and written in SimPoint .bb format when the
+// interval ends. Intervals end on bb boundaries, so they may be slightly
+// longer than requested
+class BbvRecorder final {
+    static constexpr bit::BitSize TABLE_SIZE_LOG_2 = 12;
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_SIZE_LOG_2;
+    static constexpr bit::BitSize PC_ALIGN_BITS = 1;
+
+    // Bb ids are numbered from 1 in order of first execution. Zero id
+    // stands for no bb
+    struct IdEntry final {
+        VirtAddr virt_addr = bb::Bb::INVALID_VA;
+        uint32_t id = 0;
+    };
+
+    std::ostream &m_out;
+    uint64_t m_interval_size = 0;
+
+    // Direct-mapped cache of bb ids backed by map of all ids
+    std::unique_ptr<IdEntry[]> m_id_cache{new IdEntry[TABLE_SIZE]};
+    std::unordered_map<VirtAddr, uint32_t> m_ids{};
+
+    // Current interval instrs by bb id and ids with non-zero counts
+    std::vector<uint64_t> m_counts{0};
+    std::vector<uint32_t> m_touched{};
+    uint64_t m_interval_icount = 0;
+    size_t m_interval_number = 0;
+
+    uint32_t m_curr_id = 0;
+    uint64_t m_curr_start_icount = 0;
+
+    NODISCARD uint32_t findId(VirtAddr virt_addr) {
+        auto &entry = m_id_cache[bit::getBitField(
+            PC_ALIGN_BITS + TABLE_SIZE_LOG_2 - 1, PC_ALIGN_BITS, virt_addr)];
+
+        if (entry.virt_addr != virt_addr) {
+            entry = {virt_addr, insertId(virt_addr)};
+        }
+
+        return entry.id;
+    }
+
+    uint32_t insertId(VirtAddr virt_addr);
+
+    // Account instrs executed in current bb up to given icount
+    void account(uint64_t icount) {
+        auto delta = icount - m_curr_start_icount;
+        m_curr_start_icount = icount;
+
+        if (m_curr_id == 0 || delta == 0) {
+            return;
+        }
+
+        auto &count = m_counts[m_curr_id];
+        if (count == 0) {
+            m_touched.push_back(m_curr_id);
+        }
+        count += delta;
+
+        m_interval_icount += delta;
+        if (m_interval_icount >= m_interval_size) {
+            writeInterval();
+        }
+    }
+
+    void writeInterval();
+
+  public:
+    BbvRecorder(std::ostream &out, uint64_t interval_size)
+        : m_out(out), m_interval_size(interval_size) {
+        SIM_ASSERT(interval_size != 0);
+    }
+
+    BbvRecorder(const BbvRecorder &) = delete;
+    BbvRecorder &operator=(const BbvRecorder &) = delete;
+
+    // Count bb entry. icount is simulator icount at bb entry
+    void enter(VirtAddr virt_addr, uint64_t icount) {
+        account(icount);
+        m_curr_id = findId(virt_addr);
+    }
+
+    // Stop counting current bb. icount is simulator icount at exit
+    void exit(uint64_t icount) {
+        account(icount);
+        m_curr_id = 0;
+    }
+
+    // Write last incomplete interval
+    void finish();
+
+    // Written intervals number
+    NODISCARD auto intervalNumber() const noexcept {
+        return m_interval_number;
+    }
+
+    // Unique bbs number
+    NODISCARD auto bbNumber() const noexcept { return m_ids.size(); }
+};
+
+// Executed instrs number by instr id
+using InstrMix = std::array<uint64_t, instr::INSTR_ID_NUMBER>;
+
+// Dynamic instrs mix recorder. Instr ids of bb are counted once on its first
+// entry and scaled by bb entries number, so executed instrs are not counted
+// one by one. Bbs are expected to run to their terminators
+class InstrMixRecorder final {
+    static constexpr bit::BitSize TABLE_SIZE_LOG_2 = 12;
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_SIZE_LOG_2;
+    static constexpr bit::BitSize PC_ALIGN_BITS = 1;
+
+    struct IdCount final {
+        instr::InstrId id = instr::InstrId::SIM_STATUS_INSTR;
+        uint32_t count = 0;
+    };
+
+    // Decoded instrs are identified by their address, as bb and superblock
+    // at the same va differ
+    struct Entry final {
+        VirtAddr virt_addr = bb::Bb::INVALID_VA;
+        const instr::Instr *instrs = nullptr;
+        uint64_t entries = 0;
+        std::vector<IdCount> id_counts{};
+    };
+
+    std::unique_ptr<Entry[]> m_table{new Entry[TABLE_SIZE]};
+    InstrMix m_mix{};
+
+    // Account entries of cached bb and count ids of new one
+    void replace(Entry &entry, VirtAddr virt_addr,
+                 const instr::Instr *instrs);
+
+    static void account(const Entry &entry, InstrMix &mix) noexcept;
+
+  public:
+    InstrMixRecorder() = default;
+
+    InstrMixRecorder(const InstrMixRecorder &) = delete;
+    InstrMixRecorder &operator=(const InstrMixRecorder &) = delete;
+
+    // Count bb entry. instrs are decoded instrs executed from the entry
+    void enter(VirtAddr virt_addr, const instr::Instr *instrs) {
+        auto &entry = m_table[bit::getBitField(
+            PC_ALIGN_BITS + TABLE_SIZE_LOG_2 - 1, PC_ALIGN_BITS, virt_addr)];
+
+        if (entry.instrs != instrs || entry.virt_addr != virt_addr) {
+            replace(entry, virt_addr, instrs);
+        }
+
+        ++entry.entries;
+    }
+
+    // Account and drop cached bbs. Must be called when decoded instrs may
+    // be changed in place
+    void flush() noexcept;
+
+    // Executed instrs number by instr id
+    NODISCARD InstrMix mix() const;
+};
+
+// Guest call graph sampler. Shadow call stack is kept from calls and
+// returns reported by simulator. Samples of the stack with leaf pc are
+// taken every interval instrs or on host timer ticks
+class CallGraphSampler final {
+    // Calls beyond max depth are only counted, so returns stay balanced
+    static constexpr size_t MAX_DEPTH = 1024;
+
+    // Call site pcs from outermost call
+    std::vector<VirtAddr> m_stack{};
+    size_t m_lost_depth = 0;
+
+    uint64_t m_interval = 0;
+    uint64_t m_next_sample_icount = std::numeric_limits<uint64_t>::max();
+
+    // Sample counts by call site pcs followed by leaf pc
+    std::map<std::vector<VirtAddr>, uint64_t> m_samples{};
+    uint64_t m_sample_number = 0;
+
+  public:
+    // Sample every interval instrs. Zero interval leaves timer samples only
+    explicit CallGraphSampler(uint64_t interval) : m_interval(interval) {
+        m_stack.reserve(MAX_DEPTH);
+
+        if (interval != 0) {
+            m_next_sample_icount = interval;
+        }
+    }
+
+    CallGraphSampler(const CallGraphSampler &) = delete;
+    CallGraphSampler &operator=(const CallGraphSampler &) = delete;
+
+    // Push call from given call site
+    void call(VirtAddr call_pc) noexcept {
+        if (m_stack.size() != MAX_DEPTH) {
+            m_stack.push_back(call_pc);
+        } else {
+            ++m_lost_depth;
+        }
+    }
+
+    // Pop call. Returns without calls, e.g. after longjmp, are ignored
+    void ret() noexcept {
+        if (m_lost_depth != 0) {
+            --m_lost_depth;
+        } else if (!m_stack.empty()) {
+            m_stack.pop_back();
+        }
+    }
+
+    // Icount of next interval sample
+    NODISCARD uint64_t nextSampleIcount() const noexcept {
+        return m_next_sample_icount;
+    }
+
+    // Sample current stack with given leaf pc. Next interval sample is
+    // scheduled if icount reached current one
+    void sample(VirtAddr pc, uint64_t icount);
+
+    NODISCARD auto sampleNumber() const noexcept { return m_sample_number; }
+
+    // Sample counts by call site pcs followed by leaf pc
+    NODISCARD const auto &samples() const noexcept { return m_samples; }
+};
+
+// Host SIGPROF timer. Handler is called with ctx from signal handler every
+// period of process CPU time, so it must be async-signal-safe. One timer
+// runs at a time
+class ProfTimer final {
+  public:
+    using Handler = void (*)(void *ctx);
+
+    ProfTimer(std::chrono::microseconds period, Handler handler, void *ctx);
+
+    ProfTimer(const ProfTimer &) = delete;
+    ProfTimer &operator=(const ProfTimer &) = delete;
+
+    ~ProfTimer();
+};
+
+// Write call graph samples as folded stacks for flamegraph.pl: functions
+// from outermost separated with ';' and samples number
+void writeFoldedStacks(std::ostream &out, const CallGraphSampler &sampler,
+                       const elf::SymbolIndex &symbols);
+
+// Add instrs mix grouped by instr class: "instr_mix.total",
+// "instr_mix.<class>.total" and "instr_mix.<class>.<instr>"
+void collectInstrMix(stats::Registry &registry, const InstrMix &mix);
+
+// Write instrs mix as CSV with class, instr and count columns
+void writeInstrMixCsv(std::ostream &out, const InstrMix &mix);
+
+// Write top bbs and functions by dynamic instrs count
+void writeReport(std::ostream &out, const std::vector<BbCounters> &counters,
+                 const elf::SymbolIndex &symbols, size_t top_number);
+
+} // namespace sim::profile
+
+#endif // INCL_SIM_PROFILE_HPP
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <signal.h>
+#include <sys/time.h>
+
+#include <sim/elf_load.hpp>
+#include <sim/profile.hpp>
+#include <sim/stats.hpp>
+
+namespace sim::profile {
+
+namespace {
+
+constexpr const char *UNKNOWN_SYMBOL = "??";
+
+constexpr int COUNT_WIDTH = 14;
+constexpr int SHARE_WIDTH = 7;
+constexpr int ADDR_WIDTH = 12;
+
+// Percent of total
+double share(uint64_t value, uint64_t total) noexcept {
+    constexpr double PERCENT = 100;
+    return total == 0 ? 0 : PERCENT * value / total;
+}
+
+template <class Item, class IcountOf>
+void sortTop(std::vector<Item> &items, size_t top_number, IcountOf icount_of) {
+    auto middle = items.begin() + std::min(top_number, items.size());
+    std::partial_sort(items.begin(), middle, items.end(),
+                      [&](const Item &lhs, const Item &rhs) {
+                          return icount_of(lhs) > icount_of(rhs);
+                      });
+    items.erase(middle, items.end());
+}
+
+// Call func for executed instr ids grouped by instr class
+template <class Func> void forEachByClass(const InstrMix &mix, Func func) {
+    for (size_t cls = 0; cls != instr::INSTR_CLASS_NUMBER; ++cls) {
+        for (size_t id = 0; id != instr::INSTR_ID_NUMBER; ++id) {
+            auto instr_id = instr::InstrId(id);
+            if (mix[id] != 0 &&
+                to_underlying(instr::instrClass(instr_id)) == cls) {
+                func(instr::InstrClass(cls), instr_id);
+            }
+        }
+    }
+}
+
+// Active prof timer handler. Signal handler reads it
+std::atomic<ProfTimer::Handler> prof_handler = nullptr;
+std::atomic<void *> prof_ctx = nullptr;
+
+void onProfSignal(int) {
+    auto handler = prof_handler.load(std::memory_order_acquire);
+    if (handler != nullptr) {
+        handler(prof_ctx.load(std::memory_order_relaxed));
+    }
+}
+
+std::string symbolName(const elf::SymbolIndex &symbols, VirtAddr addr) {
+    if (const auto *symbol = symbols.find(addr)) {
+        return symbol->name;
+    }
+
+    std::ostringstream out{};
+    out << "0x" << std::hex << addr;
+    return out.str();
+}
+
+} // namespace
+
+void BbProfiler::evict(BbCounters &counters) {
+    if (counters.virt_addr == bb::Bb::INVALID_VA) {
+        return;
+    }
+
+    auto &evicted = m_evicted[counters.virt_addr];
+    evicted.virt_addr = counters.virt_addr;
+    evicted.entries += counters.entries;
+    evicted.icount += counters.icount;
+}
+
+std::vector<BbCounters> BbProfiler::counters() const {
+    auto all = m_evicted;
+
+    for (size_t i = 0; i != TABLE_SIZE; ++i) {
+        const auto &counters = m_table[i];
+        if (counters.virt_addr == bb::Bb::INVALID_VA) {
+            continue;
+        }
+
+        auto &merged = all[counters.virt_addr];
+        merged.virt_addr = counters.virt_addr;
+        merged.entries += counters.entries;
+        merged.icount += counters.icount;
+    }
+
+    std::vector<BbCounters> out{};
+    out.reserve(all.size());
+    for (auto &&[virt_addr, counters] : all) {
+        out.push_back(counters);
+    }
+
+    return out;
+}
+
+uint32_t BbvRecorder::insertId(VirtAddr virt_addr) {
+    auto [it, inserted] =
+        m_ids.try_emplace(virt_addr, static_cast<uint32_t>(m_ids.size() + 1));
+
+    if (inserted) {
+        m_counts.push_back(0);
+    }
+
+    return it->second;
+}
+
+void BbvRecorder::writeInterval() {
+    std::sort(m_touched.begin(), m_touched.end());
+
+    m_out << 'T';
+    for (auto id : m_touched) {
+        m_out << ':' << id << ':' << m_counts[id] << ' ';
+        m_counts[id] = 0;
+    }
+    m_out << '\n';
+
+    m_touched.clear();
+    m_interval_icount = 0;
+    ++m_interval_number;
+}
+
+void BbvRecorder::finish() {
+    if (m_interval_icount != 0) {
+        writeInterval();
+    }
+
+    m_out.flush();
+}
+
+void InstrMixRecorder::account(const Entry &entry, InstrMix &mix) noexcept {
+    for (auto &&[id, count] : entry.id_counts) {
+        mix[to_underlying(id)] += entry.entries * count;
+    }
+}
+
+void InstrMixRecorder::replace(Entry &entry, VirtAddr virt_addr,
+                               const instr::Instr *instrs) {
+    account(entry, m_mix);
+
+    entry.virt_addr = virt_addr;
+    entry.instrs = instrs;
+    entry.entries = 0;
+    entry.id_counts.clear();
+
+    bb::forEachInstr(instrs, [&entry](const instr::Instr &instr) {
+        auto it = std::find_if(entry.id_counts.begin(), entry.id_counts.end(),
+                               [&instr](const IdCount &id_count) {
+                                   return id_count.id == instr.id();
+                               });
+
+        if (it == entry.id_counts.end()) {
+            entry.id_counts.push_back({instr.id(), 1});
+        } else {
+            ++it->count;
+        }
+    });
+}
+
+void InstrMixRecorder::flush() noexcept {
+    for (size_t i = 0; i != TABLE_SIZE; ++i) {
+        auto &entry = m_table[i];
+
+        account(entry, m_mix);
+        entry = {};
+    }
+}
+
+InstrMix InstrMixRecorder::mix() const {
+    auto mix = m_mix;
+    for (size_t i = 0; i != TABLE_SIZE; ++i) {
+        account(m_table[i], mix);
+    }
+
+    return mix;
+}
+
+void CallGraphSampler::sample(VirtAddr pc, uint64_t icount) {
+    auto frames = m_stack;
+    frames.push_back(pc);
+    ++m_samples[std::move(frames)];
+    ++m_sample_number;
+
+    if (icount >= m_next_sample_icount) {
+        m_next_sample_icount = icount + m_interval;
+    }
+}
+
+ProfTimer::ProfTimer(std::chrono::microseconds period, Handler handler,
+                     void *ctx) {
+    prof_ctx.store(ctx, std::memory_order_relaxed);
+    prof_handler.store(handler, std::memory_order_release);
+
+    // Interrupted guest syscalls are restarted
+    struct sigaction action {};
+    action.sa_handler = onProfSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+
+    auto usecs = std::max<int64_t>(period.count(), 1);
+    timeval tick{usecs / 1000000, usecs % 1000000};
+    itimerval timer{tick, tick};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+ProfTimer::~ProfTimer() {
+    itimerval timer{};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+
+    prof_handler.store(nullptr, std::memory_order_release);
+}
+
+void writeFoldedStacks(std::ostream &out, const CallGraphSampler &sampler,
+                       const elf::SymbolIndex &symbols) {
+    // Samples at different pcs of the same functions are merged
+    std::map<std::string, uint64_t> stacks{};
+
+    for (auto &&[frames, count] : sampler.samples()) {
+        std::string stack{};
+        for (auto pc : frames) {
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += symbolName(symbols, pc);
+        }
+
+        stacks[stack] += count;
+    }
+
+    for (auto &&[stack, count] : stacks) {
+        out << stack << ' ' << count << '\n';
+    }
+}
+
+void collectInstrMix(stats::Registry &registry, const InstrMix &mix) {
+    std::array<uint64_t, instr::INSTR_CLASS_NUMBER> class_totals{};
+    uint64_t total = 0;
+
+    for (size_t id = 0; id != instr::INSTR_ID_NUMBER; ++id) {
+        auto cls = instr::instrClass(instr::InstrId(id));
+        class_totals[to_underlying(cls)] += mix[id];
+        total += mix[id];
+    }
+
+    registry.add("instr_mix.total", total);
+
+    // Entries of class are added in a row
+    std::string prefix{};
+    forEachByClass(mix, [&](instr::InstrClass cls, instr::InstrId id) {
+        auto class_prefix =
+            std::string{"instr_mix."} + instr::instrClassName(cls) + '.';
+
+        if (class_prefix != prefix) {
+            prefix = std::move(class_prefix);
+            registry.add(prefix + "total", class_totals[to_underlying(cls)]);
+        }
+
+        registry.add(prefix + instr::instrName(id), mix[to_underlying(id)]);
+    });
+}
+
+void writeInstrMixCsv(std::ostream &out, const InstrMix &mix) {
+    out << "class,instr,count\n";
+
+    forEachByClass(mix, [&](instr::InstrClass cls, instr::InstrId id) {
+        out << instr::instrClassName(cls) << ',' << instr::instrName(id)
+            << ',' << mix[to_underlying(id)] << '\n';
+    });
+}
+
+void writeReport(std::ostream &out, const std::vector<BbCounters> &counters,
+                 const elf::SymbolIndex &symbols, size_t top_number) {
+    uint64_t total_icount = 0;
+    std::map<std::string, uint64_t> func_icounts{};
+
+    for (auto &&bb : counters) {
+        total_icount += bb.icount;
+
+        const auto *symbol = symbols.find(bb.virt_addr);
+        func_icounts[symbol ? symbol->name : UNKNOWN_SYMBOL] += bb.icount;
+    }
+
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+
+    out << "total icount = " << total_icount << ", bbs = " << counters.size()
+        << std::endl
+        << std::endl;
+
+    // Top bbs
+    auto top_bbs = counters;
+    sortTop(top_bbs, top_number,
+            [](const BbCounters &bb) { return bb.icount; });
+
+    out << std::setw(COUNT_WIDTH) << "icount" << std::setw(SHARE_WIDTH) << "%"
+        << std::setw(COUNT_WIDTH) << "entries" << "  " << std::setw(ADDR_WIDTH)
+        << "bb" << "  symbol" << std::endl;
+
+    for (auto &&bb : top_bbs) {
+        out << std::setw(COUNT_WIDTH) << bb.icount << std::setw(SHARE_WIDTH)
+            << share(bb.icount, total_icount) << std::setw(COUNT_WIDTH)
+            << bb.entries << "  " << std::hex << std::setw(ADDR_WIDTH)
+            << bb.virt_addr << std::dec << "  ";
+
+        if (const auto *symbol = symbols.find(bb.virt_addr)) {
+            out << symbol->name << "+0x" << std::hex
+                << bb.virt_addr - symbol->addr << std::dec;
+        } else {
+            out << UNKNOWN_SYMBOL;
+        }
+        out << std::endl;
+    }
+
+    // Top functions
+    std::vector<std::pair<std::string, uint64_t>> top_funcs(
+        func_icounts.begin(), func_icounts.end());
+    sortTop(top_funcs, top_number,
+            [](const auto &func) { return func.second; });
+
+    out << std::endl
+        << std::setw(COUNT_WIDTH) << "icount" << std::setw(SHARE_WIDTH) << "%"
+        << "  function" << std::endl;
+
+    for (auto &&[name, icount] : top_funcs) {
+        out << std::setw(COUNT_WIDTH) << icount << std::setw(SHARE_WIDTH)
+            << share(icount, total_icount) << "  " << name << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace sim::profile
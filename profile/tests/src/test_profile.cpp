@@ -0,0 +1,207 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <sim/elf_load.hpp>
+#include <sim/profile.hpp>
+#include <sim/stats.hpp>
+
+namespace sim::profile {
+
+namespace {
+
+const BbCounters *findBb(const std::vector<BbCounters> &counters,
+                         VirtAddr virt_addr) {
+    for (auto &&bb : counters) {
+        if (bb.virt_addr == virt_addr) {
+            return &bb;
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace
+
+TEST(ProfileTest, bbProfiler) {
+    // Second and third bbs conflict in profiler table
+    constexpr VirtAddr BB0 = 0x10000;
+    constexpr VirtAddr BB1 = 0x10100;
+    constexpr VirtAddr BB2 = BB1 + (VirtAddr{1} << 13);
+
+    BbProfiler profiler{};
+
+    uint64_t icount = 0;
+    for (size_t i = 0; i != 10; ++i) {
+        profiler.enter(BB0, icount);
+        icount += 3;
+        profiler.enter(i % 2 ? BB1 : BB2, icount);
+        icount += 5;
+    }
+    profiler.exit(icount);
+
+    // Not counted after exit
+    profiler.exit(icount + 100);
+
+    auto counters = profiler.counters();
+    ASSERT_EQ(counters.size(), 3);
+
+    const auto *bb0 = findBb(counters, BB0);
+    ASSERT_NE(bb0, nullptr);
+    ASSERT_EQ(bb0->entries, 10);
+    ASSERT_EQ(bb0->icount, 30);
+
+    for (auto virt_addr : {BB1, BB2}) {
+        const auto *bb = findBb(counters, virt_addr);
+        ASSERT_NE(bb, nullptr);
+        ASSERT_EQ(bb->entries, 5);
+        ASSERT_EQ(bb->icount, 25);
+    }
+}
+
+TEST(ProfileTest, bbvRecorder) {
+    constexpr VirtAddr BB0 = 0x10000;
+    constexpr VirtAddr BB1 = 0x10100;
+    // Conflicts with BB1 in id cache
+    constexpr VirtAddr BB2 = BB1 + (VirtAddr{1} << 13);
+
+    std::ostringstream out{};
+    BbvRecorder recorder{out, 10};
+
+    recorder.enter(BB0, 0);
+    recorder.enter(BB1, 4);
+    // First interval ends on entry of bb crossing its size
+    recorder.enter(BB0, 12);
+    recorder.enter(BB2, 16);
+    recorder.enter(BB1, 18);
+    recorder.exit(20);
+    recorder.finish();
+
+    ASSERT_EQ(out.str(), "T:1:4 :2:8 \nT:1:4 :2:2 :3:2 \n");
+    ASSERT_EQ(recorder.intervalNumber(), 2);
+    ASSERT_EQ(recorder.bbNumber(), 3);
+
+    // Nothing is left to write
+    recorder.finish();
+    ASSERT_EQ(recorder.intervalNumber(), 2);
+}
+
+TEST(ProfileTest, instrMix) {
+    using instr::Instr;
+    using instr::InstrId;
+
+    constexpr VirtAddr BB0 = 0x10000;
+    constexpr VirtAddr BB1 = 0x10100;
+    // Conflicts with BB1 in recorder table
+    constexpr VirtAddr BB2 = BB1 + (VirtAddr{1} << 13);
+
+    // addi x20, x2, 7; ld a1, 0(a0)
+    const Instr BB0_INSTRS[] = {Instr(0x00710a13), Instr(0x00053583),
+                                Instr(0)};
+    // addi x20, x2, 7; addi x20, x2, 7; beq x3, x30, 10
+    const Instr BB1_INSTRS[] = {Instr(0x00710a13), Instr(0x00710a13),
+                                Instr(0x01e18563), Instr(0)};
+
+    InstrMixRecorder recorder{};
+    for (size_t i = 0; i != 3; ++i) {
+        recorder.enter(BB0, BB0_INSTRS);
+        recorder.enter(i % 2 ? BB2 : BB1, BB1_INSTRS);
+    }
+
+    // Recorded entries are kept after flush
+    recorder.flush();
+    recorder.enter(BB0, BB0_INSTRS);
+
+    auto mix = recorder.mix();
+    ASSERT_EQ(mix[to_underlying(InstrId::ADDI)], 4 + 2 * 3);
+    ASSERT_EQ(mix[to_underlying(InstrId::LD)], 4);
+    ASSERT_EQ(mix[to_underlying(InstrId::BEQ)], 3);
+    ASSERT_EQ(mix[to_underlying(InstrId::SIM_STATUS_INSTR)], 0);
+
+    stats::Registry registry{};
+    collectInstrMix(registry, mix);
+    ASSERT_EQ(std::get<uint64_t>(*registry.find("instr_mix.total")), 17);
+    ASSERT_EQ(std::get<uint64_t>(*registry.find("instr_mix.op_imm.ADDI")),
+              10);
+    ASSERT_EQ(std::get<uint64_t>(*registry.find("instr_mix.load.total")), 4);
+    ASSERT_EQ(registry.find("instr_mix.op.total"), nullptr);
+
+    std::ostringstream out{};
+    writeInstrMixCsv(out, mix);
+    ASSERT_EQ(out.str(), "class,instr,count\n"
+                         "load,LD,4\n"
+                         "op_imm,ADDI,10\n"
+                         "branch,BEQ,3\n");
+}
+
+TEST(ProfileTest, callGraphSampler) {
+    elf::SymbolIndex symbols{{{"main", 0x1000, 0x100},
+                              {"foo", 0x2000, 0x100},
+                              {"bar", 0x3000, 0x100}}};
+
+    CallGraphSampler sampler{10};
+    ASSERT_EQ(sampler.nextSampleIcount(), 10);
+
+    sampler.sample(0x1004, 10);
+    ASSERT_EQ(sampler.nextSampleIcount(), 20);
+
+    sampler.call(0x1008);
+    sampler.sample(0x2004, 20);
+    sampler.call(0x2008);
+    sampler.sample(0x3000, 30);
+    sampler.sample(0x3010, 40);
+    sampler.ret();
+    // Timer sample does not move interval sample point
+    sampler.sample(0x2010, 45);
+    ASSERT_EQ(sampler.nextSampleIcount(), 50);
+
+    sampler.ret();
+    // Unmatched return is ignored
+    sampler.ret();
+    sampler.sample(0x5000, 50);
+    ASSERT_EQ(sampler.sampleNumber(), 6);
+
+    std::ostringstream out{};
+    writeFoldedStacks(out, sampler, symbols);
+    ASSERT_EQ(out.str(), "0x5000 1\n"
+                         "main 1\n"
+                         "main;foo 2\n"
+                         "main;foo;bar 2\n");
+}
+
+TEST(ProfileTest, symbolIndex) {
+    elf::SymbolIndex symbols{{{"main", 0x1000, 0x40},
+                              {"_start", 0x800, 0},
+                              {"main_alias", 0x1000, 0},
+                              {"loop", 0x2000, 0x10}}};
+
+    ASSERT_EQ(symbols.find(0x7fc), nullptr);
+    ASSERT_EQ(symbols.find(0x800)->name, "_start");
+    // Sizeless symbol spans up to the next one
+    ASSERT_EQ(symbols.find(0xffc)->name, "_start");
+    // Sized symbol is preferred on same addr
+    ASSERT_EQ(symbols.find(0x103c)->name, "main");
+    ASSERT_EQ(symbols.find(0x1040), nullptr);
+    ASSERT_EQ(symbols.find(0x2008)->name, "loop");
+    ASSERT_EQ(symbols.find(0x2010), nullptr);
+}
+
+TEST(ProfileTest, report) {
+    elf::SymbolIndex symbols{{{"main", 0x1000, 0x100}}};
+    std::vector<BbCounters> counters = {
+        {0x1010, 1, 10}, {0x1020, 2, 30}, {0x5000, 1, 60}};
+
+    std::ostringstream out{};
+    writeReport(out, counters, symbols, 2);
+    auto report = out.str();
+
+    ASSERT_NE(report.find("total icount = 100"), std::string::npos);
+    ASSERT_NE(report.find("main+0x20"), std::string::npos);
+    // Only top 2 bbs are listed
+    ASSERT_EQ(report.find("main+0x10"), std::string::npos);
+    ASSERT_NE(report.find("60.00"), std::string::npos);
+    ASSERT_NE(report.find("40.00  main"), std::string::npos);
+    ASSERT_NE(report.find("??"), std::string::npos);
+}
+
+} // namespace sim::profile
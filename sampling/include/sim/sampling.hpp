@@ -0,0 +1,154 @@
+#ifndef INCL_SIM_SAMPLING_HPP
+#define INCL_SIM_SAMPLING_HPP
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/csr.hpp>
+#include <sim/fpr.hpp>
+#include <sim/gpr.hpp>
+#include <sim/memory.hpp>
+#include <sim/simulator.hpp>
+#include <sim/syscall.hpp>
+#include <sim/vr.hpp>
+
+namespace sim::sampling {
+
+// Copy of guest memory page content
+using PageData = std::array<uint8_t, memory::PAGE_SIZE>;
+
+// Guest pages of checkpoint. Set holds pages dirtied since parent set
+// only, and every MAX_DEPTH-th set holds all pages, so checkpoints are
+// taken in time of dirty pages copy and lookups walk bounded chain.
+// Unmodified pages content is shared
+struct PageSet final {
+    static constexpr size_t MAX_DEPTH = 16;
+
+    std::unordered_map<PhysAddr, std::shared_ptr<const PageData>> pages{};
+    std::shared_ptr<const PageSet> parent = nullptr;
+    // Parents number up to full set
+    size_t depth = 0;
+
+    // Find page content. Returns nullptr for missing page
+    NODISCARD std::shared_ptr<const PageData> find(PhysAddr page_pa) const;
+
+    // Call func(page_pa, page) with latest content of each page
+    template <class Func> void forEachPage(Func func) const {
+        std::unordered_set<PhysAddr> seen{};
+
+        for (const auto *set = this; set != nullptr; set = set->parent.get()) {
+            for (auto &&[page_pa, page] : set->pages) {
+                if (seen.insert(page_pa).second) {
+                    func(page_pa, page);
+                }
+            }
+        }
+    }
+};
+
+// Simulation state at interval start.
+// Pages not modified between checkpoints are shared by them
+struct Checkpoint final {
+    // Counted from functional pass start
+    size_t icount = 0;
+    // Simulator icount. Counter CSRs read it
+    size_t sim_icount = 0;
+
+    VirtAddr pc = 0;
+    gpr::GPRFile gpr_file{};
+    fpr::FPRFile fpr_file{};
+    vr::VRFile vr_file{};
+    csr::CSRFile csr_file{};
+
+    // Guest functions simulated on host
+    std::unordered_map<VirtAddr, Simulator::HostFunc> host_funcs{};
+    std::array<Simulator::HostFuncCost, Simulator::HOST_FUNC_NUMBER>
+        host_func_costs{};
+
+    // Guest process state: memory layout, files and buffered output
+    syscall::Emulator::State syscalls{};
+
+    std::shared_ptr<const PageSet> pages = nullptr;
+};
+
+// Load checkpoint state to given simulator. Simulator must own its physical
+// memory and must be reset
+void restoreCheckpoint(Simulator &sim, const Checkpoint &checkpoint);
+
+// Detailed simulation result for one interval
+struct IntervalResult final {
+    size_t idx = 0;
+    // Functional pass icount at interval start
+    size_t start_icount = 0;
+    size_t icount = 0;
+    SimStatus status = SimStatus::OK;
+    // Host wall time in seconds
+    double wall_time = 0;
+};
+
+// Aggregated detailed simulation result
+struct SamplingResult final {
+    std::vector<IntervalResult> intervals{};
+    size_t icount = 0;
+    // Host wall time in seconds
+    double wall_time = 0;
+
+    NODISCARD double mips() const noexcept {
+        static constexpr double MEGA = 1e6;
+        return wall_time == 0 ? 0 : icount / wall_time / MEGA;
+    }
+};
+
+// Sampled simulation.
+// Functional pass drops checkpoints every interval instructions. Selected
+// intervals are then re-simulated from checkpoints in parallel
+class Sampler final {
+  public:
+    // Instrumentation hook. Called from worker threads with interval simulator
+    using Hook = std::function<void(Simulator &, IntervalResult &)>;
+
+  private:
+    size_t m_interval = 0;
+
+    std::vector<Checkpoint> m_checkpoints{};
+
+    // Functional pass results
+    SimStatus m_status = SimStatus::OK;
+    size_t m_icount = 0;
+    double m_wall_time = 0;
+
+  public:
+    explicit Sampler(size_t interval) : m_interval(interval) {
+        SIM_ASSERT(interval != 0);
+    }
+
+    // Functional pass. Simulator state must be ready for simulation from
+    // start_pc. Checkpoints are dropped on bb boundaries, so intervals may be
+    // slightly longer than requested
+    SimStatus record(Simulator &sim, VirtAddr start_pc);
+
+    NODISCARD const auto &checkpoints() const noexcept { return m_checkpoints; }
+    NODISCARD auto intervalNumber() const noexcept {
+        return m_checkpoints.size();
+    }
+
+    NODISCARD auto status() const noexcept { return m_status; }
+    NODISCARD auto icount() const noexcept { return m_icount; }
+    NODISCARD auto wallTime() const noexcept { return m_wall_time; }
+
+    // Re-simulate selected intervals (all intervals if none are selected) on
+    // worker_number threads. Hooks are called before and after each interval.
+    // Guest output is not repeated
+    SamplingResult simulate(const std::vector<size_t> &intervals,
+                            size_t worker_number, const Hook &on_start = {},
+                            const Hook &on_end = {}) const;
+};
+
+} // namespace sim::sampling
+
+#endif // INCL_SIM_SAMPLING_HPP
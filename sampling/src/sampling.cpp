@@ -0,0 +1,225 @@
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include <sim/pool.hpp>
+#include <sim/sampling.hpp>
+
+namespace sim::sampling {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+NODISCARD double secondsSince(Clock::time_point start) noexcept {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+NODISCARD std::shared_ptr<const PageData>
+copyPage(const memory::PhysMemory &pm, PhysAddr page_pa) {
+    auto host_page_ptr = pm.getConstHostPagePtr(page_pa);
+    SIM_ASSERT(host_page_ptr != nullptr);
+
+    auto page = std::make_shared<PageData>();
+    std::memcpy(page->data(), host_page_ptr, memory::PAGE_SIZE);
+
+    return page;
+}
+
+// Take checkpoint of current simulator state. Only pages dirtied since
+// previous checkpoint are copied
+void takeCheckpoint(Simulator &sim, std::vector<Checkpoint> &checkpoints) {
+    auto &pm = sim.getPhysMemory();
+    auto &hart = sim.getHart();
+
+    Checkpoint checkpoint{sim.icount(),   sim.icount(),   hart.pc(),
+                          hart.gprFile(), hart.fprFile(), hart.vrFile(),
+                          hart.csrFile()};
+    checkpoint.host_funcs = sim.hostFuncs();
+    checkpoint.host_func_costs = sim.hostFuncCosts();
+    checkpoint.syscalls = sim.syscalls().state();
+
+    std::vector<PhysAddr> dirty_pages{};
+    pm.takeDirtyPages(dirty_pages);
+
+    auto pages = std::make_shared<PageSet>();
+
+    if (checkpoints.empty()) {
+        pm.forEachPage([&](PhysAddr page_pa, memory::ConstHostPtr) {
+            pages->pages.emplace(page_pa, copyPage(pm, page_pa));
+        });
+    } else {
+        const auto &parent = checkpoints.back().pages;
+
+        // Cut chain with full set
+        if (parent->depth + 1 == PageSet::MAX_DEPTH) {
+            parent->forEachPage(
+                [&](PhysAddr page_pa, std::shared_ptr<const PageData> page) {
+                    pages->pages.emplace(page_pa, std::move(page));
+                });
+        } else {
+            pages->parent = parent;
+            pages->depth = parent->depth + 1;
+        }
+
+        for (auto page_pa : dirty_pages) {
+            pages->pages[page_pa] = copyPage(pm, page_pa);
+        }
+    }
+
+    checkpoint.pages = std::move(pages);
+
+    checkpoints.push_back(std::move(checkpoint));
+
+    // Cached host pointers bypass dirty tracking
+    sim.invalidateTLBs();
+}
+
+} // namespace
+
+std::shared_ptr<const PageData> PageSet::find(PhysAddr page_pa) const {
+    for (const auto *set = this; set != nullptr; set = set->parent.get()) {
+        if (auto it = set->pages.find(page_pa); it != set->pages.end()) {
+            return it->second;
+        }
+    }
+
+    return nullptr;
+}
+
+void restoreCheckpoint(Simulator &sim, const Checkpoint &checkpoint) {
+    auto &pm = sim.getPhysMemory();
+    auto &hart = sim.getHart();
+
+    hart.pc() = checkpoint.pc;
+    hart.gprFile() = checkpoint.gpr_file;
+    hart.fprFile() = checkpoint.fpr_file;
+    hart.vrFile() = checkpoint.vr_file;
+    hart.csrFile() = checkpoint.csr_file;
+
+    sim.setIcount(checkpoint.sim_icount);
+    sim.clearReservation();
+
+    for (auto &&[entry, func] : checkpoint.host_funcs) {
+        sim.setHostFunc(entry, func);
+    }
+    for (size_t i = 0; i != Simulator::HOST_FUNC_NUMBER; ++i) {
+        sim.setHostFuncCost(static_cast<Simulator::HostFunc>(i),
+                            checkpoint.host_func_costs[i]);
+    }
+
+    checkpoint.pages->forEachPage(
+        [&](PhysAddr page_pa, const std::shared_ptr<const PageData> &page) {
+            SIM_ASSERT(pm.addRAMPage(page_pa));
+            std::memcpy(pm.getHostPagePtr(page_pa), page->data(),
+                        memory::PAGE_SIZE);
+        });
+
+    sim.syscalls().restore(checkpoint.syscalls);
+}
+
+SimStatus Sampler::record(Simulator &sim, VirtAddr start_pc) {
+    auto start = Clock::now();
+
+    m_checkpoints.clear();
+
+    auto &pm = sim.getPhysMemory();
+    pm.setDirtyTracking(true);
+
+    sim.getHart().pc() = start_pc;
+    auto icount_start = sim.icount();
+
+    auto status = SimStatus::SIM__ICOUNT_LIMIT;
+    while (status == SimStatus::SIM__ICOUNT_LIMIT) {
+        takeCheckpoint(sim, m_checkpoints);
+        status = sim.resume(m_interval);
+    }
+
+    pm.setDirtyTracking(false);
+
+    m_status = status;
+    m_icount = sim.icount() - icount_start;
+    m_wall_time = secondsSince(start);
+
+    // Checkpoints icount is counted from functional pass start
+    for (auto &&checkpoint : m_checkpoints) {
+        checkpoint.icount -= icount_start;
+    }
+
+    return status;
+}
+
+SamplingResult Sampler::simulate(const std::vector<size_t> &intervals,
+                                 size_t worker_number, const Hook &on_start,
+                                 const Hook &on_end) const {
+    SIM_ASSERT(worker_number != 0);
+
+    auto start = Clock::now();
+
+    SamplingResult res{};
+
+    if (intervals.empty()) {
+        for (size_t i = 0, end = intervalNumber(); i != end; ++i) {
+            res.intervals.push_back({i});
+        }
+    } else {
+        for (auto idx : intervals) {
+            SIM_ASSERT(idx < intervalNumber());
+            res.intervals.push_back({idx});
+        }
+    }
+
+    // Simulators are created lazily by their workers
+    std::vector<std::unique_ptr<Simulator>> sims(worker_number);
+
+    pool::WorkStealingPool pool{worker_number};
+    pool.run(res.intervals.size(), [&](size_t worker_idx, size_t job_idx) {
+        auto interval_start = Clock::now();
+
+        auto &sim = sims[worker_idx];
+        if (sim == nullptr) {
+            sim = std::make_unique<Simulator>();
+            sim->syscalls().setDropOutput(true);
+        } else {
+            sim->reset();
+        }
+
+        auto &interval = res.intervals[job_idx];
+        const auto &checkpoint = m_checkpoints[interval.idx];
+        interval.start_icount = checkpoint.icount;
+
+        restoreCheckpoint(*sim, checkpoint);
+
+        if (on_start) {
+            on_start(*sim, interval);
+        }
+
+        // Last interval runs until functional pass end
+        if (interval.idx + 1 == intervalNumber()) {
+            interval.status = sim->resume(std::numeric_limits<size_t>::max());
+        } else {
+            auto end_icount = m_checkpoints[interval.idx + 1].icount;
+            interval.status = sim->resume(end_icount - checkpoint.icount);
+
+            if (interval.status == SimStatus::SIM__ICOUNT_LIMIT) {
+                interval.status = SimStatus::OK;
+            }
+        }
+
+        interval.icount = sim->icount() - checkpoint.sim_icount;
+        interval.wall_time = secondsSince(interval_start);
+
+        if (on_end) {
+            on_end(*sim, interval);
+        }
+    });
+
+    for (auto &&interval : res.intervals) {
+        res.icount += interval.icount;
+    }
+    res.wall_time = secondsSince(start);
+
+    return res;
+}
+
+} // namespace sim::sampling
@@ -0,0 +1,386 @@
+#include <mutex>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <sim/sampling.hpp>
+
+namespace sim::sampling {
+
+class SamplingTest : public ::testing::Test {
+  protected:
+    static constexpr PhysAddr CODE_SEG_BASE = 0x5000000000;
+    static constexpr PhysAddr DATA_PAGE_PA = 0x6000000000;
+
+    static constexpr uint64_t N = 1000;
+    static constexpr size_t INTERVAL = 500;
+
+    // Sums [0, N) storing partial sums to DATA_PAGE_PA
+    const std::vector<InstrCode> CODE = {
+        0x0060039b, // addiw t2, zero, 6
+        0x02439393, // slli t2, t2, 36
+        0x00000293, // addi t0, zero, 0
+        0x3e800313, // addi t1, zero, 1000
+        0x00000593, // addi a1, zero, 0
+
+        // for:
+        0x0062da63, // bge t0, t1, end
+        0x005585b3, // add a1, a1, t0
+        0x00b3b023, // sd a1, 0(t2)
+        0x00128293, // addi t0, t0, 1
+        0xff1ff06f, // j for
+
+        // end:
+        0x0003b603, // ld a2, 0(t2)
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    // Fills DATA_PAGE_PA with 64-byte chunks of memset calls. Guest memset
+    // is a byte loop at MEMSET_VA. instret is read after every call
+    static constexpr VirtAddr MEMSET_VA = CODE_SEG_BASE + 60;
+
+    const std::vector<InstrCode> MEMSET_CODE = {
+        0x0060039b, // addiw t2, zero, 6
+        0x02439393, // slli t2, t2, 36
+        0x00000293, // addi t0, zero, 0
+        0x06400313, // addi t1, zero, 100
+
+        // loop:
+        0x0262d063, // bge t0, t1, end
+        0x00038513, // addi a0, t2, 0
+        0x00028593, // addi a1, t0, 0
+        0x04000613, // addi a2, zero, 64
+        0x01c000ef, // jal ra, memset
+        0xc0202773, // csrr a4, instret
+        0x00128293, // addi t0, t0, 1
+        0xfe5ff06f, // j loop
+
+        // end:
+        0xc02026f3, // csrr a3, instret
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073, // ecall
+
+        // memset:
+        0x00060a63, // beqz a2, ret
+        0x00b50023, // sb a1, 0(a0)
+        0x00150513, // addi a0, a0, 1
+        0xfff60613, // addi a2, a2, -1
+        0xff1ff06f, // j memset
+
+        // ret:
+        0x00008067 // ret
+    };
+
+    // Writes 2 bytes from each of 16 heap pages. Pages are touched one by one,
+    // so they are mapped in different intervals. s3 sums written bytes
+    const std::vector<InstrCode> HEAP_CODE = {
+        0x00000513, // addi a0, zero, 0
+        0x0d600893, // addi a7, zero, 214
+        0x00000073, // ecall
+        0x00050413, // addi s0, a0, 0
+        0x000102b7, // lui t0, 0x10
+        0x00540533, // add a0, s0, t0
+        0x00000073, // ecall
+        0x00000493, // addi s1, zero, 0
+        0x01000913, // addi s2, zero, 16
+        0x00000993, // addi s3, zero, 0
+
+        // loop:
+        0x0524d263, // bge s1, s2, end
+        0x00c49313, // slli t1, s1, 12
+        0x006405b3, // add a1, s0, t1
+        0x02a00393, // addi t2, zero, 42
+        0x00758023, // sb t2, 0(a1)
+        0x00a00393, // addi t2, zero, 10
+        0x007580a3, // sb t2, 1(a1)
+        0x00100513, // addi a0, zero, 1
+        0x00200613, // addi a2, zero, 2
+        0x04000893, // addi a7, zero, 64
+        0x00000073, // ecall
+        0x00a989b3, // add s3, s3, a0
+        0x03200e13, // addi t3, zero, 50
+
+        // spin:
+        0xfffe0e13, // addi t3, t3, -1
+        0xfe0e1ee3, // bnez t3, spin
+        0x00148493, // addi s1, s1, 1
+        0xfc1ff06f, // j loop
+
+        // end:
+        0x05d00893, // addi a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    void load(Simulator &sim, const std::vector<InstrCode> &code) {
+        auto &pm = sim.getPhysMemory();
+
+        SIM_ASSERT(pm.addRAMPage(CODE_SEG_BASE));
+        SIM_ASSERT(pm.addRAMPage(DATA_PAGE_PA));
+
+        for (size_t i = 0, end = code.size(); i != end; ++i) {
+            SIM_ASSERT(pm.write(CODE_SEG_BASE + i * INSTR_CODE_SIZE, code[i])
+                           .status == SimStatus::OK);
+        }
+    }
+};
+
+TEST_F(SamplingTest, checkpoints) {
+    Simulator sim{};
+    load(sim, CODE);
+
+    Sampler sampler{INTERVAL};
+    ASSERT_EQ(sampler.record(sim, CODE_SEG_BASE), SimStatus::OK);
+    ASSERT_EQ(sampler.icount(), sim.icount());
+
+    const auto &checkpoints = sampler.checkpoints();
+    ASSERT_GE(checkpoints.size(),
+              sampler.icount() / (INTERVAL + bb::Bb::MAX_SIZE));
+    ASSERT_LE(checkpoints.size(), sampler.icount() / INTERVAL + 1);
+
+    ASSERT_EQ(checkpoints.front().icount, 0);
+    ASSERT_EQ(checkpoints.front().pc, CODE_SEG_BASE);
+
+    for (size_t i = 1, end = checkpoints.size(); i != end; ++i) {
+        ASSERT_GE(checkpoints[i].icount, checkpoints[i - 1].icount + INTERVAL);
+
+        // Code page is never modified, so it is shared by all checkpoints
+        ASSERT_EQ(checkpoints[i].pages->find(CODE_SEG_BASE),
+                  checkpoints[0].pages->find(CODE_SEG_BASE));
+        ASSERT_NE(checkpoints[i].pages->find(DATA_PAGE_PA),
+                  checkpoints[i - 1].pages->find(DATA_PAGE_PA));
+    }
+}
+
+// Checkpoints hold dirty pages only, chains are cut with full page sets
+TEST_F(SamplingTest, pageSets) {
+    Simulator sim{};
+    load(sim, CODE);
+
+    Sampler sampler{100};
+    ASSERT_EQ(sampler.record(sim, CODE_SEG_BASE), SimStatus::OK);
+
+    const auto &checkpoints = sampler.checkpoints();
+    ASSERT_GT(checkpoints.size(), 2 * PageSet::MAX_DEPTH);
+
+    for (size_t i = 0, end = checkpoints.size(); i != end; ++i) {
+        const auto &pages = *checkpoints[i].pages;
+
+        ASSERT_EQ(pages.depth, i % PageSet::MAX_DEPTH);
+        ASSERT_EQ(pages.parent == nullptr, pages.depth == 0);
+        ASSERT_EQ(pages.pages.size(), pages.depth == 0 ? 2 : 1);
+        ASSERT_NE(pages.find(CODE_SEG_BASE), nullptr);
+
+        // Loop stores partial sum in a1 on each iteration
+        Simulator interval_sim{};
+        restoreCheckpoint(interval_sim, checkpoints[i]);
+
+        uint64_t sum = 0;
+        ASSERT_EQ(interval_sim.getPhysMemory().read(DATA_PAGE_PA, sum).status,
+                  SimStatus::OK);
+        ASSERT_EQ(sum, checkpoints[i].gpr_file.read<uint64_t>(
+                           gpr::GPR_IDX::A1));
+    }
+}
+
+TEST_F(SamplingTest, intervals) {
+    Simulator sim{};
+    load(sim, CODE);
+
+    Sampler sampler{INTERVAL};
+    ASSERT_EQ(sampler.record(sim, CODE_SEG_BASE), SimStatus::OK);
+
+    const auto &checkpoints = sampler.checkpoints();
+
+    // Hart state at the end of each interval
+    std::mutex mutex{};
+    std::vector<std::pair<VirtAddr, gpr::GPRFile>> end_states(
+        checkpoints.size());
+
+    auto res = sampler.simulate(
+        {}, 2, {}, [&](Simulator &interval_sim, IntervalResult &interval) {
+            std::lock_guard lock{mutex};
+            end_states[interval.idx] = {interval_sim.getHart().pc(),
+                                        interval_sim.getHart().gprFile()};
+        });
+
+    ASSERT_EQ(res.intervals.size(), checkpoints.size());
+    ASSERT_EQ(res.icount, sampler.icount());
+
+    for (size_t i = 0, end = res.intervals.size(); i != end; ++i) {
+        const auto &interval = res.intervals[i];
+
+        ASSERT_EQ(interval.idx, i);
+        ASSERT_EQ(interval.status, SimStatus::OK);
+        ASSERT_EQ(interval.start_icount, checkpoints[i].icount);
+
+        if (i + 1 == end) {
+            break;
+        }
+
+        // Interval ends in the state of next checkpoint
+        ASSERT_EQ(interval.icount,
+                  checkpoints[i + 1].icount - checkpoints[i].icount);
+        ASSERT_EQ(end_states[i].first, checkpoints[i + 1].pc);
+        for (size_t reg = 0; reg != gpr::GPR_NUMBER; ++reg) {
+            ASSERT_EQ(end_states[i].second.read<uint64_t>(reg),
+                      checkpoints[i + 1].gpr_file.read<uint64_t>(reg));
+        }
+    }
+
+    // Last interval reaches program end
+    auto sum = end_states.back().second.read<uint64_t>(gpr::GPR_IDX::A2);
+    ASSERT_EQ(sum, N * (N - 1) / 2);
+}
+
+TEST_F(SamplingTest, selectedIntervals) {
+    Simulator sim{};
+    load(sim, CODE);
+
+    Sampler sampler{INTERVAL};
+    ASSERT_EQ(sampler.record(sim, CODE_SEG_BASE), SimStatus::OK);
+    ASSERT_GT(sampler.intervalNumber(), 3);
+
+    auto res = sampler.simulate({1, 3}, 1);
+
+    ASSERT_EQ(res.intervals.size(), 2);
+    ASSERT_EQ(res.intervals[0].idx, 1);
+    ASSERT_EQ(res.intervals[1].idx, 3);
+    ASSERT_EQ(res.icount, res.intervals[0].icount + res.intervals[1].icount);
+}
+
+TEST_F(SamplingTest, hostFuncsAndCounters) {
+    Simulator sim{};
+    load(sim, MEMSET_CODE);
+    sim.setHostFunc(MEMSET_VA, Simulator::HostFunc::MEMSET);
+
+    Sampler sampler{INTERVAL};
+    ASSERT_EQ(sampler.record(sim, CODE_SEG_BASE), SimStatus::OK);
+
+    const auto &checkpoints = sampler.checkpoints();
+    ASSERT_GT(checkpoints.size(), 1);
+
+    // instret at program end
+    auto end_instret = sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A3);
+
+    std::mutex mutex{};
+    std::vector<gpr::GPRFile> end_gprs(checkpoints.size());
+
+    auto res = sampler.simulate(
+        {}, 2, {}, [&](Simulator &interval_sim, IntervalResult &interval) {
+            std::lock_guard lock{mutex};
+            end_gprs[interval.idx] = interval_sim.getHart().gprFile();
+        });
+
+    ASSERT_EQ(res.icount, sampler.icount());
+
+    // Intervals run host memset and read the same instret as functional pass
+    for (size_t i = 0, end = res.intervals.size(); i != end; ++i) {
+        const auto &interval = res.intervals[i];
+        ASSERT_EQ(interval.status, SimStatus::OK);
+
+        if (i + 1 == end) {
+            ASSERT_EQ(interval.icount,
+                      sampler.icount() - checkpoints[i].icount);
+            ASSERT_EQ(end_gprs[i].read<uint64_t>(gpr::GPR_IDX::A3),
+                      end_instret);
+            break;
+        }
+
+        ASSERT_EQ(interval.icount,
+                  checkpoints[i + 1].icount - checkpoints[i].icount);
+        ASSERT_EQ(end_gprs[i].read<uint64_t>(gpr::GPR_IDX::A4),
+                  checkpoints[i + 1].gpr_file.read<uint64_t>(gpr::GPR_IDX::A4));
+    }
+}
+
+TEST_F(SamplingTest, syscalls) {
+    Simulator sim{};
+    load(sim, HEAP_CODE);
+
+    // Code page is mapped at CODE_VA. Heap pages are mapped lazily from
+    // HEAP_PPN by copy of mapper kept in syscalls state
+    static constexpr VirtAddr CODE_VA = 0x10000;
+    static constexpr VirtAddr BRK_START = 0x100000;
+    static constexpr memory::PPN TABLE_REGION_SIZE = 0x10;
+    static constexpr memory::PPN HEAP_PPN = 0x100;
+
+    using Flags = memory::PTEFlags;
+    static constexpr Flags FLAGS{Flags::U_MASK | Flags::R_MASK |
+                                 Flags::W_MASK | Flags::X_MASK};
+
+    memory::SimpleMemoryMapper mapper{sim.getPhysMemory(),
+                                      csr::SATP64::MODEValue::SV39, 0,
+                                      TABLE_REGION_SIZE};
+    ASSERT_EQ(mapper.map({FLAGS, CODE_VA / memory::PAGE_SIZE,
+                          CODE_SEG_BASE / memory::PAGE_SIZE}),
+              SimStatus::OK);
+
+    sim.syscalls().setMemory(
+        BRK_START, [mapper, ppn = HEAP_PPN](memory::PhysMemory &pm,
+                                           memory::VPN vpn) mutable {
+            SIM_ASSERT(pm.addRAMPage(ppn * memory::PAGE_SIZE));
+            return mapper.map(pm, {FLAGS, vpn, ppn++});
+        });
+
+    csr::SATP64 satp64{};
+    satp64.setMODE(csr::SATP64::MODEValue::SV39);
+    sim.getHart().csrFile().set(satp64);
+
+    // Guest stdout goes to pipe
+    int pipe_fds[2] = {};
+    ASSERT_EQ(pipe2(pipe_fds, O_NONBLOCK), 0);
+
+    int saved_stdout = dup(STDOUT_FILENO);
+    ASSERT_NE(dup2(pipe_fds[1], STDOUT_FILENO), -1);
+
+    Sampler sampler{INTERVAL};
+    auto status = sampler.record(sim, CODE_VA);
+
+    char buf[64] = {};
+    auto recorded = read(pipe_fds[0], buf, sizeof(buf));
+
+    std::mutex mutex{};
+    std::vector<gpr::GPRFile> end_gprs(sampler.intervalNumber());
+
+    auto res = sampler.simulate(
+        {}, 2, {}, [&](Simulator &interval_sim, IntervalResult &interval) {
+            std::lock_guard lock{mutex};
+            end_gprs[interval.idx] = interval_sim.getHart().gprFile();
+        });
+
+    // Intervals don't repeat guest output
+    auto repeated = read(pipe_fds[0], buf, sizeof(buf));
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    ASSERT_EQ(status, SimStatus::OK);
+    ASSERT_EQ(recorded, 32);
+    ASSERT_EQ(repeated, -1);
+
+    const auto &checkpoints = sampler.checkpoints();
+    ASSERT_GT(checkpoints.size(), 2);
+    ASSERT_EQ(res.icount, sampler.icount());
+
+    // Intervals map heap pages and write as functional pass
+    for (size_t i = 0, end = res.intervals.size(); i != end; ++i) {
+        ASSERT_EQ(res.intervals[i].status, SimStatus::OK);
+
+        auto written = end_gprs[i].read<uint64_t>(gpr::GPR_IDX::S3);
+        if (i + 1 == end) {
+            ASSERT_EQ(written, 32);
+            break;
+        }
+
+        ASSERT_EQ(written,
+                  checkpoints[i + 1].gpr_file.read<uint64_t>(gpr::GPR_IDX::S3));
+    }
+}
+
+} // namespace sim::sampling
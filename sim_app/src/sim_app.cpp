@@ -1,18 +1,44 @@
+#include <charconv>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include <sim/batch.hpp>
+#include <sim/bpred.hpp>
+#include <sim/cache_model.hpp>
 #include <sim/common.hpp>
-#include <sim/elf_load.hpp>
 #include <sim/memory.hpp>
+#include <sim/plugin/manager.hpp>
+#include <sim/profile.hpp>
+#include <sim/sampling.hpp>
 #include <sim/simulator.hpp>
+#include <sim/stats.hpp>
+#include <sim/trace.hpp>
+#include <sim/trace/mem_trace.hpp>
+#include <sim/translator.hpp>
 
 using namespace sim;
 
 namespace {
 
+constexpr size_t PROFILE_TOP_NUMBER = 20;
+
+// SimPoint default interval
+constexpr size_t DEFAULT_BBV_INTERVAL = 100000000;
+
+// Call graph default sampling interval
+constexpr size_t DEFAULT_CALL_GRAPH_INTERVAL = 10000;
+
 void dump_gpr_file(const gpr::GPRFile &gpr_file) {
     std::cout << std::setfill('0');
 
@@ -28,38 +54,370 @@ void dump_gpr_file(const gpr::GPRFile &gpr_file) {
     std::cout << std::setfill(' ') << std::dec;
 }
 
-} // namespace
+void print_usage(const char *app_name) {
+    std::cerr << "Usage:" << std::endl
+              << "  " << app_name
+              << " [--translate <workers>] [--host-funcs] [--trace <file>]"
+              << " [--mem-trace <file>]"
+              << " [--profile <report>] [--stats <json>]"
+              << " [--instr-mix <json | csv>]"
+              << " [--bbv <file> [--bbv-interval <n>]]"
+              << " [--cache <report> [--cache-level <level>=<config>]..."
+              << " [--cache-sampling <n>]]"
+              << " [--bpred <predictor> [--bpred-report <report>]]"
+              << " [--call-graph <folded> [--call-graph-interval <n> |"
+              << " --call-graph-timer <us>]]"
+              << " [--plugin <so>[,<args>]]... <elf>" << std::endl
+              << "    cache level: l1i | l1d | l2, config:"
+              << " <size>:<assoc>:<line size>:<lru | fifo | random>"
+              << std::endl
+              << "    predictor: bimodal | gshare | tage-lite" << std::endl
+              << "  " << app_name
+              << " --batch [--jobs <n>] [--share-code] <elf | @manifest>..."
+              << std::endl
+              << "  " << app_name
+              << " --sample <interval> [--period <k>] [--jobs <n>]"
+              << " [--bbv <file>] [<model options>] <elf>" << std::endl
+              << "    model options: --host-funcs, --profile, --stats,"
+              << " --instr-mix, --cache*, --bpred*" << std::endl;
+}
 
-int main(int argc, char **argv) {
-    SIM_ASSERT(argc == 2);
+// Parse whole string as decimal number
+bool parse_size(const char *str, size_t &value) {
+    const auto *end = str + std::strlen(str);
+    auto [ptr, ec] = std::from_chars(str, end, value);
+    return ec == std::errc{} && ptr == end && ptr != str;
+}
+
+// Parse numeric value of option at argv[i]. Usage is printed on error
+bool parse_option_size(char **argv, int i, size_t &value) {
+    if (parse_size(argv[i + 1], value)) {
+        return true;
+    }
+
+    std::cerr << "Invalid " << argv[i] << " value " << argv[i + 1]
+              << std::endl;
+    print_usage(argv[0]);
+    return false;
+}
+
+void dump_translator_stats(const translator::Stats &stats) {
+    std::cout << "translator: requests = " << stats.requests
+              << ", completed = " << stats.completed
+              << ", dropped = " << stats.dropped
+              << ", max queue depth = " << stats.max_queue_depth
+              << ", avg latency = " << stats.avg_latency_us
+              << " us, max latency = " << stats.max_latency_us << " us"
+              << std::endl;
+}
+
+void add_translator_stats(stats::Registry &registry,
+                          const translator::Stats &stats) {
+    registry.add("translator.requests", stats.requests);
+    registry.add("translator.completed", stats.completed);
+    registry.add("translator.dropped", stats.dropped);
+    registry.add("translator.max_queue_depth", stats.max_queue_depth);
+    registry.add("translator.avg_latency_us", stats.avg_latency_us);
+    registry.add("translator.max_latency_us", stats.max_latency_us);
+}
+
+// Single ELF run options
+struct SingleOptions final {
+    const char *elf_path = nullptr;
+    size_t translate_workers = 0;
+    bool host_funcs = false;
+    const char *trace_path = nullptr;
+    const char *mem_trace_path = nullptr;
+    const char *profile_path = nullptr;
+    const char *stats_path = nullptr;
+    const char *instr_mix_path = nullptr;
+    const char *bbv_path = nullptr;
+    size_t bbv_interval = DEFAULT_BBV_INTERVAL;
+    const char *cache_path = nullptr;
+    cache_model::Hierarchy::Config cache_config{};
+    const char *bpred_name = nullptr;
+    const char *bpred_report_path = nullptr;
+    const char *call_graph_path = nullptr;
+    size_t call_graph_interval = DEFAULT_CALL_GRAPH_INTERVAL;
+    // Host timer period. Zero period leaves interval sampling
+    size_t call_graph_timer_us = 0;
+    // "<shared object>[,<args>]" specs
+    std::vector<std::string_view> plugin_specs{};
+};
+
+// Parse "<l1i | l1d | l2>=<cache config>" level spec
+bool parse_cache_level(std::string_view spec,
+                       cache_model::Hierarchy::Config &config) {
+    auto eq = spec.find('=');
+    if (eq == std::string_view::npos) {
+        return false;
+    }
+
+    auto name = spec.substr(0, eq);
+    cache_model::CacheConfig *level = name == "l1i"   ? &config.l1i
+                                      : name == "l1d" ? &config.l1d
+                                      : name == "l2"  ? &config.l2
+                                                      : nullptr;
+
+    return level != nullptr &&
+           cache_model::parseCacheConfig(spec.substr(eq + 1), *level);
+}
+
+// Results of models enabled by run options
+struct ModelResults final {
+    size_t icount = 0;
+    std::vector<profile::BbCounters> bb_counters{};
+    profile::InstrMix instr_mix{};
+    const cache_model::Hierarchy *cache_model = nullptr;
+    const bpred::Model *bpred_model = nullptr;
+};
+
+void write_model_reports(const SingleOptions &options,
+                         const ModelResults &results,
+                         const elf::SymbolIndex &symbols) {
+    if (results.cache_model != nullptr) {
+        std::ofstream report{options.cache_path};
+        cache_model::writeReport(report, *results.cache_model, symbols,
+                                 PROFILE_TOP_NUMBER);
+    }
+
+    if (results.bpred_model != nullptr) {
+        const auto &model = *results.bpred_model;
+        std::cout << "bpred: cond branches = "
+                  << model.condBranches().executions
+                  << ", mispredicts = " << model.mispredicts()
+                  << ", mpki = "
+                  << bpred::mpki(model.mispredicts(), results.icount)
+                  << std::endl;
+
+        if (options.bpred_report_path != nullptr) {
+            std::ofstream report{options.bpred_report_path};
+            bpred::writeReport(report, model, results.icount, symbols,
+                               PROFILE_TOP_NUMBER);
+        }
+    }
+
+    if (options.profile_path != nullptr) {
+        std::ofstream report{options.profile_path};
+        profile::writeReport(report, results.bb_counters, symbols,
+                             PROFILE_TOP_NUMBER);
+    }
+
+    if (options.instr_mix_path != nullptr) {
+        std::ofstream out{options.instr_mix_path};
+        if (std::string_view{options.instr_mix_path}.ends_with(".csv")) {
+            profile::writeInstrMixCsv(out, results.instr_mix);
+        } else {
+            stats::Registry registry{};
+            profile::collectInstrMix(registry, results.instr_mix);
+            registry.writeJson(out);
+        }
+    }
+}
+
+void add_model_stats(stats::Registry &registry, const SingleOptions &options,
+                     const ModelResults &results) {
+    if (results.cache_model != nullptr) {
+        results.cache_model->collectStats(registry);
+    }
+    if (results.bpred_model != nullptr) {
+        results.bpred_model->collectStats(registry, results.icount);
+    }
+    if (options.instr_mix_path != nullptr) {
+        profile::collectInstrMix(registry, results.instr_mix);
+    }
+}
+
+int run_single(const SingleOptions &options) {
+    auto simulator = sim::Simulator();
+
+    std::unique_ptr<trace::Writer> tracer = nullptr;
+    if (options.trace_path != nullptr) {
+#ifndef SIM_TRACE_ENABLE
+        std::cerr << "Execution trace is disabled in this build" << std::endl;
+#endif
+        tracer = std::make_unique<trace::Writer>(options.trace_path);
+        if (!tracer->isOpen()) {
+            std::cerr << "Failed to open trace " << options.trace_path
+                      << std::endl;
+            return -1;
+        }
+
+        simulator.setTracer(tracer.get());
+    }
+
+    std::unique_ptr<trace::MemWriter> mem_tracer = nullptr;
+    if (options.mem_trace_path != nullptr) {
+#ifndef SIM_MEM_TRACE_ENABLE
+        std::cerr << "Memory trace is disabled in this build" << std::endl;
+#endif
+        mem_tracer = std::make_unique<trace::MemWriter>(options.mem_trace_path);
+        if (!mem_tracer->isOpen()) {
+            std::cerr << "Failed to open memory trace "
+                      << options.mem_trace_path << std::endl;
+            return -1;
+        }
+
+        simulator.setMemTracer(mem_tracer.get());
+    }
+
+    std::unique_ptr<translator::Translator> translator = nullptr;
+    if (options.translate_workers != 0) {
+        translator = std::make_unique<translator::Translator>(
+            options.translate_workers);
+        simulator.setTranslator(translator.get());
+    }
+
+    profile::BbProfiler profiler{};
+    if (options.profile_path != nullptr) {
+        simulator.setProfiler(&profiler);
+    }
+
+    profile::InstrMixRecorder instr_mix{};
+    if (options.instr_mix_path != nullptr) {
+        simulator.setInstrMixRecorder(&instr_mix);
+    }
 
-#ifdef SIM_LOG_ENABLE
-    std::ofstream log{"log.txt"};
-    auto *log_ptr = &log;
-#else
-    std::ofstream *log_ptr = nullptr;
+    std::unique_ptr<cache_model::Hierarchy> cache_model = nullptr;
+    if (options.cache_path != nullptr) {
+#ifndef SIM_CACHE_MODEL_ENABLE
+        std::cerr << "Cache model is disabled in this build" << std::endl;
 #endif
+        cache_model =
+            std::make_unique<cache_model::Hierarchy>(options.cache_config);
+        simulator.setCacheModel(cache_model.get());
+    }
 
-    auto simulator = sim::Simulator(log_ptr);
-    auto &pm = simulator.getPhysMemory();
+    std::unique_ptr<bpred::Model> bpred_model = nullptr;
+    if (options.bpred_name != nullptr) {
+#ifndef SIM_BPRED_ENABLE
+        std::cerr << "Branch predictor model is disabled in this build"
+                  << std::endl;
+#endif
+        bpred_model = bpred::makeModel(options.bpred_name);
+        simulator.setBranchModel(bpred_model.get());
+    }
 
-    elf::ElfLoader loader{pm};
+    std::unique_ptr<profile::CallGraphSampler> call_graph = nullptr;
+    std::unique_ptr<profile::ProfTimer> prof_timer = nullptr;
+    if (options.call_graph_path != nullptr) {
+        auto timer_period =
+            std::chrono::microseconds(options.call_graph_timer_us);
 
-    auto [stack_map_status, start_sp] = loader.mapStack();
-    SIM_ASSERT(stack_map_status == SimStatus::OK);
-    simulator.getHart().gprFile().write(gpr::GPR_IDX::SP, start_sp);
+        call_graph = std::make_unique<profile::CallGraphSampler>(
+            timer_period.count() != 0 ? 0 : options.call_graph_interval);
+        simulator.setCallGraphSampler(call_graph.get());
 
-    auto [load_elf_status, start_pc] = loader.loadElf(argv[1]);
-    SIM_ASSERT(load_elf_status == SimStatus::OK);
+        if (timer_period.count() != 0) {
+            prof_timer = std::make_unique<profile::ProfTimer>(
+                timer_period,
+                [](void *ctx) {
+                    static_cast<Simulator *>(ctx)->postIpi(
+                        Simulator::IPI_CALL_GRAPH_SAMPLE);
+                },
+                &simulator);
+        }
+    }
 
-    csr::SATP64 satp64{};
-    satp64.setMODE(csr::SATP64::MODEValue::SV39);
-    simulator.getHart().csrFile().set(satp64);
+    plugin::Manager plugins{};
+    for (auto spec : options.plugin_specs) {
+        auto comma = spec.find(',');
+        auto path = std::string{spec.substr(0, comma)};
+        auto args = comma == std::string_view::npos
+                        ? std::string{}
+                        : std::string{spec.substr(comma + 1)};
 
-    auto status = simulator.simulate(start_pc);
+        if (plugins.load(path, args) != SimStatus::OK) {
+            std::cerr << "Failed to load plugin " << path << ": "
+                      << plugins.loadError() << std::endl;
+            return -1;
+        }
+    }
+    if (!plugins.empty()) {
+        simulator.setPlugins(&plugins);
+    }
+
+    std::ofstream bbv_out{};
+    std::unique_ptr<profile::BbvRecorder> bbv_recorder = nullptr;
+    if (options.bbv_path != nullptr) {
+        bbv_out.open(options.bbv_path);
+        bbv_recorder = std::make_unique<profile::BbvRecorder>(
+            bbv_out, options.bbv_interval);
+        simulator.setBbvRecorder(bbv_recorder.get());
+    }
+
+    auto load_res =
+        batch::loadElf(simulator, options.elf_path, options.host_funcs);
+
+    auto status = load_res.status;
+    if (status == SimStatus::OK) {
+        status = simulator.simulate(load_res.start_pc);
+    }
 
     std::cout << "icount = " << simulator.icount() << std::endl;
 
+    prof_timer.reset();
+    if (call_graph) {
+        std::cout << "call graph: samples = " << call_graph->sampleNumber()
+                  << std::endl;
+
+        std::ofstream out{options.call_graph_path};
+        profile::writeFoldedStacks(out, *call_graph, load_res.symbols);
+    }
+
+    plugins.exit(simulator.getHart(), simulator.icount());
+
+    if (tracer) {
+        simulator.setTracer(nullptr);
+        tracer->close();
+        std::cout << "trace: records = " << tracer->recordNumber()
+                  << std::endl;
+    }
+
+    if (mem_tracer) {
+        simulator.setMemTracer(nullptr);
+        mem_tracer->close();
+        std::cout << "mem trace: records = " << mem_tracer->recordNumber()
+                  << ", bytes = " << mem_tracer->byteNumber() << std::endl;
+    }
+
+    if (translator) {
+        dump_translator_stats(translator->stats());
+    }
+
+    if (bbv_recorder) {
+        bbv_recorder->finish();
+    }
+
+    ModelResults results{};
+    results.icount = simulator.icount();
+    if (options.profile_path != nullptr) {
+        results.bb_counters = profiler.counters();
+    }
+    if (options.instr_mix_path != nullptr) {
+        results.instr_mix = instr_mix.mix();
+    }
+    results.cache_model = cache_model.get();
+    results.bpred_model = bpred_model.get();
+
+    write_model_reports(options, results, load_res.symbols);
+
+    if (options.stats_path != nullptr) {
+        if constexpr (!stats::ENABLED) {
+            std::cerr << "Stats are disabled in this build" << std::endl;
+        }
+
+        stats::Registry registry{};
+        simulator.collectStats(registry);
+        if (translator) {
+            add_translator_stats(registry, translator->stats());
+        }
+        add_model_stats(registry, options, results);
+
+        std::ofstream out{options.stats_path};
+        registry.writeJson(out);
+    }
+
     std::cout << "GPRs:" << std::endl;
     dump_gpr_file(simulator.getHart().gprFile());
 
@@ -74,3 +432,427 @@ int main(int argc, char **argv) {
 
     SIM_UNREACHABLE();
 }
+
+// Parse single run options. Errors are printed
+bool parse_single_options(int argc, char **argv, SingleOptions &options) {
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && std::strcmp(argv[i], "--translate") == 0) {
+            if (!parse_option_size(argv, i++, options.translate_workers)) {
+                return false;
+            }
+            options.translate_workers =
+                std::max(1UL, options.translate_workers);
+        } else if (std::strcmp(argv[i], "--host-funcs") == 0) {
+            options.host_funcs = true;
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--trace") == 0) {
+            options.trace_path = argv[++i];
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--mem-trace") == 0) {
+            options.mem_trace_path = argv[++i];
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--profile") == 0) {
+            options.profile_path = argv[++i];
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--stats") == 0) {
+            options.stats_path = argv[++i];
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--instr-mix") == 0) {
+            options.instr_mix_path = argv[++i];
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--bbv") == 0) {
+            options.bbv_path = argv[++i];
+        } else if (i + 1 < argc &&
+                   std::strcmp(argv[i], "--bbv-interval") == 0) {
+            if (!parse_option_size(argv, i++, options.bbv_interval)) {
+                return false;
+            }
+            options.bbv_interval = std::max(1UL, options.bbv_interval);
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--cache") == 0) {
+            options.cache_path = argv[++i];
+        } else if (i + 1 < argc &&
+                   std::strcmp(argv[i], "--cache-level") == 0) {
+            if (!parse_cache_level(argv[++i], options.cache_config)) {
+                std::cerr << "Invalid cache level " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (i + 1 < argc &&
+                   std::strcmp(argv[i], "--cache-sampling") == 0) {
+            if (!parse_option_size(argv, i++,
+                                   options.cache_config.set_sampling)) {
+                return false;
+            }
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--bpred") == 0) {
+            options.bpred_name = argv[++i];
+        } else if (i + 1 < argc &&
+                   std::strcmp(argv[i], "--bpred-report") == 0) {
+            options.bpred_report_path = argv[++i];
+        } else if (i + 1 < argc &&
+                   std::strcmp(argv[i], "--call-graph") == 0) {
+            options.call_graph_path = argv[++i];
+        } else if (i + 1 < argc &&
+                   std::strcmp(argv[i], "--call-graph-interval") == 0) {
+            if (!parse_option_size(argv, i++, options.call_graph_interval)) {
+                return false;
+            }
+            options.call_graph_interval =
+                std::max(1UL, options.call_graph_interval);
+        } else if (i + 1 < argc &&
+                   std::strcmp(argv[i], "--call-graph-timer") == 0) {
+            if (!parse_option_size(argv, i++, options.call_graph_timer_us)) {
+                return false;
+            }
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--plugin") == 0) {
+            options.plugin_specs.emplace_back(argv[++i]);
+        } else {
+            options.elf_path = argv[i];
+        }
+    }
+
+    if (options.elf_path == nullptr) {
+        print_usage(argv[0]);
+        return false;
+    }
+
+    if (!options.cache_config.isValid()) {
+        std::cerr << "Invalid cache model config" << std::endl;
+        return false;
+    }
+
+    if (options.bpred_name != nullptr &&
+        bpred::makeModel(options.bpred_name) == nullptr) {
+        std::cerr << "Unknown branch predictor " << options.bpred_name
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int run_single_args(int argc, char **argv) {
+    SingleOptions options{};
+    if (!parse_single_options(argc, argv, options)) {
+        return -1;
+    }
+
+    return run_single(options);
+}
+
+int run_batch(size_t jobs, bool share_code,
+              const std::vector<std::string> &elf_paths) {
+    auto res = batch::BatchRunner{jobs, share_code}.run(elf_paths);
+
+    int ret = 0;
+    for (auto &&job : res.jobs) {
+        std::cout << job.elf_path << ": status = "
+                  << sim::to_underlying(job.status)
+                  << ", icount = " << job.icount << ", time = " << job.wall_time
+                  << " s" << std::endl;
+
+        if (job.status != SimStatus::OK) {
+            ret = -1;
+        }
+    }
+
+    std::cout << "jobs = " << res.jobs.size() << ", icount = " << res.icount
+              << ", time = " << res.wall_time << " s, MIPS = " << res.mips()
+              << std::endl;
+
+    return ret;
+}
+
+// Models of one re-simulated interval
+struct IntervalModels final {
+    profile::BbProfiler profiler{};
+    profile::InstrMixRecorder instr_mix{};
+    std::unique_ptr<cache_model::Hierarchy> cache_model = nullptr;
+    std::unique_ptr<bpred::Model> bpred_model = nullptr;
+};
+
+// Models enabled by options are attached to simulator of every re-simulated
+// interval. Their results are merged when the interval ends
+class SampledModels final {
+    const SingleOptions &m_options;
+
+    std::mutex m_mutex{};
+    std::unordered_map<const Simulator *, std::unique_ptr<IntervalModels>>
+        m_running{};
+
+    std::map<VirtAddr, profile::BbCounters> m_bb_counters{};
+    profile::InstrMix m_instr_mix{};
+    std::unique_ptr<cache_model::Hierarchy> m_cache_model = nullptr;
+    std::unique_ptr<bpred::Model> m_bpred_model = nullptr;
+
+  public:
+    explicit SampledModels(const SingleOptions &options) : m_options(options) {
+        if (options.cache_path != nullptr) {
+#ifndef SIM_CACHE_MODEL_ENABLE
+            std::cerr << "Cache model is disabled in this build" << std::endl;
+#endif
+            m_cache_model =
+                std::make_unique<cache_model::Hierarchy>(options.cache_config);
+        }
+        if (options.bpred_name != nullptr) {
+#ifndef SIM_BPRED_ENABLE
+            std::cerr << "Branch predictor model is disabled in this build"
+                      << std::endl;
+#endif
+            m_bpred_model = bpred::makeModel(options.bpred_name);
+        }
+    }
+
+    void start(Simulator &sim) {
+        auto models = std::make_unique<IntervalModels>();
+
+        if (m_options.profile_path != nullptr) {
+            sim.setProfiler(&models->profiler);
+        }
+        if (m_options.instr_mix_path != nullptr) {
+            sim.setInstrMixRecorder(&models->instr_mix);
+        }
+        if (m_cache_model) {
+            models->cache_model = std::make_unique<cache_model::Hierarchy>(
+                m_options.cache_config);
+            sim.setCacheModel(models->cache_model.get());
+        }
+        if (m_bpred_model) {
+            models->bpred_model = bpred::makeModel(m_options.bpred_name);
+            sim.setBranchModel(models->bpred_model.get());
+        }
+
+        std::lock_guard lock{m_mutex};
+        m_running.emplace(&sim, std::move(models));
+    }
+
+    void end(Simulator &sim) {
+        sim.setProfiler(nullptr);
+        sim.setInstrMixRecorder(nullptr);
+        sim.setCacheModel(nullptr);
+        sim.setBranchModel(nullptr);
+
+        std::lock_guard lock{m_mutex};
+        auto node = m_running.extract(&sim);
+        SIM_ASSERT(!node.empty());
+        const auto &models = *node.mapped();
+
+        if (m_options.profile_path != nullptr) {
+            for (auto &&bb : models.profiler.counters()) {
+                auto &total = m_bb_counters[bb.virt_addr];
+                total.virt_addr = bb.virt_addr;
+                total.entries += bb.entries;
+                total.icount += bb.icount;
+            }
+        }
+        if (m_options.instr_mix_path != nullptr) {
+            auto mix = models.instr_mix.mix();
+            for (size_t i = 0; i != mix.size(); ++i) {
+                m_instr_mix[i] += mix[i];
+            }
+        }
+        if (m_cache_model) {
+            m_cache_model->merge(*models.cache_model);
+        }
+        if (m_bpred_model) {
+            m_bpred_model->merge(*models.bpred_model);
+        }
+    }
+
+    // Merged results of ended intervals
+    NODISCARD ModelResults results(size_t icount) const {
+        ModelResults results{};
+        results.icount = icount;
+        for (auto &&[virt_addr, bb] : m_bb_counters) {
+            results.bb_counters.push_back(bb);
+        }
+        results.instr_mix = m_instr_mix;
+        results.cache_model = m_cache_model.get();
+        results.bpred_model = m_bpred_model.get();
+
+        return results;
+    }
+};
+
+// Functional pass with checkpoints every interval instructions, then
+// parallel re-simulation of every period-th interval. Bb vectors of
+// functional pass intervals are written to bbv_path if it is set. Models
+// enabled by options run on re-simulated intervals only
+int run_sampled(size_t interval, size_t period, size_t jobs,
+                const SingleOptions &options) {
+    sim::Simulator simulator{};
+
+    auto load_res =
+        batch::loadElf(simulator, options.elf_path, options.host_funcs);
+    if (load_res.status != SimStatus::OK) {
+        std::cout << "Error: " << sim::to_underlying(load_res.status)
+                  << std::endl;
+        return -1;
+    }
+
+    std::ofstream bbv_out{};
+    std::unique_ptr<profile::BbvRecorder> bbv_recorder = nullptr;
+    if (options.bbv_path != nullptr) {
+        bbv_out.open(options.bbv_path);
+        bbv_recorder =
+            std::make_unique<profile::BbvRecorder>(bbv_out, interval);
+        simulator.setBbvRecorder(bbv_recorder.get());
+    }
+
+    sampling::Sampler sampler{interval};
+    auto status = sampler.record(simulator, load_res.start_pc);
+
+    if (bbv_recorder) {
+        simulator.setBbvRecorder(nullptr);
+        bbv_recorder->finish();
+    }
+
+    std::cout << "functional: status = " << sim::to_underlying(status)
+              << ", icount = " << sampler.icount()
+              << ", checkpoints = " << sampler.intervalNumber()
+              << ", time = " << sampler.wallTime() << " s" << std::endl;
+
+    std::vector<size_t> intervals{};
+    for (size_t i = 0; i < sampler.intervalNumber(); i += period) {
+        intervals.push_back(i);
+    }
+
+    SampledModels models{options};
+    auto res = sampler.simulate(
+        intervals, jobs,
+        [&models](Simulator &sim, sampling::IntervalResult &) {
+            models.start(sim);
+        },
+        [&models](Simulator &sim, sampling::IntervalResult &) {
+            models.end(sim);
+        });
+
+    int ret = status == SimStatus::OK ? 0 : -1;
+    for (auto &&interval : res.intervals) {
+        std::cout << "interval " << interval.idx
+                  << ": start = " << interval.start_icount
+                  << ", status = " << sim::to_underlying(interval.status)
+                  << ", icount = " << interval.icount
+                  << ", time = " << interval.wall_time << " s" << std::endl;
+
+        if (interval.status != SimStatus::OK) {
+            ret = -1;
+        }
+    }
+
+    std::cout << "intervals = " << res.intervals.size()
+              << ", icount = " << res.icount << ", time = " << res.wall_time
+              << " s, MIPS = " << res.mips() << std::endl;
+
+    auto results = models.results(res.icount);
+    write_model_reports(options, results, load_res.symbols);
+
+    if (options.stats_path != nullptr) {
+        if constexpr (!stats::ENABLED) {
+            std::cerr << "Stats are disabled in this build" << std::endl;
+        }
+
+        stats::Registry registry{};
+        add_model_stats(registry, options, results);
+
+        std::ofstream out{options.stats_path};
+        registry.writeJson(out);
+    }
+
+    return ret;
+}
+
+int run_sampled_args(int argc, char **argv) {
+    size_t interval = 0;
+    size_t period = 1;
+    size_t jobs = std::max(1U, std::thread::hardware_concurrency());
+    // Single run options are parsed from the rest of args
+    std::vector<char *> single_argv{argv[0]};
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && std::strcmp(argv[i], "--sample") == 0) {
+            if (!parse_option_size(argv, i++, interval)) {
+                return -1;
+            }
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--period") == 0) {
+            if (!parse_option_size(argv, i++, period)) {
+                return -1;
+            }
+            period = std::max(1UL, period);
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--jobs") == 0) {
+            if (!parse_option_size(argv, i++, jobs)) {
+                return -1;
+            }
+            jobs = std::max(1UL, jobs);
+        } else {
+            single_argv.push_back(argv[i]);
+        }
+    }
+
+    SingleOptions options{};
+    if (!parse_single_options(static_cast<int>(single_argv.size()),
+                              single_argv.data(), options)) {
+        return -1;
+    }
+
+    // Bbvs are recorded per sampling interval, and whole run instruments
+    // are not meaningful for separate intervals
+    if (options.translate_workers != 0 || options.trace_path != nullptr ||
+        options.mem_trace_path != nullptr ||
+        options.call_graph_path != nullptr ||
+        !options.plugin_specs.empty() ||
+        options.bbv_interval != DEFAULT_BBV_INTERVAL) {
+        std::cerr << "Option is not supported with --sample" << std::endl;
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    if (interval == 0) {
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    return run_sampled(interval, period, jobs, options);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--sample") == 0) {
+        return run_sampled_args(argc, argv);
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--batch") != 0) {
+        return run_single_args(argc, argv);
+    }
+
+    if (argc < 2 || std::strcmp(argv[1], "--batch") != 0) {
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    size_t jobs = std::max(1U, std::thread::hardware_concurrency());
+    bool share_code = false;
+    std::vector<std::string> elf_paths{};
+
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            if (!parse_option_size(argv, i++, jobs)) {
+                return -1;
+            }
+            jobs = std::max(1UL, jobs);
+            continue;
+        }
+
+        if (std::strcmp(argv[i], "--share-code") == 0) {
+            share_code = true;
+            continue;
+        }
+
+        // @manifest adds paths listed in manifest file
+        if (argv[i][0] == '@') {
+            if (!batch::readManifest(argv[i] + 1, elf_paths)) {
+                std::cerr << "Failed to read manifest " << argv[i] + 1
+                          << std::endl;
+                return -1;
+            }
+            continue;
+        }
+
+        elf_paths.emplace_back(argv[i]);
+    }
+
+    return run_batch(jobs, share_code, elf_paths);
+}
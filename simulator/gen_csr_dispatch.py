@@ -0,0 +1,94 @@
+import yaml
+import sys
+import os
+
+CSR_NUMBER = 4096
+
+# CSRs with bits [11:10] set are read-only
+READ_ONLY_MASK = 0xc00
+
+def gen_file_open() -> str :
+    return """
+        #ifndef SIMULATOR_CSR_DISPATCH_GEN_HPP
+        #define SIMULATOR_CSR_DISPATCH_GEN_HPP
+
+        namespace sim {
+
+    """
+
+def gen_csr_idxs(csrs: dict) -> dict :
+    idxs = {}
+
+    for csr_name, csr_descr in csrs.items() :
+        csr_idx = csr_descr["idx"]
+
+        if "number" in csr_descr :
+            first = csr_descr["first"]
+
+            for i in range(csr_descr["number"]) :
+                idxs[csr_idx + i] = (csr_name + str(first + i)).upper()
+            continue
+
+        idxs[csr_idx] = csr_name.upper()
+
+    return idxs
+
+# Dense table indexed by CSR number, so CSR access is one indirect call
+def gen_table(method: str, handler: str, ptr_type: str, idxs: dict,
+              writable_only: bool) -> str :
+    out = "inline Simulator::%s Simulator::%s(csr::CSRIdx idx) noexcept {" %\
+        (ptr_type, method)
+
+    out += "static constexpr %s TABLE[] = {\n" % ptr_type
+
+    for csr_idx in range(CSR_NUMBER) :
+        name = idxs.get(csr_idx, None)
+        is_read_only = (csr_idx & READ_ONLY_MASK) == READ_ONLY_MASK
+
+        if name is None or (writable_only and is_read_only) :
+            out += "nullptr,\n"
+            continue
+
+        out += "%s<csr::CSRIdx::%s>,\n" % (handler, name)
+
+    out += """
+            };
+
+            return TABLE[to_underlying(idx)];
+        }
+
+    """
+
+    return out
+
+def gen_file_close() -> str :
+    return """
+        } // namespace sim
+
+        #endif // SIMULATOR_CSR_DISPATCH_GEN_HPP
+
+    """
+
+def main() :
+    IN_NAME = sys.argv[1]
+    OUT_NAME = sys.argv[2]
+
+    with open(IN_NAME, 'r') as file :
+        csrs = yaml.safe_load(file)
+
+    idxs = gen_csr_idxs(csrs)
+
+    out = open(OUT_NAME, 'w')
+
+    out.write(gen_file_open())
+
+    out.write(gen_table("csrReader", "readCSR", "CSRReadPtr", idxs, False))
+    out.write(gen_table("csrWriter", "writeCSR", "CSRWritePtr", idxs, True))
+
+    out.write(gen_file_close())
+
+    out.close()
+    os.system("clang-format -i %s" % OUT_NAME)
+
+if __name__ == "__main__" :
+    main()
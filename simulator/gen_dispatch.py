@@ -10,7 +10,48 @@ IMPLEMENTED_INSTRS = [
     "SUBW", "SLLW", "SRLW", "SRAW", "LD", "LW", "LWU",
     "LH", "LHU", "LB", "LBU", "SD", "SW", "SH", "SB",
     "JAL", "JALR", "BEQ", "BNE", "BLT", "BLTU", "BGE",
-    "BGEU", "ECALL"
+    "BGEU", "ECALL", "FENCE", "FENCE_I",
+    "MUL", "MULH", "MULHSU", "MULHU", "DIV", "DIVU", "REM", "REMU",
+    "MULW", "DIVW", "DIVUW", "REMW", "REMUW",
+    "FLW", "FSW", "FADD_S", "FSUB_S", "FMUL_S", "FDIV_S", "FSQRT_S",
+    "FMADD_S", "FMSUB_S", "FNMSUB_S", "FNMADD_S", "FSGNJ_S", "FSGNJN_S",
+    "FSGNJX_S", "FMIN_S", "FMAX_S", "FEQ_S", "FLT_S", "FLE_S",
+    "FCLASS_S", "FCVT_W_S", "FCVT_S_W", "FCVT_WU_S", "FCVT_S_WU",
+    "FCVT_L_S", "FCVT_S_L", "FCVT_LU_S", "FCVT_S_LU", "FLD", "FSD",
+    "FADD_D", "FSUB_D", "FMUL_D", "FDIV_D", "FSQRT_D", "FMADD_D",
+    "FMSUB_D", "FNMSUB_D", "FNMADD_D", "FSGNJ_D", "FSGNJN_D",
+    "FSGNJX_D", "FMIN_D", "FMAX_D", "FEQ_D", "FLT_D", "FLE_D",
+    "FCLASS_D", "FCVT_W_D", "FCVT_D_W", "FCVT_WU_D", "FCVT_D_WU",
+    "FCVT_L_D", "FCVT_D_L", "FCVT_LU_D", "FCVT_D_LU", "FMV_X_W",
+    "FMV_W_X", "FMV_X_D", "FMV_D_X", "FCVT_S_D", "FCVT_D_S",
+    "AMOADD_W", "AMOXOR_W", "AMOOR_W", "AMOAND_W", "AMOMIN_W",
+    "AMOMAX_W", "AMOMINU_W", "AMOMAXU_W", "AMOSWAP_W", "LR_W", "SC_W",
+    "AMOADD_D", "AMOXOR_D", "AMOOR_D", "AMOAND_D", "AMOMIN_D",
+    "AMOMAX_D", "AMOMINU_D", "AMOMAXU_D", "AMOSWAP_D", "LR_D", "SC_D",
+    "ADD_UW", "SH1ADD", "SH2ADD", "SH3ADD", "SH1ADD_UW", "SH2ADD_UW",
+    "SH3ADD_UW", "SLLI_UW", "ANDN", "ORN", "XNOR", "CLZ", "CLZW", "CTZ",
+    "CTZW", "CPOP", "CPOPW", "MAX", "MAXU", "MIN", "MINU", "SEXT_B",
+    "SEXT_H", "ZEXT_H", "ROL", "ROLW", "ROR", "RORI", "RORIW", "RORW",
+    "ORC_B", "REV8", "BCLR", "BCLRI", "BEXT", "BEXTI", "BINV", "BINVI",
+    "BSET", "BSETI",
+    "VSETVLI", "VSETIVLI", "VSETVL", "VLE8_V", "VLE16_V", "VLE32_V", "VLE64_V",
+    "VSE8_V", "VSE16_V", "VSE32_V", "VSE64_V", "VLSE8_V", "VLSE16_V",
+    "VLSE32_V", "VLSE64_V", "VSSE8_V", "VSSE16_V", "VSSE32_V", "VSSE64_V",
+    "VADD_VV", "VADD_VX", "VADD_VI", "VSUB_VV", "VSUB_VX", "VRSUB_VX",
+    "VRSUB_VI", "VMINU_VV", "VMINU_VX", "VMIN_VV", "VMIN_VX", "VMAXU_VV",
+    "VMAXU_VX", "VMAX_VV", "VMAX_VX", "VAND_VV", "VAND_VX", "VAND_VI",
+    "VOR_VV", "VOR_VX", "VOR_VI", "VXOR_VV", "VXOR_VX", "VXOR_VI", "VMSEQ_VV",
+    "VMSEQ_VX", "VMSEQ_VI", "VMSNE_VV", "VMSNE_VX", "VMSNE_VI", "VMSLTU_VV",
+    "VMSLTU_VX", "VMSLT_VV", "VMSLT_VX", "VMSLEU_VV", "VMSLEU_VX", "VMSLEU_VI",
+    "VMSLE_VV", "VMSLE_VX", "VMSLE_VI", "VMSGTU_VX", "VMSGTU_VI", "VMSGT_VX",
+    "VMSGT_VI", "VSLL_VV", "VSLL_VX", "VSLL_VI", "VSRL_VV", "VSRL_VX",
+    "VSRL_VI", "VSRA_VV", "VSRA_VX", "VSRA_VI", "VMERGE_VVM", "VMV_V_V",
+    "VMERGE_VXM", "VMV_V_X", "VMERGE_VIM", "VMV_V_I", "VREDSUM_VS",
+    "VREDAND_VS", "VREDOR_VS", "VREDXOR_VS", "VREDMINU_VS", "VREDMIN_VS",
+    "VREDMAXU_VS", "VREDMAX_VS", "VMANDN_MM", "VMAND_MM", "VMOR_MM",
+    "VMXOR_MM", "VMORN_MM", "VMNAND_MM", "VMNOR_MM", "VMXNOR_MM", "VMV_X_S",
+    "VCPOP_M", "VFIRST_M", "VMV_S_X", "VMUL_VV", "VMUL_VX",
+    "CSRRW", "CSRRS", "CSRRC", "CSRRWI", "CSRRSI", "CSRRCI"
 ]
 
 def gen_file_open() -> str :
@@ -39,6 +80,10 @@ def gen_dispatch(instrs: dict) -> str :
         else :
             out += ", nullptr"
 
+    out += ", %s" % gen_sim_method_name("SIM_HOST_CALL")
+    out += ", %s" % gen_sim_method_name("SIM_PLUGIN_CALL")
+    out += ", %s" % gen_sim_method_name("SIM_PLUGIN_BLOCK")
+
     out += """
             };
 
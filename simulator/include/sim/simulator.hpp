@@ -1,20 +1,71 @@
 #ifndef INCL_SIM_SIMULATOR_HPP
 #define INCL_SIM_SIMULATOR_HPP
 
-#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cfenv>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <type_traits>
+#include <unordered_map>
 
 #include <sim/bb.hpp>
 #include <sim/bb_cache.hpp>
+#include <sim/bpred.hpp>
+#include <sim/cache_model.hpp>
 #include <sim/common.hpp>
+#include <sim/csr.hpp>
 #include <sim/hart.hpp>
 #include <sim/instr.hpp>
 #include <sim/memory.hpp>
+#include <sim/plugin/manager.hpp>
+#include <sim/profile.hpp>
+#include <sim/shared_bb_store.hpp>
+#include <sim/stats.hpp>
+#include <sim/syscall.hpp>
 #include <sim/tlb.hpp>
+#include <sim/trace.hpp>
+#include <sim/trace/mem_trace.hpp>
+#include <sim/translator.hpp>
+#include <sim/vr.hpp>
+#include <sim/vr/kernels.hpp>
 
 namespace sim {
 
-class Simulator final {
+class Simulator final : private translator::Client {
+  public:
+    // Inter-processor interrupt requests.
+    // Posted by other harts and served on basic block boundaries
+    enum IpiMask : uint32_t {
+        IPI_TLB_FLUSH = 1 << 0,
+        IPI_BB_CACHE_FLUSH = 1 << 1,
+        IPI_STOP = 1 << 2,
+        IPI_HOT_BB_READY = 1 << 3,
+        IPI_CALL_GRAPH_SAMPLE = 1 << 4,
+    };
+
+    // Guest libc functions simulated with host routines
+    enum class HostFunc : uint8_t { MEMCPY, MEMSET, STRLEN, STRCMP };
+    static constexpr size_t HOST_FUNC_NUMBER = 4;
+
+    // Guest instrs credited to icount per host function call: call_icount
+    // plus word_icount for every 8 bytes processed
+    struct HostFuncCost final {
+        size_t call_icount = 0;
+        size_t word_icount = 0;
+    };
+
+    // Rough costs of word-at-a-time guest implementations
+    static constexpr std::array<HostFuncCost, HOST_FUNC_NUMBER>
+        DEFAULT_HOST_FUNC_COSTS = {{{8, 3}, {6, 2}, {6, 6}, {6, 10}}};
+
+  private:
     using MemAccessType = memory::MMU64::AccessType;
 
     static constexpr size_t TLB_SIZE_LOG_2 = 7;
@@ -23,9 +74,11 @@ class Simulator final {
     using ReadTLB = cache::TLB<memory::ConstHostPtr, TLB_SIZE_LOG_2>;
     using WriteTLB = cache::TLB<memory::HostPtr, TLB_SIZE_LOG_2>;
 
-    memory::PhysMemory m_phys_memory{};
+    // Physical memory owned by single-hart simulator.
+    // Harts of a multi-hart system share external physical memory
+    std::unique_ptr<memory::PhysMemory> m_own_phys_memory = nullptr;
 
-    hart::Hart m_hart{m_phys_memory};
+    hart::Hart m_hart;
 
     ReadTLB m_read_tlb{};
     WriteTLB m_write_tlb{};
@@ -33,51 +86,306 @@ class Simulator final {
 
     cache::BbCache<BB_CACHE_SIZE_LOG_2> m_bb_cache;
 
+    // Decoded bbs shared with other harts and simulators. When set, bbs are
+    // taken from shared store through m_bb_ptr_cache instead of m_bb_cache
+    cache::SharedBbStore *m_shared_bb_store = nullptr;
+    cache::BbPtrCache<BB_CACHE_SIZE_LOG_2> m_bb_ptr_cache;
+
+    // Background translator for hot bbs. Built superblocks are delivered
+    // with IPI_HOT_BB_READY and installed to m_hot_bbs on bb boundary
+    translator::Translator *m_translator = nullptr;
+    cache::HotBbCache<BB_CACHE_SIZE_LOG_2> m_hot_bbs;
+
+    // Incremented on bb cache invalidation to drop outdated translations
+    uint64_t m_code_generation = 0;
+
+    std::mutex m_ready_mutex{};
+    std::vector<translator::Result> m_ready_hot_bbs{};
+
     size_t m_icount = 0;
 
-    std::ostream *m_log = nullptr;
+    // Guest process syscalls
+    syscall::Emulator m_syscalls{};
+
+    // Guest function entries simulated on host. Host call bbs are installed
+    // on bb cache misses, so lookups are kept off the hot path
+    std::unordered_map<VirtAddr, HostFunc> m_host_funcs{};
+    std::array<HostFuncCost, HOST_FUNC_NUMBER> m_host_func_costs =
+        DEFAULT_HOST_FUNC_COSTS;
+
+    // LR/SC reservation.
+    // SC succeeds if reserved memory still holds the value loaded by LR, so
+    // reservations need no global lock
+    struct Reservation final {
+        const void *host_ptr = nullptr;
+        size_t size = 0;
+        uint64_t value = 0;
+    };
+
+    Reservation m_reservation{};
+
+    // Guest rounding mode installed in host FPU. Host FPU is reconfigured
+    // only when FP instr rounding mode differs from it
+    uint8_t m_host_rm = to_underlying(fpr::RoundingMode::RNE);
+
+    // Pending IPIs mask
+    std::atomic<uint32_t> m_pending_ipi = 0;
+
+    // Execution statistics. TLBs and MMU keep their own counters
+    struct Stats final {
+        stats::Counter bb_cache_hits{};
+        stats::Counter bb_cache_misses{};
+        stats::Counter bb_cache_evictions{};
+        stats::Counter superblock_hits{};
+        stats::Counter bbs_decoded{};
+        stats::Counter instrs{};
+        stats::Counter wall_ns{};
+    };
+
+    Stats m_stats{};
+
+    // Hot bbs profiler. nullptr disables profiling
+    profile::BbProfiler *m_profiler = nullptr;
+
+    // Set if any bb entry hook is enabled, so disabled hooks cost one check
+    // per bb. Maintained by hook setters
+    bool m_bb_hooks = false;
+
+    void updateBbHooks() noexcept {
+        m_bb_hooks = m_profiler != nullptr || m_bbv_recorder != nullptr ||
+                     m_instr_mix != nullptr;
+    }
+
+    // Call enabled bb entry hooks
+    void enterBb(const instr::Instr *instrs);
+
+    // SimPoint bb vectors recorder. nullptr disables recording
+    profile::BbvRecorder *m_bbv_recorder = nullptr;
+
+    // Dynamic instrs mix recorder. nullptr disables recording
+    profile::InstrMixRecorder *m_instr_mix = nullptr;
+
+    // Guest call graph sampler. nullptr disables sampling
+    profile::CallGraphSampler *m_call_graph = nullptr;
 
-    static constexpr size_t LOG_REG_ID_FILL = 2;
+    // Track guest call or return done by current jump instr
+    void trackCallGraph(const instr::Instr *instr, bool is_indirect) {
+        if (m_call_graph == nullptr) {
+            return;
+        }
+
+        if (instr->rd() == gpr::GPR_IDX::RA) {
+            m_call_graph->call(m_hart.pc());
+        } else if (is_indirect && instr->rd() == gpr::GPR_IDX::ZERO &&
+                   instr->rs1() == gpr::GPR_IDX::RA) {
+            m_call_graph->ret();
+        }
+    }
+
+    // Instrumentation plugins. nullptr disables instrumentation
+    plugin::Manager *m_plugins = nullptr;
+
+    // Redirect entry of just decoded bb or superblock to its instrumented
+    // copy if plugins hooked it
+    template <class Block> void instrument(Block &block) {
+        if (auto entry =
+                m_plugins->instrument(block.getVirtAddr(), block.instrs())) {
+            block.redirect(*entry);
+        }
+    }
+
+    // Decoded instrs executed from bb entry. Entries redirected by plugins
+    // are resolved to instrumented copies
+    const instr::Instr *entryInstrs(const instr::Instr *instrs) const noexcept {
+        return instrs->id() == instr::InstrId::SIM_PLUGIN_BLOCK
+                   ? m_plugins->blockInstrs(instrs->imm())
+                   : instrs;
+    }
+
+    // Cache hierarchy model. Hooks are compiled in with
+    // SIM_CACHE_MODEL_ENABLE only. nullptr disables modelling
+    cache_model::Hierarchy *m_cache_model = nullptr;
+
+    // Branch predictor model. Hooks are compiled in with SIM_BPRED_ENABLE
+    // only. nullptr disables modelling
+    bpred::Model *m_bpred = nullptr;
+
+    // Feed branch predictor model with outcome of current conditional
+    // branch
+    void modelCondBranch([[maybe_unused]] bool taken) {
+#ifdef SIM_BPRED_ENABLE
+        if (m_bpred != nullptr) {
+            m_bpred->condBranch(m_hart.pc(), taken);
+        }
+#endif
+    }
 
-    void logInstr([[maybe_unused]] const char *mnemonic) {
-#ifdef SIM_LOG_ENABLE
-        if (m_log) {
-            *m_log << m_hart.pc() << ": " << mnemonic << std::endl;
+    // Feed branch predictor model with current jump instr
+    void modelJump([[maybe_unused]] const instr::Instr *instr,
+                   [[maybe_unused]] bool is_indirect,
+                   [[maybe_unused]] VirtAddr target) {
+#ifdef SIM_BPRED_ENABLE
+        if (m_bpred != nullptr) {
+            auto kind =
+                bpred::classifyJump(is_indirect, instr->rd(), instr->rs1());
+            m_bpred->jump(kind, m_hart.pc(), target,
+                          m_hart.pc() + instr->size());
         }
 #endif
     }
 
-    void logGprWrite([[maybe_unused]] size_t idx) {
-#ifdef SIM_LOG_ENABLE
-        if (m_log) {
-            auto value = m_hart.gprFile().read<RegValue>(idx);
+    // Feed cache model with fetches of bb instrs starting at current pc
+    void modelBbFetch(const instr::Instr *instrs);
 
-            *m_log << "\tReg [" << std::setw(LOG_REG_ID_FILL) << idx
-                   << "] <= " << value << std::endl;
+    // Feed cache model with data access of current instr
+    void modelDataAccess([[maybe_unused]] VirtAddr va) {
+#ifdef SIM_CACHE_MODEL_ENABLE
+        if (m_cache_model != nullptr) {
+            m_cache_model->dataAccess(m_hart.pc(), va);
         }
 #endif
     }
 
-    void logPcWrite() {
-#ifdef SIM_LOG_ENABLE
-        if (m_log) {
-            *m_log << "\tPc <= " << m_hart.pc() << std::endl;
+    // Binary execution trace. Record of current instr is filled by log
+    // helpers and pushed when next instr starts. Helpers are compiled in
+    // with SIM_TRACE_ENABLE only
+    trace::Writer *m_tracer = nullptr;
+    trace::Record m_trace_record{};
+    bool m_trace_pending = false;
+
+    void pushTraceRecord() noexcept {
+        if (m_trace_pending) {
+            m_tracer->push(m_trace_record);
+            m_trace_pending = false;
+        }
+    }
+
+    void logInstr([[maybe_unused]] const instr::Instr *instr) noexcept {
+#ifdef SIM_TRACE_ENABLE
+        if (m_tracer != nullptr) {
+            pushTraceRecord();
+
+            m_trace_record = {};
+            m_trace_record.pc = m_hart.pc();
+            m_trace_record.instr_id = to_underlying(instr->id());
+            m_trace_pending = true;
+        }
+#endif
+    }
+
+    void traceRegWrite(uint8_t flag, size_t idx, RegValue value) noexcept {
+        m_trace_record.flags |= flag;
+        m_trace_record.reg_idx = static_cast<uint8_t>(idx);
+        m_trace_record.reg_value = value;
+    }
+
+    void logGprWrite([[maybe_unused]] size_t idx) noexcept {
+#ifdef SIM_TRACE_ENABLE
+        if (m_tracer != nullptr) {
+            traceRegWrite(trace::Record::GPR_WRITE, idx,
+                          m_hart.gprFile().read<RegValue>(idx));
+        }
+#endif
+    }
+
+    void logFprWrite([[maybe_unused]] size_t idx) noexcept {
+#ifdef SIM_TRACE_ENABLE
+        if (m_tracer != nullptr) {
+            traceRegWrite(trace::Record::FPR_WRITE, idx,
+                          m_hart.fprFile().readBits(idx));
+        }
+#endif
+    }
+
+    void logVrWrite([[maybe_unused]] size_t idx) noexcept {
+#ifdef SIM_TRACE_ENABLE
+        if (m_tracer != nullptr) {
+            RegValue value = 0;
+            std::memcpy(&value, m_hart.vrFile().data(idx), sizeof(value));
+            traceRegWrite(trace::Record::VR_WRITE, idx, value);
         }
 #endif
     }
 
     void logMemWrite([[maybe_unused]] VirtAddr va,
-                     [[maybe_unused]] RegValue value) {
-#ifdef SIM_LOG_ENABLE
-        if (m_log) {
-            *m_log << "\tMem [" << va << "] <= " << value << std::endl;
+                     [[maybe_unused]] RegValue value) noexcept {
+#ifdef SIM_TRACE_ENABLE
+        if (m_tracer != nullptr) {
+            m_trace_record.flags |= trace::Record::MEM_WRITE;
+            m_trace_record.mem_addr = va;
+            m_trace_record.mem_value = value;
+        }
+#endif
+    }
+
+    // Memory access trace. Hooks are compiled in with SIM_MEM_TRACE_ENABLE
+    // only. TLBs map vas to host pages, so pas of traced accesses are found
+    // with separate page translations cache
+    struct MemTracePage final {
+        VirtAddr va_page = bb::Bb::INVALID_VA;
+        PhysAddr pa_page = 0;
+    };
+
+    static constexpr bit::BitSize MEM_TRACE_PAGES_LOG_2 = 6;
+
+    trace::MemWriter *m_mem_tracer = nullptr;
+    std::unique_ptr<MemTracePage[]> m_mem_trace_pages = nullptr;
+
+    // Translate va of successful access for memory trace
+    PhysAddr memTracePa(MemAccessType access_type, VirtAddr va);
+
+    // Out of line to keep inlined memory accesses small
+    void pushMemRecord(trace::MemRecord::Type type, VirtAddr va, size_t size);
+
+    // Record data access of current instr to memory trace
+    void traceMemAccess([[maybe_unused]] trace::MemRecord::Type type,
+                        [[maybe_unused]] VirtAddr va,
+                        [[maybe_unused]] size_t size) {
+#ifdef SIM_MEM_TRACE_ENABLE
+        if (m_mem_tracer != nullptr) {
+            pushMemRecord(type, va, size);
+        }
+#endif
+    }
+
+    // Feed cache model and memory trace with bulk data access of current
+    // instr, e.g. page chunk of unit-stride vector access. Access is split
+    // into accesses of unit bytes
+    void modelBulkAccess([[maybe_unused]] trace::MemRecord::Type type,
+                         [[maybe_unused]] VirtAddr va,
+                         [[maybe_unused]] size_t size,
+                         [[maybe_unused]] size_t unit) {
+#if defined(SIM_CACHE_MODEL_ENABLE) || defined(SIM_MEM_TRACE_ENABLE)
+        if (m_cache_model == nullptr && m_mem_tracer == nullptr) {
+            return;
+        }
+
+        for (size_t offset = 0; offset != size;) {
+            // Trace records are powers of 2 in size
+            auto access_size = std::bit_floor(std::min(unit, size - offset));
+
+            modelDataAccess(va + offset);
+            traceMemAccess(type, va + offset, access_size);
+
+            offset += access_size;
         }
 #endif
     }
 
+    // Record fetches of bb instrs starting at current pc to memory trace
+    void traceBbFetch(const instr::Instr *instrs);
+
     // Translate VA -> PA in current privilege level
     template <MemAccessType access_type> auto translateVa(VirtAddr va) {
-        return m_hart.mmu64().translate(PrivLevel::USER, access_type, va);
+        auto res = m_hart.mmu64().translate(PrivLevel::USER, access_type, va);
+
+        // Pages of brk and mmap regions are mapped on first access
+        if (res.status == SimStatus::MMU64__PAGE_FAULT &&
+            m_syscalls.mapLazy(m_hart.physMemory(), va)) {
+            res = m_hart.mmu64().translate(PrivLevel::USER, access_type, va);
+        }
+
+        return res;
     }
 
     // Memory load result
@@ -106,10 +414,17 @@ class Simulator final {
             return {SimStatus::SIM__UNALIGNED_LOAD, 0};
         }
 
+        if constexpr (access_type == MemAccessType::READ) {
+            modelDataAccess(va);
+        }
+
         // Try to hit tlb
         memory::ConstHostPtr host_addr = nullptr;
         if (getReadTLB<access_type>().find(va, host_addr)) {
             Int value = *reinterpret_cast<const Int *>(host_addr);
+            if constexpr (access_type == MemAccessType::READ) {
+                traceMemAccess(trace::MemRecord::READ, va, sizeof(Int));
+            }
             return {SimStatus::OK, value};
         }
 
@@ -129,6 +444,9 @@ class Simulator final {
         // Cache tranlation
         getReadTLB<access_type>().update(va, to_cache);
 
+        if constexpr (access_type == MemAccessType::READ) {
+            traceMemAccess(trace::MemRecord::READ, va, sizeof(Int));
+        }
         return {SimStatus::OK, value};
     }
 
@@ -150,7 +468,7 @@ class Simulator final {
         logGprWrite(instr->rd());
 
         ++m_icount;
-        m_hart.pc() += INSTR_CODE_SIZE;
+        m_hart.pc() += instr->size();
         return SimStatus::OK;
     }
 
@@ -162,10 +480,13 @@ class Simulator final {
             return SimStatus::SIM__UNALIGNED_STORE;
         }
 
+        modelDataAccess(va);
+
         // Try to hit tlb
         memory::HostPtr host_addr = nullptr;
         if (m_write_tlb.find(va, host_addr)) {
             *reinterpret_cast<Int *>(host_addr) = value;
+            traceMemAccess(trace::MemRecord::WRITE, va, sizeof(Int));
             return SimStatus::OK;
         }
 
@@ -184,6 +505,7 @@ class Simulator final {
         // Cache translation
         m_write_tlb.update(va, to_cache);
 
+        traceMemAccess(trace::MemRecord::WRITE, va, sizeof(Int));
         return SimStatus::OK;
     }
 
@@ -205,10 +527,499 @@ class Simulator final {
         logMemWrite(va, value);
 
         ++m_icount;
-        m_hart.pc() += INSTR_CODE_SIZE;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    // Get host address of given va for reading. Address is valid up to the
+    // end of its page. Read TLB is used for translation
+    SimStatus getReadHostPtr(VirtAddr va,
+                             memory::ConstHostPtr &host_addr) noexcept {
+        // Try to hit tlb
+        if (m_read_tlb.find(va, host_addr)) {
+            return SimStatus::OK;
+        }
+
+        // Translate VA -> PA
+        auto [mmu_status, pa] = translateVa<MemAccessType::READ>(va);
+        if (mmu_status != SimStatus::OK) {
+            return mmu_status;
+        }
+
+        auto host_page_ptr = m_hart.physMemory().getConstHostPagePtr(
+            pa & ~memory::PAGE_OFFSET_MASK);
+        if (host_page_ptr == nullptr) {
+            return SimStatus::PHYS_MEM__ACCESS_FAULT;
+        }
+
+        // Cache translation
+        m_read_tlb.update(va, host_page_ptr);
+        host_addr = host_page_ptr + (va & memory::PAGE_OFFSET_MASK);
+
         return SimStatus::OK;
     }
 
+    // Get host address of given va for writing. Address is valid up to the
+    // end of its page. Write TLB is used for translation
+    SimStatus getWriteHostPtr(VirtAddr va,
+                              memory::HostPtr &host_addr) noexcept {
+        // Try to hit tlb
+        if (m_write_tlb.find(va, host_addr)) {
+            return SimStatus::OK;
+        }
+
+        // Translate VA -> PA
+        auto [mmu_status, pa] = translateVa<MemAccessType::WRITE>(va);
+        if (mmu_status != SimStatus::OK) {
+            return mmu_status;
+        }
+
+        auto host_page_ptr = m_hart.physMemory().getHostPagePtr(
+            pa & ~memory::PAGE_OFFSET_MASK);
+        if (host_page_ptr == nullptr) {
+            return SimStatus::PHYS_MEM__ACCESS_FAULT;
+        }
+
+        // Cache translation
+        m_write_tlb.update(va, host_page_ptr);
+        host_addr = host_page_ptr + (va & memory::PAGE_OFFSET_MASK);
+
+        return SimStatus::OK;
+    }
+
+    // Get host pointer for atomic access to integer at given address.
+    // Write TLB is used for translation
+    template <class Int>
+    SimStatus getAtomicHostPtr(VirtAddr va, Int *&host_ptr) noexcept {
+        static_assert(std::is_integral_v<Int>);
+
+        // Check alignment
+        if (va & memory::addrAlignMask<Int>()) {
+            return SimStatus::SIM__UNALIGNED_STORE;
+        }
+
+        modelDataAccess(va);
+
+        memory::HostPtr host_addr = nullptr;
+        auto status = getWriteHostPtr(va, host_addr);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+
+        host_ptr = reinterpret_cast<Int *>(host_addr);
+        traceMemAccess(trace::MemRecord::AMO, va, sizeof(Int));
+        return SimStatus::OK;
+    }
+
+    // Get host pointer for LR access to integer at given address.
+    // Read TLB is used for translation
+    template <class Int>
+    SimStatus getLrHostPtr(VirtAddr va, const Int *&host_ptr) noexcept {
+        static_assert(std::is_integral_v<Int>);
+
+        // Check alignment
+        if (va & memory::addrAlignMask<Int>()) {
+            return SimStatus::SIM__UNALIGNED_LOAD;
+        }
+
+        modelDataAccess(va);
+
+        memory::ConstHostPtr host_addr = nullptr;
+        auto status = getReadHostPtr(va, host_addr);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+
+        host_ptr = reinterpret_cast<const Int *>(host_addr);
+        traceMemAccess(trace::MemRecord::READ, va, sizeof(Int));
+        return SimStatus::OK;
+    }
+
+    // Simulate AMO instruction for given type.
+    // Op performs read-modify-write on std::atomic_ref and returns old value
+    template <class Int, class Op>
+    SimStatus simAmoInstr(const instr::Instr *instr, Op op) {
+        static_assert(std::is_signed_v<Int>);
+
+        auto &gpr = m_hart.gprFile();
+        auto va = gpr.read<VirtAddr>(instr->rs1());
+        auto value = static_cast<Int>(gpr.read<uint64_t>(instr->rs2()));
+
+        Int *host_ptr = nullptr;
+        auto status = getAtomicHostPtr(va, host_ptr);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+
+        Int old = op(std::atomic_ref<Int>(*host_ptr), value);
+        gpr.write(instr->rd(), old);
+
+        logGprWrite(instr->rd());
+
+        ++m_icount;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    // Simulate LR instruction for given type
+    template <class Int> SimStatus simLrInstr(const instr::Instr *instr) {
+        static_assert(std::is_signed_v<Int>);
+
+        auto &gpr = m_hart.gprFile();
+        auto va = gpr.read<VirtAddr>(instr->rs1());
+
+        const Int *host_ptr = nullptr;
+        auto status = getLrHostPtr(va, host_ptr);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+
+        // Host page is writable, atomic_ref needs non-const object
+        Int value = std::atomic_ref<Int>(*const_cast<Int *>(host_ptr)).load();
+        m_reservation = {host_ptr, sizeof(Int), static_cast<uint64_t>(value)};
+
+        gpr.write(instr->rd(), value);
+
+        logGprWrite(instr->rd());
+
+        ++m_icount;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    // Simulate SC instruction for given type
+    template <class Int> SimStatus simScInstr(const instr::Instr *instr) {
+        static_assert(std::is_signed_v<Int>);
+
+        auto &gpr = m_hart.gprFile();
+        auto va = gpr.read<VirtAddr>(instr->rs1());
+        auto value = static_cast<Int>(gpr.read<uint64_t>(instr->rs2()));
+
+        Int *host_ptr = nullptr;
+        auto status = getAtomicHostPtr(va, host_ptr);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+
+        // SC always invalidates reservation
+        auto reservation = m_reservation;
+        m_reservation = {};
+
+        bool success = false;
+        if (reservation.host_ptr == host_ptr &&
+            reservation.size == sizeof(Int)) {
+            auto expected = static_cast<Int>(reservation.value);
+            success = std::atomic_ref<Int>(*host_ptr).compare_exchange_strong(
+                expected, value);
+        }
+
+        gpr.write(instr->rd(), success ? 0 : 1);
+
+        logGprWrite(instr->rd());
+        if (success) {
+            logMemWrite(va, value);
+        }
+
+        ++m_icount;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    NODISCARD static int hostRoundingMode(uint8_t rm) noexcept {
+        switch (fpr::RoundingMode{rm}) {
+        case fpr::RoundingMode::RTZ:
+            return FE_TOWARDZERO;
+        case fpr::RoundingMode::RDN:
+            return FE_DOWNWARD;
+        case fpr::RoundingMode::RUP:
+            return FE_UPWARD;
+        default:
+            return FE_TONEAREST;
+        }
+    }
+
+    NODISCARD static uint8_t fflagsFromHost(int host_flags) noexcept {
+        uint8_t fflags = 0;
+
+        fflags |= host_flags & FE_INEXACT ? fpr::FFLAGS::NX : 0;
+        fflags |= host_flags & FE_UNDERFLOW ? fpr::FFLAGS::UF : 0;
+        fflags |= host_flags & FE_OVERFLOW ? fpr::FFLAGS::OF : 0;
+        fflags |= host_flags & FE_DIVBYZERO ? fpr::FFLAGS::DZ : 0;
+        fflags |= host_flags & FE_INVALID ? fpr::FFLAGS::NV : 0;
+
+        return fflags;
+    }
+
+    // Rounding mode of FP instr. DYN is resolved with frm
+    NODISCARD uint8_t roundingMode(const instr::Instr *instr) noexcept {
+        auto rm = instr->rm();
+        if (rm == to_underlying(fpr::RoundingMode::DYN)) {
+            rm = m_hart.fprFile().frm();
+        }
+
+        return rm;
+    }
+
+    // Install rounding mode of FP instr to host FPU
+    SimStatus setRoundingMode(const instr::Instr *instr) noexcept {
+        auto rm = roundingMode(instr);
+        if (rm == m_host_rm) {
+            return SimStatus::OK;
+        }
+
+        // Reserved rounding modes make instr illegal. Host has no ties to
+        // max magnitude mode, so RMM is not supported
+        if (rm >= to_underlying(fpr::RoundingMode::RMM)) {
+            return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+        }
+
+        std::fesetround(hostRoundingMode(rm));
+        m_host_rm = rm;
+
+        return SimStatus::OK;
+    }
+
+    struct FpToIntRounding final {
+        SimStatus status = SimStatus::OK;
+        // RMM is not installed to host FPU and is applied by conversion
+        bool rmm = false;
+    };
+
+    // Install rounding mode of FP to integer conversion
+    FpToIntRounding setFpToIntRoundingMode(const instr::Instr *instr) noexcept {
+        if (roundingMode(instr) == to_underlying(fpr::RoundingMode::RMM)) {
+            return {SimStatus::OK, true};
+        }
+
+        return {setRoundingMode(instr), false};
+    }
+
+    // Accrue exception flags raised by host FPU since previous sync.
+    // Flags are not checked per instr: host FPU accumulates them
+    void syncFflags() noexcept {
+        auto host_flags = std::fetestexcept(FE_ALL_EXCEPT);
+        if (host_flags != 0) {
+            m_hart.fprFile().accrueFflags(fflagsFromHost(host_flags));
+            std::feclearexcept(FE_ALL_EXCEPT);
+        }
+    }
+
+    // Host FP environment of simulation thread. Guest rounding mode is
+    // installed for simulation and raised flags are accrued to fflags
+    class HostFpEnv final {
+        Simulator &m_sim;
+        std::fenv_t m_host_env{};
+
+      public:
+        explicit HostFpEnv(Simulator &sim) : m_sim(sim) {
+            std::fegetenv(&m_host_env);
+            std::feclearexcept(FE_ALL_EXCEPT);
+            std::fesetround(hostRoundingMode(m_sim.m_host_rm));
+        }
+
+        HostFpEnv(const HostFpEnv &) = delete;
+        HostFpEnv &operator=(const HostFpEnv &) = delete;
+
+        ~HostFpEnv() {
+            m_sim.syncFflags();
+            std::fesetenv(&m_host_env);
+        }
+    };
+
+    // Simulate FP instr computing rd from rs1, rs2 and rs3 values
+    template <class Float, class Op>
+    SimStatus simFpInstr(const instr::Instr *instr, Op op) {
+        auto &fpr = m_hart.fprFile();
+
+        Float res = op(fpr.read<Float>(instr->rs1()),
+                       fpr.read<Float>(instr->rs2()),
+                       fpr.read<Float>(instr->rs3()));
+        fpr.write(instr->rd(), res);
+
+        logFprWrite(instr->rd());
+
+        ++m_icount;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    // Simulate FP instr rounding its result. NaN results are canonical
+    template <class Float, class Op>
+    SimStatus simFpRoundingInstr(const instr::Instr *instr, Op op) {
+        if (auto status = setRoundingMode(instr); status != SimStatus::OK) {
+            return status;
+        }
+
+        return simFpInstr<Float>(instr, [op](Float a, Float b, Float c) {
+            Float res = op(a, b, c);
+            return std::isnan(res) ? fpr::canonicalNaN<Float>() : res;
+        });
+    }
+
+    // Simulate FP instr writing integer result to rd
+    template <class Float, class Op>
+    SimStatus simFpToGprInstr(const instr::Instr *instr, Op op) {
+        auto &fpr = m_hart.fprFile();
+        auto &gpr = m_hart.gprFile();
+
+        RegValue res = op(fpr.read<Float>(instr->rs1()),
+                          fpr.read<Float>(instr->rs2()));
+        gpr.write(instr->rd(), res);
+
+        logGprWrite(instr->rd());
+
+        ++m_icount;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    // Simulate FP load instruction for given raw type
+    template <class UInt> SimStatus simFpLoadInstr(const instr::Instr *instr) {
+        static_assert(std::is_unsigned_v<UInt>);
+
+        auto &gpr = m_hart.gprFile();
+        auto va_base = gpr.read<VirtAddr>(instr->rs1());
+        auto va = va_base + static_cast<int32_t>(instr->imm());
+
+        auto [status, res] = loadInt<UInt, MemAccessType::READ>(va);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+
+        auto &fpr = m_hart.fprFile();
+        if constexpr (sizeof(UInt) == sizeof(float)) {
+            fpr.writeBits(instr->rd(), fpr::NAN_BOX | res);
+        } else {
+            fpr.writeBits(instr->rd(), res);
+        }
+
+        logFprWrite(instr->rd());
+
+        ++m_icount;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    // Simulate FP store instruction for given raw type
+    template <class UInt>
+    SimStatus simFpStoreInstr(const instr::Instr *instr) {
+        static_assert(std::is_unsigned_v<UInt>);
+
+        auto &gpr = m_hart.gprFile();
+        auto va_base = gpr.read<VirtAddr>(instr->rs1());
+        auto va = va_base + static_cast<int32_t>(instr->imm());
+
+        auto value =
+            static_cast<UInt>(m_hart.fprFile().readBits(instr->rs2()));
+
+        auto status = storeInt(va, value);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+
+        logMemWrite(va, value);
+
+        ++m_icount;
+        m_hart.pc() += instr->size();
+        return SimStatus::OK;
+    }
+
+    // Host functions. Defined in sim/simulator/sim_host_call.hpp
+
+    // Host routines model word-at-a-time guest implementations: icount is
+    // credited and memory accesses are modelled per word
+    static constexpr size_t HOST_FUNC_WORD_SIZE = sizeof(uint64_t);
+
+    NODISCARD static size_t pageBytesLeft(VirtAddr va) noexcept {
+        return memory::PAGE_SIZE - (va & memory::PAGE_OFFSET_MASK);
+    }
+
+    NODISCARD const HostFunc *findHostFunc(VirtAddr va) const noexcept {
+        if (m_host_funcs.empty()) {
+            return nullptr;
+        }
+
+        auto it = m_host_funcs.find(va);
+        return it != m_host_funcs.end() ? &it->second : nullptr;
+    }
+
+    // Host routines over guest memory. Memory is accessed page span by page
+    // span through TLBs
+    SimStatus hostMemcpy(VirtAddr dst, VirtAddr src, size_t size) noexcept;
+    SimStatus hostMemset(VirtAddr dst, uint8_t value, size_t size) noexcept;
+    SimStatus hostStrlen(VirtAddr str, size_t &len) noexcept;
+    SimStatus hostStrcmp(VirtAddr lhs, VirtAddr rhs, int &res,
+                         size_t &size) noexcept;
+
+    // Simulate guest function call with host routine and return to ra
+    SimStatus simHostCall(HostFunc func) noexcept;
+
+    // Vector instrs helpers. Defined in sim/simulator/sim_vector.hpp
+
+    // Vector instr operand kinds: vector, scalar register and immediate
+    enum class VecOperand { VV, VX, VI };
+
+    // Call func with zero value of element type for given SEW in bytes
+    template <class Func> static SimStatus withSew(size_t sew, Func func);
+
+    // Check vtype is valid and given registers start aligned groups
+    NODISCARD bool
+    vecGroupsValid(std::initializer_list<size_t> regs) const noexcept;
+
+    // Scalar operand of .vx and .vi instrs truncated to element type.
+    // Shift amount immediates are unsigned
+    template <class UInt, VecOperand operand>
+    NODISCARD UInt vecScalar(const instr::Instr *instr,
+                             bool unsigned_imm) const noexcept;
+
+    // Set vtype and vl = min(avl, vlmax). Current vl is kept if keep_vl
+    SimStatus simVsetInstr(const instr::Instr *instr, RegValue avl,
+                           RegValue vtype, bool keep_vl) noexcept;
+
+    // Unit-stride and strided vector loads and stores
+    template <class UInt>
+    SimStatus simVecLoadInstr(const instr::Instr *instr, bool strided);
+    template <class UInt>
+    SimStatus simVecStoreInstr(const instr::Instr *instr, bool strided);
+
+    template <vr::Op op, VecOperand operand>
+    SimStatus simVecArithInstr(const instr::Instr *instr);
+
+    // vmerge if merge is set and vmv.v otherwise
+    template <VecOperand operand>
+    SimStatus simVecMergeInstr(const instr::Instr *instr, bool merge);
+
+    // Integer compare writing mask register
+    template <bool is_signed, template <typename> typename Cmp,
+              VecOperand operand>
+    SimStatus simVecCmpInstr(const instr::Instr *instr);
+
+    template <vr::Op op> SimStatus simVecReduceInstr(const instr::Instr *instr);
+
+    // Mask register logical op
+    template <vr::Op op> SimStatus simVecMaskInstr(const instr::Instr *instr);
+
+    // CSR access. Defined in sim/simulator/sim_csr.hpp
+
+    using CSRReadPtr = SimStatus (*)(Simulator &, RegValue &) noexcept;
+    using CSRWritePtr = SimStatus (*)(Simulator &, RegValue) noexcept;
+
+    template <csr::CSRIdx idx>
+    static SimStatus readCSR(Simulator &sim, RegValue &dst) noexcept;
+    template <csr::CSRIdx idx>
+    static SimStatus writeCSR(Simulator &sim, RegValue value) noexcept;
+
+    // Generated tables indexed by CSR number. nullptr for unsupported CSRs
+    // and writes to read-only CSRs
+    inline static CSRReadPtr csrReader(csr::CSRIdx idx) noexcept;
+    inline static CSRWritePtr csrWriter(csr::CSRIdx idx) noexcept;
+
+    enum class CSROp { WRITE, SET, CLEAR };
+
+    // Zicsr instr with rs1 value or uimm5 as source
+    template <CSROp op>
+    SimStatus simCSRInstr(const instr::Instr *instr, RegValue src) noexcept;
+
     template <class Int, template <typename> typename Cmp>
     SimStatus simCondBranch(const instr::Instr *instr) {
         auto &gpr = m_hart.gprFile();
@@ -216,30 +1027,64 @@ class Simulator final {
         auto rs1 = gpr.read<Int>(instr->rs1());
         auto rs2 = gpr.read<Int>(instr->rs2());
 
-        if (Cmp<Int>()(rs1, rs2)) {
+        bool taken = Cmp<Int>()(rs1, rs2);
+        modelCondBranch(taken);
+
+        if (taken) {
             auto offset = static_cast<int32_t>(instr->imm());
             auto new_pc = m_hart.pc() + offset;
 
-            if (new_pc & 0x3) {
+            if (new_pc & PC_ALIGN_MASK) {
                 return SimStatus::SIM__PC_ALIGN_ERROR;
             }
 
             ++m_icount;
             m_hart.pc() = new_pc;
 
-            logPcWrite();
-
             return SimStatus::OK;
         }
 
         ++m_icount;
-        m_hart.pc() += INSTR_CODE_SIZE;
-
-        logPcWrite();
+        m_hart.pc() += instr->size();
 
         return SimStatus::OK;
     }
 
+    // Serve pending IPIs
+    SimStatus serveIpi() noexcept;
+
+    // Simulate bbs until icount_limit is reached or simulation stops
+    SimStatus simulateBbs(size_t icount_limit);
+
+    struct SharedBbResult final {
+        SimStatus status = SimStatus::OK;
+        const bb::Bb *bb = nullptr;
+    };
+
+    // Find bb in shared store. Bb is decoded and published on miss.
+    // nullptr bb is returned for bbs which could not be shared
+    SharedBbResult findSharedBb(VirtAddr virt_addr);
+
+    // Count hot bb execution. Returns superblock instrs if it is ready
+    const instr::Instr *findHotInstrs(VirtAddr virt_addr) noexcept;
+
+    void onTranslated(translator::Result &&result) override;
+
+    NODISCARD bool isHostFunc(VirtAddr va) const noexcept override {
+        return findHostFunc(va) != nullptr;
+    }
+
+    // Install superblocks delivered by translator
+    void installHotBbs();
+
+    // Count bb cache miss replacing entry for given virtual address
+    void countBbCacheMiss(VirtAddr replaced_va) noexcept {
+        m_stats.bb_cache_misses.inc();
+        if (replaced_va != bb::Bb::INVALID_VA) {
+            m_stats.bb_cache_evictions.inc();
+        }
+    }
+
     template <instr::InstrId>
     static SimStatus simInstr(Simulator &sim,
                               const instr::Instr *instr) noexcept;
@@ -248,6 +1093,37 @@ class Simulator final {
 
     inline static SimInstrPtr dispatch(instr::InstrId) noexcept;
 
+    // Fetch 32-bit code window starting at 2 bytes aligned address.
+    // Upper half of window is fetched only for uncompressed instrs, so
+    // compressed instr at the end of the last code page does not fault
+    LoadResult<InstrCode> fetchWindow(VirtAddr va) noexcept {
+        // Window within single page is read with one fetch TLB lookup
+        memory::ConstHostPtr host_addr = nullptr;
+        if ((va & memory::PAGE_OFFSET_MASK) <=
+                memory::PAGE_SIZE - INSTR_CODE_SIZE &&
+            m_fetch_tlb.find(va, host_addr)) {
+            InstrCode window = 0;
+            std::memcpy(&window, host_addr, sizeof(window));
+            return {SimStatus::OK, window};
+        }
+
+        // Slow path fetches halves separately, so instr may cross page
+        // boundary. Fetch TLB is filled on the way
+        auto lo = loadInt<uint16_t, MemAccessType::FETCH>(va);
+        if (lo.status != SimStatus::OK || instr::isCompressed(lo.value)) {
+            return {lo.status, lo.value};
+        }
+
+        auto hi = loadInt<uint16_t, MemAccessType::FETCH>(
+            va + COMPRESSED_INSTR_CODE_SIZE);
+        if (hi.status != SimStatus::OK) {
+            return {hi.status, 0};
+        }
+
+        InstrCode window = hi.value;
+        return {SimStatus::OK, window << bit::bitSize<uint16_t>() | lo.value};
+    }
+
     class Fetch final {
         using FetchResult = bb::Bb::FetchResult;
 
@@ -259,27 +1135,211 @@ class Simulator final {
             : m_curr_fetch_addr(bb_virt_addr), m_sim(sim) {}
 
         FetchResult operator()() noexcept {
-            auto res = m_sim.loadInt<InstrCode, MemAccessType::FETCH>(
-                m_curr_fetch_addr);
+            auto res = m_sim.fetchWindow(m_curr_fetch_addr);
 
-            m_curr_fetch_addr += INSTR_CODE_SIZE;
+            m_curr_fetch_addr += instr::codeSize(res.value);
             return {res.status, res.value};
         }
     };
 
   public:
-    Simulator(std::ostream *log = nullptr) : m_log(log) {
-        if (m_log) {
-            *m_log << std::hex << std::setfill('0');
-        }
-    }
+    Simulator()
+        : m_own_phys_memory(std::make_unique<memory::PhysMemory>()),
+          m_hart(*m_own_phys_memory) {}
+
+    // Create simulator for one hart of a multi-hart system
+    Simulator(memory::PhysMemory &phys_memory, size_t hart_id)
+        : m_hart(phys_memory, hart_id) {}
 
     auto &getHart() noexcept { return m_hart; }
-    auto &getPhysMemory() noexcept { return m_phys_memory; }
+    auto &getPhysMemory() noexcept { return m_hart.physMemory(); }
 
     auto icount() const noexcept { return m_icount; }
 
-    SimStatus simulate(VirtAddr start_pc);
+    // Continue instructions count from given value, e.g. from checkpoint
+    void setIcount(size_t icount) noexcept { m_icount = icount; }
+
+    auto &syscalls() noexcept { return m_syscalls; }
+
+    // Count bb executions with given profiler. nullptr disables profiling
+    void setProfiler(profile::BbProfiler *profiler) noexcept {
+        m_profiler = profiler;
+        updateBbHooks();
+    }
+
+    // Model branch prediction with given model. nullptr disables
+    // modelling. Ignored unless built with SIM_BPRED_ENABLE
+    void setBranchModel(bpred::Model *model) noexcept { m_bpred = model; }
+
+    // Model caches with given hierarchy. nullptr disables modelling.
+    // Ignored unless built with SIM_CACHE_MODEL_ENABLE
+    void setCacheModel(cache_model::Hierarchy *cache_model) noexcept {
+        m_cache_model = cache_model;
+    }
+
+    // Record SimPoint bb vectors with given recorder. nullptr disables
+    // recording
+    void setBbvRecorder(profile::BbvRecorder *recorder) noexcept {
+        m_bbv_recorder = recorder;
+        updateBbHooks();
+    }
+
+    // Sample guest call graph with given sampler. Interval samples are taken
+    // on bb boundaries, timer samples are requested with
+    // IPI_CALL_GRAPH_SAMPLE. nullptr disables sampling
+    void setCallGraphSampler(profile::CallGraphSampler *sampler) noexcept {
+        m_call_graph = sampler;
+    }
+
+    // Record dynamic instrs mix. nullptr disables recording
+    void setInstrMixRecorder(profile::InstrMixRecorder *recorder) noexcept {
+        m_instr_mix = recorder;
+        updateBbHooks();
+    }
+
+    // Instrument executed code with plugins of given manager. nullptr
+    // disables instrumentation. Shared bbs are not instrumented, so shared
+    // bbs store is not used with plugins
+    void setPlugins(plugin::Manager *plugins) noexcept {
+        m_plugins = plugins;
+        if (plugins != nullptr) {
+            setSharedBbStore(nullptr);
+        }
+
+        invalidateBbCache();
+    }
+
+    // Record executed instrs to binary trace. nullptr disables tracing.
+    // Pending record of the last instr is pushed on tracer change. Ignored
+    // unless built with SIM_TRACE_ENABLE
+    void setTracer(trace::Writer *tracer) noexcept {
+        if (m_tracer != nullptr) {
+            pushTraceRecord();
+        }
+
+        m_tracer = tracer;
+        m_trace_pending = false;
+    }
+
+    // Record memory accesses of executed instrs to memory trace. Fetches
+    // of bb are recorded on bb entry. nullptr disables tracing. Ignored
+    // unless built with SIM_MEM_TRACE_ENABLE
+    void setMemTracer(trace::MemWriter *tracer) {
+        if (tracer != nullptr && m_mem_trace_pages == nullptr) {
+            m_mem_trace_pages = std::make_unique<MemTracePage[]>(
+                size_t{1} << MEM_TRACE_PAGES_LOG_2);
+        }
+
+        m_mem_tracer = tracer;
+    }
+
+    // Add execution statistics to registry. Counters accumulate over
+    // simulate and resume calls
+    void collectStats(stats::Registry &registry) const;
+
+    // Simulate guest function at given entry with host routine
+    void setHostFunc(VirtAddr entry, HostFunc func) {
+        // Translator reads host functions
+        waitTranslations();
+
+        m_host_funcs[entry] = func;
+        invalidateBbCache();
+    }
+
+    void setHostFuncCost(HostFunc func, HostFuncCost cost) noexcept {
+        m_host_func_costs[to_underlying(func)] = cost;
+    }
+
+    const auto &hostFuncs() const noexcept { return m_host_funcs; }
+    const auto &hostFuncCosts() const noexcept { return m_host_func_costs; }
+
+    // time CSR frequency. time counts host steady clock ticks
+    static constexpr uint64_t TIME_FREQ = 10000000;
+
+    // Post IPI to this hart. Thread-safe
+    void postIpi(uint32_t ipi_mask) noexcept {
+        m_pending_ipi.fetch_or(ipi_mask, std::memory_order_release);
+    }
+
+    // Cancel pending IPIs. Thread-safe
+    void cancelIpi(uint32_t ipi_mask) noexcept {
+        m_pending_ipi.fetch_and(~ipi_mask, std::memory_order_relaxed);
+    }
+
+    // Drop LR reservation. Reserved host page may be reused for other guest
+    // memory, e.g. after physical memory reset
+    void clearReservation() noexcept { m_reservation = {}; }
+
+    void invalidateTLBs() noexcept {
+        m_read_tlb.invalidate();
+        m_write_tlb.invalidate();
+        m_fetch_tlb.invalidate();
+
+        if (m_mem_trace_pages != nullptr) {
+            std::fill_n(m_mem_trace_pages.get(),
+                        size_t{1} << MEM_TRACE_PAGES_LOG_2, MemTracePage{});
+        }
+    }
+
+    ~Simulator() { waitTranslations(); }
+
+    void invalidateBbCache() noexcept {
+        m_bb_cache.invalidate();
+        m_bb_ptr_cache.invalidate();
+        m_hot_bbs.invalidate();
+        ++m_code_generation;
+
+        // Bbs are decoded in place of invalidated ones
+        if (m_instr_mix != nullptr) {
+            m_instr_mix->flush();
+        }
+    }
+
+    // Use shared decoded bbs store. nullptr disables sharing. Ignored with
+    // plugins set
+    void setSharedBbStore(cache::SharedBbStore *store) noexcept {
+        m_shared_bb_store = m_plugins == nullptr ? store : nullptr;
+        m_bb_ptr_cache.invalidate();
+    }
+
+    // Translate hot bbs to superblocks in background. nullptr disables
+    // translation
+    void setTranslator(translator::Translator *translator) noexcept {
+        waitTranslations();
+
+        m_translator = translator;
+        m_hot_bbs.invalidate();
+    }
+
+    // Reset simulator for next run. Owned physical memory is cleared, but
+    // its host memory is kept for reuse
+    void reset() noexcept {
+        // Translator reads code from host pages
+        waitTranslations();
+
+        m_hart.reset();
+        m_icount = 0;
+        m_syscalls.reset();
+        m_host_funcs.clear();
+        m_host_func_costs = DEFAULT_HOST_FUNC_COSTS;
+
+        clearReservation();
+        invalidateTLBs();
+        invalidateBbCache();
+
+        if (m_own_phys_memory) {
+            m_own_phys_memory->reset();
+        }
+    }
+
+    // Simulate from start_pc. Stops on first bb boundary after max_icount
+    // instructions with SIM__ICOUNT_LIMIT status
+    SimStatus simulate(VirtAddr start_pc,
+                       size_t max_icount = std::numeric_limits<size_t>::max());
+
+    // Continue simulation from current hart state. Stops on first bb boundary
+    // after max_icount instructions with SIM__ICOUNT_LIMIT status
+    SimStatus resume(size_t max_icount);
 };
 
 } // namespace sim
@@ -0,0 +1,197 @@
+#ifndef INCL_SIMULATOR_SIM_CSR_HPP
+#define INCL_SIMULATOR_SIM_CSR_HPP
+
+#include <cfenv>
+#include <chrono>
+
+#include <sim/simulator.hpp>
+
+namespace sim {
+
+#define SIM_CSR_READ(CSR_NAME)                                                 \
+    template <>                                                                \
+    inline SimStatus Simulator::readCSR<csr::CSRIdx::CSR_NAME>(                \
+        [[maybe_unused]] Simulator & sim, RegValue & dst) noexcept
+
+#define SIM_CSR_WRITE(CSR_NAME)                                                \
+    template <>                                                                \
+    inline SimStatus Simulator::writeCSR<csr::CSRIdx::CSR_NAME>(               \
+        [[maybe_unused]] Simulator & sim,                                      \
+        [[maybe_unused]] RegValue value) noexcept
+
+// hpmcounters are not modelled and read as zero
+template <csr::CSRIdx idx>
+SimStatus Simulator::readCSR(Simulator &, RegValue &dst) noexcept {
+    static_assert(idx >= csr::CSRIdx::HPMCOUNTER3 &&
+                  idx <= csr::CSRIdx::HPMCOUNTER31);
+
+    dst = 0;
+    return SimStatus::OK;
+}
+
+// Flags raised by host FPU since previous sync are accrued before read
+SIM_CSR_READ(FFLAGS) {
+    sim.syncFflags();
+    dst = sim.m_hart.fprFile().fflags();
+    return SimStatus::OK;
+}
+
+// Pending host FPU flags are overwritten by written value too
+SIM_CSR_WRITE(FFLAGS) {
+    std::feclearexcept(FE_ALL_EXCEPT);
+    sim.m_hart.fprFile().setFflags(static_cast<uint8_t>(value));
+    return SimStatus::OK;
+}
+
+SIM_CSR_READ(FRM) {
+    dst = sim.m_hart.fprFile().frm();
+    return SimStatus::OK;
+}
+
+SIM_CSR_WRITE(FRM) {
+    sim.m_hart.fprFile().setFrm(static_cast<uint8_t>(value));
+    return SimStatus::OK;
+}
+
+SIM_CSR_READ(FCSR) {
+    sim.syncFflags();
+    dst = sim.m_hart.fprFile().fcsr();
+    return SimStatus::OK;
+}
+
+SIM_CSR_WRITE(FCSR) {
+    std::feclearexcept(FE_ALL_EXCEPT);
+    sim.m_hart.fprFile().setFcsr(value);
+    return SimStatus::OK;
+}
+
+// Vector instrs are not interrupted, so vstart is always zero
+SIM_CSR_READ(VSTART) {
+    dst = 0;
+    return SimStatus::OK;
+}
+
+SIM_CSR_WRITE(VSTART) { return SimStatus::OK; }
+
+SIM_CSR_READ(VL) {
+    dst = sim.m_hart.vrFile().vl();
+    return SimStatus::OK;
+}
+
+SIM_CSR_READ(VTYPE) {
+    dst = sim.m_hart.vrFile().vtype();
+    return SimStatus::OK;
+}
+
+SIM_CSR_READ(VLENB) {
+    dst = vr::VLENB;
+    return SimStatus::OK;
+}
+
+// Every instr takes one cycle
+SIM_CSR_READ(CYCLE) {
+    dst = sim.m_icount;
+    return SimStatus::OK;
+}
+
+SIM_CSR_READ(TIME) {
+    using Ticks = std::chrono::duration<uint64_t, std::ratio<1, TIME_FREQ>>;
+
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    dst = std::chrono::duration_cast<Ticks>(now).count();
+    return SimStatus::OK;
+}
+
+// Retired instrs are counted anyway, so instret costs nothing
+SIM_CSR_READ(INSTRET) {
+    dst = sim.m_icount;
+    return SimStatus::OK;
+}
+
+SIM_CSR_READ(MSTATUS) {
+    return sim.m_hart.csrFile().read<XLen::XLEN_64>(csr::CSRIdx::MSTATUS,
+                                                    dst);
+}
+
+// mstatus SUM and MXR bits affect translation
+SIM_CSR_WRITE(MSTATUS) {
+    auto status =
+        sim.m_hart.csrFile().write<XLen::XLEN_64>(csr::CSRIdx::MSTATUS, value);
+
+    sim.invalidateTLBs();
+    return status;
+}
+
+SIM_CSR_READ(SATP) {
+    return sim.m_hart.csrFile().read<XLen::XLEN_64>(csr::CSRIdx::SATP, dst);
+}
+
+SIM_CSR_WRITE(SATP) {
+    auto status =
+        sim.m_hart.csrFile().write<XLen::XLEN_64>(csr::CSRIdx::SATP, value);
+
+    sim.invalidateTLBs();
+    return status;
+}
+
+#undef SIM_CSR_READ
+#undef SIM_CSR_WRITE
+
+template <Simulator::CSROp op>
+SimStatus Simulator::simCSRInstr(const instr::Instr *instr,
+                                 RegValue src) noexcept {
+    constexpr RegValue CSR_IDX_MASK = 0xfff;
+
+    auto idx = csr::CSRIdx(instr->imm() & CSR_IDX_MASK);
+
+    // CSRRW with rd = x0 does not read CSR. CSRRS and CSRRC with rs1 = x0
+    // or zero uimm do not write it
+    bool do_read = op != CSROp::WRITE || instr->rd() != 0;
+    bool do_write = op == CSROp::WRITE || instr->rs1() != 0;
+
+    RegValue old_value = 0;
+    if (do_read) {
+        auto reader = csrReader(idx);
+        if (reader == nullptr) {
+            return SimStatus::CSR__NOT_SUPPORTED;
+        }
+
+        auto status = reader(*this, old_value);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+    }
+
+    if (do_write) {
+        auto writer = csrWriter(idx);
+        if (writer == nullptr) {
+            return SimStatus::CSR__NOT_SUPPORTED;
+        }
+
+        auto value = src;
+        if constexpr (op == CSROp::SET) {
+            value = old_value | src;
+        } else if constexpr (op == CSROp::CLEAR) {
+            value = old_value & ~src;
+        }
+
+        auto status = writer(*this, value);
+        if (status != SimStatus::OK) {
+            return status;
+        }
+    }
+
+    m_hart.gprFile().write(instr->rd(), old_value);
+
+    logGprWrite(instr->rd());
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+} // namespace sim
+
+#include <sim/simulator/csr_dispatch.gen.hpp>
+
+#endif // INCL_SIMULATOR_SIM_CSR_HPP
@@ -0,0 +1,193 @@
+#ifndef INCL_SIMULATOR_SIM_HOST_CALL_HPP
+#define INCL_SIMULATOR_SIM_HOST_CALL_HPP
+
+#include <algorithm>
+#include <cstring>
+
+#include <sim/simulator.hpp>
+
+namespace sim {
+
+inline SimStatus Simulator::hostMemcpy(VirtAddr dst, VirtAddr src,
+                                       size_t size) noexcept {
+    while (size != 0) {
+        memory::HostPtr dst_ptr = nullptr;
+        if (auto status = getWriteHostPtr(dst, dst_ptr);
+            status != SimStatus::OK) {
+            return status;
+        }
+
+        memory::ConstHostPtr src_ptr = nullptr;
+        if (auto status = getReadHostPtr(src, src_ptr);
+            status != SimStatus::OK) {
+            return status;
+        }
+
+        auto chunk = std::min({size, pageBytesLeft(dst), pageBytesLeft(src)});
+        modelBulkAccess(trace::MemRecord::READ, src, chunk,
+                        HOST_FUNC_WORD_SIZE);
+        modelBulkAccess(trace::MemRecord::WRITE, dst, chunk,
+                        HOST_FUNC_WORD_SIZE);
+        std::memmove(dst_ptr, src_ptr, chunk);
+
+        dst += chunk;
+        src += chunk;
+        size -= chunk;
+    }
+
+    return SimStatus::OK;
+}
+
+inline SimStatus Simulator::hostMemset(VirtAddr dst, uint8_t value,
+                                       size_t size) noexcept {
+    while (size != 0) {
+        memory::HostPtr dst_ptr = nullptr;
+        if (auto status = getWriteHostPtr(dst, dst_ptr);
+            status != SimStatus::OK) {
+            return status;
+        }
+
+        auto chunk = std::min(size, pageBytesLeft(dst));
+        modelBulkAccess(trace::MemRecord::WRITE, dst, chunk,
+                        HOST_FUNC_WORD_SIZE);
+        std::memset(dst_ptr, value, chunk);
+
+        dst += chunk;
+        size -= chunk;
+    }
+
+    return SimStatus::OK;
+}
+
+inline SimStatus Simulator::hostStrlen(VirtAddr str, size_t &len) noexcept {
+    for (len = 0;;) {
+        memory::ConstHostPtr ptr = nullptr;
+        if (auto status = getReadHostPtr(str + len, ptr);
+            status != SimStatus::OK) {
+            return status;
+        }
+
+        auto chunk = pageBytesLeft(str + len);
+        const auto *end =
+            static_cast<memory::ConstHostPtr>(std::memchr(ptr, 0, chunk));
+
+        // Terminating zero is read too
+        auto read_size =
+            end != nullptr ? static_cast<size_t>(end - ptr) + 1 : chunk;
+        modelBulkAccess(trace::MemRecord::READ, str + len, read_size,
+                        HOST_FUNC_WORD_SIZE);
+
+        if (end != nullptr) {
+            len += end - ptr;
+            return SimStatus::OK;
+        }
+
+        len += chunk;
+    }
+
+    SIM_UNREACHABLE();
+}
+
+// Size is set to the number of compared bytes
+inline SimStatus Simulator::hostStrcmp(VirtAddr lhs, VirtAddr rhs, int &res,
+                                       size_t &size) noexcept {
+    for (size = 0;;) {
+        memory::ConstHostPtr lhs_ptr = nullptr;
+        if (auto status = getReadHostPtr(lhs + size, lhs_ptr);
+            status != SimStatus::OK) {
+            return status;
+        }
+
+        memory::ConstHostPtr rhs_ptr = nullptr;
+        if (auto status = getReadHostPtr(rhs + size, rhs_ptr);
+            status != SimStatus::OK) {
+            return status;
+        }
+
+        auto chunk =
+            std::min(pageBytesLeft(lhs + size), pageBytesLeft(rhs + size));
+
+        size_t cmp_size = 0;
+        while (cmp_size != chunk && lhs_ptr[cmp_size] == rhs_ptr[cmp_size] &&
+               lhs_ptr[cmp_size] != 0) {
+            ++cmp_size;
+        }
+        auto is_end = cmp_size != chunk;
+        // Mismatch or terminating zero is read too
+        cmp_size += is_end;
+
+        modelBulkAccess(trace::MemRecord::READ, lhs + size, cmp_size,
+                        HOST_FUNC_WORD_SIZE);
+        modelBulkAccess(trace::MemRecord::READ, rhs + size, cmp_size,
+                        HOST_FUNC_WORD_SIZE);
+
+        if (is_end) {
+            res = int{lhs_ptr[cmp_size - 1]} - int{rhs_ptr[cmp_size - 1]};
+            size += cmp_size;
+            return SimStatus::OK;
+        }
+
+        size += chunk;
+    }
+
+    SIM_UNREACHABLE();
+}
+
+inline SimStatus Simulator::simHostCall(HostFunc func) noexcept {
+    auto &gpr = m_hart.gprFile();
+
+    auto a0 = gpr.read<RegValue>(gpr::GPR_IDX::A0);
+    auto a1 = gpr.read<RegValue>(gpr::GPR_IDX::A1);
+    auto a2 = gpr.read<RegValue>(gpr::GPR_IDX::A2);
+
+    auto status = SimStatus::OK;
+    RegValue res = 0;
+    // Bytes processed
+    size_t size = 0;
+
+    switch (func) {
+    case HostFunc::MEMCPY:
+        status = hostMemcpy(a0, a1, a2);
+        res = a0;
+        size = a2;
+        break;
+    case HostFunc::MEMSET:
+        status = hostMemset(a0, static_cast<uint8_t>(a1), a2);
+        res = a0;
+        size = a2;
+        break;
+    case HostFunc::STRLEN:
+        status = hostStrlen(a0, size);
+        res = size++;
+        break;
+    case HostFunc::STRCMP: {
+        int cmp = 0;
+        status = hostStrcmp(a0, a1, cmp, size);
+        res = static_cast<RegValue>(int64_t{cmp});
+        break;
+    }
+    default:
+        SIM_UNREACHABLE();
+    }
+
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    gpr.write(gpr::GPR_IDX::A0, res);
+    logGprWrite(gpr::GPR_IDX::A0);
+
+    const auto &cost = m_host_func_costs[to_underlying(func)];
+    m_icount += cost.call_icount +
+                cost.word_icount * ((size + HOST_FUNC_WORD_SIZE - 1) /
+                                    HOST_FUNC_WORD_SIZE);
+
+    // Return to caller
+    m_hart.pc() = gpr.read<VirtAddr>(gpr::GPR_IDX::RA) & ~VirtAddr{1};
+
+    return SimStatus::OK;
+}
+
+} // namespace sim
+
+#endif // INCL_SIMULATOR_SIM_HOST_CALL_HPP
@@ -1,14 +1,24 @@
 #ifndef INCL_SIMULATOR_SIM_INSTR_HPP
 #define INCL_SIMULATOR_SIM_INSTR_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cfenv>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
 #include <sim/simulator.hpp>
+#include <sim/simulator/sim_csr.hpp>
+#include <sim/simulator/sim_host_call.hpp>
+#include <sim/simulator/sim_vector.hpp>
 
 namespace sim {
 
 inline constexpr const auto *getSimInstrPtr(instr::InstrId id);
 
-static constexpr VirtAddr PC_ALIGN_MASK = 0x3;
-
 #define SIM_INSTR(INSTR_NAME)                                                  \
     template <>                                                                \
     inline SimStatus Simulator::simInstr<instr::InstrId::INSTR_NAME>(          \
@@ -24,24 +34,55 @@ static constexpr VirtAddr PC_ALIGN_MASK = 0x3;
 #define INCR_AND_SIM_NEXT()                                                    \
     do {                                                                       \
         ++sim.m_icount;                                                        \
-        sim.m_hart.pc() += INSTR_CODE_SIZE;                                    \
+        sim.m_hart.pc() += instr->size();                                      \
         SIM_NEXT();                                                            \
     } while (0)
 
-#define LOG_REG_WRITE_INSTR(INSTR_NAME)                                        \
+#define LOG_REG_WRITE_INSTR()                                                  \
     do {                                                                       \
-        sim.logInstr(INSTR_NAME);                                              \
+        sim.logInstr(instr);                                                   \
         sim.logGprWrite(instr->rd());                                          \
     } while (0)
 
 SIM_INSTR(SIM_STATUS_INSTR) { return instr->status(); }
 
+// Host call ends bb: guest function returns to ra
+SIM_INSTR(SIM_HOST_CALL) {
+    sim.logInstr(instr);
+
+    if (sim.m_call_graph != nullptr) {
+        sim.m_call_graph->ret();
+    }
+
+    return sim.simHostCall(Simulator::HostFunc(instr->imm()));
+}
+
+// Plugin hook runs before next instr and takes no icount
+SIM_INSTR(SIM_PLUGIN_CALL) {
+    sim.m_plugins->call(instr->imm(), sim.m_hart);
+    SIM_NEXT();
+}
+
+// Instrumented bb entry: execution goes on with instrumented copy
+SIM_INSTR(SIM_PLUGIN_BLOCK) {
+    const auto *block = sim.m_plugins->blockInstrs(instr->imm());
+    return sim.dispatch(block->id())(sim, block);
+}
+
 SIM_INSTR(ECALL) {
-    sim.logInstr("ECALL");
+    sim.logInstr(instr);
 
     ++sim.m_icount;
-    sim.m_hart.pc() += INSTR_CODE_SIZE;
-    return SimStatus::SIM__EXIT;
+    sim.m_hart.pc() += instr->size();
+
+    // Syscall is handled in place. Simulation stops on exit only
+    auto status = sim.m_syscalls.handle(sim.m_hart);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    sim.logGprWrite(gpr::GPR_IDX::A0);
+    SIM_NEXT();
 }
 
 SIM_INSTR(ADD) {
@@ -52,7 +93,7 @@ SIM_INSTR(ADD) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("ADD");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -64,7 +105,7 @@ SIM_INSTR(SUB) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SUB");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -77,7 +118,7 @@ SIM_INSTR(SLT) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SLT");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -90,7 +131,7 @@ SIM_INSTR(SLTU) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SLTU");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -102,7 +143,7 @@ SIM_INSTR(AND) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("AND");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -114,7 +155,7 @@ SIM_INSTR(OR) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("OR");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -126,7 +167,7 @@ SIM_INSTR(XOR) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("XOR");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -138,7 +179,7 @@ SIM_INSTR(ADDI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("ADDI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -150,7 +191,7 @@ SIM_INSTR(SLTI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SLTI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -162,7 +203,7 @@ SIM_INSTR(SLTIU) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SLTIU");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -174,7 +215,7 @@ SIM_INSTR(ANDI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("ANDI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -186,7 +227,7 @@ SIM_INSTR(ORI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("ORI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -198,7 +239,7 @@ SIM_INSTR(XORI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("XORI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -208,7 +249,7 @@ SIM_INSTR(ADDIW) {
 
     gpr.write(instr->rd(), static_cast<int32_t>(word_res));
 
-    LOG_REG_WRITE_INSTR("ADDIW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -218,7 +259,7 @@ SIM_INSTR(SLLI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SLLI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -228,7 +269,7 @@ SIM_INSTR(SRLI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SRLI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -238,7 +279,7 @@ SIM_INSTR(SRAI) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SRAI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -249,7 +290,7 @@ SIM_INSTR(SLLIW) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SLLIW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -259,7 +300,7 @@ SIM_INSTR(SRLIW) {
 
     gpr.write(instr->rd(), static_cast<int32_t>(word_res));
 
-    LOG_REG_WRITE_INSTR("SRLIW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -269,7 +310,7 @@ SIM_INSTR(SRAIW) {
 
     gpr.write(instr->rd(), word_res);
 
-    LOG_REG_WRITE_INSTR("SRAIW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -278,7 +319,7 @@ SIM_INSTR(LUI) {
 
     gpr.write(instr->rd(), static_cast<int32_t>(instr->imm()));
 
-    LOG_REG_WRITE_INSTR("LUI");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -288,7 +329,7 @@ SIM_INSTR(AUIPC) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("AUIPC");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -299,7 +340,7 @@ SIM_INSTR(SLL) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SLL");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -310,7 +351,7 @@ SIM_INSTR(SRL) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SRL");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -321,7 +362,7 @@ SIM_INSTR(SRA) {
 
     gpr.write(instr->rd(), res);
 
-    LOG_REG_WRITE_INSTR("SRA");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -332,7 +373,7 @@ SIM_INSTR(ADDW) {
 
     gpr.write(instr->rd(), word_res);
 
-    LOG_REG_WRITE_INSTR("ADDW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -343,7 +384,7 @@ SIM_INSTR(SUBW) {
 
     gpr.write(instr->rd(), word_res);
 
-    LOG_REG_WRITE_INSTR("SUBW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -354,7 +395,7 @@ SIM_INSTR(SLLW) {
 
     gpr.write(instr->rd(), static_cast<int32_t>(word_res));
 
-    LOG_REG_WRITE_INSTR("SLLW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -365,7 +406,7 @@ SIM_INSTR(SRLW) {
 
     gpr.write(instr->rd(), static_cast<int32_t>(word_res));
 
-    LOG_REG_WRITE_INSTR("SRLW");
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
@@ -376,12 +417,306 @@ SIM_INSTR(SRAW) {
 
     gpr.write(instr->rd(), word_res);
 
-    LOG_REG_WRITE_INSTR("SRAW");
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+__extension__ using Int128 = __int128;
+__extension__ using Uint128 = unsigned __int128;
+
+// RISC-V division results: no traps on division by zero and overflow
+template <class Int> inline Int divResult(Int lhs, Int rhs) noexcept {
+    if (rhs == 0) {
+        return static_cast<Int>(-1);
+    }
+    if constexpr (std::is_signed_v<Int>) {
+        if (lhs == std::numeric_limits<Int>::min() && rhs == -1) {
+            return lhs;
+        }
+    }
+    return lhs / rhs;
+}
+
+template <class Int> inline Int remResult(Int lhs, Int rhs) noexcept {
+    if (rhs == 0) {
+        return lhs;
+    }
+    if constexpr (std::is_signed_v<Int>) {
+        if (lhs == std::numeric_limits<Int>::min() && rhs == -1) {
+            return 0;
+        }
+    }
+    return lhs % rhs;
+}
+
+template <class Float> NODISCARD bool isSignalingNaN(Float value) noexcept {
+    using Bits = std::conditional_t<sizeof(Float) == sizeof(uint32_t),
+                                    uint32_t, uint64_t>;
+    constexpr auto QUIET_BIT = Bits{1}
+                               << (std::numeric_limits<Float>::digits - 2);
+
+    return std::isnan(value) && !(std::bit_cast<Bits>(value) & QUIET_BIT);
+}
+
+// FMIN/FMAX semantics: NaN operand is ignored, -0 is less than +0
+template <class Float> Float fpMin(Float lhs, Float rhs) noexcept {
+    if (isSignalingNaN(lhs) || isSignalingNaN(rhs)) {
+        std::feraiseexcept(FE_INVALID);
+    }
+
+    if (std::isnan(lhs) && std::isnan(rhs)) {
+        return fpr::canonicalNaN<Float>();
+    }
+    if (std::isnan(lhs) || std::isnan(rhs)) {
+        return std::isnan(lhs) ? rhs : lhs;
+    }
+    if (lhs == rhs) {
+        return std::signbit(lhs) ? lhs : rhs;
+    }
+
+    return lhs < rhs ? lhs : rhs;
+}
+
+template <class Float> Float fpMax(Float lhs, Float rhs) noexcept {
+    if (isSignalingNaN(lhs) || isSignalingNaN(rhs)) {
+        std::feraiseexcept(FE_INVALID);
+    }
+
+    if (std::isnan(lhs) && std::isnan(rhs)) {
+        return fpr::canonicalNaN<Float>();
+    }
+    if (std::isnan(lhs) || std::isnan(rhs)) {
+        return std::isnan(lhs) ? rhs : lhs;
+    }
+    if (lhs == rhs) {
+        return std::signbit(lhs) ? rhs : lhs;
+    }
+
+    return lhs > rhs ? lhs : rhs;
+}
+
+// FEQ is quiet comparison: only signaling NaNs are invalid
+template <class Float> bool fpEq(Float lhs, Float rhs) noexcept {
+    if (isSignalingNaN(lhs) || isSignalingNaN(rhs)) {
+        std::feraiseexcept(FE_INVALID);
+    }
+
+    return lhs == rhs;
+}
+
+// FLT and FLE are signaling comparisons: any NaN is invalid
+template <class Float> bool fpLt(Float lhs, Float rhs) noexcept {
+    if (std::isnan(lhs) || std::isnan(rhs)) {
+        std::feraiseexcept(FE_INVALID);
+        return false;
+    }
+
+    return lhs < rhs;
+}
+
+template <class Float> bool fpLe(Float lhs, Float rhs) noexcept {
+    if (std::isnan(lhs) || std::isnan(rhs)) {
+        std::feraiseexcept(FE_INVALID);
+        return false;
+    }
+
+    return lhs <= rhs;
+}
+
+template <class Float> RegValue fpClass(Float value) noexcept {
+    bool negative = std::signbit(value);
+
+    switch (std::fpclassify(value)) {
+    case FP_INFINITE:
+        return negative ? 1 << 0 : 1 << 7;
+    case FP_NORMAL:
+        return negative ? 1 << 1 : 1 << 6;
+    case FP_SUBNORMAL:
+        return negative ? 1 << 2 : 1 << 5;
+    case FP_ZERO:
+        return negative ? 1 << 3 : 1 << 4;
+    default:
+        return isSignalingNaN(value) ? 1 << 8 : 1 << 9;
+    }
+}
+
+// Convert FP value to integer in current rounding mode or with ties to max
+// magnitude if rmm is set. Out of range values saturate and NaN is converted
+// to max value
+template <class Int, class Float>
+Int fpToInt(Float value, bool rmm) noexcept {
+    // Bounds are powers of 2, so they are exact
+    const Float upper =
+        std::ldexp(Float{1}, std::numeric_limits<Int>::digits);
+    const Float lower = std::is_signed_v<Int> ? -upper : Float{0};
+
+    if (std::isnan(value)) {
+        std::feraiseexcept(FE_INVALID);
+        return std::numeric_limits<Int>::max();
+    }
+
+    Float rounded = rmm ? std::round(value) : std::nearbyint(value);
+    if (rounded < lower) {
+        std::feraiseexcept(FE_INVALID);
+        return std::numeric_limits<Int>::min();
+    }
+    if (rounded >= upper) {
+        std::feraiseexcept(FE_INVALID);
+        return std::numeric_limits<Int>::max();
+    }
+
+    if (rounded != value) {
+        std::feraiseexcept(FE_INEXACT);
+    }
+
+    return static_cast<Int>(rounded);
+}
+
+SIM_INSTR(MUL) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res =
+        gpr.read<uint64_t>(instr->rs1()) * gpr.read<uint64_t>(instr->rs2());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MULH) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = static_cast<Int128>(gpr.read<int64_t>(instr->rs1())) *
+               gpr.read<int64_t>(instr->rs2());
+
+    gpr.write(instr->rd(), static_cast<uint64_t>(res >> 64));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MULHSU) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = static_cast<Int128>(gpr.read<int64_t>(instr->rs1())) *
+               static_cast<Int128>(gpr.read<uint64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), static_cast<uint64_t>(res >> 64));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MULHU) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = static_cast<Uint128>(gpr.read<uint64_t>(instr->rs1())) *
+               gpr.read<uint64_t>(instr->rs2());
+
+    gpr.write(instr->rd(), static_cast<uint64_t>(res >> 64));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(DIV) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = divResult(gpr.read<int64_t>(instr->rs1()),
+                         gpr.read<int64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(DIVU) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = divResult(gpr.read<uint64_t>(instr->rs1()),
+                         gpr.read<uint64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(REM) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = remResult(gpr.read<int64_t>(instr->rs1()),
+                         gpr.read<int64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(REMU) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = remResult(gpr.read<uint64_t>(instr->rs1()),
+                         gpr.read<uint64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MULW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto word_res = static_cast<int32_t>(gpr.read<uint32_t>(instr->rs1()) *
+                                         gpr.read<uint32_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(DIVW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto word_res = divResult(gpr.read<int32_t>(instr->rs1()),
+                              gpr.read<int32_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(DIVUW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto word_res = static_cast<int32_t>(divResult(
+        gpr.read<uint32_t>(instr->rs1()), gpr.read<uint32_t>(instr->rs2())));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(REMW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto word_res = remResult(gpr.read<int32_t>(instr->rs1()),
+                              gpr.read<int32_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(REMUW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto word_res = static_cast<int32_t>(remResult(
+        gpr.read<uint32_t>(instr->rs1()), gpr.read<uint32_t>(instr->rs2())));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
     INCR_AND_SIM_NEXT();
 }
 
 SIM_INSTR(LD) {
-    sim.logInstr("LD");
+    sim.logInstr(instr);
 
     auto status = sim.simLoadInstr<int64_t>(instr);
     if (status != SimStatus::OK) {
@@ -392,7 +727,7 @@ SIM_INSTR(LD) {
 }
 
 SIM_INSTR(LW) {
-    sim.logInstr("LW");
+    sim.logInstr(instr);
 
     auto status = sim.simLoadInstr<int32_t>(instr);
     if (status != SimStatus::OK) {
@@ -403,7 +738,7 @@ SIM_INSTR(LW) {
 }
 
 SIM_INSTR(LH) {
-    sim.logInstr("LH");
+    sim.logInstr(instr);
 
     auto status = sim.simLoadInstr<int16_t>(instr);
     if (status != SimStatus::OK) {
@@ -414,7 +749,7 @@ SIM_INSTR(LH) {
 }
 
 SIM_INSTR(LB) {
-    sim.logInstr("LB");
+    sim.logInstr(instr);
 
     auto status = sim.simLoadInstr<int8_t>(instr);
     if (status != SimStatus::OK) {
@@ -425,7 +760,7 @@ SIM_INSTR(LB) {
 }
 
 SIM_INSTR(LWU) {
-    sim.logInstr("LWU");
+    sim.logInstr(instr);
 
     auto status = sim.simLoadInstr<uint32_t>(instr);
     if (status != SimStatus::OK) {
@@ -436,7 +771,7 @@ SIM_INSTR(LWU) {
 }
 
 SIM_INSTR(LHU) {
-    sim.logInstr("LHU");
+    sim.logInstr(instr);
 
     auto status = sim.simLoadInstr<uint16_t>(instr);
     if (status != SimStatus::OK) {
@@ -447,7 +782,7 @@ SIM_INSTR(LHU) {
 }
 
 SIM_INSTR(LBU) {
-    sim.logInstr("LBU");
+    sim.logInstr(instr);
 
     auto status = sim.simLoadInstr<uint8_t>(instr);
     if (status != SimStatus::OK) {
@@ -458,7 +793,7 @@ SIM_INSTR(LBU) {
 }
 
 SIM_INSTR(SD) {
-    sim.logInstr("SD");
+    sim.logInstr(instr);
 
     auto status = sim.simStoreInstr<uint64_t>(instr);
     if (status != SimStatus::OK) {
@@ -469,7 +804,7 @@ SIM_INSTR(SD) {
 }
 
 SIM_INSTR(SW) {
-    sim.logInstr("SW");
+    sim.logInstr(instr);
 
     auto status = sim.simStoreInstr<uint32_t>(instr);
     if (status != SimStatus::OK) {
@@ -480,7 +815,7 @@ SIM_INSTR(SW) {
 }
 
 SIM_INSTR(SH) {
-    sim.logInstr("SH");
+    sim.logInstr(instr);
 
     auto status = sim.simStoreInstr<uint16_t>(instr);
     if (status != SimStatus::OK) {
@@ -491,7 +826,7 @@ SIM_INSTR(SH) {
 }
 
 SIM_INSTR(SB) {
-    sim.logInstr("SB");
+    sim.logInstr(instr);
 
     auto status = sim.simStoreInstr<uint8_t>(instr);
     if (status != SimStatus::OK) {
@@ -502,11 +837,11 @@ SIM_INSTR(SB) {
 }
 
 SIM_INSTR(JAL) {
-    sim.logInstr("JAL");
+    sim.logInstr(instr);
 
     auto &gpr = sim.m_hart.gprFile();
 
-    auto link_pc = sim.m_hart.pc() + 4;
+    auto link_pc = sim.m_hart.pc() + instr->size();
     int64_t offset = static_cast<int32_t>(instr->imm());
     auto new_pc = sim.m_hart.pc() + offset;
 
@@ -515,22 +850,24 @@ SIM_INSTR(JAL) {
     }
 
     gpr.write(instr->rd(), link_pc);
+    sim.modelJump(instr, false, new_pc);
+    sim.trackCallGraph(instr, false);
 
     ++sim.m_icount;
     sim.m_hart.pc() = new_pc;
 
     sim.logGprWrite(instr->rd());
-    sim.logPcWrite();
 
-    return SimStatus::OK;
+    // Followed by terminator in bb or by jump target in superblock
+    SIM_NEXT();
 }
 
 SIM_INSTR(JALR) {
-    sim.logInstr("JALR");
+    sim.logInstr(instr);
 
     auto &gpr = sim.m_hart.gprFile();
 
-    auto link_pc = sim.m_hart.pc() + 4;
+    auto link_pc = sim.m_hart.pc() + instr->size();
     int64_t offset = static_cast<int32_t>(instr->imm());
     auto new_pc = (offset + gpr.read<int64_t>(instr->rs1())) & ~1;
 
@@ -539,46 +876,2857 @@ SIM_INSTR(JALR) {
     }
 
     gpr.write(instr->rd(), link_pc);
+    sim.modelJump(instr, true, new_pc);
+    sim.trackCallGraph(instr, true);
 
     ++sim.m_icount;
     sim.m_hart.pc() = new_pc;
 
     sim.logGprWrite(instr->rd());
-    sim.logPcWrite();
 
     return SimStatus::OK;
 }
 
 SIM_INSTR(BEQ) {
-    sim.logInstr("BEQ");
+    sim.logInstr(instr);
     return sim.simCondBranch<int64_t, std::equal_to>(instr);
 }
 
 SIM_INSTR(BNE) {
-    sim.logInstr("BNE");
+    sim.logInstr(instr);
     return sim.simCondBranch<int64_t, std::not_equal_to>(instr);
 }
 
 SIM_INSTR(BLT) {
-    sim.logInstr("BLT");
+    sim.logInstr(instr);
     return sim.simCondBranch<int64_t, std::less>(instr);
 }
 
 SIM_INSTR(BLTU) {
-    sim.logInstr("BLTU");
+    sim.logInstr(instr);
     return sim.simCondBranch<uint64_t, std::less>(instr);
 }
 
 SIM_INSTR(BGE) {
-    sim.logInstr("BGE");
+    sim.logInstr(instr);
     return sim.simCondBranch<int64_t, std::greater_equal>(instr);
 }
 
 SIM_INSTR(BGEU) {
-    sim.logInstr("BGEU");
+    sim.logInstr(instr);
     return sim.simCondBranch<uint64_t, std::greater_equal>(instr);
 }
 
+// Atomically store value if cmp(value, old) is true.
+// Returns old value
+template <class Int, class Cmp>
+inline Int amoSelect(std::atomic_ref<Int> ref, Int value, Cmp cmp) noexcept {
+    Int old = ref.load();
+    while (!ref.compare_exchange_weak(old, cmp(value, old) ? value : old)) {
+    }
+    return old;
+}
+
+// Atomically store value if cmp(value, old) is true for unsigned values.
+// Returns old value
+template <class Int, class Cmp>
+inline Int amoSelectUnsigned(std::atomic_ref<Int> ref, Int value,
+                             Cmp cmp) noexcept {
+    using UInt = std::make_unsigned_t<Int>;
+
+    return amoSelect(ref, value, [cmp](Int lhs, Int rhs) {
+        return cmp(static_cast<UInt>(lhs), static_cast<UInt>(rhs));
+    });
+}
+
+SIM_INSTR(AMOADD_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_add(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOXOR_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_xor(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOOR_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_or(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOAND_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_and(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOSWAP_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(
+        instr, [](auto ref, auto value) { return ref.exchange(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMIN_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(instr, [](auto ref, auto value) {
+        return amoSelect(ref, value, std::less{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMAX_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(instr, [](auto ref, auto value) {
+        return amoSelect(ref, value, std::greater{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMINU_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(instr, [](auto ref, auto value) {
+        return amoSelectUnsigned(ref, value, std::less{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMAXU_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int32_t>(instr, [](auto ref, auto value) {
+        return amoSelectUnsigned(ref, value, std::greater{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(LR_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simLrInstr<int32_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(SC_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.simScInstr<int32_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOADD_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_add(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOXOR_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_xor(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOOR_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_or(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOAND_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(
+        instr, [](auto ref, auto value) { return ref.fetch_and(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOSWAP_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(
+        instr, [](auto ref, auto value) { return ref.exchange(value); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMIN_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(instr, [](auto ref, auto value) {
+        return amoSelect(ref, value, std::less{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMAX_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(instr, [](auto ref, auto value) {
+        return amoSelect(ref, value, std::greater{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMINU_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(instr, [](auto ref, auto value) {
+        return amoSelectUnsigned(ref, value, std::less{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(AMOMAXU_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simAmoInstr<int64_t>(instr, [](auto ref, auto value) {
+        return amoSelectUnsigned(ref, value, std::greater{});
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(LR_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simLrInstr<int64_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(SC_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simScInstr<int64_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FENCE) {
+    sim.logInstr(instr);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FLW) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpLoadInstr<uint32_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSW) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpStoreInstr<uint32_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FADD_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs + rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSUB_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs - rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMUL_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs * rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FDIV_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs / rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSQRT_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto src, auto, auto) { return std::sqrt(src); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMADD_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto a, auto b, auto c) { return std::fma(a, b, c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMSUB_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto a, auto b, auto c) { return std::fma(a, b, -c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FNMSUB_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto a, auto b, auto c) { return std::fma(-a, b, c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FNMADD_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<float>(
+        instr, [](auto a, auto b, auto c) { return std::fma(-a, b, -c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSGNJ_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<float>(instr, [](auto lhs, auto rhs, auto) {
+        return std::copysign(lhs, rhs);
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSGNJN_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<float>(instr, [](auto lhs, auto rhs, auto) {
+        return std::copysign(lhs, -rhs);
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSGNJX_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<float>(instr, [](auto lhs, auto rhs, auto) {
+        return std::signbit(rhs) ? -lhs : lhs;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMIN_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<float>(
+        instr, [](auto lhs, auto rhs, auto) { return fpMin(lhs, rhs); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMAX_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<float>(
+        instr, [](auto lhs, auto rhs, auto) { return fpMax(lhs, rhs); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FEQ_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<float>(instr, fpEq<float>);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FLT_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<float>(instr, fpLt<float>);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FLE_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<float>(instr, fpLe<float>);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FCLASS_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<float>(
+        instr, [](auto src, auto) { return fpClass(src); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_W_S) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<int32_t>(fpr.read<float>(instr->rs1()), rmm);
+
+    // 32-bit results are sign extended
+    gpr.write(instr->rd(), static_cast<int32_t>(res));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_S_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<int32_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<float>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_WU_S) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<uint32_t>(fpr.read<float>(instr->rs1()), rmm);
+
+    // 32-bit results are sign extended
+    gpr.write(instr->rd(), static_cast<int32_t>(res));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_S_WU) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<uint32_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<float>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_L_S) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<int64_t>(fpr.read<float>(instr->rs1()), rmm);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_S_L) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<int64_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<float>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_LU_S) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<uint64_t>(fpr.read<float>(instr->rs1()), rmm);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_S_LU) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<uint64_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<float>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FLD) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpLoadInstr<uint64_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSD) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpStoreInstr<uint64_t>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FADD_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs + rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSUB_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs - rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMUL_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs * rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FDIV_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto lhs, auto rhs, auto) { return lhs / rhs; });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSQRT_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto src, auto, auto) { return std::sqrt(src); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMADD_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto a, auto b, auto c) { return std::fma(a, b, c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMSUB_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto a, auto b, auto c) { return std::fma(a, b, -c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FNMSUB_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto a, auto b, auto c) { return std::fma(-a, b, c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FNMADD_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpRoundingInstr<double>(
+        instr, [](auto a, auto b, auto c) { return std::fma(-a, b, -c); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSGNJ_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<double>(instr, [](auto lhs, auto rhs, auto) {
+        return std::copysign(lhs, rhs);
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSGNJN_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<double>(instr, [](auto lhs, auto rhs, auto) {
+        return std::copysign(lhs, -rhs);
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FSGNJX_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<double>(instr, [](auto lhs, auto rhs, auto) {
+        return std::signbit(rhs) ? -lhs : lhs;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMIN_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<double>(
+        instr, [](auto lhs, auto rhs, auto) { return fpMin(lhs, rhs); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FMAX_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpInstr<double>(
+        instr, [](auto lhs, auto rhs, auto) { return fpMax(lhs, rhs); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FEQ_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<double>(instr, fpEq<double>);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FLT_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<double>(instr, fpLt<double>);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FLE_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<double>(instr, fpLe<double>);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FCLASS_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.simFpToGprInstr<double>(
+        instr, [](auto src, auto) { return fpClass(src); });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_W_D) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<int32_t>(fpr.read<double>(instr->rs1()), rmm);
+
+    // 32-bit results are sign extended
+    gpr.write(instr->rd(), static_cast<int32_t>(res));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_D_W) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<int32_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<double>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_WU_D) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<uint32_t>(fpr.read<double>(instr->rs1()), rmm);
+
+    // 32-bit results are sign extended
+    gpr.write(instr->rd(), static_cast<int32_t>(res));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_D_WU) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<uint32_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<double>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_L_D) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<int64_t>(fpr.read<double>(instr->rs1()), rmm);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_D_L) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<int64_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<double>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_LU_D) {
+    auto [status, rmm] = sim.setFpToIntRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = fpToInt<uint64_t>(fpr.read<double>(instr->rs1()), rmm);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_D_LU) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto src = sim.m_hart.gprFile().read<uint64_t>(instr->rs1());
+
+    fpr.write(instr->rd(), static_cast<double>(src));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FMV_X_W) {
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+    auto bits = static_cast<uint32_t>(fpr.readBits(instr->rs1()));
+
+    gpr.write(instr->rd(), static_cast<int32_t>(bits));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FMV_W_X) {
+    sim.logInstr(instr);
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto bits = sim.m_hart.gprFile().read<uint32_t>(instr->rs1());
+
+    fpr.writeBits(instr->rd(), fpr::NAN_BOX | bits);
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FMV_X_D) {
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+
+    gpr.write(instr->rd(), fpr.readBits(instr->rs1()));
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FMV_D_X) {
+    sim.logInstr(instr);
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto &gpr = sim.m_hart.gprFile();
+
+    fpr.writeBits(instr->rd(), gpr.read<uint64_t>(instr->rs1()));
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_S_D) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto res = static_cast<float>(fpr.read<double>(instr->rs1()));
+
+    fpr.write(instr->rd(), std::isnan(res) ? fpr::canonicalNaN<float>() : res);
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(FCVT_D_S) {
+    sim.logInstr(instr);
+
+    auto status = sim.setRoundingMode(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    auto &fpr = sim.m_hart.fprFile();
+    auto res = static_cast<double>(fpr.read<float>(instr->rs1()));
+
+    fpr.write(instr->rd(), std::isnan(res) ? fpr::canonicalNaN<double>() : res);
+
+    sim.logFprWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ADD_UW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs2()) +
+               gpr.read<uint32_t>(instr->rs1());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SH1ADD) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs2()) +
+               (gpr.read<uint64_t>(instr->rs1()) << 1);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SH2ADD) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs2()) +
+               (gpr.read<uint64_t>(instr->rs1()) << 2);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SH3ADD) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs2()) +
+               (gpr.read<uint64_t>(instr->rs1()) << 3);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SH1ADD_UW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs2()) +
+               (uint64_t{gpr.read<uint32_t>(instr->rs1())} << 1);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SH2ADD_UW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs2()) +
+               (uint64_t{gpr.read<uint32_t>(instr->rs1())} << 2);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SH3ADD_UW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs2()) +
+               (uint64_t{gpr.read<uint32_t>(instr->rs1())} << 3);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SLLI_UW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = uint64_t{gpr.read<uint32_t>(instr->rs1())} << instr->imm();
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ANDN) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res =
+        gpr.read<uint64_t>(instr->rs1()) & ~gpr.read<uint64_t>(instr->rs2());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ORN) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res =
+        gpr.read<uint64_t>(instr->rs1()) | ~gpr.read<uint64_t>(instr->rs2());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(XNOR) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res =
+        ~(gpr.read<uint64_t>(instr->rs1()) ^ gpr.read<uint64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+// Bit counting is done with <bit>, which is lowered to lzcnt, tzcnt and
+// popcnt when the host has them
+SIM_INSTR(CLZ) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::countl_zero(gpr.read<uint64_t>(instr->rs1()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(CLZW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::countl_zero(gpr.read<uint32_t>(instr->rs1()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(CTZ) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::countr_zero(gpr.read<uint64_t>(instr->rs1()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(CTZW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::countr_zero(gpr.read<uint32_t>(instr->rs1()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(CPOP) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::popcount(gpr.read<uint64_t>(instr->rs1()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(CPOPW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::popcount(gpr.read<uint32_t>(instr->rs1()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MAX) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::max(gpr.read<int64_t>(instr->rs1()),
+                        gpr.read<int64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MAXU) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::max(gpr.read<uint64_t>(instr->rs1()),
+                        gpr.read<uint64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MIN) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::min(gpr.read<int64_t>(instr->rs1()),
+                        gpr.read<int64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(MINU) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::min(gpr.read<uint64_t>(instr->rs1()),
+                        gpr.read<uint64_t>(instr->rs2()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SEXT_B) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<int8_t>(instr->rs1());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(SEXT_H) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<int16_t>(instr->rs1());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ZEXT_H) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint16_t>(instr->rs1());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ROL) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto shamt = static_cast<int>(gpr.read<uint64_t>(instr->rs2()) & 0x3f);
+    auto res = std::rotl(gpr.read<uint64_t>(instr->rs1()), shamt);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ROLW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto shamt = static_cast<int>(gpr.read<uint64_t>(instr->rs2()) & 0x1f);
+    auto word_res = static_cast<int32_t>(
+        std::rotl(gpr.read<uint32_t>(instr->rs1()), shamt));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ROR) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto shamt = static_cast<int>(gpr.read<uint64_t>(instr->rs2()) & 0x3f);
+    auto res = std::rotr(gpr.read<uint64_t>(instr->rs1()), shamt);
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(RORI) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = std::rotr(gpr.read<uint64_t>(instr->rs1()),
+                         static_cast<int>(instr->imm()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(RORIW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto word_res = static_cast<int32_t>(std::rotr(
+        gpr.read<uint32_t>(instr->rs1()), static_cast<int>(instr->imm())));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(RORW) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto shamt = static_cast<int>(gpr.read<uint64_t>(instr->rs2()) & 0x1f);
+    auto word_res = static_cast<int32_t>(
+        std::rotr(gpr.read<uint32_t>(instr->rs1()), shamt));
+
+    gpr.write(instr->rd(), word_res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(ORC_B) {
+    constexpr uint64_t LOW_7_BITS = 0x7f7f7f7f7f7f7f7f;
+
+    auto &gpr = sim.m_hart.gprFile();
+    auto value = gpr.read<uint64_t>(instr->rs1());
+
+    // Top bit of each byte is set iff byte is not zero
+    auto nonzero = (((value & LOW_7_BITS) + LOW_7_BITS) | value) & ~LOW_7_BITS;
+    auto res = (nonzero >> 7) * 0xff;
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(REV8) {
+    auto &gpr = sim.m_hart.gprFile();
+    // std::byteswap is C++23
+    auto res = __builtin_bswap64(gpr.read<uint64_t>(instr->rs1()));
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BCLR) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto bit = uint64_t{1} << (gpr.read<uint64_t>(instr->rs2()) & 0x3f);
+    auto res = gpr.read<uint64_t>(instr->rs1()) & ~bit;
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BCLRI) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res =
+        gpr.read<uint64_t>(instr->rs1()) & ~(uint64_t{1} << instr->imm());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BEXT) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto shamt = gpr.read<uint64_t>(instr->rs2()) & 0x3f;
+    auto res = (gpr.read<uint64_t>(instr->rs1()) >> shamt) & 1;
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BEXTI) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = (gpr.read<uint64_t>(instr->rs1()) >> instr->imm()) & 1;
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BINV) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto bit = uint64_t{1} << (gpr.read<uint64_t>(instr->rs2()) & 0x3f);
+    auto res = gpr.read<uint64_t>(instr->rs1()) ^ bit;
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BINVI) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs1()) ^ (uint64_t{1} << instr->imm());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BSET) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto bit = uint64_t{1} << (gpr.read<uint64_t>(instr->rs2()) & 0x3f);
+    auto res = gpr.read<uint64_t>(instr->rs1()) | bit;
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(BSETI) {
+    auto &gpr = sim.m_hart.gprFile();
+    auto res = gpr.read<uint64_t>(instr->rs1()) | (uint64_t{1} << instr->imm());
+
+    gpr.write(instr->rd(), res);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(VSETVLI) {
+    sim.logInstr(instr);
+
+    // AVL in x0 requests vlmax. vl is kept if rd is x0 too
+    auto rs1 = instr->rs1();
+    auto avl = rs1 != 0 ? sim.m_hart.gprFile().read<RegValue>(rs1)
+                        : ~RegValue{0};
+
+    auto keep_vl = rs1 == 0 && instr->rd() == 0;
+    auto status = sim.simVsetInstr(instr, avl, instr->imm(), keep_vl);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSETIVLI) {
+    sim.logInstr(instr);
+
+    // AVL immediate is stored in rs1 field
+    auto status = sim.simVsetInstr(instr, instr->rs1(), instr->imm(), false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSETVL) {
+    sim.logInstr(instr);
+
+    auto &gpr = sim.m_hart.gprFile();
+    auto rs1 = instr->rs1();
+    auto avl = rs1 != 0 ? gpr.read<RegValue>(rs1) : ~RegValue{0};
+
+    auto status = sim.simVsetInstr(instr, avl, gpr.read<RegValue>(instr->rs2()),
+                                   rs1 == 0 && instr->rd() == 0);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLE8_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint8_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLE16_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint16_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLE32_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint32_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLE64_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint64_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSE8_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint8_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSE16_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint16_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSE32_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint32_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSE64_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint64_t>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLSE8_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint8_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLSE16_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint16_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLSE32_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint32_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VLSE64_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecLoadInstr<uint64_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSSE8_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint8_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSSE16_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint16_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSSE32_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint32_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSSE64_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecStoreInstr<uint64_t>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VADD_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::ADD, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VADD_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::ADD, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VADD_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::ADD, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSUB_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SUB, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSUB_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SUB, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VRSUB_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::RSUB, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VRSUB_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::RSUB, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMINU_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MINU, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMINU_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MINU, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMIN_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MIN, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMIN_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MIN, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMAXU_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MAXU, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMAXU_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MAXU, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMAX_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MAX, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMAX_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MAX, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VAND_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::AND, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VAND_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::AND, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VAND_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::AND, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VOR_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::OR, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VOR_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::OR, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VOR_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::OR, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VXOR_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::XOR, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VXOR_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::XOR, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VXOR_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::XOR, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSEQ_VV) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::equal_to, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSEQ_VX) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::equal_to, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSEQ_VI) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::equal_to, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSNE_VV) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::not_equal_to, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSNE_VX) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::not_equal_to, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSNE_VI) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::not_equal_to, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLTU_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecCmpInstr<false, std::less, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLTU_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecCmpInstr<false, std::less, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLT_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecCmpInstr<true, std::less, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLT_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecCmpInstr<true, std::less, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLEU_VV) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::less_equal, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLEU_VX) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::less_equal, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLEU_VI) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::less_equal, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLE_VV) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<true, std::less_equal, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLE_VX) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<true, std::less_equal, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSLE_VI) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<true, std::less_equal, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSGTU_VX) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::greater, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSGTU_VI) {
+    sim.logInstr(instr);
+
+    auto status =
+        sim.simVecCmpInstr<false, std::greater, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSGT_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecCmpInstr<true, std::greater, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMSGT_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecCmpInstr<true, std::greater, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSLL_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SLL, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSLL_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SLL, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSLL_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SLL, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSRL_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SRL, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSRL_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SRL, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSRL_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SRL, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSRA_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SRA, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSRA_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SRA, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VSRA_VI) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::SRA, VecOperand::VI>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMERGE_VVM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMergeInstr<VecOperand::VV>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMV_V_V) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMergeInstr<VecOperand::VV>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMERGE_VXM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMergeInstr<VecOperand::VX>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMV_V_X) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMergeInstr<VecOperand::VX>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMERGE_VIM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMergeInstr<VecOperand::VI>(instr, true);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMV_V_I) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMergeInstr<VecOperand::VI>(instr, false);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDSUM_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::ADD>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDAND_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::AND>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDOR_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::OR>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDXOR_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::XOR>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDMINU_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::MINU>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDMIN_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::MIN>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDMAXU_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::MAXU>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VREDMAX_VS) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecReduceInstr<vr::Op::MAX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMANDN_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::ANDN>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMAND_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::AND>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMOR_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::OR>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMXOR_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::XOR>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMORN_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::ORN>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMNAND_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::NAND>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMNOR_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::NOR>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMXNOR_MM) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecMaskInstr<vr::Op::XNOR>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMV_X_S) {
+    auto &vr_file = sim.m_hart.vrFile();
+    auto &gpr = sim.m_hart.gprFile();
+
+    // Element 0 is read regardless of vl
+    auto status = withSew(vr_file.sew(), [&](auto zero) {
+        using Int = std::make_signed_t<decltype(zero)>;
+
+        gpr.write(instr->rd(), vr_file.readElem<Int>(instr->rs2(), 0));
+        return SimStatus::OK;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(VCPOP_M) {
+    auto &vr_file = sim.m_hart.vrFile();
+    if (vr_file.vill()) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0, vl = vr_file.vl(); i != vl; ++i) {
+        count += vr_file.active(instr->vm(), i) &&
+                 vr_file.maskBit(instr->rs2(), i);
+    }
+
+    sim.m_hart.gprFile().write(instr->rd(), count);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(VFIRST_M) {
+    auto &vr_file = sim.m_hart.vrFile();
+    if (vr_file.vill()) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    // -1 if no mask bit is set
+    int64_t first = -1;
+    for (size_t i = 0, vl = vr_file.vl(); i != vl; ++i) {
+        if (vr_file.active(instr->vm(), i) &&
+            vr_file.maskBit(instr->rs2(), i)) {
+            first = static_cast<int64_t>(i);
+            break;
+        }
+    }
+
+    sim.m_hart.gprFile().write(instr->rd(), first);
+
+    LOG_REG_WRITE_INSTR();
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(VMV_S_X) {
+    sim.logInstr(instr);
+
+    auto &vr_file = sim.m_hart.vrFile();
+    auto value = sim.m_hart.gprFile().read<uint64_t>(instr->rs1());
+
+    auto status = withSew(vr_file.sew(), [&](auto zero) {
+        if (vr_file.vl() != 0) {
+            vr_file.writeElem(instr->rd(), 0,
+                              static_cast<decltype(zero)>(value));
+        }
+        return SimStatus::OK;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    sim.logVrWrite(instr->rd());
+    INCR_AND_SIM_NEXT();
+}
+
+SIM_INSTR(VMUL_VV) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MUL, VecOperand::VV>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(VMUL_VX) {
+    sim.logInstr(instr);
+
+    auto status = sim.simVecArithInstr<vr::Op::MUL, VecOperand::VX>(instr);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(CSRRW) {
+    sim.logInstr(instr);
+
+    auto src = sim.m_hart.gprFile().read<RegValue>(instr->rs1());
+
+    auto status = sim.simCSRInstr<CSROp::WRITE>(instr, src);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(CSRRS) {
+    sim.logInstr(instr);
+
+    auto src = sim.m_hart.gprFile().read<RegValue>(instr->rs1());
+
+    auto status = sim.simCSRInstr<CSROp::SET>(instr, src);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(CSRRC) {
+    sim.logInstr(instr);
+
+    auto src = sim.m_hart.gprFile().read<RegValue>(instr->rs1());
+
+    auto status = sim.simCSRInstr<CSROp::CLEAR>(instr, src);
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(CSRRWI) {
+    sim.logInstr(instr);
+
+    // uimm5 is encoded in rs1 field
+    auto status = sim.simCSRInstr<CSROp::WRITE>(instr, instr->rs1());
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(CSRRSI) {
+    sim.logInstr(instr);
+
+    // uimm5 is encoded in rs1 field
+    auto status = sim.simCSRInstr<CSROp::SET>(instr, instr->rs1());
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(CSRRCI) {
+    sim.logInstr(instr);
+
+    // uimm5 is encoded in rs1 field
+    auto status = sim.simCSRInstr<CSROp::CLEAR>(instr, instr->rs1());
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    SIM_NEXT();
+}
+
+SIM_INSTR(FENCE_I) {
+    sim.logInstr(instr);
+
+    // Drop decoded code. FENCE.I ends bb, so current bb is not used anymore
+    sim.invalidateBbCache();
+
+    // Code pages could be modified through cached host pointers
+    if (sim.m_shared_bb_store != nullptr) {
+        sim.getPhysMemory().invalidateCodeHashes();
+    }
+
+    ++sim.m_icount;
+    sim.m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
 #undef SIM_INSTR
 #undef INCR_AND_SIM_NEXT
 #undef LOG_REG_WRITE_INSTR
@@ -0,0 +1,454 @@
+#ifndef INCL_SIMULATOR_SIM_VECTOR_HPP
+#define INCL_SIMULATOR_SIM_VECTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+#include <sim/simulator.hpp>
+
+namespace sim {
+
+template <class Func> SimStatus Simulator::withSew(size_t sew, Func func) {
+    switch (sew) {
+    case sizeof(uint8_t):
+        return func(uint8_t{});
+    case sizeof(uint16_t):
+        return func(uint16_t{});
+    case sizeof(uint32_t):
+        return func(uint32_t{});
+    case sizeof(uint64_t):
+        return func(uint64_t{});
+    default:
+        // Vector instrs are illegal while vill is set
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+}
+
+inline bool
+Simulator::vecGroupsValid(std::initializer_list<size_t> regs) const noexcept {
+    const auto &vr_file = m_hart.vrFile();
+    if (vr_file.vill()) {
+        return false;
+    }
+
+    return std::all_of(regs.begin(), regs.end(),
+                       [&](size_t idx) { return vr_file.validGroup(idx); });
+}
+
+template <class UInt, Simulator::VecOperand operand>
+UInt Simulator::vecScalar(const instr::Instr *instr,
+                          bool unsigned_imm) const noexcept {
+    static_assert(operand != VecOperand::VV);
+
+    if constexpr (operand == VecOperand::VX) {
+        return static_cast<UInt>(m_hart.gprFile().read<uint64_t>(instr->rs1()));
+    } else {
+        constexpr uint32_t UIMM5_MASK = 0x1f;
+
+        auto imm = static_cast<int32_t>(instr->imm());
+        return static_cast<UInt>(unsigned_imm ? imm & UIMM5_MASK : imm);
+    }
+}
+
+inline SimStatus Simulator::simVsetInstr(const instr::Instr *instr,
+                                         RegValue avl, RegValue vtype,
+                                         bool keep_vl) noexcept {
+    auto &vr_file = m_hart.vrFile();
+    auto vl = vr_file.vl();
+
+    if (vr_file.setVtype(vtype)) {
+        vr_file.setVl(std::min<RegValue>(keep_vl ? vl : avl, vr_file.vlmax()));
+    }
+
+    m_hart.gprFile().write(instr->rd(), vr_file.vl());
+
+    logGprWrite(instr->rd());
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+template <class UInt>
+SimStatus Simulator::simVecLoadInstr(const instr::Instr *instr, bool strided) {
+    auto &vr_file = m_hart.vrFile();
+    auto &gpr = m_hart.gprFile();
+
+    auto vd = instr->rd();
+    auto group_size = vr_file.groupSizeFor(sizeof(UInt));
+    if (group_size == 0 || vd % group_size != 0 ||
+        (!instr->vm() && vd == 0)) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    auto va = gpr.read<VirtAddr>(instr->rs1());
+    auto vl = vr_file.vl();
+
+    if (!strided && instr->vm()) {
+        if (va & memory::addrAlignMask<UInt>()) {
+            return SimStatus::SIM__UNALIGNED_LOAD;
+        }
+
+        // Unit-stride data is copied page by page with one TLB lookup per
+        // page. Models see it as element accesses
+        auto *dst = vr_file.data(vd);
+        for (size_t left = vl * sizeof(UInt); left != 0;) {
+            auto chunk = std::min<size_t>(
+                left, memory::PAGE_SIZE - (va & memory::PAGE_OFFSET_MASK));
+
+            memory::ConstHostPtr src = nullptr;
+            auto status = getReadHostPtr(va, src);
+            if (status != SimStatus::OK) {
+                return status;
+            }
+
+            modelBulkAccess(trace::MemRecord::READ, va, chunk, sizeof(UInt));
+            std::memcpy(dst, src, chunk);
+
+            dst += chunk;
+            va += chunk;
+            left -= chunk;
+        }
+    } else {
+        auto stride = strided ? gpr.read<VirtAddr>(instr->rs2()) : sizeof(UInt);
+
+        for (size_t i = 0; i != vl; ++i, va += stride) {
+            if (!vr_file.active(instr->vm(), i)) {
+                continue;
+            }
+
+            auto [status, value] = loadInt<UInt, MemAccessType::READ>(va);
+            if (status != SimStatus::OK) {
+                return status;
+            }
+
+            vr_file.writeElem(vd, i, value);
+        }
+    }
+
+    logVrWrite(vd);
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+template <class UInt>
+SimStatus Simulator::simVecStoreInstr(const instr::Instr *instr,
+                                      bool strided) {
+    auto &vr_file = m_hart.vrFile();
+    auto &gpr = m_hart.gprFile();
+
+    // Store data register is encoded in vd field
+    auto vs3 = instr->rd();
+    auto group_size = vr_file.groupSizeFor(sizeof(UInt));
+    if (group_size == 0 || vs3 % group_size != 0) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    auto va = gpr.read<VirtAddr>(instr->rs1());
+    auto vl = vr_file.vl();
+
+    if (!strided && instr->vm()) {
+        if (va & memory::addrAlignMask<UInt>()) {
+            return SimStatus::SIM__UNALIGNED_STORE;
+        }
+
+        const auto *src = vr_file.data(vs3);
+        for (size_t left = vl * sizeof(UInt); left != 0;) {
+            auto chunk = std::min<size_t>(
+                left, memory::PAGE_SIZE - (va & memory::PAGE_OFFSET_MASK));
+
+            memory::HostPtr dst = nullptr;
+            auto status = getWriteHostPtr(va, dst);
+            if (status != SimStatus::OK) {
+                return status;
+            }
+
+            modelBulkAccess(trace::MemRecord::WRITE, va, chunk, sizeof(UInt));
+            std::memcpy(dst, src, chunk);
+
+            src += chunk;
+            va += chunk;
+            left -= chunk;
+        }
+    } else {
+        auto stride = strided ? gpr.read<VirtAddr>(instr->rs2()) : sizeof(UInt);
+
+        for (size_t i = 0; i != vl; ++i, va += stride) {
+            if (!vr_file.active(instr->vm(), i)) {
+                continue;
+            }
+
+            auto status = storeInt(va, vr_file.readElem<UInt>(vs3, i));
+            if (status != SimStatus::OK) {
+                return status;
+            }
+        }
+    }
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+template <vr::Op op, Simulator::VecOperand operand>
+SimStatus Simulator::simVecArithInstr(const instr::Instr *instr) {
+    auto &vr_file = m_hart.vrFile();
+
+    size_t vs1 = operand == VecOperand::VV ? instr->rs1() : 0;
+    if (!vecGroupsValid({instr->rd(), instr->rs2(), vs1}) ||
+        (!instr->vm() && instr->rd() == 0)) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    auto status = withSew(vr_file.sew(), [&](auto zero) {
+        using UInt = decltype(zero);
+
+        auto vl = vr_file.vl();
+        auto *vd = reinterpret_cast<UInt *>(vr_file.data(instr->rd()));
+        const auto *vs2 =
+            reinterpret_cast<const UInt *>(vr_file.data(instr->rs2()));
+
+        if constexpr (operand == VecOperand::VV) {
+            const auto *vs1 =
+                reinterpret_cast<const UInt *>(vr_file.data(instr->rs1()));
+
+            if (instr->vm()) {
+                vr::vvKernel<op>(vd, vs2, vs1, vl);
+                return SimStatus::OK;
+            }
+
+            for (size_t i = 0; i != vl; ++i) {
+                if (vr_file.maskBit(0, i)) {
+                    vd[i] = vr::scalarOp<op>(vs2[i], vs1[i]);
+                }
+            }
+        } else {
+            constexpr bool IS_SHIFT =
+                op == vr::Op::SLL || op == vr::Op::SRL || op == vr::Op::SRA;
+            auto x = vecScalar<UInt, operand>(instr, IS_SHIFT);
+
+            if (instr->vm()) {
+                vr::vxKernel<op>(vd, vs2, x, vl);
+                return SimStatus::OK;
+            }
+
+            for (size_t i = 0; i != vl; ++i) {
+                if (vr_file.maskBit(0, i)) {
+                    vd[i] = vr::scalarOp<op>(vs2[i], x);
+                }
+            }
+        }
+
+        return SimStatus::OK;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    logVrWrite(instr->rd());
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+template <Simulator::VecOperand operand>
+SimStatus Simulator::simVecMergeInstr(const instr::Instr *instr, bool merge) {
+    auto &vr_file = m_hart.vrFile();
+
+    size_t vs1 = operand == VecOperand::VV ? instr->rs1() : 0;
+    if (!vecGroupsValid({instr->rd(), instr->rs2(), vs1}) ||
+        (merge && instr->rd() == 0)) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    auto status = withSew(vr_file.sew(), [&](auto zero) {
+        using UInt = decltype(zero);
+
+        auto vl = vr_file.vl();
+        auto *vd = reinterpret_cast<UInt *>(vr_file.data(instr->rd()));
+        const auto *vs2 =
+            reinterpret_cast<const UInt *>(vr_file.data(instr->rs2()));
+
+        if constexpr (operand == VecOperand::VV) {
+            const auto *vs1 =
+                reinterpret_cast<const UInt *>(vr_file.data(instr->rs1()));
+
+            if (!merge) {
+                std::memmove(vd, vs1, vl * sizeof(UInt));
+                return SimStatus::OK;
+            }
+
+            for (size_t i = 0; i != vl; ++i) {
+                vd[i] = vr_file.maskBit(0, i) ? vs1[i] : vs2[i];
+            }
+        } else {
+            auto x = vecScalar<UInt, operand>(instr, false);
+
+            if (!merge) {
+                vr::splatKernel(vd, x, vl);
+                return SimStatus::OK;
+            }
+
+            for (size_t i = 0; i != vl; ++i) {
+                vd[i] = vr_file.maskBit(0, i) ? x : vs2[i];
+            }
+        }
+
+        return SimStatus::OK;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    logVrWrite(instr->rd());
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+template <bool is_signed, template <typename> typename Cmp,
+          Simulator::VecOperand operand>
+SimStatus Simulator::simVecCmpInstr(const instr::Instr *instr) {
+    auto &vr_file = m_hart.vrFile();
+
+    size_t vs1 = operand == VecOperand::VV ? instr->rs1() : 0;
+    if (!vecGroupsValid({instr->rs2(), vs1})) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    auto status = withSew(vr_file.sew(), [&](auto zero) {
+        using UInt = decltype(zero);
+        using Elem =
+            std::conditional_t<is_signed, std::make_signed_t<UInt>, UInt>;
+
+        auto vl = vr_file.vl();
+        const auto *vs2 =
+            reinterpret_cast<const UInt *>(vr_file.data(instr->rs2()));
+
+        // Result is built aside: vd may overlap sources and v0
+        std::array<uint8_t, vr::VLENB> mask{};
+        std::memcpy(mask.data(), vr_file.data(instr->rd()), mask.size());
+
+        for (size_t i = 0; i != vl; ++i) {
+            if (!vr_file.active(instr->vm(), i)) {
+                continue;
+            }
+
+            UInt rhs = 0;
+            if constexpr (operand == VecOperand::VV) {
+                rhs = vr_file.readElem<UInt>(instr->rs1(), i);
+            } else {
+                rhs = vecScalar<UInt, operand>(instr, false);
+            }
+
+            auto bit_mask = static_cast<uint8_t>(1 << (i % bit::BYTE_SIZE));
+            auto &byte = mask[i / bit::BYTE_SIZE];
+
+            auto lhs = static_cast<Elem>(vs2[i]);
+            if (Cmp<Elem>()(lhs, static_cast<Elem>(rhs))) {
+                byte |= bit_mask;
+            } else {
+                byte &= static_cast<uint8_t>(~bit_mask);
+            }
+        }
+
+        std::memcpy(vr_file.data(instr->rd()), mask.data(), mask.size());
+        return SimStatus::OK;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    logVrWrite(instr->rd());
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+template <vr::Op op>
+SimStatus Simulator::simVecReduceInstr(const instr::Instr *instr) {
+    auto &vr_file = m_hart.vrFile();
+
+    if (!vecGroupsValid({instr->rs2()})) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    auto status = withSew(vr_file.sew(), [&](auto zero) {
+        using UInt = decltype(zero);
+
+        auto vl = vr_file.vl();
+        if (vl == 0) {
+            return SimStatus::OK;
+        }
+
+        const auto *vs2 =
+            reinterpret_cast<const UInt *>(vr_file.data(instr->rs2()));
+        auto res = vr_file.readElem<UInt>(instr->rs1(), 0);
+
+        if (instr->vm()) {
+            res = vr::reduceKernel<op>(vs2, vl, res);
+        } else {
+            for (size_t i = 0; i != vl; ++i) {
+                if (vr_file.maskBit(0, i)) {
+                    res = vr::scalarOp<op>(res, vs2[i]);
+                }
+            }
+        }
+
+        vr_file.writeElem(instr->rd(), 0, res);
+        return SimStatus::OK;
+    });
+    if (status != SimStatus::OK) {
+        return status;
+    }
+
+    logVrWrite(instr->rd());
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+template <vr::Op op>
+SimStatus Simulator::simVecMaskInstr(const instr::Instr *instr) {
+    auto &vr_file = m_hart.vrFile();
+
+    if (vr_file.vill()) {
+        return SimStatus::SIM__NOT_IMPLEMENTED_INSTR;
+    }
+
+    auto vl = vr_file.vl();
+    auto *vd = vr_file.data(instr->rd());
+    const auto *vs2 = vr_file.data(instr->rs2());
+    const auto *vs1 = vr_file.data(instr->rs1());
+
+    // Whole bytes of mask are processed by kernel
+    auto bytes = vl / bit::BYTE_SIZE;
+    vr::vvKernel<op>(vd, vs2, vs1, bytes);
+
+    // Bits past vl are kept
+    if (auto tail_bits = vl % bit::BYTE_SIZE; tail_bits != 0) {
+        auto keep_mask = static_cast<uint8_t>(0xff << tail_bits);
+        auto res = vr::scalarOp<op>(vs2[bytes], vs1[bytes]);
+
+        vd[bytes] = static_cast<uint8_t>((vd[bytes] & keep_mask) |
+                                         (res & ~keep_mask));
+    }
+
+    logVrWrite(instr->rd());
+
+    ++m_icount;
+    m_hart.pc() += instr->size();
+    return SimStatus::OK;
+}
+
+} // namespace sim
+
+#endif // INCL_SIMULATOR_SIM_VECTOR_HPP
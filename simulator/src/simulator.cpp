@@ -1,22 +1,286 @@
+#include <algorithm>
+#include <chrono>
+
 #include <sim/simulator.hpp>
 #include <sim/simulator/sim_instr.hpp>
 
 namespace sim {
 
-SimStatus Simulator::simulate(VirtAddr start_pc) {
+SimStatus Simulator::serveIpi() noexcept {
+    auto ipi = m_pending_ipi.exchange(0, std::memory_order_acquire);
+
+    if (ipi & IPI_TLB_FLUSH) {
+        invalidateTLBs();
+    }
+
+    if (ipi & IPI_BB_CACHE_FLUSH) {
+        invalidateBbCache();
+    }
+
+    if (ipi & IPI_HOT_BB_READY) {
+        installHotBbs();
+    }
+
+    if ((ipi & IPI_CALL_GRAPH_SAMPLE) && m_call_graph != nullptr) {
+        m_call_graph->sample(m_hart.pc(), m_icount);
+    }
+
+    if (ipi & IPI_STOP) {
+        return SimStatus::SIM__STOP_REQUEST;
+    }
+
+    return SimStatus::OK;
+}
+
+Simulator::SharedBbResult Simulator::findSharedBb(VirtAddr virt_addr) {
+    // Host call bbs are private
+    if (findHostFunc(virt_addr) != nullptr) {
+        return {SimStatus::OK, nullptr};
+    }
+
+    auto [mmu_status, pa] = translateVa<MemAccessType::FETCH>(virt_addr);
+    if (mmu_status != SimStatus::OK) {
+        return {mmu_status, nullptr};
+    }
+
+    // Instr crossing page boundary depends on two pages, so bb starting with
+    // it is kept private
+    auto page_offset = pa & memory::PAGE_OFFSET_MASK;
+    if (page_offset > memory::PAGE_SIZE - INSTR_CODE_SIZE) {
+        return {SimStatus::OK, nullptr};
+    }
+
+    auto page_pa = pa - page_offset;
+    auto page_hash = m_hart.physMemory().getCodePageHash(page_pa);
+    if (page_hash == 0) {
+        return {SimStatus::PHYS_MEM__ACCESS_FAULT, nullptr};
+    }
+
+    auto key = cache::SharedBbStore::Key{
+        pa, page_hash,
+        m_hart.physMemory().getConstHostPagePtr(page_pa) + page_offset,
+        std::min(cache::SharedBbStore::MAX_CODE_SIZE,
+                 memory::PAGE_SIZE - page_offset)};
+
+    if (const auto *bb = m_shared_bb_store->find(key)) {
+        return {SimStatus::OK, bb};
+    }
+
+    // Shared bb content depends on single page only
+    bb::Bb bb{};
+    auto fetch = Fetch(virt_addr, *this);
+    bb.update(virt_addr, fetch, memory::PAGE_SIZE - page_offset);
+    m_stats.bbs_decoded.inc();
+
+    return {SimStatus::OK, m_shared_bb_store->publish(key, bb)};
+}
+
+const instr::Instr *Simulator::findHotInstrs(VirtAddr virt_addr) noexcept {
+    auto &hot = m_hot_bbs.find(virt_addr);
+
+    if (hot.virt_addr != virt_addr) {
+        hot = {virt_addr};
+    }
+
+    if (hot.superblock != nullptr) {
+        return hot.superblock->instrs();
+    }
+
+    // Superblock could not start with instr crossing page boundary
+    auto page_offset = virt_addr & memory::PAGE_OFFSET_MASK;
+    if (page_offset > memory::PAGE_SIZE - INSTR_CODE_SIZE) {
+        return nullptr;
+    }
+
+    if (++hot.exec_count == m_translator->hotThreshold()) {
+        // Bb was just fetched, so its page is in fetch TLB
+        memory::ConstHostPtr host_ptr = nullptr;
+        // Host function entries are not translated
+        bool requested =
+            findHostFunc(virt_addr) == nullptr &&
+            m_fetch_tlb.find(virt_addr, host_ptr) &&
+            m_translator->request(
+                *this, virt_addr,
+                host_ptr - (virt_addr & memory::PAGE_OFFSET_MASK),
+                m_code_generation);
+
+        // Try again later
+        if (!requested) {
+            hot.exec_count = 0;
+        }
+    }
+
+    return nullptr;
+}
+
+void Simulator::onTranslated(translator::Result &&result) {
+    {
+        std::lock_guard lock{m_ready_mutex};
+        m_ready_hot_bbs.push_back(std::move(result));
+    }
+
+    postIpi(IPI_HOT_BB_READY);
+}
+
+void Simulator::installHotBbs() {
+    std::vector<translator::Result> ready{};
+    {
+        std::lock_guard lock{m_ready_mutex};
+        ready.swap(m_ready_hot_bbs);
+    }
+
+    for (auto &&result : ready) {
+        auto &hot = m_hot_bbs.find(result.virt_addr);
+
+        // Drop translations of outdated code
+        if (result.generation == m_code_generation &&
+            hot.virt_addr == result.virt_addr) {
+            if (m_plugins != nullptr && result.superblock != nullptr) {
+                instrument(*result.superblock);
+            }
+
+            hot.superblock = std::move(result.superblock);
+        }
+    }
+}
+
+SimStatus Simulator::simulate(VirtAddr start_pc, size_t max_icount) {
     m_hart.pc() = start_pc;
     m_icount = 0;
 
+    return resume(max_icount);
+}
+
+SimStatus Simulator::resume(size_t max_icount) {
+    using Clock = std::chrono::steady_clock;
+
+    HostFpEnv host_fp_env{*this};
+
+    auto start_icount = m_icount;
+    Clock::time_point start_time{};
+    if constexpr (stats::ENABLED) {
+        start_time = Clock::now();
+    }
+
+    auto icount_limit = m_icount + std::min(max_icount, ~m_icount);
+    auto status = SimStatus::OK;
     while (true) {
-        // Fetch & decode bb
-        auto &cached_bb = m_bb_cache.find(m_hart.pc());
-        if (cached_bb.getVirtAddr() != m_hart.pc()) {
-            auto fetch = Fetch(m_hart.pc(), *this);
-            cached_bb.update(m_hart.pc(), fetch);
+        // Simulation stops on call graph sample points
+        auto sample_icount = m_call_graph != nullptr
+                                 ? m_call_graph->nextSampleIcount()
+                                 : icount_limit;
+        status = simulateBbs(std::min(icount_limit, sample_icount));
+
+        if (status != SimStatus::SIM__ICOUNT_LIMIT ||
+            m_icount >= icount_limit) {
+            break;
         }
 
+        m_call_graph->sample(m_hart.pc(), m_icount);
+    }
+
+    if (m_profiler != nullptr) {
+        m_profiler->exit(m_icount);
+    }
+
+    if (m_bbv_recorder != nullptr) {
+        m_bbv_recorder->exit(m_icount);
+    }
+
+    if constexpr (stats::ENABLED) {
+        auto wall_time = Clock::now() - start_time;
+        m_stats.wall_ns.add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(wall_time)
+                .count());
+        m_stats.instrs.add(m_icount - start_icount);
+    }
+
+    return status;
+}
+
+SimStatus Simulator::simulateBbs(size_t icount_limit) {
+    while (true) {
+        if (m_icount >= icount_limit) {
+            return SimStatus::SIM__ICOUNT_LIMIT;
+        }
+
+        // Serve IPIs on bb boundary
+        if (m_pending_ipi.load(std::memory_order_relaxed)) {
+            if (auto status = serveIpi(); status != SimStatus::OK) {
+                return status;
+            }
+        }
+
+        // Superblocks built by translator take precedence over bbs
+        const instr::Instr *instrs =
+            m_translator != nullptr ? findHotInstrs(m_hart.pc()) : nullptr;
+
+        if (instrs != nullptr) {
+            m_stats.superblock_hits.inc();
+        } else if (m_shared_bb_store != nullptr) {
+            // Take bb from shared store
+            auto &entry = m_bb_ptr_cache.find(m_hart.pc());
+            if (entry.virt_addr != m_hart.pc()) {
+                countBbCacheMiss(entry.virt_addr);
+
+                auto [status, bb] = findSharedBb(m_hart.pc());
+                if (status != SimStatus::OK) {
+                    return status;
+                }
+
+                entry = {m_hart.pc(), bb};
+            } else {
+                m_stats.bb_cache_hits.inc();
+            }
+
+            if (entry.bb != nullptr) {
+                instrs = entry.bb->instrs();
+            }
+        }
+
+        if (instrs == nullptr) {
+            // Fetch & decode bb
+            auto &cached_bb = m_bb_cache.find(m_hart.pc());
+            if (cached_bb.getVirtAddr() != m_hart.pc()) {
+                countBbCacheMiss(cached_bb.getVirtAddr());
+
+                if (const auto *func = findHostFunc(m_hart.pc())) {
+                    cached_bb.updateHostCall(
+                        m_hart.pc(),
+                        instr::Instr::hostCallInstr(to_underlying(*func)));
+                } else {
+                    auto fetch = Fetch(m_hart.pc(), *this);
+                    cached_bb.update(m_hart.pc(), fetch);
+                    m_stats.bbs_decoded.inc();
+
+                    if (m_plugins != nullptr) {
+                        instrument(cached_bb);
+                    }
+                }
+            } else {
+                m_stats.bb_cache_hits.inc();
+            }
+
+            instrs = cached_bb.instrs();
+        }
+
+        if (m_bb_hooks) {
+            enterBb(instrs);
+        }
+
+#ifdef SIM_CACHE_MODEL_ENABLE
+        if (m_cache_model != nullptr) {
+            modelBbFetch(instrs);
+        }
+#endif
+
+#ifdef SIM_MEM_TRACE_ENABLE
+        if (m_mem_tracer != nullptr) {
+            traceBbFetch(instrs);
+        }
+#endif
+
         // Execute
-        const auto *instrs = cached_bb.instrs();
         auto status = dispatch(instrs->id())(*this, instrs);
 
         if (status == SimStatus::SIM__EXIT) {
@@ -31,4 +295,121 @@ SimStatus Simulator::simulate(VirtAddr start_pc) {
     SIM_UNREACHABLE();
 }
 
+void Simulator::enterBb(const instr::Instr *instrs) {
+    if (m_profiler != nullptr) {
+        m_profiler->enter(m_hart.pc(), m_icount);
+    }
+
+    if (m_bbv_recorder != nullptr) {
+        m_bbv_recorder->enter(m_hart.pc(), m_icount);
+    }
+
+    if (m_instr_mix != nullptr) {
+        m_instr_mix->enter(m_hart.pc(), entryInstrs(instrs));
+    }
+}
+
+void Simulator::modelBbFetch(const instr::Instr *instrs) {
+    auto pc = m_hart.pc();
+
+    // Superblocks continue through JAL to its target
+    bb::forEachInstr(entryInstrs(instrs), [&](const instr::Instr &instr) {
+        m_cache_model->fetch(pc);
+
+        pc += instr.id() == instr::InstrId::JAL
+                  ? static_cast<int32_t>(instr.imm())
+                  : instr.size();
+    });
+}
+
+PhysAddr Simulator::memTracePa(MemAccessType access_type, VirtAddr va) {
+    auto &page = m_mem_trace_pages[bit::getBitField(
+        memory::PAGE_BIT_SIZE + MEM_TRACE_PAGES_LOG_2 - 1,
+        memory::PAGE_BIT_SIZE, va)];
+
+    auto va_page = va & ~memory::PAGE_OFFSET_MASK;
+    if (page.va_page != va_page) {
+        // Access translation is already counted
+        auto [status, pa] =
+            m_hart.mmu64().query(PrivLevel::USER, access_type, va);
+
+        // Failures are not cached, so later mapping is seen
+        if (status != SimStatus::OK) {
+            return 0;
+        }
+
+        page = {va_page, pa & ~memory::PAGE_OFFSET_MASK};
+    }
+
+    return page.pa_page | (va & memory::PAGE_OFFSET_MASK);
+}
+
+void Simulator::pushMemRecord(trace::MemRecord::Type type, VirtAddr va,
+                              size_t size) {
+    auto access_type = type == trace::MemRecord::READ ? MemAccessType::READ
+                                                      : MemAccessType::WRITE;
+
+    m_mem_tracer->push({m_hart.pc(), va, memTracePa(access_type, va),
+                        static_cast<uint8_t>(size), type});
+}
+
+void Simulator::traceBbFetch(const instr::Instr *instrs) {
+    auto pc = m_hart.pc();
+
+    // Superblocks continue through JAL to its target
+    bb::forEachInstr(entryInstrs(instrs), [&](const instr::Instr &instr) {
+        // Host calls fetch no guest code
+        if (instr.id() == instr::InstrId::SIM_HOST_CALL) {
+            return;
+        }
+
+        m_mem_tracer->push({pc, pc, memTracePa(MemAccessType::FETCH, pc),
+                            static_cast<uint8_t>(instr.size()),
+                            trace::MemRecord::FETCH});
+
+        pc += instr.id() == instr::InstrId::JAL
+                  ? static_cast<int32_t>(instr.imm())
+                  : instr.size();
+    });
+}
+
+void Simulator::collectStats(stats::Registry &registry) const {
+    if constexpr (!stats::ENABLED) {
+        return;
+    }
+
+    auto add_tlb = [&registry](const std::string &name, const auto &tlb) {
+        registry.add("tlb." + name + ".hits", tlb.hits());
+        registry.add("tlb." + name + ".misses", tlb.misses());
+    };
+
+    add_tlb("read", m_read_tlb);
+    add_tlb("write", m_write_tlb);
+    add_tlb("fetch", m_fetch_tlb);
+
+    registry.add("bb_cache.hits", m_stats.bb_cache_hits.value());
+    registry.add("bb_cache.misses", m_stats.bb_cache_misses.value());
+    registry.add("bb_cache.evictions", m_stats.bb_cache_evictions.value());
+    registry.add("bb_cache.superblock_hits", m_stats.superblock_hits.value());
+
+    const auto &mmu = m_hart.mmu64();
+    for (size_t depth = 0; depth <= memory::MMU64::MAX_WALK_DEPTH; ++depth) {
+        registry.add("mmu.walks_by_depth." + std::to_string(depth),
+                     mmu.walks(depth));
+    }
+
+    registry.add("decode.bbs", m_stats.bbs_decoded.value());
+
+    constexpr double NS_PER_S = 1e9;
+    constexpr double NS_PER_US = 1e3;
+
+    auto wall_ns = m_stats.wall_ns.value();
+    auto instrs = m_stats.instrs.value();
+
+    registry.add("host.instrs", instrs);
+    registry.add("host.wall_time_s", wall_ns / NS_PER_S);
+    registry.add("host.mips",
+                 wall_ns == 0 ? 0. : instrs / (wall_ns / NS_PER_US));
+}
+
 } // namespace sim
@@ -1,7 +1,16 @@
+#include <algorithm>
+#include <array>
+#include <cfenv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include <sim/elf_load.hpp>
 #include <sim/simulator.hpp>
 
 namespace sim {
@@ -12,7 +21,7 @@ class SimulatorTest : public ::testing::Test {
 
     Simulator sim{};
 
-    SimStatus simulate(const std::vector<InstrCode> &code) {
+    static void load(Simulator &sim, const std::vector<InstrCode> &code) {
         auto &phys_memory = sim.getPhysMemory();
 
         for (PhysAddr page_pa = CODE_SEG_BASE,
@@ -26,9 +35,47 @@ class SimulatorTest : public ::testing::Test {
                 phys_memory.write(CODE_SEG_BASE + i * INSTR_CODE_SIZE, code[i])
                     .status == SimStatus::OK);
         }
+    }
+
+    // Load code given as 16-bit parcels starting from given address
+    static void loadParcels(Simulator &sim, PhysAddr pa,
+                            const std::vector<uint16_t> &parcels) {
+        auto &phys_memory = sim.getPhysMemory();
+
+        for (size_t i = 0, end = parcels.size(); i != end; ++i) {
+            auto parcel_pa = pa + i * COMPRESSED_INSTR_CODE_SIZE;
+            auto page_pa = parcel_pa & ~memory::PAGE_OFFSET_MASK;
+            if (phys_memory.getHostPagePtr(page_pa) == nullptr) {
+                SIM_ASSERT(phys_memory.addRAMPage(page_pa));
+            }
+
+            SIM_ASSERT(phys_memory.write(parcel_pa, parcels[i]).status ==
+                       SimStatus::OK);
+        }
+    }
 
+    SimStatus simulate(const std::vector<InstrCode> &code) {
+        load(sim, code);
         return sim.simulate(CODE_SEG_BASE);
     }
+
+    static constexpr size_t BRANCH_BB_IDX = 64;
+
+    // 7 instrs. Bb ending in cond branch takes bb cache entry of longer bb
+    // executed before it, so instrs left after branch are stale
+    static std::vector<InstrCode> branchBbCode() {
+        std::vector<InstrCode> code(BRANCH_BB_IDX + 4, 0);
+        code[0] = 0x0010029b; // addiw t0, zero, 1
+        code[1] = 0x0020031b; // addiw t1, zero, 2
+        code[2] = 0x0030039b; // addiw t2, zero, 3
+        code[3] = 0x0f40006f; // j branch
+
+        code[BRANCH_BB_IDX] = 0x00000463;     // branch: beq zero, zero, end
+        code[BRANCH_BB_IDX + 2] = 0x05d0089b; // end: addiw a7, x0, 93
+        code[BRANCH_BB_IDX + 3] = 0x00000073; // ecall
+
+        return code;
+    }
 };
 
 TEST_F(SimulatorTest, ecall) {
@@ -63,6 +110,264 @@ TEST_F(SimulatorTest, addSub) {
     ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A1), 10);
 }
 
+TEST_F(SimulatorTest, mulDiv) {
+    const std::vector<InstrCode> CODE = {
+        0xff900293, // addi t0,x0,-7
+        0x00200313, // addi t1,x0,2
+        0x026283b3, // mul t2,t0,t1
+        0x0262c433, // div s0,t0,t1
+        0x0262e4b3, // rem s1,t0,t1
+        0x0202d533, // divu a0,t0,x0
+        0x0202e5b3, // rem a1,t0,x0
+        0xfff00613, // addi a2,x0,-1
+        0x03f61693, // slli a3,a2,63
+        0x02c6c733, // div a4,a3,a2
+        0x02c6e7b3, // rem a5,a3,a2
+        0x02c63833, // mulhu a6,a2,a2
+        0x02c61e33, // mulh t3,a2,a2
+        0x02c62eb3, // mulhsu t4,a2,a2
+        0x026289bb, // mulw s3,t0,t1
+        0x02665a3b, // divuw s4,a2,t1
+        0x0262eabb, // remw s5,t0,t1
+
+        0x05d00893, // addi a7,x0,93
+        0x00000073  // ecall
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), CODE.size());
+
+    const auto &gpr = sim.getHart().gprFile();
+    constexpr auto INT64_MIN_VALUE = std::numeric_limits<int64_t>::min();
+
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::T2), -14);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S0), -3);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S1), -1);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A0), UINT64_MAX);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A1), -7);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A4), INT64_MIN_VALUE);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A5), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A6), UINT64_MAX - 1);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::T3), 0);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::T4), -1);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S3), -14);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S4), 0x7fffffff);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S5), -1);
+}
+
+TEST_F(SimulatorTest, bitManip) {
+    const std::vector<InstrCode> CODE = {
+        0xf0000293, // addi t0,x0,-256
+        0x00300313, // addi t1,x0,3
+        0x20534433, // sh2add s0,t1,t0
+        0x086284bb, // add.uw s1,t0,t1
+        0x0842991b, // slli.uw s2,t0,4
+        0x4062f9b3, // andn s3,t0,t1
+        0x60031a13, // clz s4,t1
+        0x60129a9b, // ctzw s5,t0
+        0x60229b13, // cpop s6,t0
+        0x0a62cbb3, // min s7,t0,t1
+        0x0a62fc33, // maxu s8,t0,t1
+        0x60429c93, // sext.b s9,t0
+        0x0802cd3b, // zext.h s10,t0
+        0x60135d93, // rori s11,t1,1
+        0x606313bb, // rolw t2,t1,t1
+        0x28735e13, // orc.b t3,t1
+        0x6b835e93, // rev8 t4,t1
+        0x2bf01f13, // bseti t5,x0,63
+        0x4862dfb3, // bext t6,t0,t1
+        0x4882d613, // bexti a2,t0,8
+        0x686315b3, // binv a1,t1,t1
+
+        0x05d00893, // addi a7,x0,93
+        0x00000073  // ecall
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), CODE.size());
+
+    const auto &gpr = sim.getHart().gprFile();
+
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S0), -244);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S1), 0xffffff03);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S2), 0xffffff000);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S3), -256);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S4), 62);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S5), 8);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S6), 56);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S7), -256);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S8), -256);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S9), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S10), 0xff00);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S11), 0x8000000000000001);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T2), 24);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T3), 0xff);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T4), 0x0300000000000000);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T5), 0x8000000000000000);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T6), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A2), 1);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A1), 11);
+}
+
+TEST_F(SimulatorTest, floatingPoint) {
+    const std::vector<InstrCode> CODE = {
+        0x00700293, // addi t0,x0,7
+        0xd222f553, // fcvt.d.l fa0,t0
+        0x00200313, // addi t1,x0,2
+        0xd22375d3, // fcvt.d.l fa1,t1
+        0x1ab57653, // fdiv.d fa2,fa0,fa1
+        0xc2260553, // fcvt.l.d a0,fa2,rne
+        0xc22615d3, // fcvt.l.d a1,fa2,rtz
+        0xc2262653, // fcvt.l.d a2,fa2,rdn
+        0x22c616d3, // fsgnjn.d fa3,fa2,fa2
+        0xc206b6d3, // fcvt.w.d a3,fa3,rup
+        0xc206f753, // fcvt.w.d a4,fa3,dyn
+        0x62b57743, // fmadd.d fa4,fa0,fa1,fa2
+        0x12a57053, // fmul.d ft0,fa0,fa0
+        0x5a0070d3, // fsqrt.d ft1,ft0
+        0xa2a0a7d3, // feq.d a5,ft1,fa0
+        0xa2c69853, // flt.d a6,fa3,fa2
+        0xe2069953, // fclass.d s2,fa3
+
+        0x40167453, // fcvt.s.d fs0,fa2
+        0x008474d3, // fadd.s fs1,fs0,fs0
+        0xe00489d3, // fmv.x.w s3,fs1
+        0xe2048a53, // fmv.x.d s4,fs1
+
+        0xd2207153, // fcvt.d.l ft2,x0
+        0x1a2571d3, // fdiv.d ft3,fa0,ft2
+        0x1a217253, // fdiv.d ft4,ft2,ft2
+        0xe2020ad3, // fmv.x.d s5,ft4
+        0xc2021b53, // fcvt.w.d s6,ft4,rtz
+        0x2aa202d3, // fmin.d ft5,ft4,fa0
+        0xa2a2abd3, // feq.d s7,ft5,fa0
+
+        0x00000397, // auipc t2,0
+        0x7ee3bc27, // fsd fa4,2040(t2)
+        0x7f83b307, // fld ft6,2040(t2)
+        0xa2e32c53, // feq.d s8,ft6,fa4
+
+        0x05d00893, // addi a7,x0,93
+        0x00000073  // ecall
+    };
+
+    auto &fpr = sim.getHart().fprFile();
+    fpr.setFrm(to_underlying(fpr::RoundingMode::RDN));
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), CODE.size());
+
+    const auto &gpr = sim.getHart().gprFile();
+
+    // Rounding modes
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A0), 4);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A1), 3);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A2), 3);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A3), -3);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A4), -4);
+
+    ASSERT_EQ(fpr.read<double>(14), 17.5);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A5), 1);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A6), 1);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S2), 1 << 1);
+
+    // Single precision values are NaN-boxed
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S3), 0x40e00000);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S4), 0xffffffff40e00000);
+
+    // Invalid operations
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S5), fpr::CANONICAL_NAN_D);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::S6),
+              std::numeric_limits<int32_t>::max());
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S7), 1);
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S8), 1);
+
+    ASSERT_EQ(fpr.fflags(),
+              fpr::FFLAGS::NX | fpr::FFLAGS::DZ | fpr::FFLAGS::NV);
+
+    // Host FP environment is restored
+    ASSERT_EQ(std::fegetround(), FE_TONEAREST);
+}
+
+TEST_F(SimulatorTest, fpRmm) {
+    const std::vector<InstrCode> CODE = {
+        0x00500293, // addi t0,x0,5
+        0xd222f553, // fcvt.d.l fa0,t0
+        0x00200313, // addi t1,x0,2
+        0xd22375d3, // fcvt.d.l fa1,t1
+        0x1ab57553, // fdiv.d fa0,fa0,fa1
+
+        0xc205c7d3, // fcvt.w.d a5,fa1,rmm
+        0x00102873, // csrr a6,fflags
+
+        0xc2054553, // fcvt.w.d a0,fa0,rmm
+        0x22a51653, // fsgnjn.d fa2,fa0,fa0
+        0xc22645d3, // fcvt.l.d a1,fa2,rmm
+        0xc2050653, // fcvt.w.d a2,fa0,rne
+        0x40157753, // fcvt.s.d fa4,fa0
+        0xc0174753, // fcvt.wu.s a4,fa4,rmm
+        0x00102973, // csrr s2,fflags
+
+        // Arithmetic can not be rounded with RMM
+        0x02a546d3 // fadd.d fa3,fa0,fa0,rmm
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::SIM__NOT_IMPLEMENTED_INSTR);
+    ASSERT_EQ(sim.icount(), CODE.size() - 1);
+
+    const auto &gpr = sim.getHart().gprFile();
+
+    // Exact conversion
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A5), 2);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A6), 0);
+
+    // Ties are rounded to max magnitude
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A0), 3);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A1), -3);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A2), 2);
+    ASSERT_EQ(gpr.read<int64_t>(gpr::GPR_IDX::A4), 3);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S2), fpr::FFLAGS::NX);
+
+    // Host FP environment is restored
+    ASSERT_EQ(std::fegetround(), FE_TONEAREST);
+}
+
+TEST_F(SimulatorTest, fflagsCsr) {
+    const std::vector<InstrCode> CODE = {
+        0x00100293, // addi t0,x0,1
+        0xd222f553, // fcvt.d.l fa0,t0
+        0x00300313, // addi t1,x0,3
+        0xd22375d3, // fcvt.d.l fa1,t1
+
+        0x1ab57653, // fdiv.d fa2,fa0,fa1
+        0x00102573, // csrr a0,fflags
+        0x00101073, // csrw fflags,x0
+        0x001025f3, // csrr a1,fflags
+
+        0x1ab57653, // fdiv.d fa2,fa0,fa1
+        0x00302673, // csrr a2,fcsr
+
+        0x1ab57653, // fdiv.d fa2,fa0,fa1
+        0x00301073, // csrw fcsr,x0
+
+        0x05d00893, // addi a7,x0,93
+        0x00000073  // ecall
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+
+    const auto &gpr = sim.getHart().gprFile();
+
+    // Flags raised in the same run are visible to guest
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A0), fpr::FFLAGS::NX);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A1), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A2), fpr::FFLAGS::NX);
+
+    // Flags cleared by guest are not accrued again at simulation end
+    ASSERT_EQ(sim.getHart().fprFile().fflags(), 0);
+}
+
 TEST_F(SimulatorTest, cycle) {
     const std::vector<InstrCode> CODE = {
         0x0000051b, // addiw a0, zero, 0
@@ -90,6 +395,504 @@ TEST_F(SimulatorTest, cycle) {
     ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T1), 5);
 }
 
+TEST_F(SimulatorTest, stats) {
+    if constexpr (!stats::ENABLED) {
+        GTEST_SKIP();
+    }
+
+    const std::vector<InstrCode> CODE = {
+        0x0000029b, // addiw t0, zero, 0
+        0x0050031b, // addiw t1, zero, 5
+
+        // for:
+        0x0062d663, // bge t0, t1, end
+        0x0012829b, // addiw t0, t0, 1
+        0xff9ff06f, // j for
+
+        // end:
+        0x05d0089b, // addiw a7, x0, 93
+        0x00000073  // ecall
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+
+    stats::Registry registry{};
+    sim.collectStats(registry);
+
+    auto value = [&registry](const std::string &name) {
+        const auto *value = registry.find(name);
+        SIM_ASSERT(value != nullptr);
+        return std::get<uint64_t>(*value);
+    };
+
+    // Loop head, loop body and exit bbs are decoded once
+    ASSERT_EQ(value("bb_cache.misses"), 4);
+    ASSERT_EQ(value("bb_cache.hits"), 8);
+    ASSERT_EQ(value("bb_cache.evictions"), 0);
+    ASSERT_EQ(value("decode.bbs"), 4);
+    ASSERT_EQ(value("host.instrs"), sim.icount());
+
+    // Bare mode translations do not walk page tables
+    ASSERT_NE(value("mmu.walks_by_depth.0"), 0);
+    ASSERT_EQ(value("mmu.walks_by_depth.1"), 0);
+    ASSERT_NE(value("tlb.fetch.hits"), 0);
+}
+
+TEST_F(SimulatorTest, bbCacheSlots) {
+    if constexpr (!stats::ENABLED) {
+        GTEST_SKIP();
+    }
+
+    const std::vector<InstrCode> TAIL = {
+        0xfff2829b, // addiw t0, t0, -1
+        0xe0029ae3, // bnez t0, loop + 4
+        0x05d0089b, // addiw a7, x0, 93
+        0x00000073  // ecall
+    };
+
+    // Loop of jumps, so bbs start at every 4-byte aligned pc of 512 bytes
+    std::vector<InstrCode> code = {0x0020029b}; // addiw t0, zero, 2
+
+    // loop:
+    code.insert(code.end(), 123, 0x0040006f); // j .+4
+    code.insert(code.end(), TAIL.begin(), TAIL.end());
+    ASSERT_EQ(code.size() * INSTR_CODE_SIZE, 512);
+
+    ASSERT_EQ(simulate(code), SimStatus::OK);
+
+    stats::Registry registry{};
+    sim.collectStats(registry);
+
+    auto value = [&registry](const std::string &name) {
+        const auto *value = registry.find(name);
+        SIM_ASSERT(value != nullptr);
+        return std::get<uint64_t>(*value);
+    };
+
+    // 125 bbs fit 128 entries of bb cache
+    ASSERT_EQ(value("bb_cache.misses"), 125);
+    ASSERT_EQ(value("bb_cache.evictions"), 0);
+    ASSERT_EQ(value("decode.bbs"), 125);
+}
+
+TEST_F(SimulatorTest, csr) {
+    const std::vector<InstrCode> CODE = {
+        0xc0202573, // rdinstret a0
+        0x00100413, // addi s0, zero, 1
+        0xc00025f3, // rdcycle a1
+        0xc0102673, // rdtime a2
+        0xc01024f3, // rdtime s1
+
+        0x0021d073, // csrrwi zero, frm, 3
+        0x002026f3, // csrr a3, frm
+        0x0012e773, // csrrsi a4, fflags, 5
+        0x001027f3, // csrr a5, fflags
+        0x00302873, // csrr a6, fcsr
+
+        0x0c9072d7, // vsetvli t0, zero, e16, m2, ta, ma
+        0xc2002373, // csrr t1, vl
+        0xc22023f3, // csrr t2, vlenb
+        0xc2102e73, // csrr t3, vtype
+
+        0xc0502ef3, // csrr t4, hpmcounter5
+        0xc0202f73, // rdinstret t5
+
+        0x05d00893, // addi a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), CODE.size());
+
+    const auto &gpr = sim.getHart().gprFile();
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A0), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A1), 2);
+    ASSERT_LE(gpr.read<uint64_t>(gpr::GPR_IDX::A2),
+              gpr.read<uint64_t>(gpr::GPR_IDX::S1));
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A3), 3);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A4), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A5), 5);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A6), 3 << 5 | 5);
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T1), 32);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T2), vr::VLENB);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T3), 0xc9);
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T4), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T5), 15);
+}
+
+TEST_F(SimulatorTest, csrNotSupported) {
+    // Counters are read-only
+    ASSERT_EQ(simulate({0xc0051073}), // csrrw zero, cycle, a0
+              SimStatus::CSR__NOT_SUPPORTED);
+
+    sim.reset();
+    ASSERT_EQ(simulate({0x7c002573}), // csrrs a0, 0x7c0, zero
+              SimStatus::CSR__NOT_SUPPORTED);
+}
+
+TEST_F(SimulatorTest, vector) {
+    const PhysAddr DATA_PAGE_PA = 0x6000000000;
+    const PhysAddr DATA_PA = DATA_PAGE_PA + memory::PAGE_SIZE - 16;
+
+    auto &phys_memory = sim.getPhysMemory();
+    ASSERT_TRUE(phys_memory.addRAMPage(DATA_PAGE_PA));
+    ASSERT_TRUE(phys_memory.addRAMPage(DATA_PAGE_PA + memory::PAGE_SIZE));
+
+    // Vector data crosses page boundary
+    for (uint32_t i = 0; i != 8; ++i) {
+        ASSERT_EQ(phys_memory.write(DATA_PA + i * 4, i + 1).status,
+                  SimStatus::OK);
+    }
+
+    const std::vector<InstrCode> CODE = {
+        0x0060059b, // addiw a1, zero, 6
+        0x02459593, // slli a1, a1, 36
+        0x7ff58593, // addi a1, a1, 2047
+        0x7f158593, // addi a1, a1, 2033
+        0x00858613, // addi a2, a1, 8
+        0x00800393, // addi t2, zero, 8
+
+        0x0d0072d7, // vsetvli t0, zero, e32, m1, ta, ma
+        0x0205e087, // vle32.v v1, (a1)
+        0x02153157, // vadd.vi v2, v1, 10
+        0x7a123057, // vmsgtu.vi v0, v1, 4
+        0x5e0081d7, // vmv.v.v v3, v1
+        0x9410a1d7, // vmul.vv v3, v1, v1, v0.t
+        0x420062d7, // vmv.s.x v5, zero
+        0x0232a2d7, // vredsum.vs v5, v3, v5
+        0x42502457, // vmv.x.s s0, v5
+        0x420824d7, // vcpop.m s1, v0
+        0x4208a957, // vfirst.m s2, v0
+        0x020661a7, // vse32.v v3, (a2)
+        0x00863983, // ld s3, 8(a2)
+        0x01c62a03, // lw s4, 28(a2)
+
+        0xcd01f357, // vsetivli t1, 3, e32, m1, ta, ma
+        0x0a75e307, // vlse32.v v6, (a1), t2
+        0x1a6323d7, // vredmaxu.vs v7, v6, v6
+        0x42702ad7, // vmv.x.s s5, v7
+
+        0x0dd07b57, // vsetvli s6, zero, e64, mf8, ta, ma
+
+        0x05d00893, // addi a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), CODE.size());
+
+    const auto &gpr = sim.getHart().gprFile();
+    const auto &vr_file = sim.getHart().vrFile();
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T0), 8);
+    ASSERT_EQ(vr_file.readElem<uint32_t>(2, 7), 18);
+    ASSERT_EQ(vr_file.data(0)[0], 0xf0);
+    // Masked off elements are left undisturbed
+    ASSERT_EQ(vr_file.readElem<uint32_t>(3, 3), 4);
+    ASSERT_EQ(vr_file.readElem<uint32_t>(3, 4), 25);
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S0), 184);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S1), 4);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S2), 4);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S3), 0x0000000400000003);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S4), 64);
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T1), 3);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S5), 3);
+
+    // SEW = 64 with LMUL = 1/8 is not supported
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::S6), 0);
+    ASSERT_TRUE(vr_file.vill());
+}
+
+#ifdef SIM_CACHE_MODEL_ENABLE
+// Fetch walk stops at cond branch
+TEST_F(SimulatorTest, cacheModelFetch) {
+    const auto code = branchBbCode();
+
+    // Each instr takes separate L1I line
+    cache_model::Hierarchy::Config config{};
+    config.l1i = {1024, 1, 4, cache_model::Replacement::LRU};
+    cache_model::Hierarchy cache_model{config};
+    sim.setCacheModel(&cache_model);
+
+    ASSERT_EQ(simulate(code), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), 7);
+    ASSERT_EQ(cache_model.level(cache_model::Level::L1I).accesses(), 7);
+}
+#endif
+
+#ifdef SIM_MEM_TRACE_ENABLE
+std::vector<trace::MemRecord> readMemTrace(const std::string &path) {
+    std::vector<trace::MemRecord> records{};
+
+    trace::MemReader reader{path};
+    for (trace::MemRecord record{}; reader.next(record);) {
+        records.push_back(record);
+    }
+    std::remove(path.c_str());
+
+    return records;
+}
+
+// Fetch walk stops at cond branch. Tracing does not count mmu walks
+TEST_F(SimulatorTest, memTraceFetch) {
+    const std::string PATH = "test_sim_mem_trace_fetch.bin";
+
+    const auto code = branchBbCode();
+
+    {
+        trace::MemWriter writer{PATH};
+        sim.setMemTracer(&writer);
+        ASSERT_EQ(simulate(code), SimStatus::OK);
+        sim.setMemTracer(nullptr);
+    }
+
+    Simulator ref_sim{};
+    load(ref_sim, code);
+    ASSERT_EQ(ref_sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+
+    const auto &mmu = sim.getHart().mmu64();
+    ASSERT_EQ(mmu.walks(0), ref_sim.getHart().mmu64().walks(0));
+
+    const std::vector<size_t> FETCH_IDXS = {
+        0, 1, 2, 3, BRANCH_BB_IDX, BRANCH_BB_IDX + 2, BRANCH_BB_IDX + 3};
+
+    auto records = readMemTrace(PATH);
+    ASSERT_EQ(records.size(), FETCH_IDXS.size());
+
+    for (size_t i = 0; i != records.size(); ++i) {
+        const auto &record = records[i];
+        auto va = CODE_SEG_BASE + FETCH_IDXS[i] * INSTR_CODE_SIZE;
+
+        ASSERT_EQ(record.type, trace::MemRecord::FETCH);
+        ASSERT_EQ(record.va, va);
+        ASSERT_EQ(record.pa, va);
+    }
+}
+
+// Host functions are traced as word accesses
+TEST_F(SimulatorTest, memTraceHostFunc) {
+    const std::string PATH = "test_sim_mem_trace_host_func.bin";
+
+    const std::vector<InstrCode> CODE = {
+        0x008000ef, // jal ra, memset
+        0x00000073, // ecall
+
+        // memset: illegal, so guest code is never executed
+        0x00000000};
+
+    static constexpr VirtAddr MEMSET_VA = CODE_SEG_BASE + 8;
+    static constexpr VirtAddr DST_VA = CODE_SEG_BASE + memory::PAGE_SIZE + 4;
+
+    ASSERT_TRUE(sim.getPhysMemory().addRAMPage(CODE_SEG_BASE +
+                                               memory::PAGE_SIZE));
+    sim.setHostFunc(MEMSET_VA, Simulator::HostFunc::MEMSET);
+
+    auto &gpr = sim.getHart().gprFile();
+    gpr.write(gpr::GPR_IDX::A0, DST_VA);
+    gpr.write(gpr::GPR_IDX::A1, 0);
+    gpr.write(gpr::GPR_IDX::A2, 20);
+    gpr.write(gpr::GPR_IDX::A7, 93);
+
+    {
+        trace::MemWriter writer{PATH};
+        sim.setMemTracer(&writer);
+        ASSERT_EQ(simulate(CODE), SimStatus::OK);
+        sim.setMemTracer(nullptr);
+    }
+
+    std::vector<trace::MemRecord> data_records{};
+    for (auto &&record : readMemTrace(PATH)) {
+        if (record.type != trace::MemRecord::FETCH) {
+            data_records.push_back(record);
+        }
+    }
+
+    const std::vector<std::pair<VirtAddr, size_t>> ACCESSES = {
+        {DST_VA, 8}, {DST_VA + 8, 8}, {DST_VA + 16, 4}};
+
+    ASSERT_EQ(data_records.size(), ACCESSES.size());
+    for (size_t i = 0; i != data_records.size(); ++i) {
+        const auto &record = data_records[i];
+
+        ASSERT_EQ(record.type, trace::MemRecord::WRITE);
+        ASSERT_EQ(record.pc, MEMSET_VA);
+        ASSERT_EQ(record.va, ACCESSES[i].first);
+        ASSERT_EQ(record.pa, ACCESSES[i].first);
+        ASSERT_EQ(record.size, ACCESSES[i].second);
+    }
+}
+
+TEST_F(SimulatorTest, memTraceVector) {
+    const PhysAddr DATA_PAGE_PA = 0x6000000000;
+    const std::string PATH = "test_sim_mem_trace.bin";
+
+    ASSERT_TRUE(sim.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+
+    const std::vector<InstrCode> CODE = {
+        0x0060059b, // addiw a1, zero, 6
+        0x02459593, // slli a1, a1, 36
+        0x04058613, // addi a2, a1, 64
+
+        0x0d0072d7, // vsetvli t0, zero, e32, m1, ta, ma
+        0x0205e087, // vle32.v v1, (a1)
+        0x020660a7, // vse32.v v1, (a2)
+
+        0x05d00893, // addi a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    {
+        trace::MemWriter writer{PATH};
+        sim.setMemTracer(&writer);
+        ASSERT_EQ(simulate(CODE), SimStatus::OK);
+        sim.setMemTracer(nullptr);
+    }
+
+    // Unit-stride accesses are traced by elements
+    std::vector<trace::MemRecord> data_records{};
+    trace::MemReader reader{PATH};
+    for (trace::MemRecord record{}; reader.next(record);) {
+        if (record.type != trace::MemRecord::FETCH) {
+            data_records.push_back(record);
+        }
+    }
+    std::remove(PATH.c_str());
+
+    auto vl = sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::T0);
+    ASSERT_EQ(data_records.size(), 2 * vl);
+
+    for (size_t i = 0; i != data_records.size(); ++i) {
+        const auto &record = data_records[i];
+        auto is_store = i >= vl;
+
+        ASSERT_EQ(record.type, is_store ? trace::MemRecord::WRITE
+                                        : trace::MemRecord::READ);
+        ASSERT_EQ(record.va, DATA_PAGE_PA + (is_store ? 64 : 0) + i % vl * 4);
+        ASSERT_EQ(record.pa, record.va);
+        ASSERT_EQ(record.size, 4);
+    }
+}
+#endif
+
+#ifdef SIM_TRACE_ENABLE
+TEST_F(SimulatorTest, trace) {
+    const std::string PATH = "test_sim_trace.bin";
+
+    const std::vector<InstrCode> CODE = {
+        0x00500513, // addi a0, zero, 5
+        0x00000297, // auipc t0, 0
+        0x02a2be23, // sd a0, 60(t0)
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    {
+        trace::Writer writer{PATH};
+        ASSERT_TRUE(writer.isOpen());
+        sim.setTracer(&writer);
+        ASSERT_EQ(simulate(CODE), SimStatus::OK);
+        sim.setTracer(nullptr);
+        writer.close();
+        ASSERT_EQ(writer.recordNumber(), CODE.size());
+    }
+
+    std::vector<trace::Record> records{};
+    {
+        trace::Reader reader{PATH};
+        ASSERT_TRUE(reader.isOpen());
+        for (trace::Record record{}; reader.next(record);) {
+            records.push_back(record);
+        }
+    }
+    std::remove(PATH.c_str());
+
+    const std::vector<instr::InstrId> IDS = {
+        instr::InstrId::ADDI, instr::InstrId::AUIPC, instr::InstrId::SD,
+        instr::InstrId::ADDIW, instr::InstrId::ECALL};
+
+    ASSERT_EQ(records.size(), IDS.size());
+    for (size_t i = 0; i != records.size(); ++i) {
+        ASSERT_EQ(records[i].pc, CODE_SEG_BASE + i * INSTR_CODE_SIZE);
+        ASSERT_EQ(records[i].instr_id, to_underlying(IDS[i]));
+    }
+
+    const auto &addi = records[0];
+    ASSERT_EQ(addi.flags, trace::Record::GPR_WRITE);
+    ASSERT_EQ(addi.reg_idx, gpr::GPR_IDX::A0);
+    ASSERT_EQ(addi.reg_value, 5);
+
+    const auto &auipc = records[1];
+    ASSERT_EQ(auipc.flags, trace::Record::GPR_WRITE);
+    ASSERT_EQ(auipc.reg_idx, gpr::GPR_IDX::T0);
+    ASSERT_EQ(auipc.reg_value, CODE_SEG_BASE + INSTR_CODE_SIZE);
+
+    const auto &sd = records[2];
+    ASSERT_EQ(sd.flags, trace::Record::MEM_WRITE);
+    ASSERT_EQ(sd.mem_addr, CODE_SEG_BASE + INSTR_CODE_SIZE + 60);
+    ASSERT_EQ(sd.mem_value, 5);
+}
+#endif
+
+#ifdef SIM_BPRED_ENABLE
+TEST_F(SimulatorTest, bpred) {
+    const std::vector<InstrCode> CODE = {
+        0x01c000ef, // jal ra, foo
+        0x00300293, // addi t0, zero, 3
+
+        // loop:
+        0xfff28293, // addi t0, t0, -1
+        0xfe029ee3, // bnez t0, loop
+
+        0x00000317, // auipc t1, 0
+        0x00c300e7, // jalr ra, 12(t1)
+        0x0080006f, // j exit
+
+        // foo:
+        0x00008067, // ret
+
+        // exit:
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    auto model = bpred::makeModel("bimodal");
+    sim.setBranchModel(model.get());
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    sim.setBranchModel(nullptr);
+
+    ASSERT_EQ(model->condBranches().executions, 3);
+
+    auto jumps = [&model](bpred::JumpKind kind) {
+        return model->jumps(kind).executions;
+    };
+
+    ASSERT_EQ(jumps(bpred::JumpKind::CALL), 1);
+    ASSERT_EQ(jumps(bpred::JumpKind::INDIRECT_CALL), 1);
+    ASSERT_EQ(jumps(bpred::JumpKind::DIRECT), 1);
+    ASSERT_EQ(jumps(bpred::JumpKind::RETURN), 2);
+    ASSERT_EQ(jumps(bpred::JumpKind::INDIRECT), 0);
+
+    // Returns are predicted by return address stack
+    ASSERT_EQ(model->jumps(bpred::JumpKind::RETURN).mispredicts, 0);
+
+    std::vector<std::pair<VirtAddr, uint64_t>> branches{};
+    for (auto &&branch : model->branches()) {
+        branches.emplace_back(branch.pc - CODE_SEG_BASE, branch.executions);
+    }
+    std::sort(branches.begin(), branches.end());
+
+    const std::vector<std::pair<VirtAddr, uint64_t>> EXPECTED = {
+        {0, 1}, {12, 3}, {20, 1}, {24, 1}, {28, 2}};
+    ASSERT_EQ(branches, EXPECTED);
+}
+#endif
+
 TEST_F(SimulatorTest, loadStore) {
     const PhysAddr DATA_PAGE_PA = 0x6000000000;
 
@@ -119,4 +922,494 @@ TEST_F(SimulatorTest, loadStore) {
     ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A2), 0x1BF);
 }
 
+TEST_F(SimulatorTest, atomics) {
+    const PhysAddr DATA_PAGE_PA = 0x6000000000;
+
+    ASSERT_TRUE(sim.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+
+    const std::vector<InstrCode> CODE = {
+        0x0060059b, // addiw a1, zero, 6
+        0x02459593, // slli a1, a1, 36
+        0xffb00613, // addi a2, zero, -5
+        0x00c5a023, // sw a2, 0(a1)
+        0x00300693, // addi a3, zero, 3
+
+        0xe0d5a72f, // amomaxu.w a4, a3, (a1)
+        0x80d5a7af, // amomin.w a5, a3, (a1)
+        0xa0d5a82f, // amomax.w a6, a3, (a1)
+        0x00d5a2af, // amoadd.w t0, a3, (a1)
+
+        0x1005a32f, // lr.w t1, (a1)
+        0x18c5a3af, // sc.w t2, a2, (a1)
+        0x18d5ae2f, // sc.w t3, a3, (a1)
+        0x0005ae83, // lw t4, 0(a1)
+
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), CODE.size());
+
+    const auto &gpr = sim.getHart().gprFile();
+
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A4), -5);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A5), -5);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A6), -5);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T0), 3);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T1), 6);
+    // First SC succeeds, second one has no reservation
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T2), 0);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T3), 1);
+    ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::T4), -5);
+}
+
+// Host pages are reused after reset, so reservation must not survive it
+TEST_F(SimulatorTest, reservationReset) {
+    const PhysAddr DATA_PAGE_PA = 0x6000000000;
+
+    const std::vector<InstrCode> LR_CODE = {
+        0x0060059b, // addiw a1, zero, 6
+        0x02459593, // slli a1, a1, 36
+        0x00700613, // addi a2, zero, 7
+        0x00c5a023, // sw a2, 0(a1)
+        0x1005a32f, // lr.w t1, (a1)
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    const std::vector<InstrCode> SC_CODE = {
+        0x0060059b, // addiw a1, zero, 6
+        0x02459593, // slli a1, a1, 36
+        0x00700613, // addi a2, zero, 7
+        0x00c5a023, // sw a2, 0(a1)
+        0x18c5a3af, // sc.w t2, a2, (a1)
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    ASSERT_TRUE(sim.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+    ASSERT_EQ(simulate(LR_CODE), SimStatus::OK);
+    auto *data_page = sim.getPhysMemory().getHostPagePtr(DATA_PAGE_PA);
+
+    sim.reset();
+
+    ASSERT_TRUE(sim.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+    ASSERT_EQ(simulate(SC_CODE), SimStatus::OK);
+    ASSERT_EQ(sim.getPhysMemory().getHostPagePtr(DATA_PAGE_PA), data_page);
+
+    ASSERT_EQ(sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::T2), 1);
+}
+
+TEST_F(SimulatorTest, atomicsUnaligned) {
+    const PhysAddr DATA_PAGE_PA = 0x6000000000;
+
+    // LR is a load, other atomics are stores
+    const std::vector<std::pair<InstrCode, SimStatus>> CASES = {
+        {0x1005a32f, SimStatus::SIM__UNALIGNED_LOAD},  // lr.w t1, (a1)
+        {0x00d5a2af, SimStatus::SIM__UNALIGNED_STORE}, // amoadd.w t0, a3, (a1)
+    };
+
+    for (auto [instr_code, status] : CASES) {
+        Simulator sim{};
+        ASSERT_TRUE(sim.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+
+        const std::vector<InstrCode> CODE = {
+            0x0060059b, // addiw a1, zero, 6
+            0x02459593, // slli a1, a1, 36
+            0x00258593, // addi a1, a1, 2
+            instr_code,
+        };
+
+        load(sim, CODE);
+        ASSERT_EQ(sim.simulate(CODE_SEG_BASE), status);
+    }
+}
+
+TEST_F(SimulatorTest, compressed) {
+    // Loop body has uncompressed instr crossing page boundary
+    const std::vector<uint16_t> CODE = {
+        0x458d, // c.li a1, 3
+
+        // loop:
+        0x0505,         // c.addi a0, 1
+        0x0613, 0x0026, // addi a2, a2, 2
+        0x15fd,         // c.addi a1, -1
+        0xfde5,         // c.bnez a1, loop
+
+        0x0893, 0x05d0, // addi a7, x0, 93
+        0x0073, 0x0000  // ecall
+    };
+
+    const PhysAddr start_pa = CODE_SEG_BASE + memory::PAGE_SIZE - 6;
+
+    cache::SharedBbStore store{};
+    Simulator shared_sim{};
+    shared_sim.setSharedBbStore(&store);
+
+    for (auto *curr_sim : {&sim, &shared_sim}) {
+        loadParcels(*curr_sim, start_pa, CODE);
+
+        ASSERT_EQ(curr_sim->simulate(start_pa), SimStatus::OK);
+        ASSERT_EQ(curr_sim->icount(), 15);
+
+        const auto &gpr = curr_sim->getHart().gprFile();
+
+        ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A0), 3);
+        ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A1), 0);
+        ASSERT_EQ(gpr.read<uint64_t>(gpr::GPR_IDX::A2), 6);
+    }
+}
+
+TEST_F(SimulatorTest, sharedBbStore) {
+    const std::vector<InstrCode> CODE = {
+        0x0000051b, // addiw a0, zero, 0
+        0x0000029b, // addiw t0, zero, 0
+        0x0050031b, // addiw t1, zero, 5
+
+        // for:
+        0x0062d863, // bge t0, t1, end
+        0x0055053b, // addw a0, a0, t0
+        0x0012829b, // addiw t0, t0, 1
+        0xff5ff06f, // j for
+
+        // end:
+        0x05d0089b, // addiw a7, x0, 93
+        0x00000073  // ecall
+    };
+
+    cache::SharedBbStore store{};
+
+    sim.setSharedBbStore(&store);
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), 26);
+    ASSERT_EQ(sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A0), 10);
+
+    auto store_size = store.size();
+    ASSERT_NE(store_size, 0);
+
+    // Same code in other simulator is not decoded again
+    Simulator other_sim{};
+    other_sim.setSharedBbStore(&store);
+    load(other_sim, CODE);
+
+    ASSERT_EQ(other_sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+    ASSERT_EQ(other_sim.icount(), 26);
+    ASSERT_EQ(other_sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A0),
+              10);
+    ASSERT_EQ(store.size(), store_size);
+}
+
+TEST_F(SimulatorTest, sharedBbStoreFenceI) {
+    // Code patches itself through cached host pointer and executes FENCE.I
+    const std::vector<InstrCode> CODE = {
+        0x00000297, // auipc t0, 0
+        0x0282a303, // lw t1, 40(t0)
+        0x0202a623, // sw zero, 44(t0)
+        0x0040006f, // j patch
+
+        // patch:
+        0x0062ae23, // sw t1, 28(t0)
+        0x0000100f, // fence.i
+
+        // patched:
+        0x0010051b, // addiw a0, zero, 1
+        0x00050513, // addi a0, a0, 0
+
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073, // ecall
+
+        0x02950513, // addi a0, a0, 41
+        0x00000000  // scratch
+    };
+
+    static constexpr VirtAddr PATCHED_VA = CODE_SEG_BASE + 24;
+
+    cache::SharedBbStore store{};
+
+    // Publish unpatched bb
+    Simulator other_sim{};
+    other_sim.setSharedBbStore(&store);
+    load(other_sim, CODE);
+
+    ASSERT_EQ(other_sim.simulate(PATCHED_VA), SimStatus::OK);
+    ASSERT_EQ(other_sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A0),
+              1);
+
+    sim.setSharedBbStore(&store);
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A0), 42);
+}
+
+TEST_F(SimulatorTest, sharedBbStoreHashCollision) {
+    const std::vector<InstrCode> CODE = {
+        0x02a0051b, // addiw a0, zero, 42
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    const std::vector<InstrCode> OTHER_CODE = {
+        0x0070051b, // addiw a0, zero, 7
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    load(sim, CODE);
+    auto page_hash = sim.getPhysMemory().getCodePageHash(CODE_SEG_BASE);
+    ASSERT_NE(page_hash, 0);
+
+    // Other code bb published with colliding page hash
+    bb::Bb other_bb{};
+    size_t fetched = 0;
+    auto fetch = [&]() {
+        return bb::Bb::FetchResult{SimStatus::OK, OTHER_CODE[fetched++]};
+    };
+    other_bb.update(CODE_SEG_BASE, fetch, OTHER_CODE.size() * INSTR_CODE_SIZE);
+
+    // Code bytes as laid out in zeroed page
+    std::array<uint8_t, cache::SharedBbStore::MAX_CODE_SIZE> other_code{};
+    std::memcpy(other_code.data(), OTHER_CODE.data(),
+                OTHER_CODE.size() * INSTR_CODE_SIZE);
+
+    cache::SharedBbStore store{};
+    auto other_key = cache::SharedBbStore::Key{
+        CODE_SEG_BASE, page_hash, other_code.data(), other_code.size()};
+    ASSERT_NE(store.publish(other_key, other_bb), nullptr);
+    ASSERT_EQ(store.find(other_key), store.publish(other_key, other_bb));
+
+    sim.setSharedBbStore(&store);
+    ASSERT_EQ(sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+    ASSERT_EQ(sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A0), 42);
+    ASSERT_EQ(store.size(), 2);
+}
+
+TEST_F(SimulatorTest, callGraph) {
+    const std::vector<InstrCode> CODE = {
+        // main:
+        0x00c000ef, // jal ra, foo
+        0x05d0089b, // addiw a7, x0, 93
+        0x00000073, // ecall
+
+        // foo:
+        0x00008293, // addi t0, ra, 0
+        0x00c000ef, // jal ra, bar
+        0x00028093, // addi ra, t0, 0
+        0x00008067, // ret
+
+        // bar:
+        0x0015051b, // addiw a0, a0, 1
+        0x00008067  // ret
+    };
+
+    elf::SymbolIndex symbols{{{"main", CODE_SEG_BASE, 12},
+                              {"foo", CODE_SEG_BASE + 12, 16},
+                              {"bar", CODE_SEG_BASE + 28, 8}}};
+
+    // Stack is sampled on each bb boundary
+    profile::CallGraphSampler sampler{1};
+    sim.setCallGraphSampler(&sampler);
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(sim.icount(), 9);
+    ASSERT_EQ(sampler.sampleNumber(), 4);
+
+    std::ostringstream out{};
+    profile::writeFoldedStacks(out, sampler, symbols);
+    ASSERT_EQ(out.str(), "main 1\n"
+                         "main;foo 2\n"
+                         "main;foo;bar 1\n");
+}
+
+// Disabling one bb hook keeps others enabled
+TEST_F(SimulatorTest, bbHooks) {
+    const std::vector<InstrCode> CODE = {
+        0x0080006f, // j end
+        0x00000000, // illegal
+
+        // end:
+        0x05d0089b, // addiw a7, x0, 93
+        0x00000073  // ecall
+    };
+
+    profile::BbProfiler profiler{};
+    std::ostringstream bbv{};
+    profile::BbvRecorder bbv_recorder{bbv, 100};
+    profile::InstrMixRecorder instr_mix{};
+
+    sim.setProfiler(&profiler);
+    sim.setBbvRecorder(&bbv_recorder);
+    sim.setInstrMixRecorder(&instr_mix);
+    sim.setProfiler(nullptr);
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    bbv_recorder.finish();
+
+    ASSERT_EQ(sim.icount(), 3);
+    ASSERT_TRUE(profiler.counters().empty());
+    ASSERT_EQ(bbv.str(), "T:1:1 :2:2 \n");
+    ASSERT_EQ(instr_mix.mix()[to_underlying(instr::InstrId::ECALL)], 1);
+}
+
+// Count instrs with instr hooks and record memory accesses
+class CountPlugin final : public plugin::Plugin {
+  public:
+    uint64_t instrs = 0;
+    uint64_t block_entries = 0;
+    std::vector<plugin::MemAccess> accesses{};
+
+    void onBlockTranslate(plugin::BlockBuilder &block) override {
+        block.onExec(
+            [](const hart::Hart &, void *data) {
+                ++static_cast<CountPlugin *>(data)->block_entries;
+            },
+            this);
+
+        for (size_t i = 0; i != block.instrNumber(); ++i) {
+            block.onInstrExec(
+                i,
+                [](const hart::Hart &, void *data) {
+                    ++static_cast<CountPlugin *>(data)->instrs;
+                },
+                this);
+
+            block.onMemAccess(
+                i,
+                [](const hart::Hart &, const plugin::MemAccess &access,
+                   void *data) {
+                    static_cast<CountPlugin *>(data)->accesses.push_back(
+                        access);
+                },
+                this);
+        }
+    }
+};
+
+TEST_F(SimulatorTest, plugins) {
+    const PhysAddr DATA_PAGE_PA = 0x6000000000;
+
+    ASSERT_TRUE(sim.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+
+    const std::vector<InstrCode> CODE = {
+        0x0000051b, // addiw a0, zero, 0
+        0x0000029b, // addiw t0, zero, 0
+        0x0050031b, // addiw t1, zero, 5
+        0x0060059b, // addiw a1, zero, 6
+        0x02459593, // slli a1, a1, 36
+
+        // for:
+        0x0062da63, // bge t0, t1, end
+        0x0055053b, // addw a0, a0, t0
+        0x00a5b423, // sd a0, 8(a1)
+        0x0012829b, // addiw t0, t0, 1
+        0xff1ff06f, // j for
+
+        // end:
+        0x0085b603, // ld a2, 8(a1)
+        0x05d0089b, // addiw a7, x0, 93
+        0x00000073  // ecall
+    };
+
+    plugin::Manager plugins{};
+    auto plugin = std::make_unique<CountPlugin>();
+    auto &counts = *plugin;
+    plugins.add(std::move(plugin));
+
+    profile::InstrMixRecorder instr_mix{};
+
+    // Shared bbs are not instrumented, so store is not used
+    cache::SharedBbStore store{};
+    sim.setSharedBbStore(&store);
+    sim.setPlugins(&plugins);
+    sim.setInstrMixRecorder(&instr_mix);
+
+    ASSERT_EQ(simulate(CODE), SimStatus::OK);
+    ASSERT_EQ(store.size(), 0);
+
+    // Hook calls take no icount
+    ASSERT_EQ(sim.icount(), 34);
+    ASSERT_EQ(counts.instrs, sim.icount());
+    ASSERT_EQ(counts.block_entries, 12);
+    ASSERT_EQ(sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A2), 10);
+
+    // Instrumented copies are walked instead of redirected bbs
+    auto mix = instr_mix.mix();
+    ASSERT_EQ(mix[to_underlying(instr::InstrId::SD)], 5);
+    ASSERT_EQ(mix[to_underlying(instr::InstrId::SIM_PLUGIN_BLOCK)], 0);
+    ASSERT_EQ(mix[to_underlying(instr::InstrId::SIM_PLUGIN_CALL)], 0);
+
+    ASSERT_EQ(counts.accesses.size(), 6);
+    for (size_t i = 0; i != counts.accesses.size(); ++i) {
+        const auto &access = counts.accesses[i];
+        ASSERT_EQ(access.va, DATA_PAGE_PA + 8);
+        ASSERT_EQ(access.size, 8);
+        ASSERT_EQ(access.is_store, i != counts.accesses.size() - 1);
+    }
+}
+
+TEST_F(SimulatorTest, hostFuncs) {
+    const std::vector<InstrCode> CODE = {
+        0x008000ef, // jal ra, func
+        0x00000073, // ecall
+
+        // func: illegal, so guest code is never executed
+        0x00000000};
+
+    static constexpr VirtAddr FUNC_VA = CODE_SEG_BASE + 8;
+    // Strings cross page boundary
+    static constexpr VirtAddr SRC_VA =
+        CODE_SEG_BASE + 2 * memory::PAGE_SIZE - 3;
+    static constexpr VirtAddr DST_VA = CODE_SEG_BASE + 3 * memory::PAGE_SIZE;
+
+    load(sim, CODE);
+
+    auto &phys_memory = sim.getPhysMemory();
+    for (size_t i = 1; i != 4; ++i) {
+        ASSERT_TRUE(
+            phys_memory.addRAMPage(CODE_SEG_BASE + i * memory::PAGE_SIZE));
+    }
+
+    const char STR[] = "host memcpy";
+    for (size_t i = 0; i != sizeof(STR); ++i) {
+        ASSERT_EQ(phys_memory.write(SRC_VA + i, uint8_t(STR[i])).status,
+                  SimStatus::OK);
+    }
+
+    auto &gpr = sim.getHart().gprFile();
+    auto call = [&](Simulator::HostFunc func, RegValue a0, RegValue a1,
+                    RegValue a2) {
+        sim.setHostFunc(FUNC_VA, func);
+
+        gpr.write(gpr::GPR_IDX::A0, a0);
+        gpr.write(gpr::GPR_IDX::A1, a1);
+        gpr.write(gpr::GPR_IDX::A2, a2);
+        gpr.write(gpr::GPR_IDX::A7, 93);
+
+        EXPECT_EQ(sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+        return gpr.read<int64_t>(gpr::GPR_IDX::A0);
+    };
+
+    using HostFunc = Simulator::HostFunc;
+
+    ASSERT_EQ(call(HostFunc::STRLEN, SRC_VA, 0, 0), sizeof(STR) - 1);
+
+    ASSERT_EQ(call(HostFunc::MEMCPY, DST_VA, SRC_VA, sizeof(STR)), DST_VA);
+    ASSERT_EQ(call(HostFunc::STRCMP, DST_VA, SRC_VA, 0), 0);
+
+    // icount is credited with equivalent guest instrs
+    const auto &cost =
+        Simulator::DEFAULT_HOST_FUNC_COSTS[to_underlying(HostFunc::STRCMP)];
+    ASSERT_EQ(sim.icount(), 2 + cost.call_icount + 2 * cost.word_icount);
+
+    ASSERT_EQ(call(HostFunc::MEMSET, DST_VA + 5, 'M', 1), DST_VA + 5);
+    ASSERT_EQ(call(HostFunc::STRCMP, DST_VA, SRC_VA, 0), 'M' - 'm');
+
+    sim.setHostFuncCost(HostFunc::MEMSET, {1, 0});
+    ASSERT_EQ(call(HostFunc::MEMSET, DST_VA, 0, memory::PAGE_SIZE), DST_VA);
+    ASSERT_EQ(sim.icount(), 3);
+
+    // Fault in host routine stops simulation
+    gpr.write(gpr::GPR_IDX::A2, 2 * memory::PAGE_SIZE);
+    ASSERT_NE(sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+}
+
 } // namespace sim
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/smp.hpp>
+#include <sim/smp/spinlock_guest.hpp>
+
+using namespace sim;
+
+// Usage: bench_spinlock [harts] [iterations] [quantum]
+
+namespace {
+
+constexpr PhysAddr CODE_SEG_BASE = 0x5000000000;
+constexpr PhysAddr DATA_PAGE_PA = smp::guest::SPINLOCK_DATA_PAGE_PA;
+
+// Each hart takes lock at DATA_PAGE_PA [iterations] times and increments
+// counter at DATA_PAGE_PA + 8 under the lock.
+// Iterations number is read from DATA_PAGE_PA + 32
+const auto &CODE = smp::guest::SPINLOCK_CODE;
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t harts = std::max(1U, std::thread::hardware_concurrency());
+    uint64_t iterations = 100000;
+    // Zero quantum means free-running harts
+    size_t quantum = 0;
+
+    if (argc > 1) {
+        harts = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = std::stoull(argv[2]);
+    }
+    if (argc > 3) {
+        quantum = std::stoul(argv[3]);
+    }
+
+    smp::SmpSimulator smp{harts};
+    auto &pm = smp.getPhysMemory();
+
+    SIM_ASSERT(pm.addRAMPage(CODE_SEG_BASE));
+    SIM_ASSERT(pm.addRAMPage(DATA_PAGE_PA));
+
+    for (size_t i = 0, end = CODE.size(); i != end; ++i) {
+        SIM_ASSERT(pm.write(CODE_SEG_BASE + i * INSTR_CODE_SIZE, CODE[i])
+                       .status == SimStatus::OK);
+    }
+    SIM_ASSERT(pm.write(DATA_PAGE_PA + 32, iterations).status ==
+               SimStatus::OK);
+
+    // Harts of one quantum run in parallel
+    smp::QuantumConfig config{quantum, true};
+
+    auto start = std::chrono::steady_clock::now();
+    auto status = quantum == 0 ? smp.simulate(CODE_SEG_BASE)
+                               : smp.simulate(CODE_SEG_BASE, config);
+    std::chrono::duration<double> time =
+        std::chrono::steady_clock::now() - start;
+
+    uint64_t counter = 0;
+    SIM_ASSERT(pm.read(DATA_PAGE_PA + 8, counter).status == SimStatus::OK);
+
+    std::cout << "harts = " << harts << ", iterations = " << iterations
+              << ", quantum = " << quantum << std::endl
+              << "time = " << time.count() << " s, icount = " << smp.icount()
+              << ", MIPS = " << smp.icount() / time.count() / 1e6 << std::endl
+              << "lock acquisitions per second = " << counter / time.count()
+              << std::endl;
+
+    if (status != SimStatus::OK || counter != harts * iterations) {
+        std::cout << "Error: status = " << sim::to_underlying(status)
+                  << ", counter = " << counter << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
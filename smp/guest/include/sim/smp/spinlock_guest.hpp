@@ -0,0 +1,59 @@
+#ifndef INCL_SIM_SMP_SPINLOCK_GUEST_HPP
+#define INCL_SIM_SMP_SPINLOCK_GUEST_HPP
+
+#include <vector>
+
+#include <sim/common.hpp>
+
+namespace sim::smp::guest {
+
+// Data page of spinlock guest. Its address is built into the code
+inline constexpr PhysAddr SPINLOCK_DATA_PAGE_PA = 0x6000000000;
+
+// Each hart takes test-and-test-and-set lock [iterations] times and
+// increments counter under the lock, then increments LR/SC and AMO counters
+// once. Data page layout:
+// [0] - lock, [8] - counter under lock, [16] - LR/SC counter,
+// [24] - AMO counter, [32] - iterations number
+inline const std::vector<InstrCode> SPINLOCK_CODE = {
+    0x0060039b, // addiw t2, zero, 6
+    0x02439393, // slli t2, t2, 36
+    0x0203b303, // ld t1, 32(t2)
+    0x00100e13, // addi t3, zero, 1
+
+    // loop:
+    0x02030663, // beqz t1, done
+
+    // acquire:
+    0x0003ae83, // lw t4, 0(t2)
+    0xfe0e9ee3, // bnez t4, acquire
+    0x0dc3aeaf, // amoswap.w.aq t4, t3, (t2)
+    0xfe0e9ae3, // bnez t4, acquire
+
+    0x0083bf03, // ld t5, 8(t2)
+    0x001f0f13, // addi t5, t5, 1
+    0x01e3b423, // sd t5, 8(t2)
+
+    0x0a03a02f, // amoswap.w.rl zero, zero, (t2)
+    0xfff30313, // addi t1, t1, -1
+    0xfd9ff06f, // j loop
+
+    // done:
+    0x01038f93, // addi t6, t2, 16
+
+    // retry:
+    0x100fbeaf, // lr.d t4, (t6)
+    0x001e8e93, // addi t4, t4, 1
+    0x19dfbf2f, // sc.d t5, t4, (t6)
+    0xfe0f1ae3, // bnez t5, retry
+
+    0x01838493, // addi s1, t2, 24
+    0x01c4b02f, // amoadd.d zero, t3, (s1)
+
+    0x05d0089b, // addiw a7, zero, 93
+    0x00000073  // ecall
+};
+
+} // namespace sim::smp::guest
+
+#endif // INCL_SIM_SMP_SPINLOCK_GUEST_HPP
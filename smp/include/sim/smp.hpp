@@ -0,0 +1,82 @@
+#ifndef INCL_SIM_SMP_HPP
+#define INCL_SIM_SMP_HPP
+
+#include <memory>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/memory.hpp>
+#include <sim/simulator.hpp>
+
+namespace sim::smp {
+
+// Deterministic quantum scheduler settings
+struct QuantumConfig final {
+    // Instructions each hart executes between barriers. Smaller quantum
+    // brings harts closer in time at the cost of more synchronization
+    size_t quantum = 10000;
+    // Simulate harts in parallel inside quantum. Results are reproducible
+    // only if harts do not communicate through memory inside one quantum.
+    // By default harts simulate their quanta one by one in hart id order,
+    // so results are identical run to run
+    bool parallel = false;
+};
+
+// Multi-hart system simulator.
+// Harts share physical memory and are simulated on separate host threads.
+// Each hart has private TLBs and bb cache. Physical memory mappings must be
+// set up before simulation starts
+class SmpSimulator final {
+    memory::PhysMemory m_phys_memory{};
+
+    std::vector<std::unique_ptr<Simulator>> m_harts{};
+    std::vector<SimStatus> m_hart_statuses{};
+
+  public:
+    explicit SmpSimulator(size_t hart_number);
+
+    NODISCARD auto hartNumber() const noexcept { return m_harts.size(); }
+
+    NODISCARD auto &getPhysMemory() noexcept { return m_phys_memory; }
+
+    // Get simulator of hart with given id
+    NODISCARD auto &getHartSim(size_t hart_id) noexcept {
+        SIM_ASSERT(hart_id < m_harts.size());
+        return *m_harts[hart_id];
+    }
+
+    // Get status of hart with given id after last simulation
+    NODISCARD auto hartStatus(size_t hart_id) const noexcept {
+        SIM_ASSERT(hart_id < m_hart_statuses.size());
+        return m_hart_statuses[hart_id];
+    }
+
+    // Use shared decoded bbs store for all harts. nullptr disables sharing
+    void setSharedBbStore(cache::SharedBbStore *store) noexcept {
+        for (auto &&hart : m_harts) {
+            hart->setSharedBbStore(store);
+        }
+    }
+
+    // Post IPI to all harts. Thread-safe
+    void broadcastIpi(uint32_t ipi_mask) noexcept;
+
+    // Total instructions count of all harts
+    NODISCARD size_t icount() const noexcept;
+
+    // Simulate all harts starting from given pc. Each hart gets its id in a0.
+    // Hart failure stops other harts.
+    // Returns first failed hart status or OK
+    SimStatus simulate(VirtAddr start_pc);
+
+    // Simulate all harts with quantum scheduler: hart n runs until
+    // n * quantum instructions then waits on barrier for other harts. Hart
+    // exits and failures are handled on barriers in hart id order, so failure
+    // stops other harts on the same quantum boundary.
+    // Returns first failed hart status or OK
+    SimStatus simulate(VirtAddr start_pc, const QuantumConfig &config);
+};
+
+} // namespace sim::smp
+
+#endif // INCL_SIM_SMP_HPP
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <barrier>
+#include <thread>
+
+#include <sim/gpr.hpp>
+#include <sim/smp.hpp>
+
+namespace sim::smp {
+
+SmpSimulator::SmpSimulator(size_t hart_number)
+    : m_hart_statuses(hart_number, SimStatus::OK) {
+    SIM_ASSERT(hart_number != 0);
+
+    m_harts.reserve(hart_number);
+    for (size_t hart_id = 0; hart_id != hart_number; ++hart_id) {
+        m_harts.push_back(std::make_unique<Simulator>(m_phys_memory, hart_id));
+    }
+}
+
+void SmpSimulator::broadcastIpi(uint32_t ipi_mask) noexcept {
+    for (auto &&hart : m_harts) {
+        hart->postIpi(ipi_mask);
+    }
+}
+
+NODISCARD size_t SmpSimulator::icount() const noexcept {
+    size_t icount = 0;
+
+    for (auto &&hart : m_harts) {
+        icount += hart->icount();
+    }
+
+    return icount;
+}
+
+SimStatus SmpSimulator::simulate(VirtAddr start_pc) {
+    auto simulate_hart = [this, start_pc](size_t hart_id) {
+        auto &sim = *m_harts[hart_id];
+        sim.getHart().gprFile().write(gpr::GPR_IDX::A0, hart_id);
+
+        auto status = sim.simulate(start_pc);
+        m_hart_statuses[hart_id] = status;
+
+        // Failed hart stops the whole system
+        if (status != SimStatus::OK && status != SimStatus::SIM__STOP_REQUEST) {
+            broadcastIpi(Simulator::IPI_STOP);
+        }
+    };
+
+    // Stop requests left from previous simulation are outdated
+    for (auto &&hart : m_harts) {
+        hart->cancelIpi(Simulator::IPI_STOP);
+    }
+
+    std::vector<std::thread> threads{};
+    threads.reserve(hartNumber());
+
+    for (size_t hart_id = 0, end = hartNumber(); hart_id != end; ++hart_id) {
+        threads.emplace_back(simulate_hart, hart_id);
+    }
+
+    for (auto &&thread : threads) {
+        thread.join();
+    }
+
+    for (auto status : m_hart_statuses) {
+        if (status != SimStatus::OK && status != SimStatus::SIM__STOP_REQUEST) {
+            return status;
+        }
+    }
+
+    return SimStatus::OK;
+}
+
+SimStatus SmpSimulator::simulate(VirtAddr start_pc,
+                                 const QuantumConfig &config) {
+    SIM_ASSERT(config.quantum != 0);
+
+    auto hart_number = hartNumber();
+
+    // Harts which did not exit or fail yet
+    std::vector<char> running(hart_number, true);
+    size_t quantum_end = config.quantum;
+    bool done = false;
+
+    for (size_t hart_id = 0; hart_id != hart_number; ++hart_id) {
+        m_harts[hart_id]->getHart().gprFile().write(gpr::GPR_IDX::A0, hart_id);
+    }
+
+    auto run_quantum = [&](size_t hart_id) {
+        if (!running[hart_id]) {
+            return;
+        }
+
+        auto &sim = *m_harts[hart_id];
+
+        if (quantum_end == config.quantum) {
+            m_hart_statuses[hart_id] = sim.simulate(start_pc, quantum_end);
+            return;
+        }
+
+        // Previous quantum could end a few instructions later
+        auto icount = sim.icount();
+        m_hart_statuses[hart_id] =
+            sim.resume(quantum_end > icount ? quantum_end - icount : 0);
+    };
+
+    // Called on quantum boundary when all harts wait on barrier
+    auto end_quantum = [&]() noexcept {
+        bool failed = false;
+
+        for (size_t hart_id = 0; hart_id != hart_number; ++hart_id) {
+            auto status = m_hart_statuses[hart_id];
+            if (running[hart_id] && status != SimStatus::SIM__ICOUNT_LIMIT) {
+                running[hart_id] = false;
+                failed |= status != SimStatus::OK;
+            }
+        }
+
+        // Failed hart stops the whole system
+        for (size_t hart_id = 0; hart_id != hart_number; ++hart_id) {
+            if (failed && running[hart_id]) {
+                running[hart_id] = false;
+                m_hart_statuses[hart_id] = SimStatus::SIM__STOP_REQUEST;
+            }
+        }
+
+        quantum_end += config.quantum;
+        done = std::find(running.begin(), running.end(), true) == running.end();
+    };
+
+    if (config.parallel) {
+        std::barrier barrier{static_cast<std::ptrdiff_t>(hart_number),
+                             end_quantum};
+
+        auto simulate_hart = [&](size_t hart_id) {
+            while (!done) {
+                run_quantum(hart_id);
+                barrier.arrive_and_wait();
+            }
+        };
+
+        std::vector<std::thread> threads{};
+        threads.reserve(hart_number);
+
+        for (size_t hart_id = 0; hart_id != hart_number; ++hart_id) {
+            threads.emplace_back(simulate_hart, hart_id);
+        }
+
+        for (auto &&thread : threads) {
+            thread.join();
+        }
+    } else {
+        while (!done) {
+            for (size_t hart_id = 0; hart_id != hart_number; ++hart_id) {
+                run_quantum(hart_id);
+            }
+            end_quantum();
+        }
+    }
+
+    for (auto status : m_hart_statuses) {
+        if (status != SimStatus::OK && status != SimStatus::SIM__STOP_REQUEST) {
+            return status;
+        }
+    }
+
+    return SimStatus::OK;
+}
+
+} // namespace sim::smp
@@ -0,0 +1,204 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sim/smp.hpp>
+#include <sim/smp/spinlock_guest.hpp>
+
+namespace sim::smp {
+
+class SmpTest : public ::testing::Test {
+  protected:
+    static constexpr PhysAddr CODE_SEG_BASE = 0x5000000000;
+    static constexpr PhysAddr DATA_PAGE_PA = guest::SPINLOCK_DATA_PAGE_PA;
+    static constexpr size_t HART_NUMBER = 4;
+
+    SmpSimulator smp{HART_NUMBER};
+
+    static void load(SmpSimulator &smp, const std::vector<InstrCode> &code) {
+        auto &phys_memory = smp.getPhysMemory();
+
+        for (PhysAddr page_pa = CODE_SEG_BASE,
+                      end = code.size() + CODE_SEG_BASE;
+             page_pa < end; page_pa += memory::PAGE_SIZE) {
+            SIM_ASSERT(phys_memory.addRAMPage(page_pa));
+        }
+
+        for (size_t i = 0, end = code.size(); i != end; ++i) {
+            SIM_ASSERT(
+                phys_memory.write(CODE_SEG_BASE + i * INSTR_CODE_SIZE, code[i])
+                    .status == SimStatus::OK);
+        }
+    }
+
+    SimStatus simulate(const std::vector<InstrCode> &code) {
+        load(smp, code);
+        return smp.simulate(CODE_SEG_BASE);
+    }
+
+    SimStatus simulate(const std::vector<InstrCode> &code,
+                       const QuantumConfig &config) {
+        load(smp, code);
+        return smp.simulate(CODE_SEG_BASE, config);
+    }
+
+    // Each hart sums [0, 64 * (hart_id + 1)) and stores the sum to
+    // DATA_PAGE_PA + 8 * hart_id
+    const std::vector<InstrCode> SUM_CODE = {
+        0x00150313, // addi t1, a0, 1
+        0x00631313, // slli t1, t1, 6
+        0x00000293, // addi t0, zero, 0
+        0x00000593, // addi a1, zero, 0
+
+        // for:
+        0x0062d863, // bge t0, t1, end
+        0x005585b3, // add a1, a1, t0
+        0x00128293, // addi t0, t0, 1
+        0xff5ff06f, // j for
+
+        // end:
+        0x0060039b, // addiw t2, zero, 6
+        0x02439393, // slli t2, t2, 36
+        0x00351e13, // slli t3, a0, 3
+        0x01c383b3, // add t2, t2, t3
+        0x00b3b023, // sd a1, 0(t2)
+
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    // Hart 0 spins forever, other harts fail on illegal instruction
+    const std::vector<InstrCode> FAILURE_CODE = {
+        0x00051463, // bnez a0, fail
+
+        // spin:
+        0x0000006f, // j spin
+
+        // fail:
+        0x00000000, // illegal
+    };
+
+    void checkSum() {
+        for (size_t hart_id = 0; hart_id != HART_NUMBER; ++hart_id) {
+            ASSERT_EQ(smp.hartStatus(hart_id), SimStatus::OK);
+
+            uint64_t n = 64 * (hart_id + 1);
+            uint64_t sum = 0;
+            auto status =
+                smp.getPhysMemory().read(DATA_PAGE_PA + 8 * hart_id, sum);
+
+            ASSERT_EQ(status.status, SimStatus::OK);
+            ASSERT_EQ(sum, n * (n - 1) / 2);
+
+            // 4 + 4 * n + 1 + 7
+            ASSERT_EQ(smp.getHartSim(hart_id).icount(), 4 * n + 12);
+        }
+    }
+
+    void checkSpinlock(uint64_t iterations) {
+        auto &phys_memory = smp.getPhysMemory();
+
+        uint64_t lock = 0;
+        uint64_t counter = 0;
+        uint64_t lr_sc_counter = 0;
+        uint64_t amo_counter = 0;
+
+        ASSERT_EQ(phys_memory.read(DATA_PAGE_PA, lock).status, SimStatus::OK);
+        ASSERT_EQ(phys_memory.read(DATA_PAGE_PA + 8, counter).status,
+                  SimStatus::OK);
+        ASSERT_EQ(phys_memory.read(DATA_PAGE_PA + 16, lr_sc_counter).status,
+                  SimStatus::OK);
+        ASSERT_EQ(phys_memory.read(DATA_PAGE_PA + 24, amo_counter).status,
+                  SimStatus::OK);
+
+        ASSERT_EQ(lock, 0);
+        ASSERT_EQ(counter, HART_NUMBER * iterations);
+        ASSERT_EQ(lr_sc_counter, HART_NUMBER);
+        ASSERT_EQ(amo_counter, HART_NUMBER);
+    }
+};
+
+TEST_F(SmpTest, sharedMemory) {
+    ASSERT_TRUE(smp.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+
+    ASSERT_EQ(simulate(SUM_CODE), SimStatus::OK);
+    checkSum();
+}
+
+TEST_F(SmpTest, failureStopsHarts) {
+    ASSERT_EQ(simulate(FAILURE_CODE), SimStatus::SIM__NOT_IMPLEMENTED_INSTR);
+    ASSERT_EQ(smp.hartStatus(0), SimStatus::SIM__STOP_REQUEST);
+}
+
+TEST_F(SmpTest, spinlock) {
+    static constexpr uint64_t ITERATIONS = 1000;
+
+    auto &phys_memory = smp.getPhysMemory();
+    ASSERT_TRUE(phys_memory.addRAMPage(DATA_PAGE_PA));
+    ASSERT_EQ(phys_memory.write(DATA_PAGE_PA + 32, ITERATIONS).status,
+              SimStatus::OK);
+
+    ASSERT_EQ(simulate(guest::SPINLOCK_CODE), SimStatus::OK);
+    checkSpinlock(ITERATIONS);
+}
+
+TEST_F(SmpTest, quantumParallel) {
+    ASSERT_TRUE(smp.getPhysMemory().addRAMPage(DATA_PAGE_PA));
+
+    ASSERT_EQ(simulate(SUM_CODE, {100, true}), SimStatus::OK);
+    checkSum();
+}
+
+TEST_F(SmpTest, quantumFailureStopsHarts) {
+    for (bool parallel : {true, false}) {
+        SmpSimulator smp{HART_NUMBER};
+        load(smp, FAILURE_CODE);
+
+        ASSERT_EQ(smp.simulate(CODE_SEG_BASE, {100, parallel}),
+                  SimStatus::SIM__NOT_IMPLEMENTED_INSTR);
+        ASSERT_EQ(smp.hartStatus(0), SimStatus::SIM__STOP_REQUEST);
+
+        // Hart 0 is stopped on first quantum boundary
+        ASSERT_EQ(smp.getHartSim(0).icount(), 100);
+    }
+}
+
+TEST_F(SmpTest, quantumDeterminism) {
+    static constexpr uint64_t ITERATIONS = 1000;
+    static constexpr size_t RUN_NUMBER = 3;
+
+    auto &phys_memory = smp.getPhysMemory();
+    ASSERT_TRUE(phys_memory.addRAMPage(DATA_PAGE_PA));
+    load(smp, guest::SPINLOCK_CODE);
+
+    // Default config and short quanta
+    for (auto config : {QuantumConfig{}, QuantumConfig{50}}) {
+        // Harts icounts of first run
+        std::vector<size_t> icounts{};
+
+        for (size_t run = 0; run != RUN_NUMBER; ++run) {
+            for (PhysAddr offset = 0; offset != 32; offset += 8) {
+                ASSERT_EQ(phys_memory.write(DATA_PAGE_PA + offset, uint64_t{0})
+                              .status,
+                          SimStatus::OK);
+            }
+            ASSERT_EQ(phys_memory.write(DATA_PAGE_PA + 32, ITERATIONS).status,
+                      SimStatus::OK);
+
+            ASSERT_EQ(smp.simulate(CODE_SEG_BASE, config), SimStatus::OK);
+            checkSpinlock(ITERATIONS);
+
+            for (size_t hart_id = 0; hart_id != HART_NUMBER; ++hart_id) {
+                auto icount = smp.getHartSim(hart_id).icount();
+
+                if (run == 0) {
+                    icounts.push_back(icount);
+                } else {
+                    ASSERT_EQ(icount, icounts[hart_id]);
+                }
+            }
+        }
+    }
+}
+
+} // namespace sim::smp
@@ -0,0 +1,77 @@
+#ifndef INCL_SIM_STATS_HPP
+#define INCL_SIM_STATS_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <sim/common.hpp>
+
+namespace sim::stats {
+
+// Counters are compiled out unless built with SIM_STATS_ENABLE
+#ifdef SIM_STATS_ENABLE
+inline constexpr bool ENABLED = true;
+#else
+inline constexpr bool ENABLED = false;
+#endif
+
+// Event counter. Empty and free when stats are disabled
+class Counter final {
+#ifdef SIM_STATS_ENABLE
+    uint64_t m_value = 0;
+#endif
+
+  public:
+    void add([[maybe_unused]] uint64_t value) noexcept {
+#ifdef SIM_STATS_ENABLE
+        m_value += value;
+#endif
+    }
+
+    void inc() noexcept { add(1); }
+
+    NODISCARD uint64_t value() const noexcept {
+#ifdef SIM_STATS_ENABLE
+        return m_value;
+#else
+        return 0;
+#endif
+    }
+};
+
+// Named statistics collected from simulator components. Names are dot
+// separated paths, e.g. "tlb.read.hits"
+class Registry final {
+  public:
+    using Value = std::variant<uint64_t, double>;
+
+  private:
+    std::vector<std::pair<std::string, Value>> m_entries{};
+
+  public:
+    void add(std::string name, uint64_t value) {
+        m_entries.emplace_back(std::move(name), value);
+    }
+
+    void add(std::string name, double value) {
+        m_entries.emplace_back(std::move(name), value);
+    }
+
+    // Entries in order of addition
+    NODISCARD const auto &entries() const noexcept { return m_entries; }
+
+    // Value of named entry. Returns nullptr if there is none
+    NODISCARD const Value *find(const std::string &name) const noexcept;
+
+    // Write entries as JSON object nested by name paths. Entries sharing
+    // path prefix are expected to be added in a row
+    void writeJson(std::ostream &out) const;
+};
+
+} // namespace sim::stats
+
+#endif // INCL_SIM_STATS_HPP
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <string_view>
+
+#include <sim/stats.hpp>
+
+namespace sim::stats {
+
+namespace {
+
+constexpr int JSON_INDENT = 4;
+constexpr int DOUBLE_PRECISION = 6;
+
+// Split dot separated name
+std::vector<std::string_view> splitName(std::string_view name) {
+    std::vector<std::string_view> path{};
+
+    while (true) {
+        auto dot = name.find('.');
+        path.push_back(name.substr(0, dot));
+
+        if (dot == std::string_view::npos) {
+            return path;
+        }
+        name.remove_prefix(dot + 1);
+    }
+}
+
+class JsonWriter final {
+    std::ostream &m_out;
+    std::vector<std::string_view> m_open{};
+    bool m_need_comma = false;
+
+    void writeKey(std::string_view key) {
+        if (m_need_comma) {
+            m_out << ',';
+        }
+
+        m_out << '\n'
+              << std::setw(JSON_INDENT * (m_open.size() + 1)) << "" << '"'
+              << key << "\": ";
+    }
+
+    void close() {
+        m_open.pop_back();
+        m_out << '\n'
+              << std::setw(JSON_INDENT * (m_open.size() + 1)) << "" << '}';
+        m_need_comma = true;
+    }
+
+  public:
+    explicit JsonWriter(std::ostream &out) : m_out(out) { m_out << '{'; }
+
+    void finish() {
+        while (!m_open.empty()) {
+            close();
+        }
+        m_out << "\n}" << std::endl;
+    }
+
+    void write(std::string_view name, const Registry::Value &value) {
+        auto path = splitName(name);
+        auto objects_number = path.size() - 1;
+
+        // Leave objects not containing this entry
+        size_t common = 0;
+        while (common != std::min(m_open.size(), objects_number) &&
+               m_open[common] == path[common]) {
+            ++common;
+        }
+        while (m_open.size() != common) {
+            close();
+        }
+
+        for (size_t i = common; i != objects_number; ++i) {
+            writeKey(path[i]);
+            m_out << '{';
+            m_open.push_back(path[i]);
+            m_need_comma = false;
+        }
+
+        writeKey(path.back());
+        if (const auto *integer = std::get_if<uint64_t>(&value)) {
+            m_out << *integer;
+        } else if (auto real = std::get<double>(value); std::isfinite(real)) {
+            m_out << std::fixed << std::setprecision(DOUBLE_PRECISION) << real
+                  << std::defaultfloat;
+        } else {
+            m_out << "null";
+        }
+        m_need_comma = true;
+    }
+};
+
+} // namespace
+
+const Registry::Value *Registry::find(const std::string &name) const noexcept {
+    auto it = std::find_if(
+        m_entries.begin(), m_entries.end(),
+        [&name](const auto &entry) { return entry.first == name; });
+
+    return it == m_entries.end() ? nullptr : &it->second;
+}
+
+void Registry::writeJson(std::ostream &out) const {
+    auto precision = out.precision();
+
+    JsonWriter writer{out};
+    for (auto &&[name, value] : m_entries) {
+        writer.write(name, value);
+    }
+    writer.finish();
+
+    out.precision(precision);
+}
+
+} // namespace sim::stats
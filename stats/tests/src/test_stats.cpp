@@ -0,0 +1,52 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <sim/stats.hpp>
+
+namespace sim::stats {
+
+TEST(StatsTest, counter) {
+    Counter counter{};
+    counter.inc();
+    counter.add(41);
+
+    ASSERT_EQ(counter.value(), ENABLED ? 42 : 0);
+}
+
+TEST(StatsTest, registry) {
+    Registry registry{};
+    registry.add("icount", uint64_t{100});
+    registry.add("tlb.read.hits", uint64_t{7});
+    registry.add("tlb.read.misses", uint64_t{3});
+    registry.add("tlb.write.hits", uint64_t{5});
+    registry.add("host.mips", 12.5);
+
+    ASSERT_EQ(registry.entries().size(), 5);
+    ASSERT_EQ(std::get<uint64_t>(*registry.find("tlb.read.misses")), 3);
+    ASSERT_EQ(std::get<double>(*registry.find("host.mips")), 12.5);
+    ASSERT_EQ(registry.find("tlb.read"), nullptr);
+
+    std::ostringstream out{};
+    registry.writeJson(out);
+
+    const std::string EXPECTED = R"({
+    "icount": 100,
+    "tlb": {
+        "read": {
+            "hits": 7,
+            "misses": 3
+        },
+        "write": {
+            "hits": 5
+        }
+    },
+    "host": {
+        "mips": 12.500000
+    }
+}
+)";
+    ASSERT_EQ(out.str(), EXPECTED);
+}
+
+} // namespace sim::stats
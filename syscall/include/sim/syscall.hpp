@@ -0,0 +1,181 @@
+#ifndef INCL_SYSCALL_HPP
+#define INCL_SYSCALL_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/hart.hpp>
+#include <sim/memory.hpp>
+
+namespace sim::syscall {
+
+// riscv64 Linux syscall numbers
+namespace SYSCALL_NO {
+enum SYSCALL_NO : uint64_t {
+    OPENAT = 56,
+    CLOSE = 57,
+    READ = 63,
+    WRITE = 64,
+    FSTAT = 80,
+    EXIT = 93,
+    EXIT_GROUP = 94,
+    CLOCK_GETTIME = 113,
+    BRK = 214,
+    MUNMAP = 215,
+    MMAP = 222
+};
+} // namespace SYSCALL_NO
+
+// Guest stdout and stderr flush policy. Buffers are always flushed on exit
+// and when full
+enum class FlushPolicy {
+    FULL,
+    // Flush on every newline
+    LINE
+};
+
+// Maps fresh zeroed RAM page at given virtual page of given memory. Mapper
+// is copied with emulator state, so copies must not share allocation state
+using PageMapper =
+    std::function<SimStatus(memory::PhysMemory &, memory::VPN)>;
+
+// Linux user-mode syscalls emulation for one guest process.
+// Guest files are backed by host file descriptors. Pages of brk and mmap
+// regions are mapped on first access
+class Emulator final {
+    using AccessType = memory::MMU64::AccessType;
+
+  public:
+    // Top of mmap region. Mappings are placed below it
+    static constexpr VirtAddr MMAP_TOP = 0x2000000000;
+
+    // Guest stdout and stderr are buffered
+    static constexpr size_t BUFFERED_FD_NUMBER = 3;
+
+    // Guest process state. Guest files are kept open by duplicated host fds
+    // closed with the last state copy. File offsets are shared with the
+    // process
+    struct State final {
+        std::shared_ptr<const std::vector<int>> fds{};
+        std::array<std::string, BUFFERED_FD_NUMBER> out_buffers{};
+
+        PageMapper mapper{};
+
+        VirtAddr brk_start = 0;
+        VirtAddr brk = 0;
+
+        VirtAddr mmap_bottom = MMAP_TOP;
+        std::map<VirtAddr, VirtAddr> mmap_regions{};
+    };
+
+  private:
+    static constexpr size_t OUT_BUFFER_SIZE = 1 << 16;
+
+    // Guest fd -> host fd. Closed fds are -1
+    std::vector<int> m_fds{};
+    std::array<std::string, BUFFERED_FD_NUMBER> m_out_buffers{};
+    FlushPolicy m_flush_policy = FlushPolicy::FULL;
+
+    // Guest output is dropped instead of written to host files
+    bool m_drop_output = false;
+
+    PageMapper m_mapper{};
+
+    VirtAddr m_brk_start = 0;
+    VirtAddr m_brk = 0;
+
+    // Lowest mmap region addr
+    VirtAddr m_mmap_bottom = MMAP_TOP;
+    // Mapped regions: begin -> end
+    std::map<VirtAddr, VirtAddr> m_mmap_regions{};
+
+    int m_exit_code = 0;
+
+    NODISCARD int hostFd(uint64_t guest_fd) const noexcept;
+
+    // Translate guest va. Pages of brk and mmap regions are mapped on the
+    // way. Returns false on fault
+    NODISCARD bool translate(hart::Hart &hart, VirtAddr va,
+                             AccessType access_type, PhysAddr &pa) noexcept;
+
+    // Copy host data to guest memory page by page
+    NODISCARD bool copyToGuest(hart::Hart &hart, VirtAddr dst,
+                               const void *src, size_t size) noexcept;
+
+    NODISCARD bool readString(hart::Hart &hart, VirtAddr va,
+                              std::string &dst) noexcept;
+
+    void flushFd(size_t guest_fd) noexcept;
+
+    int64_t sysOpenat(hart::Hart &hart, int64_t dir_fd, VirtAddr path_va,
+                      int64_t flags, int64_t mode) noexcept;
+    int64_t sysClose(uint64_t fd) noexcept;
+    int64_t sysRead(hart::Hart &hart, uint64_t fd, VirtAddr buf,
+                    size_t count) noexcept;
+    int64_t sysWrite(hart::Hart &hart, uint64_t fd, VirtAddr buf,
+                     size_t count) noexcept;
+    int64_t sysFstat(hart::Hart &hart, uint64_t fd, VirtAddr buf) noexcept;
+    int64_t sysClockGettime(hart::Hart &hart, int64_t clock_id,
+                            VirtAddr buf) noexcept;
+    int64_t sysBrk(VirtAddr brk) noexcept;
+    int64_t sysMmap(VirtAddr addr, size_t length, int64_t prot, int64_t flags,
+                    int64_t fd) noexcept;
+    int64_t sysMunmap(VirtAddr addr, size_t length) noexcept;
+
+  public:
+    Emulator() { reset(); }
+
+    Emulator(const Emulator &) = delete;
+    Emulator &operator=(const Emulator &) = delete;
+
+    ~Emulator() { reset(); }
+
+    // Flush buffered output, close guest files and drop memory layout
+    void reset() noexcept;
+
+    // Set loaded program memory layout. Program break starts at brk_start
+    void setMemory(VirtAddr brk_start, PageMapper mapper) {
+        m_brk_start = m_brk = brk_start;
+        m_mapper = std::move(mapper);
+    }
+
+    void setFlushPolicy(FlushPolicy policy) noexcept {
+        m_flush_policy = policy;
+    }
+
+    // Drop guest output. Re-simulated process must not repeat output of the
+    // original one
+    void setDropOutput(bool drop) noexcept { m_drop_output = drop; }
+
+    // Copy of process state. Mapper copy continues page allocation
+    // independently
+    NODISCARD State state() const;
+
+    // Continue process from given state. Emulator must be reset and its
+    // memory must hold copy of state process memory
+    void restore(const State &state);
+
+    // Handle ecall. Syscall number is taken from a7, args from a0-a5.
+    // Result is written to a0. Returns SIM__EXIT on exit
+    NODISCARD SimStatus handle(hart::Hart &hart) noexcept;
+
+    // Map page of brk or mmap region containing va in given memory.
+    // Returns false if va is outside of them
+    NODISCARD bool mapLazy(memory::PhysMemory &pm, VirtAddr va) noexcept;
+
+    // Write buffered guest stdout and stderr
+    void flush() noexcept;
+
+    NODISCARD auto exitCode() const noexcept { return m_exit_code; }
+    NODISCARD auto brk() const noexcept { return m_brk; }
+};
+
+} // namespace sim::syscall
+
+#endif // INCL_SYSCALL_HPP
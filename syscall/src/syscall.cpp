@@ -0,0 +1,579 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sim/syscall.hpp>
+
+namespace sim::syscall {
+
+namespace {
+
+// riscv64 Linux ABI values
+static constexpr int64_t GUEST_AT_FDCWD = -100;
+
+static constexpr int64_t GUEST_MAP_PRIVATE = 0x02;
+static constexpr int64_t GUEST_MAP_FIXED = 0x10;
+static constexpr int64_t GUEST_MAP_ANONYMOUS = 0x20;
+
+static constexpr size_t GUEST_PATH_MAX = 4096;
+
+// riscv64 struct stat
+struct GuestStat final {
+    uint64_t st_dev = 0;
+    uint64_t st_ino = 0;
+    uint32_t st_mode = 0;
+    uint32_t st_nlink = 0;
+    uint32_t st_uid = 0;
+    uint32_t st_gid = 0;
+    uint64_t st_rdev = 0;
+    uint64_t pad1 = 0;
+    int64_t st_size = 0;
+    int32_t st_blksize = 0;
+    int32_t pad2 = 0;
+    int64_t st_blocks = 0;
+    int64_t st_atime_sec = 0;
+    uint64_t st_atime_nsec = 0;
+    int64_t st_mtime_sec = 0;
+    uint64_t st_mtime_nsec = 0;
+    int64_t st_ctime_sec = 0;
+    uint64_t st_ctime_nsec = 0;
+    uint32_t unused4 = 0;
+    uint32_t unused5 = 0;
+};
+
+static_assert(sizeof(GuestStat) == 128);
+
+struct GuestTimespec final {
+    int64_t tv_sec = 0;
+    int64_t tv_nsec = 0;
+};
+
+NODISCARD constexpr VirtAddr pageAlignUp(VirtAddr va) noexcept {
+    return (va + memory::PAGE_OFFSET_MASK) & ~memory::PAGE_OFFSET_MASK;
+}
+
+// Bytes from va to the end of its page, but not more than size
+NODISCARD constexpr size_t pageChunk(VirtAddr va, size_t size) noexcept {
+    return std::min(size, memory::PAGE_SIZE - (va & memory::PAGE_OFFSET_MASK));
+}
+
+} // namespace
+
+void Emulator::reset() noexcept {
+    flush();
+
+    for (size_t fd = BUFFERED_FD_NUMBER; fd < m_fds.size(); ++fd) {
+        if (m_fds[fd] != -1) {
+            ::close(m_fds[fd]);
+        }
+    }
+    m_fds = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+
+    m_mapper = {};
+    m_brk_start = m_brk = 0;
+    m_mmap_bottom = MMAP_TOP;
+    m_mmap_regions.clear();
+
+    m_exit_code = 0;
+}
+
+NODISCARD Emulator::State Emulator::state() const {
+    // Duplicated fds are closed with the last state copy. Host standard
+    // streams are not duplicated
+    std::shared_ptr<std::vector<int>> fds{
+        new std::vector<int>(m_fds), [](std::vector<int> *fds) {
+            for (size_t fd = BUFFERED_FD_NUMBER; fd < fds->size(); ++fd) {
+                if ((*fds)[fd] != -1) {
+                    ::close((*fds)[fd]);
+                }
+            }
+            delete fds;
+        }};
+
+    for (size_t fd = BUFFERED_FD_NUMBER; fd < fds->size(); ++fd) {
+        if ((*fds)[fd] != -1) {
+            (*fds)[fd] = ::dup((*fds)[fd]);
+        }
+    }
+
+    State state{};
+    state.fds = std::move(fds);
+    state.out_buffers = m_out_buffers;
+
+    state.mapper = m_mapper;
+    state.brk_start = m_brk_start;
+    state.brk = m_brk;
+    state.mmap_bottom = m_mmap_bottom;
+    state.mmap_regions = m_mmap_regions;
+
+    return state;
+}
+
+void Emulator::restore(const State &state) {
+    // Default state has standard streams only, as reset emulator
+    if (state.fds != nullptr) {
+        m_fds = *state.fds;
+    }
+
+    for (size_t fd = BUFFERED_FD_NUMBER; fd < m_fds.size(); ++fd) {
+        if (m_fds[fd] != -1) {
+            m_fds[fd] = ::dup(m_fds[fd]);
+        }
+    }
+
+    m_out_buffers = state.out_buffers;
+
+    m_mapper = state.mapper;
+    m_brk_start = state.brk_start;
+    m_brk = state.brk;
+    m_mmap_bottom = state.mmap_bottom;
+    m_mmap_regions = state.mmap_regions;
+}
+
+NODISCARD SimStatus Emulator::handle(hart::Hart &hart) noexcept {
+    auto &gpr = hart.gprFile();
+
+    auto arg = [&](size_t i) {
+        return gpr.read<uint64_t>(gpr::GPR_IDX::A0 + i);
+    };
+    auto sarg = [&](size_t i) {
+        return gpr.read<int64_t>(gpr::GPR_IDX::A0 + i);
+    };
+
+    int64_t res = -ENOSYS;
+
+    switch (gpr.read<uint64_t>(gpr::GPR_IDX::A7)) {
+    case SYSCALL_NO::EXIT:
+    case SYSCALL_NO::EXIT_GROUP:
+        m_exit_code = static_cast<int>(sarg(0));
+        flush();
+        return SimStatus::SIM__EXIT;
+
+    case SYSCALL_NO::OPENAT:
+        res = sysOpenat(hart, sarg(0), arg(1), sarg(2), sarg(3));
+        break;
+    case SYSCALL_NO::CLOSE:
+        res = sysClose(arg(0));
+        break;
+    case SYSCALL_NO::READ:
+        res = sysRead(hart, arg(0), arg(1), arg(2));
+        break;
+    case SYSCALL_NO::WRITE:
+        res = sysWrite(hart, arg(0), arg(1), arg(2));
+        break;
+    case SYSCALL_NO::FSTAT:
+        res = sysFstat(hart, arg(0), arg(1));
+        break;
+    case SYSCALL_NO::CLOCK_GETTIME:
+        res = sysClockGettime(hart, sarg(0), arg(1));
+        break;
+    case SYSCALL_NO::BRK:
+        res = sysBrk(arg(0));
+        break;
+    case SYSCALL_NO::MMAP:
+        res = sysMmap(arg(0), arg(1), sarg(2), sarg(3), sarg(4));
+        break;
+    case SYSCALL_NO::MUNMAP:
+        res = sysMunmap(arg(0), arg(1));
+        break;
+
+    default:
+        break;
+    }
+
+    gpr.write(gpr::GPR_IDX::A0, res);
+    return SimStatus::OK;
+}
+
+NODISCARD bool Emulator::mapLazy(memory::PhysMemory &pm,
+                                 VirtAddr va) noexcept {
+    if (!m_mapper) {
+        return false;
+    }
+
+    bool in_brk = va >= m_brk_start && va < pageAlignUp(m_brk);
+
+    bool in_mmap = false;
+    if (auto it = m_mmap_regions.upper_bound(va);
+        it != m_mmap_regions.begin()) {
+        in_mmap = va < std::prev(it)->second;
+    }
+
+    if (!in_brk && !in_mmap) {
+        return false;
+    }
+
+    auto status = m_mapper(pm, va / memory::PAGE_SIZE);
+    return status == SimStatus::OK ||
+           status == SimStatus::MAPPER__ALREADY_MAPPED;
+}
+
+void Emulator::flush() noexcept {
+    for (size_t fd = 0; fd != BUFFERED_FD_NUMBER; ++fd) {
+        flushFd(fd);
+    }
+}
+
+void Emulator::flushFd(size_t guest_fd) noexcept {
+    auto &buffer = m_out_buffers[guest_fd];
+
+    for (size_t done = 0; !m_drop_output && done < buffer.size();) {
+        auto written = ::write(guest_fd, buffer.data() + done,
+                               buffer.size() - done);
+        if (written <= 0) {
+            break;
+        }
+        done += written;
+    }
+
+    buffer.clear();
+}
+
+NODISCARD int Emulator::hostFd(uint64_t guest_fd) const noexcept {
+    return guest_fd < m_fds.size() ? m_fds[guest_fd] : -1;
+}
+
+NODISCARD bool Emulator::translate(hart::Hart &hart, VirtAddr va,
+                                   AccessType access_type,
+                                   PhysAddr &pa) noexcept {
+    auto &mmu = hart.mmu64();
+
+    auto res = mmu.translate(PrivLevel::USER, access_type, va);
+    if (res.status == SimStatus::MMU64__PAGE_FAULT &&
+        mapLazy(hart.physMemory(), va)) {
+        res = mmu.translate(PrivLevel::USER, access_type, va);
+    }
+
+    pa = res.phys_addr;
+    return res.status == SimStatus::OK;
+}
+
+NODISCARD bool Emulator::copyToGuest(hart::Hart &hart, VirtAddr dst,
+                                     const void *src, size_t size) noexcept {
+    const auto *src_bytes = static_cast<const uint8_t *>(src);
+
+    for (size_t chunk = 0; size != 0; size -= chunk) {
+        chunk = pageChunk(dst, size);
+
+        PhysAddr pa = 0;
+        if (!translate(hart, dst, AccessType::WRITE, pa)) {
+            return false;
+        }
+
+        auto *page =
+            hart.physMemory().getHostPagePtr(pa & ~memory::PAGE_OFFSET_MASK);
+        if (page == nullptr) {
+            return false;
+        }
+
+        std::memcpy(page + (pa & memory::PAGE_OFFSET_MASK), src_bytes, chunk);
+
+        src_bytes += chunk;
+        dst += chunk;
+    }
+
+    return true;
+}
+
+NODISCARD bool Emulator::readString(hart::Hart &hart, VirtAddr va,
+                                    std::string &dst) noexcept {
+    dst.clear();
+
+    while (dst.size() < GUEST_PATH_MAX) {
+        auto chunk = pageChunk(va, GUEST_PATH_MAX - dst.size());
+
+        PhysAddr pa = 0;
+        if (!translate(hart, va, AccessType::READ, pa)) {
+            return false;
+        }
+
+        auto *page = hart.physMemory().getConstHostPagePtr(
+            pa & ~memory::PAGE_OFFSET_MASK);
+        if (page == nullptr) {
+            return false;
+        }
+
+        const auto *begin = reinterpret_cast<const char *>(page) +
+                            (pa & memory::PAGE_OFFSET_MASK);
+        const auto *end = std::find(begin, begin + chunk, '\0');
+
+        dst.append(begin, end);
+        if (end != begin + chunk) {
+            return true;
+        }
+
+        va += chunk;
+    }
+
+    return false;
+}
+
+int64_t Emulator::sysOpenat(hart::Hart &hart, int64_t dir_fd,
+                            VirtAddr path_va, int64_t flags,
+                            int64_t mode) noexcept {
+    std::string path{};
+    if (!readString(hart, path_va, path)) {
+        return -EFAULT;
+    }
+
+    int host_dir_fd = dir_fd == GUEST_AT_FDCWD ? AT_FDCWD : hostFd(dir_fd);
+    if (host_dir_fd == -1) {
+        return -EBADF;
+    }
+
+    // Open flags have the same values on Linux hosts
+    int host_fd = ::openat(host_dir_fd, path.c_str(), static_cast<int>(flags),
+                           static_cast<mode_t>(mode));
+    if (host_fd == -1) {
+        return -errno;
+    }
+
+    auto free_it =
+        std::find(m_fds.begin() + BUFFERED_FD_NUMBER, m_fds.end(), -1);
+    if (free_it != m_fds.end()) {
+        *free_it = host_fd;
+        return free_it - m_fds.begin();
+    }
+
+    m_fds.push_back(host_fd);
+    return m_fds.size() - 1;
+}
+
+int64_t Emulator::sysClose(uint64_t fd) noexcept {
+    if (hostFd(fd) == -1) {
+        return -EBADF;
+    }
+
+    // Host standard streams stay open
+    if (fd < BUFFERED_FD_NUMBER) {
+        flushFd(fd);
+    } else if (::close(m_fds[fd]) == -1) {
+        m_fds[fd] = -1;
+        return -errno;
+    }
+
+    m_fds[fd] = -1;
+    return 0;
+}
+
+int64_t Emulator::sysRead(hart::Hart &hart, uint64_t fd, VirtAddr buf,
+                          size_t count) noexcept {
+    int host_fd = hostFd(fd);
+    if (host_fd == -1) {
+        return -EBADF;
+    }
+
+    // Prompt is shown before waiting for input
+    if (fd == STDIN_FILENO) {
+        flush();
+    }
+
+    size_t done = 0;
+    for (size_t chunk = 0; done != count; done += chunk) {
+        chunk = pageChunk(buf + done, count - done);
+
+        PhysAddr pa = 0;
+        if (!translate(hart, buf + done, AccessType::WRITE, pa)) {
+            return done != 0 ? done : -EFAULT;
+        }
+
+        auto *page =
+            hart.physMemory().getHostPagePtr(pa & ~memory::PAGE_OFFSET_MASK);
+        if (page == nullptr) {
+            return done != 0 ? done : -EFAULT;
+        }
+
+        auto read_num =
+            ::read(host_fd, page + (pa & memory::PAGE_OFFSET_MASK), chunk);
+        if (read_num == -1) {
+            return done != 0 ? done : -errno;
+        }
+
+        if (static_cast<size_t>(read_num) != chunk) {
+            return done + read_num;
+        }
+    }
+
+    return done;
+}
+
+int64_t Emulator::sysWrite(hart::Hart &hart, uint64_t fd, VirtAddr buf,
+                           size_t count) noexcept {
+    int host_fd = hostFd(fd);
+    if (host_fd == -1) {
+        return -EBADF;
+    }
+
+    bool buffered = fd < BUFFERED_FD_NUMBER && host_fd == static_cast<int>(fd);
+
+    size_t done = 0;
+    for (size_t chunk = 0; done != count; done += chunk) {
+        chunk = pageChunk(buf + done, count - done);
+
+        PhysAddr pa = 0;
+        if (!translate(hart, buf + done, AccessType::READ, pa)) {
+            return done != 0 ? done : -EFAULT;
+        }
+
+        auto *page = hart.physMemory().getConstHostPagePtr(
+            pa & ~memory::PAGE_OFFSET_MASK);
+        if (page == nullptr) {
+            return done != 0 ? done : -EFAULT;
+        }
+
+        const auto *data = reinterpret_cast<const char *>(page) +
+                           (pa & memory::PAGE_OFFSET_MASK);
+
+        if (m_drop_output) {
+            continue;
+        }
+
+        if (!buffered) {
+            auto written = ::write(host_fd, data, chunk);
+            if (written == -1) {
+                return done != 0 ? done : -errno;
+            }
+
+            if (static_cast<size_t>(written) != chunk) {
+                return done + written;
+            }
+            continue;
+        }
+
+        auto &buffer = m_out_buffers[fd];
+        buffer.append(data, chunk);
+
+        if (buffer.size() >= OUT_BUFFER_SIZE ||
+            (m_flush_policy == FlushPolicy::LINE &&
+             std::memchr(data, '\n', chunk) != nullptr)) {
+            flushFd(fd);
+        }
+    }
+
+    return done;
+}
+
+int64_t Emulator::sysFstat(hart::Hart &hart, uint64_t fd,
+                           VirtAddr buf) noexcept {
+    int host_fd = hostFd(fd);
+    if (host_fd == -1) {
+        return -EBADF;
+    }
+
+    struct stat host_stat {};
+    if (::fstat(host_fd, &host_stat) == -1) {
+        return -errno;
+    }
+
+    GuestStat guest_stat{};
+    guest_stat.st_dev = host_stat.st_dev;
+    guest_stat.st_ino = host_stat.st_ino;
+    guest_stat.st_mode = host_stat.st_mode;
+    guest_stat.st_nlink = host_stat.st_nlink;
+    guest_stat.st_uid = host_stat.st_uid;
+    guest_stat.st_gid = host_stat.st_gid;
+    guest_stat.st_rdev = host_stat.st_rdev;
+    guest_stat.st_size = host_stat.st_size;
+    guest_stat.st_blksize = host_stat.st_blksize;
+    guest_stat.st_blocks = host_stat.st_blocks;
+    guest_stat.st_atime_sec = host_stat.st_atim.tv_sec;
+    guest_stat.st_atime_nsec = host_stat.st_atim.tv_nsec;
+    guest_stat.st_mtime_sec = host_stat.st_mtim.tv_sec;
+    guest_stat.st_mtime_nsec = host_stat.st_mtim.tv_nsec;
+    guest_stat.st_ctime_sec = host_stat.st_ctim.tv_sec;
+    guest_stat.st_ctime_nsec = host_stat.st_ctim.tv_nsec;
+
+    if (!copyToGuest(hart, buf, &guest_stat, sizeof(guest_stat))) {
+        return -EFAULT;
+    }
+
+    return 0;
+}
+
+int64_t Emulator::sysClockGettime(hart::Hart &hart, int64_t clock_id,
+                                  VirtAddr buf) noexcept {
+    // Clock ids have the same values on Linux hosts
+    timespec host_ts{};
+    if (::clock_gettime(static_cast<clockid_t>(clock_id), &host_ts) == -1) {
+        return -errno;
+    }
+
+    GuestTimespec guest_ts{host_ts.tv_sec, host_ts.tv_nsec};
+    if (!copyToGuest(hart, buf, &guest_ts, sizeof(guest_ts))) {
+        return -EFAULT;
+    }
+
+    return 0;
+}
+
+int64_t Emulator::sysBrk(VirtAddr brk) noexcept {
+    // Failed brk returns current program break
+    if (m_mapper && brk >= m_brk_start && brk <= m_mmap_bottom) {
+        m_brk = brk;
+    }
+
+    return m_brk;
+}
+
+int64_t Emulator::sysMmap([[maybe_unused]] VirtAddr addr, size_t length,
+                          [[maybe_unused]] int64_t prot, int64_t flags,
+                          [[maybe_unused]] int64_t fd) noexcept {
+    // Address hint is ignored, so fixed mappings are not supported
+    if (length == 0 || (flags & GUEST_MAP_FIXED)) {
+        return -EINVAL;
+    }
+
+    // Only private anonymous mappings are supported
+    if ((flags & GUEST_MAP_ANONYMOUS) == 0 ||
+        (flags & GUEST_MAP_PRIVATE) == 0) {
+        return -ENODEV;
+    }
+
+    length = pageAlignUp(length);
+    if (!m_mapper || length > m_mmap_bottom ||
+        m_mmap_bottom - length < pageAlignUp(m_brk)) {
+        return -ENOMEM;
+    }
+
+    // Address space is not reused, so new mapping pages are always fresh
+    m_mmap_bottom -= length;
+    m_mmap_regions.emplace(m_mmap_bottom, m_mmap_bottom + length);
+
+    return m_mmap_bottom;
+}
+
+int64_t Emulator::sysMunmap(VirtAddr addr, size_t length) noexcept {
+    if ((addr & memory::PAGE_OFFSET_MASK) || length == 0) {
+        return -EINVAL;
+    }
+
+    auto end = addr + pageAlignUp(length);
+
+    // Cut [addr, end) out of regions. Pages mapped already are kept in page
+    // tables, since mapper can't remove mappings
+    auto it = m_mmap_regions.upper_bound(addr);
+    if (it != m_mmap_regions.begin()) {
+        --it;
+    }
+
+    while (it != m_mmap_regions.end() && it->first < end) {
+        auto [region_begin, region_end] = *it;
+        it = m_mmap_regions.erase(it);
+
+        if (region_begin < addr) {
+            m_mmap_regions.emplace(region_begin, std::min(region_end, addr));
+        }
+        if (region_end > end) {
+            m_mmap_regions.emplace(end, region_end);
+        }
+    }
+
+    return 0;
+}
+
+} // namespace sim::syscall
@@ -0,0 +1,232 @@
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <sim/common.hpp>
+#include <sim/hart.hpp>
+#include <sim/syscall.hpp>
+
+namespace sim::syscall {
+
+class SyscallTest : public ::testing::Test {
+  protected:
+    // Translation is disabled, so guest va is pa
+    static constexpr VirtAddr DATA_VA = 0x1000;
+    static constexpr VirtAddr BRK_START = 0x100000;
+
+    memory::PhysMemory phys_memory{};
+    hart::Hart hart{phys_memory};
+
+    Emulator emulator{};
+
+    void SetUp() override {
+        ASSERT_TRUE(phys_memory.addRAMPage(DATA_VA));
+    }
+
+    void writeData(VirtAddr va, const std::string &data) {
+        auto *page = phys_memory.getHostPagePtr(va & ~memory::PAGE_OFFSET_MASK);
+        std::memcpy(page + (va & memory::PAGE_OFFSET_MASK), data.c_str(),
+                    data.size() + 1);
+    }
+
+    std::string readData(VirtAddr va, size_t size) {
+        const auto *page =
+            phys_memory.getConstHostPagePtr(va & ~memory::PAGE_OFFSET_MASK);
+        return {reinterpret_cast<const char *>(page) +
+                    (va & memory::PAGE_OFFSET_MASK),
+                size};
+    }
+
+    int64_t call(uint64_t no, std::initializer_list<uint64_t> args) {
+        auto &gpr = hart.gprFile();
+
+        gpr.write(gpr::GPR_IDX::A7, no);
+        size_t i = 0;
+        for (auto arg : args) {
+            gpr.write(gpr::GPR_IDX::A0 + i++, arg);
+        }
+
+        EXPECT_EQ(emulator.handle(hart), SimStatus::OK);
+        return gpr.read<int64_t>(gpr::GPR_IDX::A0);
+    }
+};
+
+TEST_F(SyscallTest, files) {
+    char path[] = "/tmp/sim_syscall_XXXXXX";
+    int tmp_fd = mkstemp(path);
+    ASSERT_NE(tmp_fd, -1);
+    close(tmp_fd);
+
+    static constexpr VirtAddr PATH_VA = DATA_VA;
+    static constexpr VirtAddr BUF_VA = DATA_VA + 0x100;
+    static constexpr VirtAddr STAT_VA = DATA_VA + 0x200;
+
+    const std::string DATA = "hello, guest";
+    writeData(PATH_VA, path);
+    writeData(BUF_VA, DATA);
+
+    static constexpr uint64_t AT_FDCWD_GUEST = -100;
+
+    auto fd = call(SYSCALL_NO::OPENAT, {AT_FDCWD_GUEST, PATH_VA, O_WRONLY});
+    ASSERT_EQ(fd, 3);
+    ASSERT_EQ(call(SYSCALL_NO::WRITE, {3, BUF_VA, DATA.size()}), DATA.size());
+    ASSERT_EQ(call(SYSCALL_NO::CLOSE, {3}), 0);
+    ASSERT_EQ(call(SYSCALL_NO::CLOSE, {3}), -EBADF);
+
+    writeData(BUF_VA, std::string(DATA.size(), ' '));
+
+    fd = call(SYSCALL_NO::OPENAT, {AT_FDCWD_GUEST, PATH_VA, O_RDONLY});
+    ASSERT_EQ(fd, 3);
+    ASSERT_EQ(call(SYSCALL_NO::READ, {3, BUF_VA, 100}), DATA.size());
+    ASSERT_EQ(readData(BUF_VA, DATA.size()), DATA);
+
+    ASSERT_EQ(call(SYSCALL_NO::FSTAT, {3, STAT_VA}), 0);
+    // st_size is at offset 48 of riscv64 struct stat
+    int64_t size = 0;
+    std::memcpy(&size, readData(STAT_VA + 48, sizeof(size)).data(),
+                sizeof(size));
+    ASSERT_EQ(size, DATA.size());
+
+    ASSERT_EQ(call(SYSCALL_NO::READ, {4, BUF_VA, 1}), -EBADF);
+    ASSERT_EQ(call(SYSCALL_NO::READ, {3, 0x10000000, 1}), -EFAULT);
+
+    unlink(path);
+}
+
+TEST_F(SyscallTest, bufferedStdout) {
+    int pipe_fds[2] = {};
+    ASSERT_EQ(pipe2(pipe_fds, O_NONBLOCK), 0);
+
+    int saved_stdout = dup(STDOUT_FILENO);
+    ASSERT_NE(dup2(pipe_fds[1], STDOUT_FILENO), -1);
+
+    writeData(DATA_VA, "line\n");
+    char buf[16] = {};
+
+    // Output is kept until flush
+    ASSERT_EQ(call(SYSCALL_NO::WRITE, {1, DATA_VA, 5}), 5);
+    ASSERT_EQ(read(pipe_fds[0], buf, sizeof(buf)), -1);
+    emulator.flush();
+    ASSERT_EQ(read(pipe_fds[0], buf, sizeof(buf)), 5);
+
+    // Line policy flushes on newline
+    emulator.setFlushPolicy(FlushPolicy::LINE);
+    ASSERT_EQ(call(SYSCALL_NO::WRITE, {1, DATA_VA, 5}), 5);
+    ASSERT_EQ(read(pipe_fds[0], buf, sizeof(buf)), 5);
+
+    // Exit flushes output
+    emulator.setFlushPolicy(FlushPolicy::FULL);
+    ASSERT_EQ(call(SYSCALL_NO::WRITE, {1, DATA_VA, 4}), 4);
+
+    hart.gprFile().write(gpr::GPR_IDX::A7, SYSCALL_NO::EXIT_GROUP);
+    hart.gprFile().write(gpr::GPR_IDX::A0, 3);
+    ASSERT_EQ(emulator.handle(hart), SimStatus::SIM__EXIT);
+    ASSERT_EQ(emulator.exitCode(), 3);
+    ASSERT_EQ(read(pipe_fds[0], buf, sizeof(buf)), 4);
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_F(SyscallTest, stateRestore) {
+    char path[] = "/tmp/sim_syscall_XXXXXX";
+    int tmp_fd = mkstemp(path);
+    ASSERT_NE(tmp_fd, -1);
+    ASSERT_EQ(write(tmp_fd, "data", 4), 4);
+    close(tmp_fd);
+
+    static constexpr VirtAddr PATH_VA = DATA_VA;
+    static constexpr VirtAddr BUF_VA = DATA_VA + 0x100;
+    writeData(PATH_VA, path);
+
+    static constexpr uint64_t AT_FDCWD_GUEST = -100;
+
+    emulator.setMemory(BRK_START, [](memory::PhysMemory &, memory::VPN) {
+        return SimStatus::OK;
+    });
+    ASSERT_EQ(call(SYSCALL_NO::OPENAT, {AT_FDCWD_GUEST, PATH_VA, O_RDONLY}),
+              3);
+    ASSERT_EQ(call(SYSCALL_NO::BRK, {BRK_START + 0x1000}), BRK_START + 0x1000);
+
+    // State keeps guest file open after process is reset
+    auto state = emulator.state();
+    emulator.reset();
+    unlink(path);
+
+    emulator.restore(state);
+    ASSERT_EQ(emulator.brk(), BRK_START + 0x1000);
+    ASSERT_EQ(call(SYSCALL_NO::READ, {3, BUF_VA, 4}), 4);
+    ASSERT_EQ(readData(BUF_VA, 4), "data");
+
+    int pipe_fds[2] = {};
+    ASSERT_EQ(pipe2(pipe_fds, O_NONBLOCK), 0);
+
+    int saved_stdout = dup(STDOUT_FILENO);
+    ASSERT_NE(dup2(pipe_fds[1], STDOUT_FILENO), -1);
+
+    // Dropped output is reported as written
+    emulator.setDropOutput(true);
+    ASSERT_EQ(call(SYSCALL_NO::WRITE, {1, BUF_VA, 4}), 4);
+    emulator.flush();
+
+    char buf[16] = {};
+    ASSERT_EQ(read(pipe_fds[0], buf, sizeof(buf)), -1);
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_F(SyscallTest, memory) {
+    size_t mapped = 0;
+    emulator.setMemory(BRK_START, [&](memory::PhysMemory &pm,
+                                      memory::VPN vpn) {
+        ++mapped;
+        return pm.addRAMPage(vpn * memory::PAGE_SIZE)
+                   ? SimStatus::OK
+                   : SimStatus::MAPPER__ALREADY_MAPPED;
+    });
+
+    // Heap pages are mapped on first access only
+    ASSERT_EQ(call(SYSCALL_NO::BRK, {0}), BRK_START);
+    ASSERT_EQ(call(SYSCALL_NO::BRK, {BRK_START + 0x1800}), BRK_START + 0x1800);
+    ASSERT_EQ(call(SYSCALL_NO::BRK, {BRK_START - 1}), BRK_START + 0x1800);
+    ASSERT_EQ(mapped, 0);
+
+    ASSERT_TRUE(emulator.mapLazy(phys_memory, BRK_START + 0x1fff));
+    ASSERT_FALSE(emulator.mapLazy(phys_memory, BRK_START + 0x2000));
+    ASSERT_EQ(mapped, 1);
+
+    static constexpr uint64_t PROT_RW = 0x3;
+    static constexpr uint64_t MAP_PRIVATE_ANON = 0x22;
+
+    auto region = call(SYSCALL_NO::MMAP, {0, 0x3000, PROT_RW,
+                                          MAP_PRIVATE_ANON, uint64_t(-1), 0});
+    ASSERT_GT(region, 0);
+    ASSERT_EQ(region & memory::PAGE_OFFSET_MASK, 0);
+    ASSERT_TRUE(emulator.mapLazy(phys_memory, region + 0x2000));
+
+    // File mappings are not supported
+    ASSERT_EQ(call(SYSCALL_NO::MMAP, {0, 0x1000, PROT_RW, 0x2, 3, 0}),
+              -ENODEV);
+
+    ASSERT_EQ(call(SYSCALL_NO::MUNMAP, {uint64_t(region) + 0x1000, 0x1000}),
+              0);
+    ASSERT_FALSE(emulator.mapLazy(phys_memory, region + 0x1000));
+    ASSERT_TRUE(emulator.mapLazy(phys_memory, region));
+    ASSERT_EQ(mapped, 3);
+
+    // Unknown syscall
+    ASSERT_EQ(call(1000, {}), -ENOSYS);
+}
+
+} // namespace sim::syscall
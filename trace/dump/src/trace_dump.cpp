@@ -0,0 +1,91 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include <sim/instr.hpp>
+#include <sim/trace.hpp>
+#include <sim/trace/mem_trace.hpp>
+
+using namespace sim;
+
+namespace {
+
+constexpr int REG_ID_FILL = 2;
+
+void dump_record(const trace::Record &record) {
+    using Record = trace::Record;
+
+    std::cout << record.pc << ": "
+              << instr::instrName(instr::InstrId(record.instr_id)) << '\n';
+
+    if (record.flags & Record::REG_WRITE) {
+        const char *kind = "Reg";
+        if (record.flags & Record::FPR_WRITE) {
+            kind = "FReg";
+        } else if (record.flags & Record::VR_WRITE) {
+            kind = "VReg";
+        }
+
+        std::cout << '\t' << kind << " [" << std::setw(REG_ID_FILL)
+                  << unsigned{record.reg_idx} << "] <= " << record.reg_value
+                  << '\n';
+    }
+
+    if (record.flags & Record::MEM_WRITE) {
+        std::cout << "\tMem [" << record.mem_addr
+                  << "] <= " << record.mem_value << '\n';
+    }
+}
+
+void dump_mem_record(const trace::MemRecord &record) {
+    constexpr const char *TYPE_NAMES[] = {"F", "R", "W", "A"};
+
+    std::cout << record.pc << ": " << TYPE_NAMES[record.type] << ' '
+              << record.va << " -> " << record.pa << " ("
+              << unsigned{record.size} << ")\n";
+}
+
+int dump_mem_trace(const char *path) {
+    trace::MemReader reader{path};
+    if (!reader.isOpen()) {
+        std::cerr << "Failed to open memory trace " << path << std::endl;
+        return -1;
+    }
+
+    std::cout << std::hex;
+
+    trace::MemRecord record{};
+    while (reader.next(record)) {
+        dump_mem_record(record);
+    }
+
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc == 3 && std::strcmp(argv[1], "--mem") == 0) {
+        return dump_mem_trace(argv[2]);
+    }
+
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--mem] <trace>" << std::endl;
+        return -1;
+    }
+
+    trace::Reader reader{argv[1]};
+    if (!reader.isOpen()) {
+        std::cerr << "Failed to open trace " << argv[1] << std::endl;
+        return -1;
+    }
+
+    std::cout << std::hex << std::setfill('0');
+
+    trace::Record record{};
+    while (reader.next(record)) {
+        dump_record(record);
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef INCL_SIM_TRACE_HPP
+#define INCL_SIM_TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/trace/spsc_ring.hpp>
+
+namespace sim::trace {
+
+// Executed instr record
+struct Record final {
+    enum Flags : uint8_t {
+        GPR_WRITE = 1 << 0,
+        FPR_WRITE = 1 << 1,
+        // Only low 64 bits of vector register are recorded
+        VR_WRITE = 1 << 2,
+        MEM_WRITE = 1 << 3,
+
+        REG_WRITE = GPR_WRITE | FPR_WRITE | VR_WRITE,
+    };
+
+    VirtAddr pc = 0;
+    RegValue reg_value = 0;
+    VirtAddr mem_addr = 0;
+    RegValue mem_value = 0;
+    uint16_t instr_id = 0;
+    uint8_t reg_idx = 0;
+    uint8_t flags = 0;
+};
+
+// Trace file starts with magic. Records are encoded with varints, pc and
+// memory addrs as deltas from previous record
+inline constexpr char FILE_MAGIC[] = "SIMTRC01";
+inline constexpr size_t FILE_MAGIC_SIZE = sizeof(FILE_MAGIC) - 1;
+
+// Binary trace writer. Execution thread pushes records to lock-free ring,
+// background thread drains it and writes encoded records to file.
+// One writer serves one simulator
+class Writer final {
+    static constexpr size_t DEFAULT_RING_CAPACITY = 1 << 16;
+    static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+    SPSCRing<Record> m_ring;
+
+    std::FILE *m_file = nullptr;
+
+    std::atomic<bool> m_stop = false;
+    std::thread m_drain_thread{};
+
+    // Encoder state. Used by drain thread only
+    VirtAddr m_prev_pc = 0;
+    VirtAddr m_prev_mem_addr = 0;
+    std::vector<uint8_t> m_out{};
+    size_t m_out_size = 0;
+    size_t m_record_number = 0;
+
+    void drain() noexcept;
+    void encode(const Record &record) noexcept;
+    void writeOut() noexcept;
+
+  public:
+    explicit Writer(const std::string &path,
+                    size_t ring_capacity = DEFAULT_RING_CAPACITY);
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    ~Writer() { close(); }
+
+    NODISCARD bool isOpen() const noexcept { return m_file != nullptr; }
+
+    // Push record. Waits for drain thread if ring is full
+    void push(const Record &record) noexcept {
+        while (!m_ring.push(record)) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Write remaining records and close file
+    void close() noexcept;
+
+    // Written records number. Valid after close
+    NODISCARD auto recordNumber() const noexcept { return m_record_number; }
+};
+
+// Sequential trace file decoder
+class Reader final {
+    static constexpr size_t READ_SIZE = 1 << 20;
+
+    std::FILE *m_file = nullptr;
+
+    std::vector<uint8_t> m_buf{};
+    size_t m_pos = 0;
+
+    VirtAddr m_prev_pc = 0;
+    VirtAddr m_prev_mem_addr = 0;
+
+    // Make sure encoded record fits in buffer unless file ends
+    void refill();
+
+  public:
+    // Open trace file. Check isOpen for magic mismatch or open failure
+    explicit Reader(const std::string &path);
+
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    ~Reader();
+
+    NODISCARD bool isOpen() const noexcept { return m_file != nullptr; }
+
+    // Decode next record. Returns false at the end of trace
+    NODISCARD bool next(Record &record);
+};
+
+} // namespace sim::trace
+
+#endif // INCL_SIM_TRACE_HPP
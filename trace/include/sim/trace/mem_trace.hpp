@@ -0,0 +1,144 @@
+#ifndef INCL_SIM_TRACE_MEM_TRACE_HPP
+#define INCL_SIM_TRACE_MEM_TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sim/common.hpp>
+#include <sim/trace/spsc_ring.hpp>
+
+namespace sim::trace {
+
+// Memory access record
+struct MemRecord final {
+    enum Type : uint8_t { FETCH, READ, WRITE, AMO };
+
+    VirtAddr pc = 0;
+    VirtAddr va = 0;
+    PhysAddr pa = 0;
+    // Access size in bytes. Power of 2 up to 8
+    uint8_t size = 0;
+    uint8_t type = FETCH;
+};
+
+// Memory trace file starts with magic. Records are encoded with varints:
+// pc as delta from previous record, data va as delta from previous data
+// access and pa as delta of pa - va from previous record
+inline constexpr char MEM_FILE_MAGIC[] = "SIMMEM01";
+inline constexpr size_t MEM_FILE_MAGIC_SIZE = sizeof(MEM_FILE_MAGIC) - 1;
+
+// Memory access trace writer. Execution thread fills chunks of raw records,
+// background thread encodes full chunks and writes them to file, so push
+// is a plain store until chunk is full. One writer serves one simulator
+class MemWriter final {
+    static constexpr size_t CHUNK_SIZE = 1 << 14;
+    static constexpr size_t CHUNK_NUMBER = 16;
+    static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+    struct Chunk final {
+        uint32_t idx = 0;
+        uint32_t size = 0;
+    };
+
+    std::unique_ptr<MemRecord[]> m_records{
+        new MemRecord[CHUNK_NUMBER * CHUNK_SIZE]};
+
+    // Full chunks go to drain thread and come back empty
+    SPSCRing<Chunk> m_full_chunks{CHUNK_NUMBER};
+    SPSCRing<uint32_t> m_free_chunks{CHUNK_NUMBER};
+
+    // Producer state
+    std::vector<uint32_t> m_own_chunks{};
+    uint32_t m_curr_chunk = 0;
+    MemRecord *m_curr = nullptr;
+    MemRecord *m_curr_end = nullptr;
+
+    std::FILE *m_file = nullptr;
+
+    std::atomic<bool> m_stop = false;
+    std::thread m_drain_thread{};
+
+    // Encoder state. Used by drain thread only
+    VirtAddr m_prev_pc = 0;
+    VirtAddr m_prev_va = 0;
+    PhysAddr m_prev_pa_offset = 0;
+    std::vector<uint8_t> m_out{};
+    size_t m_out_size = 0;
+    size_t m_record_number = 0;
+    size_t m_byte_number = 0;
+
+    // Pass current chunk to drain thread and take next empty one
+    void submit() noexcept;
+
+    void drain() noexcept;
+    void encode(const MemRecord &record) noexcept;
+    void writeOut() noexcept;
+
+  public:
+    explicit MemWriter(const std::string &path);
+
+    MemWriter(const MemWriter &) = delete;
+    MemWriter &operator=(const MemWriter &) = delete;
+
+    ~MemWriter() { close(); }
+
+    NODISCARD bool isOpen() const noexcept { return m_file != nullptr; }
+
+    // Push record. Waits for drain thread if all chunks are full
+    void push(const MemRecord &record) noexcept {
+        *m_curr++ = record;
+
+        if (m_curr == m_curr_end) {
+            submit();
+        }
+    }
+
+    // Write remaining records and close file
+    void close() noexcept;
+
+    // Written records number. Valid after close
+    NODISCARD auto recordNumber() const noexcept { return m_record_number; }
+
+    // Written bytes number. Valid after close
+    NODISCARD auto byteNumber() const noexcept { return m_byte_number; }
+};
+
+// Sequential memory trace file decoder
+class MemReader final {
+    static constexpr size_t READ_SIZE = 1 << 20;
+
+    std::FILE *m_file = nullptr;
+
+    std::vector<uint8_t> m_buf{};
+    size_t m_pos = 0;
+
+    VirtAddr m_prev_pc = 0;
+    VirtAddr m_prev_va = 0;
+    PhysAddr m_prev_pa_offset = 0;
+
+    // Make sure encoded record fits in buffer unless file ends
+    void refill();
+
+  public:
+    // Open trace file. Check isOpen for magic mismatch or open failure
+    explicit MemReader(const std::string &path);
+
+    MemReader(const MemReader &) = delete;
+    MemReader &operator=(const MemReader &) = delete;
+
+    ~MemReader();
+
+    NODISCARD bool isOpen() const noexcept { return m_file != nullptr; }
+
+    // Decode next record. Returns false at the end of trace
+    NODISCARD bool next(MemRecord &record);
+};
+
+} // namespace sim::trace
+
+#endif // INCL_SIM_TRACE_MEM_TRACE_HPP
@@ -0,0 +1,67 @@
+#ifndef INCL_SIM_TRACE_SPSC_RING_HPP
+#define INCL_SIM_TRACE_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <sim/common.hpp>
+
+namespace sim::trace {
+
+// Bounded lock-free single-producer single-consumer ring.
+// Producer and consumer own their position counters and only read the other
+// one, so push and pop are a plain store plus a release publish
+template <class T> class SPSCRing final {
+    size_t m_mask = 0;
+    std::unique_ptr<T[]> m_cells = nullptr;
+
+    alignas(64) std::atomic<size_t> m_push_pos = 0;
+    // Consumer position seen by producer. Reloaded when ring looks full
+    size_t m_cached_pop_pos = 0;
+
+    alignas(64) std::atomic<size_t> m_pop_pos = 0;
+
+  public:
+    // Capacity must be power of 2
+    explicit SPSCRing(size_t capacity)
+        : m_mask(capacity - 1), m_cells(new T[capacity]) {
+        SIM_ASSERT(capacity != 0 && (capacity & m_mask) == 0);
+    }
+
+    NODISCARD size_t capacity() const noexcept { return m_mask + 1; }
+
+    // Returns false if ring is full. Producer only
+    NODISCARD bool push(const T &value) noexcept {
+        auto pos = m_push_pos.load(std::memory_order_relaxed);
+
+        if (pos - m_cached_pop_pos > m_mask) {
+            m_cached_pop_pos = m_pop_pos.load(std::memory_order_acquire);
+            if (pos - m_cached_pop_pos > m_mask) {
+                return false;
+            }
+        }
+
+        m_cells[pos & m_mask] = value;
+        m_push_pos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pass all available values to consume in push order. Returns number of
+    // consumed values. Consumer only
+    template <class Consume> size_t popAll(Consume consume) {
+        auto pos = m_pop_pos.load(std::memory_order_relaxed);
+        auto end = m_push_pos.load(std::memory_order_acquire);
+
+        for (auto curr = pos; curr != end; ++curr) {
+            consume(m_cells[curr & m_mask]);
+        }
+
+        m_pop_pos.store(end, std::memory_order_release);
+        return end - pos;
+    }
+};
+
+} // namespace sim::trace
+
+#endif // INCL_SIM_TRACE_SPSC_RING_HPP
@@ -0,0 +1,60 @@
+#ifndef INCL_SIM_TRACE_VARINT_HPP
+#define INCL_SIM_TRACE_VARINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sim/common.hpp>
+
+namespace sim::trace {
+
+// Max encoded uint64_t size
+inline constexpr size_t MAX_VARINT_SIZE = 10;
+
+// LEB128 encoding: 7 bits per byte, high bit set on all bytes but the last.
+// Returns end of encoded value. Out must have MAX_VARINT_SIZE bytes
+inline uint8_t *putVarint(uint8_t *out, uint64_t value) noexcept {
+    constexpr uint8_t MORE = 0x80;
+
+    while (value >= MORE) {
+        *out++ = static_cast<uint8_t>(value) | MORE;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+
+    return out;
+}
+
+// Zigzag encoding maps small negative deltas to small unsigned values
+NODISCARD constexpr uint64_t zigzag(int64_t value) noexcept {
+    return (static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63);
+}
+
+NODISCARD constexpr int64_t unzigzag(uint64_t value) noexcept {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Decode varint at pos. Returns false if input ends before varint does
+NODISCARD inline bool getVarint(const uint8_t *data, size_t size,
+                                size_t &pos, uint64_t &value) noexcept {
+    constexpr uint8_t MORE = 0x80;
+    constexpr uint8_t PAYLOAD_MASK = 0x7f;
+    constexpr size_t MAX_SHIFT = 63;
+
+    value = 0;
+    for (size_t shift = 0; pos != size && shift <= MAX_SHIFT; shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint64_t>(byte & PAYLOAD_MASK) << shift;
+
+        if ((byte & MORE) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace sim::trace
+
+#endif // INCL_SIM_TRACE_VARINT_HPP
@@ -0,0 +1,241 @@
+#include <chrono>
+#include <cstring>
+
+#include <sim/trace/mem_trace.hpp>
+#include <sim/trace/varint.hpp>
+
+namespace sim::trace {
+
+namespace {
+
+// Record header layout: type in bits [1, 0], log2 of size in bits [3, 2]
+constexpr uint8_t TYPE_MASK = 0x3;
+constexpr unsigned SIZE_LOG2_SHIFT = 2;
+constexpr uint8_t SIZE_LOG2_MASK = 0x3;
+// pc is the same as in previous record and is omitted
+constexpr uint8_t SAME_PC = 1 << 4;
+// va is equal to pc and is omitted
+constexpr uint8_t VA_IS_PC = 1 << 5;
+
+// Header + pc + va + pa
+constexpr size_t MAX_MEM_RECORD_SIZE = 1 + 3 * MAX_VARINT_SIZE;
+
+uint8_t sizeLog2(uint8_t size) noexcept {
+    uint8_t log2 = 0;
+    while ((1U << log2) < size) {
+        ++log2;
+    }
+
+    return log2;
+}
+
+} // namespace
+
+MemWriter::MemWriter(const std::string &path)
+    : m_file(std::fopen(path.c_str(), "wb")) {
+    for (uint32_t idx = CHUNK_NUMBER - 1; idx != 0; --idx) {
+        m_own_chunks.push_back(idx);
+    }
+    m_curr = m_records.get();
+    m_curr_end = m_curr + CHUNK_SIZE;
+
+    if (m_file == nullptr) {
+        return;
+    }
+
+    std::fwrite(MEM_FILE_MAGIC, 1, MEM_FILE_MAGIC_SIZE, m_file);
+    m_byte_number = MEM_FILE_MAGIC_SIZE;
+
+    // Whole chunk is encoded without reallocation
+    m_out.resize(FLUSH_SIZE + CHUNK_SIZE * MAX_MEM_RECORD_SIZE);
+    m_drain_thread = std::thread{[this] { drain(); }};
+}
+
+void MemWriter::submit() noexcept {
+    auto *chunk_begin = m_records.get() + m_curr_chunk * CHUNK_SIZE;
+    Chunk full{m_curr_chunk, static_cast<uint32_t>(m_curr - chunk_begin)};
+
+    // Ring holds all chunks, so it is never full
+    [[maybe_unused]] bool pushed = m_full_chunks.push(full);
+    SIM_ASSERT(pushed);
+
+    while (m_own_chunks.empty()) {
+        m_free_chunks.popAll(
+            [this](uint32_t idx) { m_own_chunks.push_back(idx); });
+
+        if (m_own_chunks.empty()) {
+            std::this_thread::yield();
+        }
+    }
+
+    m_curr_chunk = m_own_chunks.back();
+    m_own_chunks.pop_back();
+
+    m_curr = m_records.get() + m_curr_chunk * CHUNK_SIZE;
+    m_curr_end = m_curr + CHUNK_SIZE;
+}
+
+void MemWriter::close() noexcept {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    submit();
+
+    m_stop.store(true, std::memory_order_release);
+    m_drain_thread.join();
+
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void MemWriter::drain() noexcept {
+    constexpr auto IDLE_SLEEP = std::chrono::microseconds(50);
+
+    while (true) {
+        // Chunks submitted before stop request are popped on this pass
+        bool stop = m_stop.load(std::memory_order_acquire);
+
+        auto popped = m_full_chunks.popAll([this](const Chunk &chunk) {
+            const auto *records = m_records.get() + chunk.idx * CHUNK_SIZE;
+            for (uint32_t i = 0; i != chunk.size; ++i) {
+                encode(records[i]);
+            }
+            m_record_number += chunk.size;
+
+            if (m_out_size >= FLUSH_SIZE) {
+                writeOut();
+            }
+
+            [[maybe_unused]] bool pushed = m_free_chunks.push(chunk.idx);
+            SIM_ASSERT(pushed);
+        });
+
+        if (popped == 0) {
+            if (stop) {
+                break;
+            }
+
+            std::this_thread::sleep_for(IDLE_SLEEP);
+        }
+    }
+
+    writeOut();
+}
+
+void MemWriter::encode(const MemRecord &record) noexcept {
+    auto *out = m_out.data() + m_out_size;
+
+    auto &header = *out++;
+    header = (record.type & TYPE_MASK) |
+             (sizeLog2(record.size) & SIZE_LOG2_MASK) << SIZE_LOG2_SHIFT;
+
+    if (record.pc == m_prev_pc) {
+        header |= SAME_PC;
+    } else {
+        out = putVarint(out, zigzag(record.pc - m_prev_pc));
+        m_prev_pc = record.pc;
+    }
+
+    if (record.va == record.pc) {
+        header |= VA_IS_PC;
+    } else {
+        out = putVarint(out, zigzag(record.va - m_prev_va));
+        m_prev_va = record.va;
+    }
+
+    // pa - va is the same for all accesses to a page
+    PhysAddr pa_offset = record.pa - record.va;
+    out = putVarint(out, zigzag(pa_offset - m_prev_pa_offset));
+    m_prev_pa_offset = pa_offset;
+
+    m_out_size = out - m_out.data();
+}
+
+void MemWriter::writeOut() noexcept {
+    std::fwrite(m_out.data(), 1, m_out_size, m_file);
+    m_byte_number += m_out_size;
+    m_out_size = 0;
+}
+
+MemReader::MemReader(const std::string &path)
+    : m_file(std::fopen(path.c_str(), "rb")) {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    char magic[MEM_FILE_MAGIC_SIZE] = {};
+    if (std::fread(magic, 1, MEM_FILE_MAGIC_SIZE, m_file) !=
+            MEM_FILE_MAGIC_SIZE ||
+        std::memcmp(magic, MEM_FILE_MAGIC, MEM_FILE_MAGIC_SIZE) != 0) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+MemReader::~MemReader() {
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+    }
+}
+
+void MemReader::refill() {
+    if (m_buf.size() - m_pos >= MAX_MEM_RECORD_SIZE) {
+        return;
+    }
+
+    m_buf.erase(m_buf.begin(), m_buf.begin() + m_pos);
+    m_pos = 0;
+
+    auto size = m_buf.size();
+    m_buf.resize(size + READ_SIZE);
+    m_buf.resize(size + std::fread(m_buf.data() + size, 1, READ_SIZE, m_file));
+}
+
+bool MemReader::next(MemRecord &record) {
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    refill();
+    if (m_pos == m_buf.size()) {
+        return false;
+    }
+
+    const auto *data = m_buf.data();
+    auto size = m_buf.size();
+
+    uint8_t header = data[m_pos++];
+
+    record = {};
+    record.type = header & TYPE_MASK;
+    record.size = 1 << (header >> SIZE_LOG2_SHIFT & SIZE_LOG2_MASK);
+
+    uint64_t value = 0;
+    if (!(header & SAME_PC)) {
+        if (!getVarint(data, size, m_pos, value)) {
+            return false;
+        }
+        m_prev_pc += unzigzag(value);
+    }
+    record.pc = m_prev_pc;
+
+    if (header & VA_IS_PC) {
+        record.va = record.pc;
+    } else {
+        if (!getVarint(data, size, m_pos, value)) {
+            return false;
+        }
+        record.va = m_prev_va += unzigzag(value);
+    }
+
+    if (!getVarint(data, size, m_pos, value)) {
+        return false;
+    }
+    m_prev_pa_offset += unzigzag(value);
+    record.pa = record.va + m_prev_pa_offset;
+
+    return true;
+}
+
+} // namespace sim::trace
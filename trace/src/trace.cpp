@@ -0,0 +1,178 @@
+#include <chrono>
+#include <cstring>
+
+#include <sim/trace.hpp>
+#include <sim/trace/varint.hpp>
+
+namespace sim::trace {
+
+namespace {
+
+// Flags + instr id + pc + reg idx + reg value + mem addr + mem value
+constexpr size_t MAX_RECORD_SIZE = 2 + 5 * MAX_VARINT_SIZE;
+
+} // namespace
+
+Writer::Writer(const std::string &path, size_t ring_capacity)
+    : m_ring(ring_capacity), m_file(std::fopen(path.c_str(), "wb")) {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    std::fwrite(FILE_MAGIC, 1, FILE_MAGIC_SIZE, m_file);
+
+    // Whole ring is encoded without reallocation
+    m_out.resize(FLUSH_SIZE + m_ring.capacity() * MAX_RECORD_SIZE);
+    m_drain_thread = std::thread{[this] { drain(); }};
+}
+
+void Writer::close() noexcept {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    m_stop.store(true, std::memory_order_release);
+    m_drain_thread.join();
+
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void Writer::drain() noexcept {
+    constexpr auto IDLE_SLEEP = std::chrono::microseconds(50);
+
+    while (true) {
+        // Records pushed before stop request are popped on this pass
+        bool stop = m_stop.load(std::memory_order_acquire);
+
+        auto popped = m_ring.popAll([this](const Record &record) {
+            encode(record);
+        });
+        m_record_number += popped;
+
+        if (m_out_size >= FLUSH_SIZE) {
+            writeOut();
+        }
+
+        if (popped == 0) {
+            if (stop) {
+                break;
+            }
+
+            std::this_thread::sleep_for(IDLE_SLEEP);
+        }
+    }
+
+    writeOut();
+}
+
+void Writer::encode(const Record &record) noexcept {
+    auto *out = m_out.data() + m_out_size;
+
+    *out++ = record.flags;
+    out = putVarint(out, record.instr_id);
+    out = putVarint(out, zigzag(record.pc - m_prev_pc));
+    m_prev_pc = record.pc;
+
+    if (record.flags & Record::REG_WRITE) {
+        *out++ = record.reg_idx;
+        out = putVarint(out, record.reg_value);
+    }
+
+    if (record.flags & Record::MEM_WRITE) {
+        out = putVarint(out, zigzag(record.mem_addr - m_prev_mem_addr));
+        out = putVarint(out, record.mem_value);
+        m_prev_mem_addr = record.mem_addr;
+    }
+
+    m_out_size = out - m_out.data();
+}
+
+void Writer::writeOut() noexcept {
+    std::fwrite(m_out.data(), 1, m_out_size, m_file);
+    m_out_size = 0;
+}
+
+Reader::Reader(const std::string &path)
+    : m_file(std::fopen(path.c_str(), "rb")) {
+    if (m_file == nullptr) {
+        return;
+    }
+
+    char magic[FILE_MAGIC_SIZE] = {};
+    if (std::fread(magic, 1, FILE_MAGIC_SIZE, m_file) != FILE_MAGIC_SIZE ||
+        std::memcmp(magic, FILE_MAGIC, FILE_MAGIC_SIZE) != 0) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+Reader::~Reader() {
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+    }
+}
+
+void Reader::refill() {
+    if (m_buf.size() - m_pos >= MAX_RECORD_SIZE) {
+        return;
+    }
+
+    m_buf.erase(m_buf.begin(), m_buf.begin() + m_pos);
+    m_pos = 0;
+
+    auto size = m_buf.size();
+    m_buf.resize(size + READ_SIZE);
+    m_buf.resize(size + std::fread(m_buf.data() + size, 1, READ_SIZE, m_file));
+}
+
+bool Reader::next(Record &record) {
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    refill();
+    if (m_pos == m_buf.size()) {
+        return false;
+    }
+
+    const auto *data = m_buf.data();
+    auto size = m_buf.size();
+
+    record = {};
+    record.flags = data[m_pos++];
+
+    uint64_t value = 0;
+    if (!getVarint(data, size, m_pos, value)) {
+        return false;
+    }
+    record.instr_id = static_cast<uint16_t>(value);
+
+    if (!getVarint(data, size, m_pos, value)) {
+        return false;
+    }
+    record.pc = m_prev_pc += unzigzag(value);
+
+    if (record.flags & Record::REG_WRITE) {
+        if (m_pos == size) {
+            return false;
+        }
+        record.reg_idx = data[m_pos++];
+
+        if (!getVarint(data, size, m_pos, record.reg_value)) {
+            return false;
+        }
+    }
+
+    if (record.flags & Record::MEM_WRITE) {
+        if (!getVarint(data, size, m_pos, value) ||
+            !getVarint(data, size, m_pos, record.mem_value)) {
+            return false;
+        }
+        record.mem_addr = m_prev_mem_addr += unzigzag(value);
+    }
+
+    return true;
+}
+
+} // namespace sim::trace
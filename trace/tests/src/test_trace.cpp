@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sim/trace.hpp>
+#include <sim/trace/mem_trace.hpp>
+#include <sim/trace/spsc_ring.hpp>
+#include <sim/trace/varint.hpp>
+
+namespace sim::trace {
+
+TEST(TraceTest, varint) {
+    const std::vector<uint64_t> VALUES = {0, 1, 127, 128, 300, ~uint64_t{0}};
+
+    std::vector<uint8_t> out(VALUES.size() * MAX_VARINT_SIZE);
+    auto *end = out.data();
+    for (auto value : VALUES) {
+        end = putVarint(end, value);
+    }
+    out.resize(end - out.data());
+    ASSERT_EQ(out.size(), 1 + 1 + 1 + 2 + 2 + 10);
+
+    size_t pos = 0;
+    for (auto value : VALUES) {
+        uint64_t decoded = 0;
+        ASSERT_TRUE(getVarint(out.data(), out.size(), pos, decoded));
+        ASSERT_EQ(decoded, value);
+    }
+
+    uint64_t decoded = 0;
+    ASSERT_FALSE(getVarint(out.data(), out.size(), pos, decoded));
+
+    for (int64_t value : {0L, -1L, 1L, -64L, INT64_MIN, INT64_MAX}) {
+        ASSERT_EQ(unzigzag(zigzag(value)), value);
+    }
+    ASSERT_EQ(zigzag(-1), 1);
+}
+
+TEST(TraceTest, spscRing) {
+    static constexpr size_t NUMBER = 100000;
+
+    SPSCRing<size_t> ring{16};
+
+    std::thread producer{[&] {
+        for (size_t i = 0; i != NUMBER; ++i) {
+            while (!ring.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    size_t expected = 0;
+    while (expected != NUMBER) {
+        auto number =
+            ring.popAll([&](size_t value) { ASSERT_EQ(value, expected++); });
+        if (number == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+}
+
+TEST(TraceTest, writeRead) {
+    const std::string PATH = "test_trace.bin";
+
+    std::vector<Record> records{};
+    for (size_t i = 0; i != 100000; ++i) {
+        Record record{};
+        record.pc = 0x10000 + (i % 17) * 4;
+        record.instr_id = i % 300;
+
+        if (i % 3 == 0) {
+            record.flags |= Record::GPR_WRITE;
+            record.reg_idx = i % 32;
+            record.reg_value = i * 0x123456789;
+        }
+
+        if (i % 5 == 0) {
+            record.flags |= Record::MEM_WRITE;
+            record.mem_addr = 0x7fff0000 - i * 8;
+            record.mem_value = ~i;
+        }
+
+        records.push_back(record);
+    }
+
+    {
+        // Small ring makes producer wait for drain thread
+        Writer writer{PATH, 64};
+        ASSERT_TRUE(writer.isOpen());
+
+        for (auto &&record : records) {
+            writer.push(record);
+        }
+
+        writer.close();
+        ASSERT_EQ(writer.recordNumber(), records.size());
+    }
+
+    Reader reader{PATH};
+    ASSERT_TRUE(reader.isOpen());
+
+    Record record{};
+    for (auto &&expected : records) {
+        ASSERT_TRUE(reader.next(record));
+
+        ASSERT_EQ(record.pc, expected.pc);
+        ASSERT_EQ(record.instr_id, expected.instr_id);
+        ASSERT_EQ(record.flags, expected.flags);
+        ASSERT_EQ(record.reg_idx, expected.reg_idx);
+        ASSERT_EQ(record.reg_value, expected.reg_value);
+        ASSERT_EQ(record.mem_addr, expected.mem_addr);
+        ASSERT_EQ(record.mem_value, expected.mem_value);
+    }
+    ASSERT_FALSE(reader.next(record));
+
+    std::remove(PATH.c_str());
+
+    // Not a trace
+    ASSERT_FALSE(Reader{"/dev/null"}.isOpen());
+}
+
+TEST(TraceTest, memWriteRead) {
+    const std::string PATH = "test_mem_trace.bin";
+
+    std::vector<MemRecord> records{};
+    for (size_t i = 0; i != 100000; ++i) {
+        MemRecord record{};
+        record.pc = 0x10000 + (i / 3 % 17) * 4;
+
+        switch (i % 3) {
+        case 0:
+            record.type = MemRecord::FETCH;
+            record.va = record.pc;
+            record.size = 4;
+            break;
+        case 1:
+            record.type = MemRecord::READ;
+            record.va = 0x7fff0000 - i * 8;
+            record.size = 8;
+            break;
+        default:
+            record.type = i % 2 ? MemRecord::WRITE : MemRecord::AMO;
+            record.va = 0x20000 + (i * 0x1234) % 0x100000;
+            record.size = 1 << i % 4;
+            break;
+        }
+        record.pa = record.va + (record.va >> 12) * 0x3000;
+
+        records.push_back(record);
+    }
+
+    size_t byte_number = 0;
+    {
+        MemWriter writer{PATH};
+        ASSERT_TRUE(writer.isOpen());
+
+        for (auto &&record : records) {
+            writer.push(record);
+        }
+
+        writer.close();
+        ASSERT_EQ(writer.recordNumber(), records.size());
+        byte_number = writer.byteNumber();
+    }
+
+    // Deltas are much shorter than raw records
+    ASSERT_LT(byte_number, records.size() * sizeof(MemRecord) / 2);
+
+    MemReader reader{PATH};
+    ASSERT_TRUE(reader.isOpen());
+
+    MemRecord record{};
+    for (auto &&expected : records) {
+        ASSERT_TRUE(reader.next(record));
+
+        ASSERT_EQ(record.pc, expected.pc);
+        ASSERT_EQ(record.va, expected.va);
+        ASSERT_EQ(record.pa, expected.pa);
+        ASSERT_EQ(record.size, expected.size);
+        ASSERT_EQ(record.type, expected.type);
+    }
+    ASSERT_FALSE(reader.next(record));
+
+    std::remove(PATH.c_str());
+
+    // Not a memory trace
+    ASSERT_FALSE(MemReader{"/dev/null"}.isOpen());
+}
+
+} // namespace sim::trace
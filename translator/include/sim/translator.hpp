@@ -0,0 +1,131 @@
+#ifndef INCL_SIM_TRANSLATOR_HPP
+#define INCL_SIM_TRANSLATOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <sim/bb.hpp>
+#include <sim/common.hpp>
+#include <sim/memory.hpp>
+#include <sim/translator/mpmc_queue.hpp>
+
+namespace sim::translator {
+
+class Translator;
+
+// Built superblock
+struct Result final {
+    VirtAddr virt_addr = 0;
+    // Client code generation at request time
+    uint64_t generation = 0;
+    std::unique_ptr<bb::Superblock> superblock = nullptr;
+};
+
+// Translation requests source
+class Client {
+    friend class Translator;
+
+    // Requests queued or being built
+    std::atomic<size_t> m_inflight = 0;
+
+  protected:
+    ~Client() = default;
+
+    // Wait for all requests of this client to complete
+    void waitTranslations() const noexcept {
+        while (m_inflight.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+  public:
+    // Called from translator worker thread
+    virtual void onTranslated(Result &&result) = 0;
+
+    // Check if va is host function entry. Superblocks end at JAL to it.
+    // Called from translator worker thread, so host functions must not
+    // change while requests are in flight
+    NODISCARD virtual bool isHostFunc(VirtAddr va) const noexcept = 0;
+};
+
+// Hot code translation request
+struct Request final {
+    Client *client = nullptr;
+    VirtAddr virt_addr = 0;
+    // Host page holding code at virt_addr. Superblock does not leave it
+    memory::ConstHostPtr host_page_ptr = nullptr;
+    uint64_t generation = 0;
+    std::chrono::steady_clock::time_point enqueue_time{};
+};
+
+// Translator statistics
+struct Stats final {
+    size_t requests = 0;
+    // Requests rejected because queue was full
+    size_t dropped = 0;
+    size_t completed = 0;
+
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+
+    // Time from request to result delivery in microseconds
+    double avg_latency_us = 0;
+    double max_latency_us = 0;
+};
+
+// Background hot code translator.
+// Execution threads push requests to lock-free queue, worker threads build
+// superblocks and hand them back to clients
+class Translator final {
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 1024;
+    static constexpr uint32_t DEFAULT_HOT_THRESHOLD = 256;
+
+    uint32_t m_hot_threshold = DEFAULT_HOT_THRESHOLD;
+
+    MPMCQueue<Request> m_queue;
+
+    // Incremented on push to wake up workers
+    std::atomic<uint32_t> m_push_counter = 0;
+    std::atomic<bool> m_stop = false;
+
+    std::atomic<size_t> m_requests = 0;
+    std::atomic<size_t> m_dropped = 0;
+    std::atomic<size_t> m_popped = 0;
+    std::atomic<size_t> m_completed = 0;
+    std::atomic<size_t> m_max_queue_depth = 0;
+    std::atomic<uint64_t> m_total_latency_ns = 0;
+    std::atomic<uint64_t> m_max_latency_ns = 0;
+
+    std::vector<std::thread> m_workers{};
+
+    void work() noexcept;
+    void translate(const Request &request) noexcept;
+
+  public:
+    explicit Translator(size_t worker_number,
+                        uint32_t hot_threshold = DEFAULT_HOT_THRESHOLD,
+                        size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+
+    Translator(const Translator &) = delete;
+    Translator &operator=(const Translator &) = delete;
+
+    ~Translator();
+
+    // Bb executions number after which translation is requested
+    NODISCARD auto hotThreshold() const noexcept { return m_hot_threshold; }
+
+    // Enqueue request. Returns false if queue is full. Lock-free
+    NODISCARD bool request(Client &client, VirtAddr virt_addr,
+                           memory::ConstHostPtr host_page_ptr,
+                           uint64_t generation) noexcept;
+
+    NODISCARD Stats stats() const noexcept;
+};
+
+} // namespace sim::translator
+
+#endif // INCL_SIM_TRANSLATOR_HPP
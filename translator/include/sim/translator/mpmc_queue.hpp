@@ -0,0 +1,95 @@
+#ifndef INCL_SIM_TRANSLATOR_MPMC_QUEUE_HPP
+#define INCL_SIM_TRANSLATOR_MPMC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <sim/common.hpp>
+
+namespace sim::translator {
+
+// Bounded lock-free multi-producer multi-consumer queue.
+// Each cell has a sequence number telling whether it is ready for push or
+// for pop on current lap, so producers and consumers only contend on their
+// own position counter
+template <class T> class MPMCQueue final {
+    struct Cell final {
+        std::atomic<size_t> sequence = 0;
+        T value{};
+    };
+
+    size_t m_mask = 0;
+    std::unique_ptr<Cell[]> m_cells = nullptr;
+
+    alignas(64) std::atomic<size_t> m_push_pos = 0;
+    alignas(64) std::atomic<size_t> m_pop_pos = 0;
+
+  public:
+    // Capacity must be power of 2
+    explicit MPMCQueue(size_t capacity)
+        : m_mask(capacity - 1), m_cells(new Cell[capacity]) {
+        SIM_ASSERT(capacity != 0 && (capacity & m_mask) == 0);
+
+        for (size_t i = 0; i != capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    NODISCARD size_t capacity() const noexcept { return m_mask + 1; }
+
+    // Returns false if queue is full
+    NODISCARD bool push(T value) noexcept {
+        auto pos = m_push_pos.load(std::memory_order_relaxed);
+
+        while (true) {
+            auto &cell = m_cells[pos & m_mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence - pos);
+
+            if (diff == 0) {
+                if (m_push_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_push_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns std::nullopt if queue is empty
+    NODISCARD std::optional<T> pop() noexcept {
+        auto pos = m_pop_pos.load(std::memory_order_relaxed);
+
+        while (true) {
+            auto &cell = m_cells[pos & m_mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence - (pos + 1));
+
+            if (diff == 0) {
+                if (m_pop_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    T value = std::move(cell.value);
+                    cell.sequence.store(pos + m_mask + 1,
+                                        std::memory_order_release);
+                    return value;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;
+            } else {
+                pos = m_pop_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+} // namespace sim::translator
+
+#endif // INCL_SIM_TRANSLATOR_MPMC_QUEUE_HPP
@@ -0,0 +1,184 @@
+#include <sim/translator.hpp>
+
+namespace sim::translator {
+
+namespace {
+
+// Fetch from single host page
+class PageFetch final {
+    VirtAddr m_page_va = 0;
+    VirtAddr m_curr_fetch_addr = 0;
+    memory::ConstHostPtr m_host_page_ptr = nullptr;
+
+  public:
+    PageFetch(VirtAddr virt_addr, memory::ConstHostPtr host_page_ptr)
+        : m_page_va(virt_addr & ~memory::PAGE_OFFSET_MASK),
+          m_curr_fetch_addr(virt_addr), m_host_page_ptr(host_page_ptr) {}
+
+    bb::Bb::FetchResult operator()() noexcept {
+        auto lo = loadHalf(m_curr_fetch_addr - m_page_va);
+        if (lo.status != SimStatus::OK || instr::isCompressed(lo.instr_code)) {
+            m_curr_fetch_addr += COMPRESSED_INSTR_CODE_SIZE;
+            return lo;
+        }
+
+        auto hi = loadHalf(m_curr_fetch_addr - m_page_va +
+                           COMPRESSED_INSTR_CODE_SIZE);
+        if (hi.status != SimStatus::OK) {
+            return hi;
+        }
+
+        m_curr_fetch_addr += INSTR_CODE_SIZE;
+        return {SimStatus::OK, hi.instr_code << bit::bitSize<uint16_t>() |
+                                   lo.instr_code};
+    }
+
+    // Load 16-bit code parcel at given page offset. Parcels are 2 bytes
+    // aligned, so instr crossing page boundary fails on upper half
+    bb::Bb::FetchResult loadHalf(VirtAddr offset) const noexcept {
+        if (offset > memory::PAGE_SIZE - COMPRESSED_INSTR_CODE_SIZE) {
+            return {SimStatus::PHYS_MEM__PAGE_ALIGN_ERROR, 0};
+        }
+
+        // Code could be changed by execution thread, so read atomically.
+        // Host pages are always writable
+        auto *code_ptr = reinterpret_cast<uint16_t *>(
+            const_cast<uint8_t *>(m_host_page_ptr + offset));
+        auto half = std::atomic_ref<uint16_t>(*code_ptr).load(
+            std::memory_order_relaxed);
+
+        return {SimStatus::OK, half};
+    }
+
+    void jump(VirtAddr virt_addr) noexcept { m_curr_fetch_addr = virt_addr; }
+};
+
+template <class Int>
+void updateMax(std::atomic<Int> &max, Int value) noexcept {
+    auto curr = max.load(std::memory_order_relaxed);
+    while (curr < value &&
+           !max.compare_exchange_weak(curr, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+Translator::Translator(size_t worker_number, uint32_t hot_threshold,
+                       size_t queue_capacity)
+    : m_hot_threshold(hot_threshold), m_queue(queue_capacity) {
+    SIM_ASSERT(worker_number != 0);
+    SIM_ASSERT(hot_threshold != 0);
+
+    m_workers.reserve(worker_number);
+    for (size_t i = 0; i != worker_number; ++i) {
+        m_workers.emplace_back([this] { work(); });
+    }
+}
+
+Translator::~Translator() {
+    m_stop.store(true, std::memory_order_relaxed);
+
+    m_push_counter.fetch_add(1, std::memory_order_release);
+    m_push_counter.notify_all();
+
+    for (auto &&worker : m_workers) {
+        worker.join();
+    }
+}
+
+bool Translator::request(Client &client, VirtAddr virt_addr,
+                         memory::ConstHostPtr host_page_ptr,
+                         uint64_t generation) noexcept {
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+    client.m_inflight.fetch_add(1, std::memory_order_relaxed);
+
+    Request request{&client, virt_addr, host_page_ptr, generation,
+                    std::chrono::steady_clock::now()};
+    if (!m_queue.push(request)) {
+        client.m_inflight.fetch_sub(1, std::memory_order_release);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto pushed = m_requests.load(std::memory_order_relaxed) -
+                  m_dropped.load(std::memory_order_relaxed);
+    updateMax(m_max_queue_depth,
+              pushed - m_popped.load(std::memory_order_relaxed));
+
+    m_push_counter.fetch_add(1, std::memory_order_release);
+    m_push_counter.notify_one();
+
+    return true;
+}
+
+void Translator::translate(const Request &request) noexcept {
+    auto superblock = std::make_unique<bb::Superblock>();
+
+    auto *client = request.client;
+
+    PageFetch fetch{request.virt_addr, request.host_page_ptr};
+    superblock->update(request.virt_addr, fetch, [client](VirtAddr va) {
+        return client->isHostFunc(va);
+    });
+
+    client->onTranslated(
+        {request.virt_addr, request.generation, std::move(superblock)});
+
+    auto latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() -
+                          request.enqueue_time)
+                          .count();
+
+    m_total_latency_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+    updateMax(m_max_latency_ns, static_cast<uint64_t>(latency_ns));
+    m_completed.fetch_add(1, std::memory_order_relaxed);
+
+    // Client can be destroyed right after this
+    client->m_inflight.fetch_sub(1, std::memory_order_release);
+}
+
+void Translator::work() noexcept {
+    while (true) {
+        auto push_counter = m_push_counter.load(std::memory_order_acquire);
+
+        if (auto request = m_queue.pop()) {
+            m_popped.fetch_add(1, std::memory_order_relaxed);
+            translate(*request);
+            continue;
+        }
+
+        if (m_stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        // Sleep until next push
+        m_push_counter.wait(push_counter, std::memory_order_acquire);
+    }
+}
+
+Stats Translator::stats() const noexcept {
+    static constexpr double NS_IN_US = 1e3;
+
+    Stats stats{};
+
+    stats.requests = m_requests.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.completed = m_completed.load(std::memory_order_relaxed);
+
+    auto pushed = stats.requests - stats.dropped;
+    auto popped = m_popped.load(std::memory_order_relaxed);
+    stats.queue_depth = pushed > popped ? pushed - popped : 0;
+    stats.max_queue_depth = m_max_queue_depth.load(std::memory_order_relaxed);
+
+    if (stats.completed != 0) {
+        stats.avg_latency_us =
+            m_total_latency_ns.load(std::memory_order_relaxed) / NS_IN_US /
+            stats.completed;
+    }
+    stats.max_latency_us =
+        m_max_latency_ns.load(std::memory_order_relaxed) / NS_IN_US;
+
+    return stats;
+}
+
+} // namespace sim::translator
@@ -0,0 +1,204 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sim/simulator.hpp>
+#include <sim/translator.hpp>
+
+namespace sim::translator {
+
+TEST(MPMCQueueTest, pushPop) {
+    MPMCQueue<size_t> queue{4};
+
+    ASSERT_FALSE(queue.pop().has_value());
+
+    for (size_t i = 0; i != queue.capacity(); ++i) {
+        ASSERT_TRUE(queue.push(i));
+    }
+    ASSERT_FALSE(queue.push(0));
+
+    for (size_t i = 0; i != queue.capacity(); ++i) {
+        ASSERT_EQ(queue.pop(), i);
+    }
+    ASSERT_FALSE(queue.pop().has_value());
+}
+
+TEST(MPMCQueueTest, concurrent) {
+    static constexpr size_t THREAD_NUMBER = 4;
+    static constexpr size_t VALUE_NUMBER = 10000;
+
+    MPMCQueue<size_t> queue{64};
+    std::atomic<size_t> sum = 0;
+
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i != THREAD_NUMBER; ++i) {
+        threads.emplace_back([&] {
+            for (size_t value = 1; value <= VALUE_NUMBER; ++value) {
+                while (!queue.push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            for (size_t popped = 0; popped != VALUE_NUMBER;) {
+                if (auto value = queue.pop()) {
+                    sum += *value;
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto &&thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(sum, THREAD_NUMBER * VALUE_NUMBER * (VALUE_NUMBER + 1) / 2);
+}
+
+class TranslatorTest : public ::testing::Test {
+  protected:
+    static constexpr PhysAddr CODE_SEG_BASE = 0x5000000000;
+    static constexpr uint64_t N = 100000;
+
+    // Sums [0, N) with direct jumps inside loop body
+    const std::vector<InstrCode> CODE = {
+        0x00000293, // addi t0, zero, 0
+        0x00018337, // lui t1, 24
+        0x6a030313, // addi t1, t1, 1696
+        0x00000513, // addi a0, zero, 0
+
+        // loop:
+        0x0062dc63, // bge t0, t1, end
+        0x00550533, // add a0, a0, t0
+        0x0080006f, // j skip
+        0x3e850513, // addi a0, a0, 1000
+
+        // skip:
+        0x00128293, // addi t0, t0, 1
+        0xfedff06f, // j loop
+
+        // end:
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073  // ecall
+    };
+
+    // Fills DATA_PAGE_PA with 64-byte chunks of memset calls. Guest memset
+    // is a byte loop at MEMSET_VA
+    static constexpr PhysAddr DATA_PAGE_PA = 0x6000000000;
+    static constexpr VirtAddr MEMSET_VA = CODE_SEG_BASE + 56;
+
+    const std::vector<InstrCode> MEMSET_CODE = {
+        0x0060039b, // addiw t2, zero, 6
+        0x02439393, // slli t2, t2, 36
+        0x00000293, // addi t0, zero, 0
+        0x00018337, // lui t1, 24
+        0x6a030313, // addi t1, t1, 1696
+
+        // loop:
+        0x0062de63, // bge t0, t1, end
+        0x00038513, // addi a0, t2, 0
+        0x00028593, // addi a1, t0, 0
+        0x04000613, // addi a2, zero, 64
+        0x014000ef, // jal ra, memset
+        0x00128293, // addi t0, t0, 1
+        0xfe9ff06f, // j loop
+
+        // end:
+        0x05d0089b, // addiw a7, zero, 93
+        0x00000073, // ecall
+
+        // memset:
+        0x00060a63, // beqz a2, ret
+        0x00b50023, // sb a1, 0(a0)
+        0x00150513, // addi a0, a0, 1
+        0xfff60613, // addi a2, a2, -1
+        0xff1ff06f, // j memset
+
+        // ret:
+        0x00008067 // ret
+    };
+
+    void load(Simulator &sim, const std::vector<InstrCode> &code) {
+        auto &pm = sim.getPhysMemory();
+
+        SIM_ASSERT(pm.addRAMPage(CODE_SEG_BASE));
+        SIM_ASSERT(pm.addRAMPage(DATA_PAGE_PA));
+
+        for (size_t i = 0, end = code.size(); i != end; ++i) {
+            SIM_ASSERT(pm.write(CODE_SEG_BASE + i * INSTR_CODE_SIZE, code[i])
+                           .status == SimStatus::OK);
+        }
+    }
+
+    void load(Simulator &sim) { load(sim, CODE); }
+};
+
+TEST_F(TranslatorTest, hotLoop) {
+    Simulator ref_sim{};
+    load(ref_sim);
+    ASSERT_EQ(ref_sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+
+    Translator translator{1, 16};
+
+    Simulator sim{};
+    sim.setTranslator(&translator);
+    load(sim);
+    ASSERT_EQ(sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+
+    ASSERT_EQ(sim.icount(), ref_sim.icount());
+    ASSERT_EQ(sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A0),
+              N * (N - 1) / 2);
+
+    auto stats = translator.stats();
+    ASSERT_NE(stats.requests, 0);
+    ASSERT_EQ(stats.completed + stats.dropped, stats.requests);
+    ASSERT_EQ(stats.queue_depth, 0);
+    ASSERT_GE(stats.max_queue_depth, 1);
+}
+
+TEST_F(TranslatorTest, reset) {
+    Translator translator{2, 1};
+
+    Simulator sim{};
+    sim.setTranslator(&translator);
+
+    // Translations of previous runs must not leak to next runs
+    for (size_t run = 0; run != 3; ++run) {
+        sim.reset();
+        load(sim);
+
+        ASSERT_EQ(sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+        ASSERT_EQ(sim.getHart().gprFile().read<uint64_t>(gpr::GPR_IDX::A0),
+                  N * (N - 1) / 2);
+    }
+}
+
+TEST_F(TranslatorTest, hostFuncCall) {
+    Simulator ref_sim{};
+    load(ref_sim, MEMSET_CODE);
+    ref_sim.setHostFunc(MEMSET_VA, Simulator::HostFunc::MEMSET);
+    ASSERT_EQ(ref_sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+
+    Translator translator{1, 16};
+
+    // Superblocks end at JAL to host function, so guest memset is not run
+    Simulator sim{};
+    sim.setTranslator(&translator);
+    load(sim, MEMSET_CODE);
+    sim.setHostFunc(MEMSET_VA, Simulator::HostFunc::MEMSET);
+    ASSERT_EQ(sim.simulate(CODE_SEG_BASE), SimStatus::OK);
+
+    ASSERT_EQ(sim.icount(), ref_sim.icount());
+    ASSERT_NE(translator.stats().requests, 0);
+
+    uint8_t value = 0;
+    ASSERT_EQ(sim.getPhysMemory().read(DATA_PAGE_PA + 63, value).status,
+              SimStatus::OK);
+    ASSERT_EQ(value, static_cast<uint8_t>(N - 1));
+}
+
+} // namespace sim::translator
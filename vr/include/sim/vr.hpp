@@ -0,0 +1,178 @@
+#ifndef INCL_VR_HPP
+#define INCL_VR_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include <sim/common.hpp>
+
+namespace sim {
+namespace vr {
+
+static constexpr size_t VR_NUMBER = 32;
+
+// Vector register length. Register with LMUL = 1 is one AVX2 host register
+static constexpr size_t VLEN = 256;
+static constexpr size_t VLENB = VLEN / bit::BYTE_SIZE;
+
+// Max element width in bits
+static constexpr size_t ELEN = 64;
+
+// vtype fields
+namespace VTYPE {
+static constexpr bit::BitIdx VLMUL_HI = 2;
+static constexpr bit::BitIdx VLMUL_LO = 0;
+static constexpr bit::BitIdx VSEW_HI = 5;
+static constexpr bit::BitIdx VSEW_LO = 3;
+static constexpr bit::BitIdx VTA = 6;
+static constexpr bit::BitIdx VMA = 7;
+
+// Bits above vma must be zero
+static constexpr RegValue RESERVED_MASK = ~RegValue{0xff};
+
+static constexpr RegValue VILL = RegValue{1} << 63;
+} // namespace VTYPE
+
+// Vector registers with vl and vtype state.
+// Registers are stored contiguously, so register group is a flat array
+class VRFile final {
+    alignas(VLENB) std::array<uint8_t, VR_NUMBER * VLENB> m_vr{};
+
+    RegValue m_vl = 0;
+    RegValue m_vtype = VTYPE::VILL;
+
+    // Derived from vtype
+    size_t m_sew = 0;
+    size_t m_vlmax = 0;
+    size_t m_group_size = 1;
+
+  public:
+    NODISCARD uint8_t *data(size_t idx) noexcept {
+        SIM_ASSERT(idx < VR_NUMBER);
+
+        return m_vr.data() + idx * VLENB;
+    }
+
+    NODISCARD const uint8_t *data(size_t idx) const noexcept {
+        SIM_ASSERT(idx < VR_NUMBER);
+
+        return m_vr.data() + idx * VLENB;
+    }
+
+    // Element of register group starting at given register
+    template <class UInt>
+    NODISCARD UInt readElem(size_t idx, size_t elem) const noexcept {
+        SIM_ASSERT((elem + 1) * sizeof(UInt) <= (VR_NUMBER - idx) * VLENB);
+
+        UInt value = 0;
+        std::memcpy(&value, data(idx) + elem * sizeof(UInt), sizeof(UInt));
+        return value;
+    }
+
+    template <class UInt>
+    void writeElem(size_t idx, size_t elem, UInt value) noexcept {
+        SIM_ASSERT((elem + 1) * sizeof(UInt) <= (VR_NUMBER - idx) * VLENB);
+
+        std::memcpy(data(idx) + elem * sizeof(UInt), &value, sizeof(UInt));
+    }
+
+    // Mask register bits
+    NODISCARD bool maskBit(size_t idx, size_t elem) const noexcept {
+        auto byte = data(idx)[elem / bit::BYTE_SIZE];
+        return (byte >> (elem % bit::BYTE_SIZE)) & 1;
+    }
+
+    void setMaskBit(size_t idx, size_t elem, bool value) noexcept {
+        auto &byte = data(idx)[elem / bit::BYTE_SIZE];
+        auto bit_mask = static_cast<uint8_t>(1 << (elem % bit::BYTE_SIZE));
+
+        byte = value ? byte | bit_mask : byte & ~bit_mask;
+    }
+
+    // Element is active if instr is unmasked or v0 mask bit is set
+    NODISCARD bool active(bool vm, size_t elem) const noexcept {
+        return vm || maskBit(0, elem);
+    }
+
+    NODISCARD auto vl() const noexcept { return m_vl; }
+    NODISCARD auto vtype() const noexcept { return m_vtype; }
+    NODISCARD bool vill() const noexcept { return m_vtype & VTYPE::VILL; }
+
+    // Selected element width in bytes
+    NODISCARD auto sew() const noexcept { return m_sew; }
+    NODISCARD auto vlmax() const noexcept { return m_vlmax; }
+    // Number of registers in a group. Fractional LMUL uses one register
+    NODISCARD auto groupSize() const noexcept { return m_group_size; }
+
+    // Register group must start at register aligned to group size
+    NODISCARD bool validGroup(size_t idx) const noexcept {
+        return idx % m_group_size == 0;
+    }
+
+    // Number of registers in a group of elements with given width in
+    // bytes. Returns 0 for invalid vtype and groups larger than 8 registers
+    NODISCARD size_t groupSizeFor(size_t eew) const noexcept {
+        auto regs = (m_vlmax * eew + VLENB - 1) / VLENB;
+        return regs <= 8 ? regs : 0;
+    }
+
+    // Vlmax for given vtype. Unsupported vtype gives 0
+    NODISCARD static size_t vlmaxFor(RegValue vtype) noexcept {
+        auto vsew = bit::getBitField(VTYPE::VSEW_HI, VTYPE::VSEW_LO, vtype);
+        auto vlmul =
+            bit::getBitField(VTYPE::VLMUL_HI, VTYPE::VLMUL_LO, vtype);
+
+        if ((vtype & VTYPE::RESERVED_MASK) != 0 || vsew > 3 || vlmul == 4) {
+            return 0;
+        }
+
+        size_t sew_bits = bit::BYTE_SIZE << vsew;
+
+        // Fractional LMUL is 1/2, 1/4 and 1/8 for vlmul 7, 6 and 5.
+        // Element of fractional group must fit LMUL * ELEN
+        if (vlmul > 4) {
+            auto shift = 8 - vlmul;
+            if (sew_bits > ELEN >> shift) {
+                return 0;
+            }
+            return VLEN / sew_bits >> shift;
+        }
+
+        return VLEN / sew_bits << vlmul;
+    }
+
+    // Install new vtype. Unsupported vtype sets vill and zeroes vl
+    bool setVtype(RegValue vtype) noexcept {
+        auto vlmax = vlmaxFor(vtype);
+        if (vlmax == 0) {
+            m_vtype = VTYPE::VILL;
+            m_vl = 0;
+            m_sew = 0;
+            m_vlmax = 0;
+            m_group_size = 1;
+            return false;
+        }
+
+        auto vsew = bit::getBitField(VTYPE::VSEW_HI, VTYPE::VSEW_LO, vtype);
+        auto vlmul =
+            bit::getBitField(VTYPE::VLMUL_HI, VTYPE::VLMUL_LO, vtype);
+
+        m_vtype = vtype;
+        m_sew = size_t{1} << vsew;
+        m_vlmax = vlmax;
+        m_group_size = vlmul < 4 ? size_t{1} << vlmul : 1;
+        return true;
+    }
+
+    void setVl(RegValue vl) noexcept {
+        SIM_ASSERT(vl <= m_vlmax);
+
+        m_vl = vl;
+    }
+};
+
+} // namespace vr
+} // namespace sim
+
+#endif // INCL_VR_HPP
@@ -0,0 +1,652 @@
+#ifndef INCL_VR_KERNELS_HPP
+#define INCL_VR_KERNELS_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <sim/common.hpp>
+
+namespace sim::vr {
+
+// Integer element operations. Left operand is vs2 element, right operand is
+// vs1 element or scalar
+enum class Op {
+    ADD,
+    SUB,
+    RSUB,
+    AND,
+    OR,
+    XOR,
+    MINU,
+    MIN,
+    MAXU,
+    MAX,
+    SLL,
+    SRL,
+    SRA,
+    MUL,
+    // Mask logical ops
+    ANDN,
+    ORN,
+    NAND,
+    NOR,
+    XNOR
+};
+
+template <Op op, class UInt>
+NODISCARD constexpr UInt scalarOp(UInt lhs, UInt rhs) noexcept {
+    static_assert(std::is_unsigned_v<UInt>);
+
+    using Int = std::make_signed_t<UInt>;
+    constexpr UInt SHAMT_MASK = bit::bitSize<UInt>() - 1;
+
+    if constexpr (op == Op::ADD) {
+        return static_cast<UInt>(lhs + rhs);
+    } else if constexpr (op == Op::SUB) {
+        return static_cast<UInt>(lhs - rhs);
+    } else if constexpr (op == Op::RSUB) {
+        return static_cast<UInt>(rhs - lhs);
+    } else if constexpr (op == Op::AND) {
+        return lhs & rhs;
+    } else if constexpr (op == Op::OR) {
+        return lhs | rhs;
+    } else if constexpr (op == Op::XOR) {
+        return lhs ^ rhs;
+    } else if constexpr (op == Op::MINU) {
+        return lhs < rhs ? lhs : rhs;
+    } else if constexpr (op == Op::MIN) {
+        return static_cast<Int>(lhs) < static_cast<Int>(rhs) ? lhs : rhs;
+    } else if constexpr (op == Op::MAXU) {
+        return lhs > rhs ? lhs : rhs;
+    } else if constexpr (op == Op::MAX) {
+        return static_cast<Int>(lhs) > static_cast<Int>(rhs) ? lhs : rhs;
+    } else if constexpr (op == Op::SLL) {
+        return static_cast<UInt>(lhs << (rhs & SHAMT_MASK));
+    } else if constexpr (op == Op::SRL) {
+        return static_cast<UInt>(lhs >> (rhs & SHAMT_MASK));
+    } else if constexpr (op == Op::SRA) {
+        return static_cast<UInt>(static_cast<Int>(lhs) >> (rhs & SHAMT_MASK));
+    } else if constexpr (op == Op::MUL) {
+        // Avoid signed overflow of promoted narrow operands
+        return static_cast<UInt>(uint64_t{lhs} * rhs);
+    } else if constexpr (op == Op::ANDN) {
+        return lhs & static_cast<UInt>(~rhs);
+    } else if constexpr (op == Op::ORN) {
+        return lhs | static_cast<UInt>(~rhs);
+    } else if constexpr (op == Op::NAND) {
+        return static_cast<UInt>(~(lhs & rhs));
+    } else if constexpr (op == Op::NOR) {
+        return static_cast<UInt>(~(lhs | rhs));
+    } else {
+        static_assert(op == Op::XNOR);
+        return static_cast<UInt>(~(lhs ^ rhs));
+    }
+}
+
+// Host SIMD implementation. AVX2 is used when enabled for the build, SSE2
+// is the x86-64 baseline. Baseline builds switch to AVX2 at runtime when
+// host supports it. Other hosts use scalar loops only
+namespace host {
+
+#if defined(__AVX2__)
+#define SIM_HOST_SIMD 1
+using Vec = __m256i;
+#define SIM_VEC(NAME) _mm256_##NAME
+#define SIM_VEC_SI(NAME) _mm256_##NAME##_si256
+#elif defined(__SSE2__)
+#define SIM_HOST_SIMD 1
+using Vec = __m128i;
+#define SIM_VEC(NAME) _mm_##NAME
+#define SIM_VEC_SI(NAME) _mm_##NAME##_si128
+#endif
+
+#ifdef SIM_HOST_SIMD
+
+static constexpr size_t VEC_SIZE = sizeof(Vec);
+
+#ifdef __SSE4_1__
+static constexpr bool HAS_SSE4_1 = true;
+#else
+static constexpr bool HAS_SSE4_1 = false;
+#endif
+
+#ifdef __AVX2__
+static constexpr bool HAS_AVX2 = true;
+#else
+static constexpr bool HAS_AVX2 = false;
+#endif
+
+inline Vec load(const void *ptr) noexcept {
+    return SIM_VEC_SI(loadu)(static_cast<const Vec *>(ptr));
+}
+
+inline void store(void *ptr, Vec value) noexcept {
+    SIM_VEC_SI(storeu)(static_cast<Vec *>(ptr), value);
+}
+
+template <class UInt> Vec broadcast(UInt value) noexcept {
+    if constexpr (sizeof(UInt) == sizeof(uint8_t)) {
+        return SIM_VEC(set1_epi8)(static_cast<char>(value));
+    } else if constexpr (sizeof(UInt) == sizeof(uint16_t)) {
+        return SIM_VEC(set1_epi16)(static_cast<short>(value));
+    } else if constexpr (sizeof(UInt) == sizeof(uint32_t)) {
+        return SIM_VEC(set1_epi32)(static_cast<int>(value));
+    } else {
+        return SIM_VEC(set1_epi64x)(static_cast<long long>(value));
+    }
+}
+
+// Op has host SIMD implementation for given element type
+template <Op op, class UInt> constexpr bool hasSimdOp() noexcept {
+    constexpr auto size = sizeof(UInt);
+
+    switch (op) {
+    case Op::ADD:
+    case Op::SUB:
+    case Op::RSUB:
+    case Op::AND:
+    case Op::OR:
+    case Op::XOR:
+    case Op::ANDN:
+    case Op::ORN:
+    case Op::NAND:
+    case Op::NOR:
+    case Op::XNOR:
+        return true;
+    case Op::MINU:
+    case Op::MAXU:
+        return size == 1 || (size != 8 && HAS_SSE4_1);
+    case Op::MIN:
+    case Op::MAX:
+        return size == 2 || (size != 8 && HAS_SSE4_1);
+    case Op::MUL:
+        return size == 2 || (size == 4 && HAS_SSE4_1);
+    case Op::SLL:
+    case Op::SRL:
+        return size >= 4 && HAS_AVX2;
+    case Op::SRA:
+        return size == 4 && HAS_AVX2;
+    }
+
+    return false;
+}
+
+template <class UInt> Vec add(Vec lhs, Vec rhs) noexcept {
+    if constexpr (sizeof(UInt) == sizeof(uint8_t)) {
+        return SIM_VEC(add_epi8)(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint16_t)) {
+        return SIM_VEC(add_epi16)(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint32_t)) {
+        return SIM_VEC(add_epi32)(lhs, rhs);
+    } else {
+        return SIM_VEC(add_epi64)(lhs, rhs);
+    }
+}
+
+template <class UInt> Vec sub(Vec lhs, Vec rhs) noexcept {
+    if constexpr (sizeof(UInt) == sizeof(uint8_t)) {
+        return SIM_VEC(sub_epi8)(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint16_t)) {
+        return SIM_VEC(sub_epi16)(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint32_t)) {
+        return SIM_VEC(sub_epi32)(lhs, rhs);
+    } else {
+        return SIM_VEC(sub_epi64)(lhs, rhs);
+    }
+}
+
+inline Vec ones() noexcept { return broadcast(~uint64_t{0}); }
+
+template <Op op, class UInt> Vec minMax(Vec lhs, Vec rhs) noexcept {
+    constexpr auto size = sizeof(UInt);
+
+    if constexpr (op == Op::MINU && size == 1) {
+        return SIM_VEC(min_epu8)(lhs, rhs);
+    } else if constexpr (op == Op::MAXU && size == 1) {
+        return SIM_VEC(max_epu8)(lhs, rhs);
+    } else if constexpr (op == Op::MIN && size == 2) {
+        return SIM_VEC(min_epi16)(lhs, rhs);
+    } else if constexpr (op == Op::MAX && size == 2) {
+        return SIM_VEC(max_epi16)(lhs, rhs);
+    } else {
+#ifdef __SSE4_1__
+        if constexpr (op == Op::MINU) {
+            return size == 2 ? SIM_VEC(min_epu16)(lhs, rhs)
+                             : SIM_VEC(min_epu32)(lhs, rhs);
+        } else if constexpr (op == Op::MAXU) {
+            return size == 2 ? SIM_VEC(max_epu16)(lhs, rhs)
+                             : SIM_VEC(max_epu32)(lhs, rhs);
+        } else if constexpr (op == Op::MIN) {
+            return size == 1 ? SIM_VEC(min_epi8)(lhs, rhs)
+                             : SIM_VEC(min_epi32)(lhs, rhs);
+        } else {
+            return size == 1 ? SIM_VEC(max_epi8)(lhs, rhs)
+                             : SIM_VEC(max_epi32)(lhs, rhs);
+        }
+#else
+        SIM_ASSERT(0);
+        return lhs;
+#endif
+    }
+}
+
+template <Op op, class UInt> Vec shift(Vec lhs, Vec rhs) noexcept {
+#ifdef __AVX2__
+    // Shift amount is taken from low log2(SEW) bits
+    rhs = _mm256_and_si256(rhs, broadcast<UInt>(bit::bitSize<UInt>() - 1));
+
+    if constexpr (op == Op::SLL) {
+        return sizeof(UInt) == 4 ? _mm256_sllv_epi32(lhs, rhs)
+                                 : _mm256_sllv_epi64(lhs, rhs);
+    } else if constexpr (op == Op::SRL) {
+        return sizeof(UInt) == 4 ? _mm256_srlv_epi32(lhs, rhs)
+                                 : _mm256_srlv_epi64(lhs, rhs);
+    } else {
+        return _mm256_srav_epi32(lhs, rhs);
+    }
+#else
+    SIM_ASSERT(0);
+    return lhs;
+#endif
+}
+
+template <class UInt> Vec mul(Vec lhs, Vec rhs) noexcept {
+    if constexpr (sizeof(UInt) == 2) {
+        return SIM_VEC(mullo_epi16)(lhs, rhs);
+    } else {
+#ifdef __SSE4_1__
+        return SIM_VEC(mullo_epi32)(lhs, rhs);
+#else
+        SIM_ASSERT(0);
+        return lhs;
+#endif
+    }
+}
+
+template <Op op, class UInt> Vec simdOp(Vec lhs, Vec rhs) noexcept {
+    static_assert(hasSimdOp<op, UInt>());
+
+    if constexpr (op == Op::ADD) {
+        return add<UInt>(lhs, rhs);
+    } else if constexpr (op == Op::SUB) {
+        return sub<UInt>(lhs, rhs);
+    } else if constexpr (op == Op::RSUB) {
+        return sub<UInt>(rhs, lhs);
+    } else if constexpr (op == Op::AND) {
+        return SIM_VEC_SI(and)(lhs, rhs);
+    } else if constexpr (op == Op::OR) {
+        return SIM_VEC_SI(or)(lhs, rhs);
+    } else if constexpr (op == Op::XOR) {
+        return SIM_VEC_SI(xor)(lhs, rhs);
+    } else if constexpr (op == Op::ANDN) {
+        return SIM_VEC_SI(andnot)(rhs, lhs);
+    } else if constexpr (op == Op::ORN) {
+        return SIM_VEC_SI(or)(lhs, SIM_VEC_SI(xor)(rhs, ones()));
+    } else if constexpr (op == Op::NAND) {
+        return SIM_VEC_SI(xor)(SIM_VEC_SI(and)(lhs, rhs), ones());
+    } else if constexpr (op == Op::NOR) {
+        return SIM_VEC_SI(xor)(SIM_VEC_SI(or)(lhs, rhs), ones());
+    } else if constexpr (op == Op::XNOR) {
+        return SIM_VEC_SI(xor)(SIM_VEC_SI(xor)(lhs, rhs), ones());
+    } else if constexpr (op == Op::MUL) {
+        return mul<UInt>(lhs, rhs);
+    } else if constexpr (op == Op::SLL || op == Op::SRL || op == Op::SRA) {
+        return shift<op, UInt>(lhs, rhs);
+    } else {
+        return minMax<op, UInt>(lhs, rhs);
+    }
+}
+
+#undef SIM_VEC
+#undef SIM_VEC_SI
+
+#endif // SIM_HOST_SIMD
+
+// AVX2 kernels for builds not targeting AVX2. They are compiled with target
+// attribute and used when host CPU supports AVX2. AVX2 covers SSE4.1 ops
+// and adds variable shifts
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__AVX2__)
+#define SIM_HOST_AVX2_DISPATCH 1
+#define SIM_AVX2_TARGET __attribute__((target("avx2")))
+
+namespace avx2 {
+
+using Vec = __m256i;
+static constexpr size_t VEC_SIZE = sizeof(Vec);
+
+// Host CPU supports AVX2
+inline const bool ENABLED = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}();
+
+// Op has AVX2 implementation for given element type
+template <Op op, class UInt> constexpr bool hasSimdOp() noexcept {
+    constexpr auto size = sizeof(UInt);
+
+    switch (op) {
+    case Op::MINU:
+    case Op::MIN:
+    case Op::MAXU:
+    case Op::MAX:
+        return size != 8;
+    case Op::MUL:
+        return size == 2 || size == 4;
+    case Op::SLL:
+    case Op::SRL:
+        return size >= 4;
+    case Op::SRA:
+        return size == 4;
+    default:
+        return true;
+    }
+}
+
+template <class UInt>
+SIM_AVX2_TARGET Vec broadcast(UInt value) noexcept {
+    if constexpr (sizeof(UInt) == sizeof(uint8_t)) {
+        return _mm256_set1_epi8(static_cast<char>(value));
+    } else if constexpr (sizeof(UInt) == sizeof(uint16_t)) {
+        return _mm256_set1_epi16(static_cast<short>(value));
+    } else if constexpr (sizeof(UInt) == sizeof(uint32_t)) {
+        return _mm256_set1_epi32(static_cast<int>(value));
+    } else {
+        return _mm256_set1_epi64x(static_cast<long long>(value));
+    }
+}
+
+template <class UInt>
+SIM_AVX2_TARGET Vec add(Vec lhs, Vec rhs) noexcept {
+    if constexpr (sizeof(UInt) == sizeof(uint8_t)) {
+        return _mm256_add_epi8(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint16_t)) {
+        return _mm256_add_epi16(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint32_t)) {
+        return _mm256_add_epi32(lhs, rhs);
+    } else {
+        return _mm256_add_epi64(lhs, rhs);
+    }
+}
+
+template <class UInt>
+SIM_AVX2_TARGET Vec sub(Vec lhs, Vec rhs) noexcept {
+    if constexpr (sizeof(UInt) == sizeof(uint8_t)) {
+        return _mm256_sub_epi8(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint16_t)) {
+        return _mm256_sub_epi16(lhs, rhs);
+    } else if constexpr (sizeof(UInt) == sizeof(uint32_t)) {
+        return _mm256_sub_epi32(lhs, rhs);
+    } else {
+        return _mm256_sub_epi64(lhs, rhs);
+    }
+}
+
+template <Op op, class UInt>
+SIM_AVX2_TARGET Vec minMax(Vec lhs, Vec rhs) noexcept {
+    constexpr auto size = sizeof(UInt);
+
+    if constexpr (op == Op::MINU) {
+        return size == 1   ? _mm256_min_epu8(lhs, rhs)
+               : size == 2 ? _mm256_min_epu16(lhs, rhs)
+                           : _mm256_min_epu32(lhs, rhs);
+    } else if constexpr (op == Op::MAXU) {
+        return size == 1   ? _mm256_max_epu8(lhs, rhs)
+               : size == 2 ? _mm256_max_epu16(lhs, rhs)
+                           : _mm256_max_epu32(lhs, rhs);
+    } else if constexpr (op == Op::MIN) {
+        return size == 1   ? _mm256_min_epi8(lhs, rhs)
+               : size == 2 ? _mm256_min_epi16(lhs, rhs)
+                           : _mm256_min_epi32(lhs, rhs);
+    } else {
+        return size == 1   ? _mm256_max_epi8(lhs, rhs)
+               : size == 2 ? _mm256_max_epi16(lhs, rhs)
+                           : _mm256_max_epi32(lhs, rhs);
+    }
+}
+
+template <Op op, class UInt>
+SIM_AVX2_TARGET Vec shift(Vec lhs, Vec rhs) noexcept {
+    // Shift amount is taken from low log2(SEW) bits
+    rhs = _mm256_and_si256(rhs, broadcast<UInt>(bit::bitSize<UInt>() - 1));
+
+    if constexpr (op == Op::SLL) {
+        return sizeof(UInt) == 4 ? _mm256_sllv_epi32(lhs, rhs)
+                                 : _mm256_sllv_epi64(lhs, rhs);
+    } else if constexpr (op == Op::SRL) {
+        return sizeof(UInt) == 4 ? _mm256_srlv_epi32(lhs, rhs)
+                                 : _mm256_srlv_epi64(lhs, rhs);
+    } else {
+        return _mm256_srav_epi32(lhs, rhs);
+    }
+}
+
+template <Op op, class UInt>
+SIM_AVX2_TARGET Vec simdOp(Vec lhs, Vec rhs) noexcept {
+    static_assert(hasSimdOp<op, UInt>());
+
+    auto ones = _mm256_set1_epi64x(-1);
+
+    if constexpr (op == Op::ADD) {
+        return add<UInt>(lhs, rhs);
+    } else if constexpr (op == Op::SUB) {
+        return sub<UInt>(lhs, rhs);
+    } else if constexpr (op == Op::RSUB) {
+        return sub<UInt>(rhs, lhs);
+    } else if constexpr (op == Op::AND) {
+        return _mm256_and_si256(lhs, rhs);
+    } else if constexpr (op == Op::OR) {
+        return _mm256_or_si256(lhs, rhs);
+    } else if constexpr (op == Op::XOR) {
+        return _mm256_xor_si256(lhs, rhs);
+    } else if constexpr (op == Op::ANDN) {
+        return _mm256_andnot_si256(rhs, lhs);
+    } else if constexpr (op == Op::ORN) {
+        return _mm256_or_si256(lhs, _mm256_xor_si256(rhs, ones));
+    } else if constexpr (op == Op::NAND) {
+        return _mm256_xor_si256(_mm256_and_si256(lhs, rhs), ones);
+    } else if constexpr (op == Op::NOR) {
+        return _mm256_xor_si256(_mm256_or_si256(lhs, rhs), ones);
+    } else if constexpr (op == Op::XNOR) {
+        return _mm256_xor_si256(_mm256_xor_si256(lhs, rhs), ones);
+    } else if constexpr (op == Op::MUL) {
+        return sizeof(UInt) == 2 ? _mm256_mullo_epi16(lhs, rhs)
+                                 : _mm256_mullo_epi32(lhs, rhs);
+    } else if constexpr (op == Op::SLL || op == Op::SRL || op == Op::SRA) {
+        return shift<op, UInt>(lhs, rhs);
+    } else {
+        return minMax<op, UInt>(lhs, rhs);
+    }
+}
+
+// Loops below process whole vectors and return processed elements number
+
+template <Op op, class UInt>
+SIM_AVX2_TARGET size_t vvLoop(UInt *vd, const UInt *vs2, const UInt *vs1,
+                              size_t n) noexcept {
+    constexpr size_t LANES = VEC_SIZE / sizeof(UInt);
+
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        auto lhs = _mm256_loadu_si256(reinterpret_cast<const Vec *>(vs2 + i));
+        auto rhs = _mm256_loadu_si256(reinterpret_cast<const Vec *>(vs1 + i));
+        _mm256_storeu_si256(reinterpret_cast<Vec *>(vd + i),
+                            simdOp<op, UInt>(lhs, rhs));
+    }
+
+    return i;
+}
+
+template <Op op, class UInt>
+SIM_AVX2_TARGET size_t vxLoop(UInt *vd, const UInt *vs2, UInt x,
+                              size_t n) noexcept {
+    constexpr size_t LANES = VEC_SIZE / sizeof(UInt);
+    auto rhs = broadcast(x);
+
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        auto lhs = _mm256_loadu_si256(reinterpret_cast<const Vec *>(vs2 + i));
+        _mm256_storeu_si256(reinterpret_cast<Vec *>(vd + i),
+                            simdOp<op, UInt>(lhs, rhs));
+    }
+
+    return i;
+}
+
+// Fold whole vectors of vs2 into acc
+template <Op op, class UInt>
+SIM_AVX2_TARGET size_t reduceLoop(const UInt *vs2, size_t n,
+                                  UInt &acc) noexcept {
+    constexpr size_t LANES = VEC_SIZE / sizeof(UInt);
+    if (n < LANES) {
+        return 0;
+    }
+
+    auto vacc = _mm256_loadu_si256(reinterpret_cast<const Vec *>(vs2));
+
+    size_t i = LANES;
+    for (; i + LANES <= n; i += LANES) {
+        auto rhs = _mm256_loadu_si256(reinterpret_cast<const Vec *>(vs2 + i));
+        vacc = simdOp<op, UInt>(vacc, rhs);
+    }
+
+    UInt lanes[LANES];
+    _mm256_storeu_si256(reinterpret_cast<Vec *>(lanes), vacc);
+    for (auto lane : lanes) {
+        acc = scalarOp<op>(acc, lane);
+    }
+
+    return i;
+}
+
+} // namespace avx2
+
+#undef SIM_AVX2_TARGET
+
+#endif // SIM_HOST_AVX2_DISPATCH
+
+} // namespace host
+
+// vd[i] = op(vs2[i], vs1[i]) for first n elements
+template <Op op, class UInt>
+void vvKernel(UInt *vd, const UInt *vs2, const UInt *vs1, size_t n) noexcept {
+    size_t i = 0;
+
+#ifdef SIM_HOST_AVX2_DISPATCH
+    if constexpr (host::avx2::hasSimdOp<op, UInt>()) {
+        if (host::avx2::ENABLED) {
+            i = host::avx2::vvLoop<op>(vd, vs2, vs1, n);
+        }
+    }
+#endif
+
+#ifdef SIM_HOST_SIMD
+    if constexpr (host::hasSimdOp<op, UInt>()) {
+        constexpr size_t LANES = host::VEC_SIZE / sizeof(UInt);
+
+        for (; i + LANES <= n; i += LANES) {
+            host::store(vd + i, host::simdOp<op, UInt>(host::load(vs2 + i),
+                                                       host::load(vs1 + i)));
+        }
+    }
+#endif
+
+    for (; i != n; ++i) {
+        vd[i] = scalarOp<op>(vs2[i], vs1[i]);
+    }
+}
+
+// vd[i] = op(vs2[i], x) for first n elements
+template <Op op, class UInt>
+void vxKernel(UInt *vd, const UInt *vs2, UInt x, size_t n) noexcept {
+    size_t i = 0;
+
+#ifdef SIM_HOST_AVX2_DISPATCH
+    if constexpr (host::avx2::hasSimdOp<op, UInt>()) {
+        if (host::avx2::ENABLED) {
+            i = host::avx2::vxLoop<op>(vd, vs2, x, n);
+        }
+    }
+#endif
+
+#ifdef SIM_HOST_SIMD
+    if constexpr (host::hasSimdOp<op, UInt>()) {
+        constexpr size_t LANES = host::VEC_SIZE / sizeof(UInt);
+        auto rhs = host::broadcast(x);
+
+        for (; i + LANES <= n; i += LANES) {
+            host::store(vd + i,
+                        host::simdOp<op, UInt>(host::load(vs2 + i), rhs));
+        }
+    }
+#endif
+
+    for (; i != n; ++i) {
+        vd[i] = scalarOp<op>(vs2[i], x);
+    }
+}
+
+// Fold first n elements of vs2 into init with op
+template <Op op, class UInt>
+NODISCARD UInt reduceKernel(const UInt *vs2, size_t n, UInt init) noexcept {
+    size_t i = 0;
+    UInt acc = init;
+
+#ifdef SIM_HOST_AVX2_DISPATCH
+    if constexpr (host::avx2::hasSimdOp<op, UInt>()) {
+        if (host::avx2::ENABLED) {
+            i = host::avx2::reduceLoop<op>(vs2, n, acc);
+        }
+    }
+#endif
+
+#ifdef SIM_HOST_SIMD
+    if constexpr (host::hasSimdOp<op, UInt>()) {
+        constexpr size_t LANES = host::VEC_SIZE / sizeof(UInt);
+
+        if (i == 0 && n >= LANES) {
+            auto vacc = host::load(vs2);
+            for (i = LANES; i + LANES <= n; i += LANES) {
+                vacc = host::simdOp<op, UInt>(vacc, host::load(vs2 + i));
+            }
+
+            UInt lanes[LANES];
+            host::store(lanes, vacc);
+            for (auto lane : lanes) {
+                acc = scalarOp<op>(acc, lane);
+            }
+        }
+    }
+#endif
+
+    for (; i != n; ++i) {
+        acc = scalarOp<op>(acc, vs2[i]);
+    }
+
+    return acc;
+}
+
+// vd[i] = x for first n elements
+template <class UInt> void splatKernel(UInt *vd, UInt x, size_t n) noexcept {
+    size_t i = 0;
+
+#ifdef SIM_HOST_SIMD
+    constexpr size_t LANES = host::VEC_SIZE / sizeof(UInt);
+    auto value = host::broadcast(x);
+
+    for (; i + LANES <= n; i += LANES) {
+        host::store(vd + i, value);
+    }
+#endif
+
+    for (; i != n; ++i) {
+        vd[i] = x;
+    }
+}
+
+} // namespace sim::vr
+
+#endif // INCL_VR_KERNELS_HPP
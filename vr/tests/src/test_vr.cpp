@@ -0,0 +1,142 @@
+#include <array>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include <sim/common.hpp>
+#include <sim/vr.hpp>
+#include <sim/vr/kernels.hpp>
+
+namespace sim {
+namespace vr {
+
+class VRTest : public ::testing::Test {
+  protected:
+    static constexpr uint64_t MT_SEED = 1003;
+    std::mt19937_64 mt{MT_SEED};
+
+    VRFile vr_file{};
+
+    // vtype for given vsew and vlmul fields
+    static RegValue makeVtype(RegValue vsew, RegValue vlmul) {
+        return vsew << VTYPE::VSEW_LO | vlmul << VTYPE::VLMUL_LO;
+    }
+
+    // Check kernels on all element counts up to n against scalarOp
+    template <Op op, class UInt> void checkKernels() {
+        static constexpr size_t N = 8 * VLENB / sizeof(UInt);
+
+        std::array<UInt, N> vs2{};
+        std::array<UInt, N> vs1{};
+        for (size_t i = 0; i != N; ++i) {
+            vs2[i] = static_cast<UInt>(mt());
+            vs1[i] = static_cast<UInt>(mt());
+        }
+        auto x = static_cast<UInt>(mt());
+
+        for (size_t n = 0; n <= N; n += 3) {
+            std::array<UInt, N> vd{};
+
+            vvKernel<op>(vd.data(), vs2.data(), vs1.data(), n);
+            for (size_t i = 0; i != n; ++i) {
+                ASSERT_EQ(vd[i], scalarOp<op>(vs2[i], vs1[i]));
+            }
+
+            vxKernel<op>(vd.data(), vs2.data(), x, n);
+            for (size_t i = 0; i != n; ++i) {
+                ASSERT_EQ(vd[i], scalarOp<op>(vs2[i], x));
+            }
+        }
+    }
+};
+
+TEST_F(VRTest, vtype) {
+    ASSERT_TRUE(vr_file.vill());
+
+    // SEW = 32, LMUL = 2
+    ASSERT_TRUE(vr_file.setVtype(makeVtype(2, 1)));
+    ASSERT_FALSE(vr_file.vill());
+    ASSERT_EQ(vr_file.sew(), 4);
+    ASSERT_EQ(vr_file.vlmax(), 2 * VLEN / 32);
+    ASSERT_EQ(vr_file.groupSize(), 2);
+    ASSERT_TRUE(vr_file.validGroup(4));
+    ASSERT_FALSE(vr_file.validGroup(3));
+    // EEW = 64 with SEW / LMUL = 16 needs 4 registers
+    ASSERT_EQ(vr_file.groupSizeFor(8), 4);
+
+    // SEW = 16, LMUL = 1/4
+    ASSERT_EQ(VRFile::vlmaxFor(makeVtype(1, 6)), VLEN / 16 / 4);
+    // SEW = 64 does not fit LMUL = 1/2 with ELEN = 64
+    ASSERT_EQ(VRFile::vlmaxFor(makeVtype(3, 7)), 0);
+    // Reserved vlmul and vsew
+    ASSERT_EQ(VRFile::vlmaxFor(makeVtype(0, 4)), 0);
+    ASSERT_EQ(VRFile::vlmaxFor(makeVtype(4, 0)), 0);
+
+    vr_file.setVl(3);
+    ASSERT_FALSE(vr_file.setVtype(RegValue{1} << 8));
+    ASSERT_TRUE(vr_file.vill());
+    ASSERT_EQ(vr_file.vl(), 0);
+}
+
+TEST_F(VRTest, elems) {
+    // Elements of register group continue in next register
+    auto last = VLENB / sizeof(uint32_t);
+    vr_file.writeElem<uint32_t>(2, last, 0xdeadbeef);
+    ASSERT_EQ(vr_file.readElem<uint32_t>(3, 0), 0xdeadbeef);
+    ASSERT_EQ(vr_file.readElem<uint16_t>(3, 1), 0xdead);
+
+    vr_file.setMaskBit(0, 9, true);
+    ASSERT_EQ(vr_file.data(0)[1], 0x2);
+    ASSERT_TRUE(vr_file.maskBit(0, 9));
+    ASSERT_TRUE(vr_file.active(false, 9));
+    ASSERT_FALSE(vr_file.active(false, 8));
+    ASSERT_TRUE(vr_file.active(true, 8));
+
+    vr_file.setMaskBit(0, 9, false);
+    ASSERT_EQ(vr_file.data(0)[1], 0);
+}
+
+TEST_F(VRTest, kernels) {
+    checkKernels<Op::ADD, uint8_t>();
+    checkKernels<Op::SUB, uint16_t>();
+    checkKernels<Op::RSUB, uint32_t>();
+    checkKernels<Op::XOR, uint64_t>();
+    checkKernels<Op::MIN, uint8_t>();
+    checkKernels<Op::MAXU, uint32_t>();
+    checkKernels<Op::MAX, uint64_t>();
+    checkKernels<Op::SLL, uint16_t>();
+    checkKernels<Op::SRA, uint32_t>();
+    checkKernels<Op::SRL, uint64_t>();
+    checkKernels<Op::MUL, uint16_t>();
+    checkKernels<Op::MUL, uint64_t>();
+
+    // Ops with SSE4.1 and AVX2 kernels only
+    checkKernels<Op::MINU, uint16_t>();
+    checkKernels<Op::MIN, uint32_t>();
+    checkKernels<Op::MAX, uint8_t>();
+    checkKernels<Op::MUL, uint32_t>();
+    checkKernels<Op::SLL, uint32_t>();
+    checkKernels<Op::SRL, uint32_t>();
+    checkKernels<Op::SLL, uint64_t>();
+
+    std::array<uint32_t, 37> vs2{};
+    uint32_t sum = 5;
+    uint32_t min = 5;
+    for (auto &elem : vs2) {
+        elem = static_cast<uint32_t>(mt());
+        sum += elem;
+        min = std::min(min, elem);
+    }
+
+    ASSERT_EQ(reduceKernel<Op::ADD>(vs2.data(), vs2.size(), 5u), sum);
+    ASSERT_EQ(reduceKernel<Op::MINU>(vs2.data(), vs2.size(), 5u), min);
+
+    std::array<uint16_t, 21> vd{};
+    splatKernel<uint16_t>(vd.data(), 0xabcd, vd.size());
+    for (auto elem : vd) {
+        ASSERT_EQ(elem, 0xabcd);
+    }
+}
+
+} // namespace vr
+} // namespace sim